@@ -0,0 +1,191 @@
+#include <vector>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+#include "Core/JobSystem.hpp"
+#include "Scene/DynamicBVH.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    // Boxes scattered through a cube whose side grows with the count, so the
+    // density, and with it the number of hits per query, stays constant.
+    std::vector<AABB> MakeBoxes(u32 count)
+    {
+        std::mt19937 rng(42);
+        f32 side = 10.0f * std::cbrt(static_cast<f32>(count));
+        std::uniform_real_distribution<f32> position(-side, side);
+        std::uniform_real_distribution<f32> extent(0.1f, 2.0f);
+
+        std::vector<AABB> boxes(count);
+        for (AABB& box : boxes) {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            glm::vec3 extents(extent(rng), extent(rng), extent(rng));
+            box = { center - extents, center + extents };
+        }
+        return boxes;
+    }
+
+    Frustum MakeFrustum()
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 50.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return Frustum::FromMatrix(projection * view);
+    }
+
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem s_Jobs;
+        return s_Jobs;
+    }
+
+}
+
+static void BM_Linear_FrustumQuery(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+    Frustum frustum = MakeFrustum();
+
+    std::vector<u32> visible;
+    for (auto _ : state) {
+        visible.clear();
+        for (u32 i = 0; i < boxes.size(); ++i) {
+            if (frustum.Intersects(boxes[i]))
+                visible.push_back(i);
+        }
+        DoNotOptimize(visible.data());
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+    state.SetCounter("visible", static_cast<f64>(visible.size()));
+}
+BENCHMARK(BM_Linear_FrustumQuery, 10000, 100000, 1000000);
+
+static void BM_BVH_FrustumQuery(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+    Frustum frustum = MakeFrustum();
+
+    DynamicBVH bvh;
+    for (u32 i = 0; i < boxes.size(); ++i)
+        bvh.CreateProxy(boxes[i], i);
+
+    std::vector<u32> visible;
+    for (auto _ : state) {
+        visible.clear();
+        bvh.Query(frustum, [&](u32 proxy) { visible.push_back(proxy); return true; });
+        DoNotOptimize(visible.data());
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+    state.SetCounter("visible", static_cast<f64>(visible.size()));
+    state.SetCounter("height", bvh.GetHeight());
+}
+BENCHMARK(BM_BVH_FrustumQuery, 10000, 100000, 1000000);
+
+static void BM_Linear_RayCast(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+    Ray ray { glm::vec3(0.0f), glm::normalize(glm::vec3(0.3f, 0.2f, -1.0f)) };
+    glm::vec3 invDirection = 1.0f / ray.Direction;
+
+    for (auto _ : state) {
+        f32 closest = 1000.0f;
+        for (const AABB& box : boxes) {
+            f32 distance;
+            if (IntersectRay(ray, invDirection, box, closest, distance))
+                closest = distance;
+        }
+        DoNotOptimize(closest);
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_Linear_RayCast, 10000, 100000, 1000000);
+
+static void BM_BVH_RayCast(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+    Ray ray { glm::vec3(0.0f), glm::normalize(glm::vec3(0.3f, 0.2f, -1.0f)) };
+    glm::vec3 invDirection = 1.0f / ray.Direction;
+
+    DynamicBVH bvh(0.0f);
+    for (u32 i = 0; i < boxes.size(); ++i)
+        bvh.CreateProxy(boxes[i], i);
+
+    for (auto _ : state) {
+        f32 closest = 1000.0f;
+        bvh.RayCast(ray, closest, [&](u32 proxy, const Ray&, f32 maxDistance) {
+            f32 distance;
+            if (IntersectRay(ray, invDirection, boxes[bvh.GetUserData(proxy)], maxDistance, distance))
+                closest = distance;
+            return closest;
+        });
+        DoNotOptimize(closest);
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_BVH_RayCast, 10000, 100000, 1000000);
+
+static void BM_BVH_MoveProxies(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+
+    DynamicBVH bvh;
+    std::vector<u32> proxies(boxes.size());
+    for (u32 i = 0; i < boxes.size(); ++i)
+        proxies[i] = bvh.CreateProxy(boxes[i], i);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<f32> step(-0.05f, 0.05f);
+
+    for (auto _ : state) {
+        for (u32 i = 0; i < boxes.size(); ++i) {
+            glm::vec3 delta(step(rng), step(rng), step(rng));
+            boxes[i].Min += delta;
+            boxes[i].Max += delta;
+            bvh.MoveProxy(proxies[i], boxes[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.Iterations() * boxes.size());
+}
+BENCHMARK(BM_BVH_MoveProxies, 10000, 100000);
+
+static void BM_BVH_Rebuild(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+
+    DynamicBVH bvh;
+    for (u32 i = 0; i < boxes.size(); ++i)
+        bvh.CreateProxy(boxes[i], i);
+
+    for (auto _ : state)
+        bvh.Rebuild();
+
+    state.SetItemsProcessed(state.Iterations() * boxes.size());
+    state.SetCounter("area_ratio", bvh.GetAreaRatio());
+}
+BENCHMARK(BM_BVH_Rebuild, 10000, 100000, 1000000);
+
+static void BM_BVH_RebuildParallel(State& state)
+{
+    std::vector<AABB> boxes = MakeBoxes(static_cast<u32>(state.Arg(0)));
+
+    DynamicBVH bvh;
+    for (u32 i = 0; i < boxes.size(); ++i)
+        bvh.CreateProxy(boxes[i], i);
+
+    for (auto _ : state)
+        bvh.Rebuild(&GetJobSystem());
+
+    state.SetItemsProcessed(state.Iterations() * boxes.size());
+    state.SetCounter("area_ratio", bvh.GetAreaRatio());
+}
+BENCHMARK(BM_BVH_RebuildParallel, 10000, 100000, 1000000);
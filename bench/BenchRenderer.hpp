@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Graphics {
+    class Renderer;
+}
+
+namespace Graphics::Bench {
+
+    // Headless renderer shared by the GPU benchmarks, created by the first
+    // one that runs so CPU-only runs never touch the device.
+    Renderer& GetRenderer();
+
+    // Destroys the shared renderer if one was created. It logs on the way
+    // out, so this has to run before Log::Shutdown().
+    void ReleaseRenderer();
+
+}
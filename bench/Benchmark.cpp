@@ -0,0 +1,170 @@
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <ctime>
+
+namespace Graphics::Bench {
+
+    void State::StartTimer()
+    {
+        m_Running = true;
+        m_Start = std::chrono::steady_clock::now();
+    }
+
+    void State::StopTimer()
+    {
+        if (!m_Running)
+            return;
+
+        m_Elapsed += std::chrono::steady_clock::now() - m_Start;
+        m_Running = false;
+    }
+
+    void State::PauseTiming()
+    {
+        StopTimer();
+    }
+
+    void State::ResumeTiming()
+    {
+        StartTimer();
+    }
+
+    Registry& Registry::Get()
+    {
+        static Registry s_Registry;
+        return s_Registry;
+    }
+
+    int Registry::Register(const std::string& name, BenchmarkFn fn, std::vector<i64> args)
+    {
+        if (args.empty()) {
+            m_Entries.push_back({ name, fn, {} });
+        } else {
+            for (i64 arg : args)
+                m_Entries.push_back({ name + "/" + std::to_string(arg), fn, { arg } });
+        }
+
+        return static_cast<int>(m_Entries.size());
+    }
+
+    static std::string EscapeJson(const std::string& value)
+    {
+        std::string result;
+        for (char c : value) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+    int Registry::Run(const RunOptions& options)
+    {
+        struct Result
+        {
+            std::string Name;
+            u64 Iterations;
+            f64 Nanoseconds;
+            f64 ItemsPerSecond;
+            f64 BytesPerSecond;
+            std::string Label;
+            std::map<std::string, f64> Counters;
+        };
+
+        std::vector<Result> results;
+
+        std::printf("%-48s %14s %12s %16s\n", "Benchmark", "Time (ns)", "Iterations", "Items/s");
+        std::printf("%s\n", std::string(93, '-').c_str());
+
+        for (const Entry& entry : m_Entries) {
+            if (!options.Filter.empty() && entry.Name.find(options.Filter) == std::string::npos)
+                continue;
+
+            // Grow the iteration count until one run covers the minimum time,
+            // the last run is the one reported.
+            u64 iterations = 1;
+            while (true) {
+                State state(iterations, entry.Args);
+                entry.Fn(state);
+                state.StopTimer();
+
+                f64 seconds = std::chrono::duration<f64>(state.m_Elapsed).count();
+                if (seconds >= options.MinTime || iterations >= (1ull << 30)) {
+                    Result result;
+                    result.Name = entry.Name;
+                    result.Iterations = iterations;
+                    result.Nanoseconds = seconds * 1e9 / static_cast<f64>(iterations);
+                    result.ItemsPerSecond = seconds > 0.0 ? static_cast<f64>(state.m_ItemsProcessed) / seconds : 0.0;
+                    result.BytesPerSecond = seconds > 0.0 ? static_cast<f64>(state.m_BytesProcessed) / seconds : 0.0;
+                    result.Label = state.m_Label;
+                    result.Counters = state.m_Counters;
+                    results.push_back(result);
+
+                    std::printf("%-48s %14.0f %12llu %16.4g %s\n", result.Name.c_str(), result.Nanoseconds,
+                        static_cast<unsigned long long>(iterations), result.ItemsPerSecond, result.Label.c_str());
+                    break;
+                }
+
+                f64 scale = seconds > 0.0 ? options.MinTime * 1.4 / seconds : 10.0;
+                iterations = static_cast<u64>(std::clamp(static_cast<f64>(iterations) * scale, static_cast<f64>(iterations + 1), static_cast<f64>(iterations) * 10.0));
+            }
+        }
+
+        if (options.OutputPath.empty())
+            return 0;
+
+        std::ofstream out(options.OutputPath);
+        if (!out) {
+            std::fprintf(stderr, "Failed to open %s\n", options.OutputPath.c_str());
+            return 1;
+        }
+
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n";
+        out << "  \"context\": {\n";
+        out << "    \"date\": \"" << date << "\",\n";
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        out << "    \"library_build_type\": \"release\"\n";
+#else
+        out << "    \"library_build_type\": \"debug\"\n";
+#endif
+        out << "  },\n";
+        out << "  \"benchmarks\": [\n";
+
+        for (usize i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+
+            out << "    {\n";
+            out << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n";
+            out << "      \"run_name\": \"" << EscapeJson(result.Name) << "\",\n";
+            out << "      \"run_type\": \"iteration\",\n";
+            out << "      \"iterations\": " << result.Iterations << ",\n";
+            out << "      \"real_time\": " << result.Nanoseconds << ",\n";
+            out << "      \"cpu_time\": " << result.Nanoseconds << ",\n";
+            out << "      \"time_unit\": \"ns\"";
+            if (result.ItemsPerSecond > 0.0)
+                out << ",\n      \"items_per_second\": " << result.ItemsPerSecond;
+            if (result.BytesPerSecond > 0.0)
+                out << ",\n      \"bytes_per_second\": " << result.BytesPerSecond;
+            if (!result.Label.empty())
+                out << ",\n      \"label\": \"" << EscapeJson(result.Label) << "\"";
+            for (const auto& [name, value] : result.Counters)
+                out << ",\n      \"" << EscapeJson(name) << "\": " << value;
+            out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n";
+        out << "}\n";
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <map>
+#include <atomic>
+
+#include "Types.hpp"
+
+namespace Graphics::Bench {
+
+    // Per-run state handed to a benchmark. The body loops over the state,
+    // everything outside the loop is setup and is not timed:
+    //
+    //     static void BM_Foo(State& state) {
+    //         Setup(state.Arg(0));
+    //         for (auto _ : state) Work();
+    //         state.SetItemsProcessed(state.Iterations() * state.Arg(0));
+    //     }
+    //     BENCHMARK(BM_Foo, 1000, 100000);
+    class State
+    {
+    public:
+        // Non-trivial so `for (auto _ : state)` does not trigger unused variable warnings.
+        struct Value
+        {
+            ~Value() {}
+        };
+
+        class Iterator
+        {
+        public:
+            Iterator(State* state, u64 remaining) : m_State(state), m_Remaining(remaining) {}
+
+            inline bool operator!=(const Iterator&) const
+            {
+                if (m_Remaining > 0)
+                    return true;
+                m_State->StopTimer();
+                return false;
+            }
+
+            inline Iterator& operator++() { --m_Remaining; return *this; }
+            inline Value operator*() const { return {}; }
+
+        private:
+            State* m_State;
+            u64 m_Remaining;
+        };
+
+    public:
+        State(u64 iterations, const std::vector<i64>& args)
+            : m_Iterations(iterations), m_Args(args) {}
+
+        inline Iterator begin() { StartTimer(); return Iterator(this, m_Iterations); }
+        inline Iterator end() { return Iterator(this, 0); }
+
+        inline i64 Arg(usize index) const { return m_Args[index]; }
+        inline u64 Iterations() const { return m_Iterations; }
+
+        inline void SetItemsProcessed(u64 items) { m_ItemsProcessed = items; }
+        inline void SetBytesProcessed(u64 bytes) { m_BytesProcessed = bytes; }
+        inline void SetLabel(const std::string& label) { m_Label = label; }
+        inline void SetCounter(const std::string& name, f64 value) { m_Counters[name] = value; }
+
+        // Excludes per-iteration setup from the measurement.
+        void PauseTiming();
+        void ResumeTiming();
+
+    private:
+        friend class Registry;
+
+        void StartTimer();
+        void StopTimer();
+
+    private:
+        u64 m_Iterations;
+        std::vector<i64> m_Args;
+
+        std::chrono::steady_clock::time_point m_Start;
+        std::chrono::steady_clock::duration m_Elapsed {};
+        bool m_Running { false };
+
+        u64 m_ItemsProcessed { 0 };
+        u64 m_BytesProcessed { 0 };
+        std::string m_Label;
+        std::map<std::string, f64> m_Counters;
+    };
+
+    using BenchmarkFn = void(*)(State&);
+
+    struct RunOptions
+    {
+        std::string Filter;
+        std::string OutputPath;
+        f64 MinTime { 0.5 };
+    };
+
+    class Registry
+    {
+    public:
+        static Registry& Get();
+
+        int Register(const std::string& name, BenchmarkFn fn, std::vector<i64> args);
+
+        // Runs every benchmark whose name contains the filter, prints a table
+        // and optionally writes Google Benchmark compatible JSON.
+        int Run(const RunOptions& options);
+
+    private:
+        struct Entry
+        {
+            std::string Name;
+            BenchmarkFn Fn;
+            std::vector<i64> Args;
+        };
+
+        std::vector<Entry> m_Entries;
+    };
+
+    // Keeps the optimizer from discarding a value that is otherwise unused.
+    template<typename T>
+    inline void DoNotOptimize(T&& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    inline void ClobberMemory()
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+}
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+
+// Registers fn once per argument, or once without arguments.
+#define BENCHMARK(fn, ...) \
+    static int BENCH_CONCAT(s_Benchmark_, __LINE__) = ::Graphics::Bench::Registry::Get().Register(#fn, fn, { __VA_ARGS__ })
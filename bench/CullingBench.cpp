@@ -0,0 +1,129 @@
+#include <vector>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+#include "Core/JobSystem.hpp"
+#include "Renderer/FrustumCuller.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    // Camera at the origin looking down -Z with a 60 degree field of view,
+    // objects scattered through a 200 unit cube so roughly a tenth survive.
+    Frustum MakeFrustum()
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return Frustum::FromMatrix(projection * view);
+    }
+
+    SphereBoundsArray MakeSpheres(u32 count)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<f32> radius(0.1f, 2.0f);
+
+        SphereBoundsArray bounds;
+        bounds.Resize(count);
+        for (u32 i = 0; i < count; ++i)
+            bounds.Set(i, { glm::vec3(position(rng), position(rng), position(rng)), radius(rng) });
+        return bounds;
+    }
+
+    BoxBoundsArray MakeBoxes(u32 count)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<f32> extent(0.1f, 2.0f);
+
+        BoxBoundsArray bounds;
+        bounds.Resize(count);
+        for (u32 i = 0; i < count; ++i) {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            glm::vec3 extents(extent(rng), extent(rng), extent(rng));
+            bounds.Set(i, { center - extents, center + extents });
+        }
+        return bounds;
+    }
+
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem s_Jobs;
+        return s_Jobs;
+    }
+
+    template<typename Bounds>
+    void RunCull(State& state, const Bounds& bounds, CullingPath path, JobSystem* jobs)
+    {
+        Frustum frustum = MakeFrustum();
+
+        FrustumCuller culler(jobs);
+        culler.SetPath(path);
+
+        std::vector<u32> visible;
+        visible.reserve(bounds.Size());
+
+        for (auto _ : state) {
+            culler.Cull(frustum, bounds, visible);
+            DoNotOptimize(visible.data());
+        }
+
+        state.SetItemsProcessed(state.Iterations() * bounds.Size());
+        state.SetLabel(FrustumCuller::GetPathName(culler.GetPath()));
+        state.SetCounter("visible", static_cast<f64>(visible.size()));
+    }
+
+}
+
+static void BM_CullSpheres_Scalar(State& state)
+{
+    RunCull(state, MakeSpheres(static_cast<u32>(state.Arg(0))), CullingPath::Scalar, nullptr);
+}
+BENCHMARK(BM_CullSpheres_Scalar, 10000, 100000, 1000000);
+
+static void BM_CullSpheres_SSE(State& state)
+{
+    RunCull(state, MakeSpheres(static_cast<u32>(state.Arg(0))), CullingPath::SSE, nullptr);
+}
+BENCHMARK(BM_CullSpheres_SSE, 10000, 100000, 1000000);
+
+static void BM_CullSpheres_AVX2(State& state)
+{
+    RunCull(state, MakeSpheres(static_cast<u32>(state.Arg(0))), CullingPath::AVX2, nullptr);
+}
+BENCHMARK(BM_CullSpheres_AVX2, 10000, 100000, 1000000);
+
+static void BM_CullSpheres_Parallel(State& state)
+{
+    RunCull(state, MakeSpheres(static_cast<u32>(state.Arg(0))), CullingPath::AVX2, &GetJobSystem());
+}
+BENCHMARK(BM_CullSpheres_Parallel, 10000, 100000, 1000000);
+
+static void BM_CullBoxes_Scalar(State& state)
+{
+    RunCull(state, MakeBoxes(static_cast<u32>(state.Arg(0))), CullingPath::Scalar, nullptr);
+}
+BENCHMARK(BM_CullBoxes_Scalar, 10000, 100000, 1000000);
+
+static void BM_CullBoxes_SSE(State& state)
+{
+    RunCull(state, MakeBoxes(static_cast<u32>(state.Arg(0))), CullingPath::SSE, nullptr);
+}
+BENCHMARK(BM_CullBoxes_SSE, 10000, 100000, 1000000);
+
+static void BM_CullBoxes_AVX2(State& state)
+{
+    RunCull(state, MakeBoxes(static_cast<u32>(state.Arg(0))), CullingPath::AVX2, nullptr);
+}
+BENCHMARK(BM_CullBoxes_AVX2, 10000, 100000, 1000000);
+
+static void BM_CullBoxes_Parallel(State& state)
+{
+    RunCull(state, MakeBoxes(static_cast<u32>(state.Arg(0))), CullingPath::AVX2, &GetJobSystem());
+}
+BENCHMARK(BM_CullBoxes_Parallel, 10000, 100000, 1000000);
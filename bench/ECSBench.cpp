@@ -0,0 +1,210 @@
+#include <vector>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "Benchmark.hpp"
+#include "Core/JobSystem.hpp"
+#include "Scene/World.hpp"
+#include "Scene/SystemScheduler.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    // Array-of-structs baseline, laid out the way a classic GameObject would be.
+    struct GameObject
+    {
+        glm::mat4 Transform { 1.0f };
+        glm::vec3 Position { 0.0f };
+        glm::vec3 Velocity { 0.0f };
+        glm::vec4 Color { 1.0f };
+        f32 Rotation { 0.0f };
+        f32 AngularVelocity { 0.0f };
+        u32 Flags { 0 };
+    };
+
+    struct Position { glm::vec3 Value; };
+    struct Velocity { glm::vec3 Value; };
+    struct Rotation { f32 Angle; f32 AngularVelocity; };
+    struct Color { glm::vec4 Value; };
+    struct Transform { glm::mat4 Value; };
+
+    constexpr f32 s_DeltaTime = 1.0f / 60.0f;
+
+    glm::mat4 ComposeTransform(const glm::vec3& position, f32 angle)
+    {
+        f32 c = std::cos(angle);
+        f32 s = std::sin(angle);
+
+        glm::mat4 result(1.0f);
+        result[0][0] = c;
+        result[0][1] = s;
+        result[1][0] = -s;
+        result[1][1] = c;
+        result[3] = glm::vec4(position, 1.0f);
+        return result;
+    }
+
+    std::vector<GameObject> MakeObjects(usize count)
+    {
+        std::vector<GameObject> objects(count);
+        for (usize i = 0; i < count; ++i) {
+            objects[i].Position = glm::vec3(static_cast<f32>(i), 0.0f, 0.0f);
+            objects[i].Velocity = glm::vec3(1.0f, 0.5f, 0.0f);
+            objects[i].AngularVelocity = 0.1f;
+        }
+        return objects;
+    }
+
+    void PopulateWorld(World& world, usize count)
+    {
+        for (usize i = 0; i < count; ++i) {
+            world.Create(
+                Position { glm::vec3(static_cast<f32>(i), 0.0f, 0.0f) },
+                Velocity { glm::vec3(1.0f, 0.5f, 0.0f) },
+                Rotation { 0.0f, 0.1f },
+                Color { glm::vec4(1.0f) },
+                Transform { glm::mat4(1.0f) }
+            );
+        }
+    }
+
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem s_Jobs;
+        return s_Jobs;
+    }
+
+}
+
+static void BM_AoS_Integrate(State& state)
+{
+    std::vector<GameObject> objects = MakeObjects(static_cast<usize>(state.Arg(0)));
+
+    for (auto _ : state) {
+        for (GameObject& object : objects)
+            object.Position += object.Velocity * s_DeltaTime;
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * objects.size());
+}
+BENCHMARK(BM_AoS_Integrate, 10000, 100000, 1000000);
+
+static void BM_ECS_Integrate(State& state)
+{
+    World world;
+    PopulateWorld(world, static_cast<usize>(state.Arg(0)));
+
+    for (auto _ : state) {
+        world.EachChunk<Position, const Velocity>([](u32 count, Entity*, Position* positions, const Velocity* velocities) {
+            for (u32 i = 0; i < count; ++i)
+                positions[i].Value += velocities[i].Value * s_DeltaTime;
+        });
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * world.GetEntityCount());
+}
+BENCHMARK(BM_ECS_Integrate, 10000, 100000, 1000000);
+
+static void BM_ECS_IntegrateParallel(State& state)
+{
+    JobSystem& jobs = GetJobSystem();
+    World world;
+    PopulateWorld(world, static_cast<usize>(state.Arg(0)));
+
+    for (auto _ : state) {
+        world.ParallelEachChunk<Position, const Velocity>(jobs, [](u32 count, Entity*, Position* positions, const Velocity* velocities) {
+            for (u32 i = 0; i < count; ++i)
+                positions[i].Value += velocities[i].Value * s_DeltaTime;
+        });
+    }
+
+    state.SetItemsProcessed(state.Iterations() * world.GetEntityCount());
+    state.SetCounter("threads", jobs.GetWorkerCount() + 1);
+}
+BENCHMARK(BM_ECS_IntegrateParallel, 10000, 100000, 1000000);
+
+// Full per-frame update: integrate, spin, fade and rebuild the transform.
+static void BM_AoS_FrameUpdate(State& state)
+{
+    std::vector<GameObject> objects = MakeObjects(static_cast<usize>(state.Arg(0)));
+
+    for (auto _ : state) {
+        for (GameObject& object : objects) {
+            object.Position += object.Velocity * s_DeltaTime;
+            object.Rotation += object.AngularVelocity * s_DeltaTime;
+            object.Color.w = std::max(0.0f, object.Color.w - s_DeltaTime * 0.01f);
+            object.Transform = ComposeTransform(object.Position, object.Rotation);
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * objects.size());
+}
+BENCHMARK(BM_AoS_FrameUpdate, 10000, 100000, 1000000);
+
+static void BM_ECS_FrameUpdate(State& state)
+{
+    JobSystem& jobs = GetJobSystem();
+    World world;
+    PopulateWorld(world, static_cast<usize>(state.Arg(0)));
+
+    // Integrate, Spin and Fade touch disjoint components and share the first
+    // stage, BuildTransform reads what they wrote and runs in the second.
+    SystemScheduler scheduler(jobs);
+
+    scheduler.AddSystem("Integrate", SystemAccess().Read<Velocity>().Write<Position>(), [&](World& w, f32 dt) {
+        w.ParallelEachChunk<Position, const Velocity>(jobs, [dt](u32 count, Entity*, Position* positions, const Velocity* velocities) {
+            for (u32 i = 0; i < count; ++i)
+                positions[i].Value += velocities[i].Value * dt;
+        });
+    });
+
+    scheduler.AddSystem("Spin", SystemAccess().Write<Rotation>(), [&](World& w, f32 dt) {
+        w.ParallelEachChunk<Rotation>(jobs, [dt](u32 count, Entity*, Rotation* rotations) {
+            for (u32 i = 0; i < count; ++i)
+                rotations[i].Angle += rotations[i].AngularVelocity * dt;
+        });
+    });
+
+    scheduler.AddSystem("Fade", SystemAccess().Write<Color>(), [&](World& w, f32 dt) {
+        w.ParallelEachChunk<Color>(jobs, [dt](u32 count, Entity*, Color* colors) {
+            for (u32 i = 0; i < count; ++i)
+                colors[i].Value.w = std::max(0.0f, colors[i].Value.w - dt * 0.01f);
+        });
+    });
+
+    scheduler.AddSystem("BuildTransform", SystemAccess().Read<Position, Rotation>().Write<Transform>(), [&](World& w, f32) {
+        w.ParallelEachChunk<const Position, const Rotation, Transform>(jobs, [](u32 count, Entity*, const Position* positions, const Rotation* rotations, Transform* transforms) {
+            for (u32 i = 0; i < count; ++i)
+                transforms[i].Value = ComposeTransform(positions[i].Value, rotations[i].Angle);
+        });
+    });
+
+    for (auto _ : state)
+        scheduler.Run(world, s_DeltaTime);
+
+    state.SetItemsProcessed(state.Iterations() * world.GetEntityCount());
+    state.SetCounter("stages", static_cast<f64>(scheduler.GetStageCount()));
+}
+BENCHMARK(BM_ECS_FrameUpdate, 10000, 100000, 1000000);
+
+static void BM_ECS_CreateDestroy(State& state)
+{
+    World world;
+    std::vector<Entity> entities(static_cast<usize>(state.Arg(0)));
+
+    for (auto _ : state) {
+        for (Entity& entity : entities)
+            entity = world.Create(Position { glm::vec3(0.0f) }, Velocity { glm::vec3(1.0f) });
+        for (Entity entity : entities)
+            world.Destroy(entity);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * entities.size());
+}
+BENCHMARK(BM_ECS_CreateDestroy, 10000, 100000);
@@ -0,0 +1,123 @@
+#include <functional>
+
+#include "Benchmark.hpp"
+#include "Core/Events/Event.hpp"
+#include "Core/Events/ApplicationEvent.hpp"
+#include "Core/Events/KeyEvent.hpp"
+#include "Core/Events/MouseEvent.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    // Same shape as Application::OnEvent: one dispatcher per event, one
+    // Dispatch per handled type, each building a std::function from a lambda.
+    struct Handler
+    {
+        u64 Closed { 0 };
+        u64 Resized { 0 };
+        u64 Keys { 0 };
+        u64 Moves { 0 };
+        u64 Clicks { 0 };
+
+        void OnEvent(Event& e)
+        {
+            EventDispatcher dispatcher(e);
+
+            dispatcher.Dispatch<WindowCloseEvent>([&](WindowCloseEvent&) -> bool {
+                Closed++;
+                return true;
+            });
+
+            dispatcher.Dispatch<WindowResizeEvent>([&](WindowResizeEvent& e) -> bool {
+                Resized += e.GetWidth() + e.GetHeight();
+                return false;
+            });
+
+            dispatcher.Dispatch<WindowMinimizeEvent>([&](WindowMinimizeEvent&) -> bool {
+                return false;
+            });
+
+            dispatcher.Dispatch<KeyPressedEvent>([&](KeyPressedEvent& e) -> bool {
+                Keys += static_cast<u64>(e.GetKeyCode());
+                return false;
+            });
+
+            dispatcher.Dispatch<MouseMovedEvent>([&](MouseMovedEvent& e) -> bool {
+                Moves += static_cast<u64>(e.GetX() + e.GetY());
+                return false;
+            });
+
+            dispatcher.Dispatch<MouseButtonPressedEvent>([&](MouseButtonPressedEvent&) -> bool {
+                Clicks++;
+                return false;
+            });
+        }
+    };
+
+}
+
+static void BM_Event_Construct(State& state)
+{
+    u32 i = 0;
+    for (auto _ : state) {
+        WindowResizeEvent event(1280 + (i & 7), 720);
+        DoNotOptimize(event);
+        i++;
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_Event_Construct);
+
+static void BM_Event_ToString(State& state)
+{
+    KeyPressedEvent event(Key::Space, 0);
+
+    for (auto _ : state) {
+        std::string text = event.ToString();
+        DoNotOptimize(text);
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_Event_ToString);
+
+// A mouse move, the most frequent event, matches the fifth of six handlers.
+static void BM_EventDispatcher_Dispatch(State& state)
+{
+    Handler handler;
+
+    for (auto _ : state) {
+        MouseMovedEvent event(640.0f, 360.0f);
+        handler.OnEvent(event);
+        DoNotOptimize(event.Handled);
+    }
+
+    DoNotOptimize(handler.Moves);
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_EventDispatcher_Dispatch);
+
+// The whole path from the window: the callback is a std::function like
+// Window's EventCallback, bound to the handler.
+static void BM_EventDispatcher_WindowCallback(State& state)
+{
+    Handler handler;
+    std::function<void(Event&)> callback = std::bind(&Handler::OnEvent, &handler, std::placeholders::_1);
+
+    u32 i = 0;
+    for (auto _ : state) {
+        switch (i++ & 3) {
+            case 0: { MouseMovedEvent event(static_cast<f32>(i), 360.0f); callback(event); break; }
+            case 1: { KeyPressedEvent event(Key::W, 1); callback(event); break; }
+            case 2: { WindowResizeEvent event(1280, 720); callback(event); break; }
+            case 3: { MouseButtonPressedEvent event(MouseButton::Left); callback(event); break; }
+        }
+    }
+
+    DoNotOptimize(handler.Keys);
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_EventDispatcher_WindowCallback);
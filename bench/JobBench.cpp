@@ -0,0 +1,92 @@
+#include <atomic>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Core/JobSystem.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem s_Jobs;
+        return s_Jobs;
+    }
+
+}
+
+// Scheduling overhead: jobs that do nothing, queued one by one and waited for.
+static void BM_Job_Execute(State& state)
+{
+    JobSystem& jobs = GetJobSystem();
+    JobContext context;
+
+    u32 count = static_cast<u32>(state.Arg(0));
+    std::atomic<u32> done { 0 };
+
+    for (auto _ : state) {
+        for (u32 i = 0; i < count; ++i)
+            jobs.Execute(context, [&]() { done.fetch_add(1, std::memory_order_relaxed); });
+        jobs.Wait(context);
+    }
+
+    DoNotOptimize(done.load());
+    state.SetItemsProcessed(state.Iterations() * count);
+    state.SetLabel(std::to_string(jobs.GetWorkerCount()) + " workers");
+}
+BENCHMARK(BM_Job_Execute, 16, 256, 4096);
+
+// One job per group, the cost of splitting a range too finely shows up
+// against the coarser groups.
+static void BM_Job_Dispatch(State& state)
+{
+    constexpr u32 count = 1 << 16;
+
+    JobSystem& jobs = GetJobSystem();
+    JobContext context;
+
+    u32 groupSize = static_cast<u32>(state.Arg(0));
+    std::vector<f32> values(count, 1.0f);
+
+    for (auto _ : state) {
+        jobs.Dispatch(context, count, groupSize, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i)
+                values[i] = values[i] * 0.999f + 0.001f;
+        });
+        jobs.Wait(context);
+    }
+
+    DoNotOptimize(values.data());
+    state.SetItemsProcessed(state.Iterations() * count);
+    state.SetLabel(std::to_string(jobs.GetWorkerCount()) + " workers");
+}
+BENCHMARK(BM_Job_Dispatch, 64, 1024, 16384);
+
+// Jobs that dispatch and wait on their own children, the waiting jobs run
+// queued work instead of blocking their worker.
+static void BM_Job_Nested(State& state)
+{
+    JobSystem& jobs = GetJobSystem();
+    JobContext context;
+
+    u32 count = static_cast<u32>(state.Arg(0));
+    std::atomic<u32> done { 0 };
+
+    for (auto _ : state) {
+        for (u32 i = 0; i < count; ++i) {
+            jobs.Execute(context, [&]() {
+                JobContext children;
+                for (u32 j = 0; j < 8; ++j)
+                    jobs.Execute(children, [&]() { done.fetch_add(1, std::memory_order_relaxed); });
+                jobs.Wait(children);
+            });
+        }
+        jobs.Wait(context);
+    }
+
+    DoNotOptimize(done.load());
+    state.SetItemsProcessed(state.Iterations() * count * 8);
+}
+BENCHMARK(BM_Job_Nested, 16, 256);
@@ -0,0 +1,105 @@
+#include <vector>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+#include "Renderer/MeshData.hpp"
+#include "Renderer/MeshSimplifier.hpp"
+#include "Renderer/LODSelection.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    const MeshData& GetSphere(u32 subdivisions)
+    {
+        static std::vector<MeshData> s_Spheres(8);
+        if (s_Spheres[subdivisions].Vertices.empty())
+            s_Spheres[subdivisions] = MeshData::CreateIcosphere(subdivisions);
+        return s_Spheres[subdivisions];
+    }
+
+}
+
+static void BM_MeshSimplifier_Half(State& state)
+{
+    const MeshData& mesh = GetSphere(static_cast<u32>(state.Arg(0)));
+    std::span<const u32> indices(mesh.Indices.data(), mesh.LODs[0].IndexCount);
+
+    MeshSimplifier simplifier(&mesh.Vertices[0].Position, static_cast<u32>(mesh.Vertices.size()), sizeof(MeshVertex));
+
+    f32 error = 0.0f;
+    usize resultCount = 0;
+    for (auto _ : state) {
+        std::vector<u32> result = simplifier.Simplify(indices, static_cast<u32>(indices.size() / 2), 1.0f, &error);
+        resultCount = result.size();
+        DoNotOptimize(result.data());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * (indices.size() / 3));
+    state.SetCounter("triangles", static_cast<f64>(resultCount / 3));
+    state.SetCounter("error", error);
+}
+BENCHMARK(BM_MeshSimplifier_Half, 3, 4, 5, 6);
+
+static void BM_MeshData_BuildChain(State& state)
+{
+    u32 subdivisions = static_cast<u32>(state.Arg(0));
+    MeshData mesh;
+
+    for (auto _ : state) {
+        mesh = MeshData::CreateIcosphere(subdivisions);
+        DoNotOptimize(mesh.Indices.data());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * mesh.GetTriangleCount());
+    state.SetCounter("levels", static_cast<f64>(mesh.LODs.size()));
+}
+BENCHMARK(BM_MeshData_BuildChain, 4, 5, 6);
+
+// Wide outdoor view over a square field of instances, the same setup as the
+// demo scene. Reports the triangles submitted with and without LOD selection.
+static void BM_LOD_FieldSelection(State& state)
+{
+    const MeshData& mesh = GetSphere(4);
+    i32 gridSize = static_cast<i32>(state.Arg(0));
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<f32> size(0.3f, 1.0f);
+
+    std::vector<BoundingSphere> instances;
+    for (i32 z = 0; z < gridSize; ++z) {
+        for (i32 x = 0; x < gridSize; ++x) {
+            f32 scale = size(rng);
+            instances.push_back({ glm::vec3((x - gridSize / 2) * 6.0f, scale, (z - gridSize / 2) * 6.0f), mesh.Bounds.Radius * scale });
+        }
+    }
+
+    std::vector<u32> levels(instances.size(), 0);
+
+    glm::vec3 eye(20.0f, 3.0f, 0.0f);
+    glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 500.0f, 0.1f);
+    f32 projectionScale = projection[1][1];
+
+    u64 triangles = 0;
+    for (auto _ : state) {
+        triangles = 0;
+        for (usize i = 0; i < instances.size(); ++i) {
+            f32 screenSize = ComputeScreenSize(instances[i], eye, projectionScale, 720.0f);
+            levels[i] = SelectLOD(mesh.LODs, mesh.Bounds.Radius, screenSize, levels[i]);
+            triangles += mesh.GetTriangleCount(levels[i]);
+        }
+        DoNotOptimize(triangles);
+    }
+
+    u64 fullDetail = static_cast<u64>(mesh.GetTriangleCount()) * instances.size();
+
+    state.SetItemsProcessed(state.Iterations() * instances.size());
+    state.SetCounter("triangles", static_cast<f64>(triangles));
+    state.SetCounter("full_detail", static_cast<f64>(fullDetail));
+    state.SetCounter("reduction", static_cast<f64>(fullDetail) / static_cast<f64>(std::max<u64>(triangles, 1)));
+}
+BENCHMARK(BM_LOD_FieldSelection, 32, 64, 128);
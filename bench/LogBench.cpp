@@ -0,0 +1,112 @@
+#include <memory>
+#include <mutex>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include "Benchmark.hpp"
+#include "Core/Log.hpp"
+#include "Core/JobSystem.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    // Formats every message with the pattern Log::Init() sets and throws the
+    // result away, so the numbers cover the logger and not the console.
+    class DiscardSink : public spdlog::sinks::base_sink<std::mutex>
+    {
+    public:
+        u64 Bytes { 0 };
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& message) override
+        {
+            spdlog::memory_buf_t formatted;
+            formatter_->format(message, formatted);
+            Bytes += formatted.size();
+        }
+
+        void flush_() override {}
+    };
+
+    // The LOG_* macros compile to nothing in release builds, so the
+    // benchmarks call the logger the way the macros expand in debug builds.
+    std::shared_ptr<spdlog::logger> MakeLogger(const std::shared_ptr<DiscardSink>& sink)
+    {
+        auto logger = std::make_shared<spdlog::logger>("BENCH", sink);
+        logger->set_pattern("[%H:%M:%S %z] [%^%l%$] [thread %t] %v");
+        logger->set_level(spdlog::level::info);
+        return logger;
+    }
+
+}
+
+static void BM_Log_Message(State& state)
+{
+    auto sink = std::make_shared<DiscardSink>();
+    auto logger = MakeLogger(sink);
+
+    for (auto _ : state)
+        logger->info("Swapchain recreated");
+
+    state.SetItemsProcessed(state.Iterations());
+    state.SetBytesProcessed(sink->Bytes);
+}
+BENCHMARK(BM_Log_Message);
+
+static void BM_Log_Formatted(State& state)
+{
+    auto sink = std::make_shared<DiscardSink>();
+    auto logger = MakeLogger(sink);
+
+    u32 frame = 0;
+    for (auto _ : state) {
+        logger->info("Frame {} took {:.3f} ms on {}", frame, 16.6f + static_cast<f32>(frame & 7), "Graphics");
+        frame++;
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+    state.SetBytesProcessed(sink->Bytes);
+}
+BENCHMARK(BM_Log_Formatted);
+
+// A message below the logger's level, the cost of a trace left in a hot path.
+static void BM_Log_Filtered(State& state)
+{
+    auto sink = std::make_shared<DiscardSink>();
+    auto logger = MakeLogger(sink);
+
+    u32 frame = 0;
+    for (auto _ : state)
+        logger->trace("Frame {} recorded", frame++);
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_Log_Filtered);
+
+// Workers logging at once contend on the sink mutex, like jobs and the
+// pipeline compile threads do on the shared logger.
+static void BM_Log_Contended(State& state)
+{
+    constexpr u32 messagesPerIteration = 1024;
+
+    auto sink = std::make_shared<DiscardSink>();
+    auto logger = MakeLogger(sink);
+
+    JobSystem jobs(static_cast<u32>(state.Arg(0)));
+    JobContext context;
+
+    for (auto _ : state) {
+        jobs.Dispatch(context, messagesPerIteration, 64, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i)
+                logger->info("Job {} finished", i);
+        });
+        jobs.Wait(context);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * messagesPerIteration);
+    state.SetBytesProcessed(sink->Bytes);
+}
+BENCHMARK(BM_Log_Contended, 1, 3, 7);
@@ -0,0 +1,32 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "BenchRenderer.hpp"
+#include "Core/Log.hpp"
+
+int main(int argc, char** argv)
+{
+    Graphics::Bench::RunOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            options.Filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--out=", 6) == 0) {
+            options.OutputPath = argv[i] + 6;
+        } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+            options.MinTime = std::stod(argv[i] + 11);
+        } else {
+            std::printf("Usage: %s [--filter=<substring>] [--out=<results.json>] [--min-time=<seconds>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Graphics::Log::Init();
+    int result = Graphics::Bench::Registry::Get().Run(options);
+    Graphics::Bench::ReleaseRenderer();
+    Graphics::Log::Shutdown();
+
+    return result;
+}
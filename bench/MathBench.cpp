@@ -0,0 +1,187 @@
+#include <vector>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Frustum.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace {
+
+    std::vector<glm::mat4> MakeTransforms(usize count)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<f32> angle(0.0f, 6.28f);
+
+        std::vector<glm::mat4> transforms(count);
+        for (glm::mat4& transform : transforms) {
+            transform = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+            transform = glm::rotate(transform, angle(rng), glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+        }
+        return transforms;
+    }
+
+    glm::mat4 MakeViewProjection()
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 500.0f, 0.1f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return projection * view;
+    }
+
+}
+
+// Model-view-projection per object, what a renderer does for every draw.
+static void BM_Math_MatrixMultiply(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+    std::vector<glm::mat4> models = MakeTransforms(count);
+    std::vector<glm::mat4> results(count);
+    glm::mat4 viewProjection = MakeViewProjection();
+
+    for (auto _ : state) {
+        for (usize i = 0; i < count; ++i)
+            results[i] = viewProjection * models[i];
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_MatrixMultiply, 1000, 100000);
+
+static void BM_Math_MatrixInverse(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+    std::vector<glm::mat4> models = MakeTransforms(count);
+    std::vector<glm::mat4> results(count);
+
+    for (auto _ : state) {
+        for (usize i = 0; i < count; ++i)
+            results[i] = glm::inverse(models[i]);
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_MatrixInverse, 1000, 100000);
+
+// Translate, rotate and scale composed from scratch, as for a moving object.
+static void BM_Math_ComposeTransform(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+    std::vector<glm::mat4> results(count);
+
+    f32 time = 0.0f;
+    for (auto _ : state) {
+        for (usize i = 0; i < count; ++i) {
+            f32 t = time + static_cast<f32>(i);
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(t, 0.0f, -t));
+            transform = glm::rotate(transform, t, glm::vec3(0.0f, 1.0f, 0.0f));
+            results[i] = glm::scale(transform, glm::vec3(1.5f));
+        }
+        time += 0.016f;
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_ComposeTransform, 1000, 100000);
+
+static void BM_Math_TransformPoints(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+
+    std::vector<glm::vec4> points(count);
+    for (glm::vec4& point : points)
+        point = glm::vec4(position(rng), position(rng), position(rng), 1.0f);
+
+    std::vector<glm::vec4> results(count);
+    glm::mat4 viewProjection = MakeViewProjection();
+
+    for (auto _ : state) {
+        for (usize i = 0; i < count; ++i)
+            results[i] = viewProjection * points[i];
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_TransformPoints, 1000, 100000);
+
+// World space bounds of a transformed box, done for every moved BVH proxy.
+static void BM_Math_TransformBounds(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+    std::vector<glm::mat4> models = MakeTransforms(count);
+    std::vector<AABB> results(count);
+
+    AABB local { glm::vec3(-1.0f), glm::vec3(1.0f) };
+
+    for (auto _ : state) {
+        for (usize i = 0; i < count; ++i) {
+            const glm::mat4& m = models[i];
+            glm::vec3 center = glm::vec3(m * glm::vec4(local.Center(), 1.0f));
+            glm::vec3 extents = glm::abs(glm::vec3(m[0])) * local.Extents().x
+                + glm::abs(glm::vec3(m[1])) * local.Extents().y
+                + glm::abs(glm::vec3(m[2])) * local.Extents().z;
+            results[i] = { center - extents, center + extents };
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_TransformBounds, 1000, 100000);
+
+static void BM_Math_FrustumFromMatrix(State& state)
+{
+    glm::mat4 viewProjection = MakeViewProjection();
+
+    for (auto _ : state) {
+        viewProjection[3][0] += 1e-6f;
+        Frustum frustum = Frustum::FromMatrix(viewProjection);
+        DoNotOptimize(frustum);
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_Math_FrustumFromMatrix);
+
+static void BM_Math_RayBox(State& state)
+{
+    usize count = static_cast<usize>(state.Arg(0));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<f32> extent(0.5f, 4.0f);
+
+    std::vector<AABB> boxes(count);
+    for (AABB& box : boxes) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        glm::vec3 extents(extent(rng));
+        box = { center - extents, center + extents };
+    }
+
+    Ray ray { glm::vec3(-150.0f, 0.0f, 0.0f), glm::normalize(glm::vec3(1.0f, 0.1f, 0.05f)) };
+    glm::vec3 invDirection = 1.0f / ray.Direction;
+
+    for (auto _ : state) {
+        u32 hits = 0;
+        for (const AABB& box : boxes) {
+            f32 distance;
+            hits += IntersectRay(ray, invDirection, box, 1000.0f, distance) ? 1 : 0;
+        }
+        DoNotOptimize(hits);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_Math_RayBox, 1000, 100000);
@@ -0,0 +1,300 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+
+#include "Benchmark.hpp"
+#include "BenchRenderer.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Renderer/Vulkan.hpp"
+#include "Renderer/PipelineLayoutCache.hpp"
+
+using namespace Graphics;
+using namespace Graphics::Bench;
+
+namespace Graphics::Bench {
+
+    static std::unique_ptr<Renderer> s_Renderer;
+
+    Renderer& GetRenderer()
+    {
+        if (!s_Renderer)
+            s_Renderer = std::make_unique<Renderer>(VkExtent2D { 256, 256 });
+        return *s_Renderer;
+    }
+
+    void ReleaseRenderer()
+    {
+        if (s_Renderer)
+            vkDeviceWaitIdle(s_Renderer->GetDevice());
+        s_Renderer.reset();
+    }
+
+}
+
+namespace {
+
+    // Same layout as the renderer's quad vertices, so Triangle.vert accepts it.
+    struct Vertex
+    {
+        glm::vec2 Pos;
+        glm::vec3 Color;
+
+        static constexpr auto Layout()
+        {
+            return MakeVertexLayout<Vertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                VERTEX_ATTRIBUTE(Vertex, Pos),
+                VERTEX_ATTRIBUTE(Vertex, Color)
+            );
+        }
+    };
+
+    struct DeviceBuffer
+    {
+        VkBuffer Buffer { VK_NULL_HANDLE };
+        VkDeviceMemory Memory { VK_NULL_HANDLE };
+    };
+
+    // The staging path every static mesh takes: fill a host visible buffer,
+    // copy it into device local memory and wait for the copy.
+    DeviceBuffer Upload(Renderer& renderer, const void* data, VkDeviceSize size, VkBufferUsageFlags usage)
+    {
+        VkDevice device = renderer.GetDevice();
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        renderer.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Bench");
+
+        void* mapped;
+        vkMapMemory(device, stagingBufferMemory, 0, size, 0, &mapped);
+        memcpy(mapped, data, size);
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        DeviceBuffer result;
+        renderer.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, result.Buffer, result.Memory, "Bench");
+
+        renderer.CopyBuffer(stagingBuffer, result.Buffer, size);
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        renderer.FreeMemory(stagingBufferMemory);
+
+        return result;
+    }
+
+    void Destroy(Renderer& renderer, DeviceBuffer& buffer)
+    {
+        vkDestroyBuffer(renderer.GetDevice(), buffer.Buffer, nullptr);
+        renderer.FreeMemory(buffer.Memory);
+        buffer = {};
+    }
+
+    // A grid of unit quads, four vertices and six indices each.
+    void MakeGrid(u32 quads, std::vector<Vertex>& vertices, std::vector<u32>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+
+        for (u32 i = 0; i < quads; ++i) {
+            f32 x = static_cast<f32>(i % 256);
+            f32 y = static_cast<f32>(i / 256);
+            u32 base = static_cast<u32>(vertices.size());
+
+            vertices.push_back({ { x, y }, { 1.0f, 0.0f, 0.0f } });
+            vertices.push_back({ { x + 1.0f, y }, { 0.0f, 1.0f, 0.0f } });
+            vertices.push_back({ { x + 1.0f, y + 1.0f }, { 0.0f, 0.0f, 1.0f } });
+            vertices.push_back({ { x, y + 1.0f }, { 1.0f, 1.0f, 1.0f } });
+
+            for (u32 index : { 0u, 1u, 2u, 2u, 3u, 0u })
+                indices.push_back(base + index);
+        }
+    }
+
+    // Everything a draw loop needs: the quad's vertex shader on a pipeline
+    // without attachments, so recording stays valid without any image.
+    class DrawContext
+    {
+    public:
+        DrawContext(Renderer& renderer)
+            : m_Renderer(renderer)
+        {
+            VkDevice device = renderer.GetDevice();
+
+            VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+            poolInfo.queueFamilyIndex = renderer.GetGraphicsQueueFamily();
+            VK_CHECK(vkCreateCommandPool(device, &poolInfo, nullptr, &m_Pool));
+
+            VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+            allocInfo.commandPool = m_Pool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+            VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &m_CommandBuffer));
+
+            ShaderReflection reflection = renderer.ReflectShaders({ "Triangle.vert" });
+            renderer.DeclareFrameData(reflection);
+            m_Layout = renderer.GetPipelineLayoutCache().GetPipelineLayout(reflection);
+
+            static constexpr auto vertexLayout = Vertex::Layout();
+
+            PipelineDesc desc;
+            desc.Shaders = { "Triangle.vert" };
+            desc.Layout = m_Layout;
+            desc.SetVertexLayout(vertexLayout);
+            desc.DepthTest = false;
+            desc.DepthWrite = false;
+            m_Pipeline = renderer.GetPipelineCache().GetBlocking(desc);
+
+            std::vector<Vertex> vertices;
+            std::vector<u32> indices;
+            MakeGrid(1, vertices, indices);
+
+            m_VertexBuffer = Upload(renderer, vertices.data(), vertices.size() * sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+            m_IndexBuffer = Upload(renderer, indices.data(), indices.size() * sizeof(u32), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        }
+
+        ~DrawContext()
+        {
+            Destroy(m_Renderer, m_VertexBuffer);
+            Destroy(m_Renderer, m_IndexBuffer);
+            vkDestroyCommandPool(m_Renderer.GetDevice(), m_Pool, nullptr);
+        }
+
+        inline bool IsValid() const { return m_Pipeline != VK_NULL_HANDLE; }
+
+        // Records count draws of the quad, each with a transform of its own.
+        // The command buffer is never submitted.
+        void Record(u32 count, bool rebind)
+        {
+            vkResetCommandPool(m_Renderer.GetDevice(), m_Pool, 0);
+
+            VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(m_CommandBuffer, &beginInfo);
+
+            VkExtent2D extent = m_Renderer.GetExtent();
+
+            VkRenderingInfo renderingInfo = { VK_STRUCTURE_TYPE_RENDERING_INFO };
+            renderingInfo.renderArea = { { 0, 0 }, extent };
+            renderingInfo.layerCount = 1;
+            vkCmdBeginRendering(m_CommandBuffer, &renderingInfo);
+
+            VkViewport viewport = { 0.0f, 0.0f, static_cast<f32>(extent.width), static_cast<f32>(extent.height), 0.0f, 1.0f };
+            VkRect2D scissor = { { 0, 0 }, extent };
+            vkCmdSetViewport(m_CommandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(m_CommandBuffer, 0, 1, &scissor);
+
+            for (u32 i = 0; i < count; ++i) {
+                if (i == 0 || rebind) {
+                    vkCmdBindPipeline(m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+
+                    VkDeviceSize offset = 0;
+                    vkCmdBindVertexBuffers(m_CommandBuffer, 0, 1, &m_VertexBuffer.Buffer, &offset);
+                    vkCmdBindIndexBuffer(m_CommandBuffer, m_IndexBuffer.Buffer, 0, VK_INDEX_TYPE_UINT32);
+
+                    m_Renderer.BindFrameData(m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Layout);
+                }
+
+                glm::mat4 model(1.0f);
+                model[3] = glm::vec4(static_cast<f32>(i), 0.0f, 0.0f, 1.0f);
+                vkCmdPushConstants(m_CommandBuffer, m_Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
+
+                vkCmdDrawIndexed(m_CommandBuffer, 6, 1, 0, 0, 0);
+            }
+
+            vkCmdEndRendering(m_CommandBuffer);
+            vkEndCommandBuffer(m_CommandBuffer);
+        }
+
+    private:
+        Renderer& m_Renderer;
+
+        VkCommandPool m_Pool { VK_NULL_HANDLE };
+        VkCommandBuffer m_CommandBuffer { VK_NULL_HANDLE };
+
+        VkPipelineLayout m_Layout { VK_NULL_HANDLE };
+        VkPipeline m_Pipeline { VK_NULL_HANDLE };
+
+        DeviceBuffer m_VertexBuffer;
+        DeviceBuffer m_IndexBuffer;
+    };
+
+}
+
+// Create, fill, copy and destroy, including the wait for the transfer.
+static void BM_GPU_UploadVertices(State& state)
+{
+    Renderer& renderer = GetRenderer();
+
+    std::vector<Vertex> vertices;
+    std::vector<u32> indices;
+    MakeGrid(static_cast<u32>(state.Arg(0)), vertices, indices);
+
+    VkDeviceSize size = vertices.size() * sizeof(Vertex);
+
+    for (auto _ : state) {
+        DeviceBuffer buffer = Upload(renderer, vertices.data(), size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        Destroy(renderer, buffer);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * vertices.size());
+    state.SetBytesProcessed(state.Iterations() * size);
+}
+BENCHMARK(BM_GPU_UploadVertices, 256, 16384, 262144);
+
+static void BM_GPU_UploadIndices(State& state)
+{
+    Renderer& renderer = GetRenderer();
+
+    std::vector<Vertex> vertices;
+    std::vector<u32> indices;
+    MakeGrid(static_cast<u32>(state.Arg(0)), vertices, indices);
+
+    VkDeviceSize size = indices.size() * sizeof(u32);
+
+    for (auto _ : state) {
+        DeviceBuffer buffer = Upload(renderer, indices.data(), size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        Destroy(renderer, buffer);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * indices.size());
+    state.SetBytesProcessed(state.Iterations() * size);
+}
+BENCHMARK(BM_GPU_UploadIndices, 256, 16384, 262144);
+
+// CPU cost per draw: push constants and an indexed draw on a bound pipeline.
+static void BM_GPU_RecordDraws(State& state)
+{
+    DrawContext context(GetRenderer());
+    if (!context.IsValid()) {
+        state.SetLabel("pipeline failed to compile");
+        for (auto _ : state) {}
+        return;
+    }
+
+    u32 count = static_cast<u32>(state.Arg(0));
+    for (auto _ : state)
+        context.Record(count, false);
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_GPU_RecordDraws, 100, 1000, 10000);
+
+// As above with the pipeline, buffers and frame data bound again for every
+// draw, the worst case of an unsorted draw list.
+static void BM_GPU_RecordDrawsRebind(State& state)
+{
+    DrawContext context(GetRenderer());
+    if (!context.IsValid()) {
+        state.SetLabel("pipeline failed to compile");
+        for (auto _ : state) {}
+        return;
+    }
+
+    u32 count = static_cast<u32>(state.Arg(0));
+    for (auto _ : state)
+        context.Record(count, true);
+
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_GPU_RecordDrawsRebind, 100, 1000, 10000);
@@ -0,0 +1,24 @@
+// Shared by BloomDownsample.comp and BloomUpsample.comp, one dispatch per
+// level of the bloom chain. Levels are sampled in GENERAL layout while the
+// chain is being built, like the depth pyramid.
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(set = 0, binding = 1, rgba16f) uniform image2D destination;
+
+// Matches PostProcess::BloomConstants.
+layout(push_constant) uniform PushConstants {
+    // Soft threshold: threshold, threshold - knee, 2 * knee, 0.25 / knee.
+    vec4 threshold;
+    // Size of a source texel in UV.
+    vec2 texelSize;
+    // Tent radius of the upsample in source texels.
+    float radius;
+    // Set on the first downsample, which thresholds the scene color.
+    uint prefilter;
+} push;
+
+float Luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
@@ -0,0 +1,19 @@
+#version 450
+
+layout(location = 0) in vec2 fragLocalPosition;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) in float fragThickness;
+layout(location = 3) in float fragFade;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float distance = 1.0 - length(fragLocalPosition);
+    float circle = smoothstep(0.0, fragFade, distance);
+    circle *= smoothstep(fragThickness + fragFade, fragThickness, distance);
+
+    if (circle == 0.0)
+        discard;
+
+    outColor = vec4(fragColor.rgb, fragColor.a * circle);
+}
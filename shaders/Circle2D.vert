@@ -0,0 +1,24 @@
+#version 450
+
+layout(location = 0) in vec3 inWorldPosition;
+layout(location = 1) in vec2 inLocalPosition;
+layout(location = 2) in vec4 inColor;
+layout(location = 3) in float inThickness;
+layout(location = 4) in float inFade;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} push;
+
+layout(location = 0) out vec2 fragLocalPosition;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) out float fragThickness;
+layout(location = 3) out float fragFade;
+
+void main() {
+    gl_Position = push.viewProjection * vec4(inWorldPosition, 1.0);
+    fragLocalPosition = inLocalPosition;
+    fragColor = inColor;
+    fragThickness = inThickness;
+    fragFade = inFade;
+}
@@ -0,0 +1,52 @@
+#version 450
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D sceneColor;
+// Level 0 of the bloom chain, the scene color again with bloom disabled.
+layout(set = 0, binding = 1) uniform sampler2D bloom;
+
+// Matches PostProcess::CompositeConstants.
+layout(push_constant) uniform PushConstants {
+    // xyz color filter, w exposure as a multiplier
+    vec4 filterExposure;
+    float bloomIntensity;
+    float contrast;
+    float saturation;
+    // Tonemapper: 0 clamp, 1 Reinhard, 2 ACES
+    uint tonemapper;
+} push;
+
+const float middleGrey = 0.18;
+
+float Luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Narkowicz's fit of the ACES filmic curve.
+vec3 ACES(vec3 x) {
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+// Every step after the scene is drawn, in one pass so the HDR color is read
+// once and the backbuffer written once. The attachment encodes to sRGB.
+void main() {
+    vec3 color = texelFetch(sceneColor, ivec2(gl_FragCoord.xy), 0).rgb;
+    color += textureLod(bloom, fragTexCoord, 0.0).rgb * push.bloomIntensity;
+
+    color *= push.filterExposure.w;
+
+    // Grading in linear HDR before the curve: filter, contrast around middle grey, saturation.
+    color *= push.filterExposure.rgb;
+    color = pow(max(color, vec3(0.0)) / middleGrey, vec3(push.contrast)) * middleGrey;
+    color = max(mix(vec3(Luminance(color)), color, push.saturation), vec3(0.0));
+
+    if (push.tonemapper == 1)
+        color = color / (1.0 + Luminance(color));
+    else if (push.tonemapper == 2)
+        color = ACES(color);
+
+    outColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,11 @@
+#version 450
+
+// Drawn in place of any fragment shader whose pipeline is still compiling.
+// Reads nothing, so it fits every pipeline layout and compiles in no time.
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = vec4(0.5, 0.5, 0.5, 1.0);
+}
@@ -0,0 +1,15 @@
+// Per-frame camera and time, written once per frame by the renderer. Each
+// frame in flight has its own slot of one buffer, the set is bound with a
+// dynamic offset that selects it.
+
+layout(set = 0, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    // Seconds since the renderer was created and since the previous frame.
+    float time;
+    float deltaTime;
+    // Swapchain size in pixels.
+    vec2 extent;
+} frame;
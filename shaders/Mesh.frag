@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec3 fragNormal;
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.3));
+const vec3 albedo = vec3(0.55, 0.6, 0.5);
+
+void main() {
+    vec3 normal = normalize(fragNormal);
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+
+    outColor = vec4(albedo * (0.15 + 0.85 * diffuse), 1.0);
+}
@@ -0,0 +1,35 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+struct Instance {
+    mat4 model;
+    vec4 sphere;
+    uint firstIndex;
+    uint indexCount;
+    uint visibilitySlot;
+    uint padding;
+};
+
+// Indexed by firstInstance, which is the instance's position in the sorted draw list.
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} push;
+
+layout(location = 0) out vec3 fragNormal;
+
+// The depth prepass and the EQUAL-tested main pass must produce identical depth.
+invariant gl_Position;
+
+void main() {
+    mat4 model = instances[gl_InstanceIndex].model;
+
+    gl_Position = push.viewProjection * (model * vec4(inPosition, 1.0));
+    // Instances are uniformly scaled, the upper 3x3 transforms normals as well.
+    fragNormal = mat3(model) * inNormal;
+}
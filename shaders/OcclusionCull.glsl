@@ -0,0 +1,69 @@
+// Shared by OcclusionCullEarly.comp and OcclusionCullLate.comp. Each instance
+// writes its own VkDrawIndexedIndirectCommand, culled instances get an
+// instance count of 0 so the draw ranges per mesh stay fixed on the CPU side.
+
+layout(local_size_x = 64) in;
+
+struct Instance {
+    mat4 model;
+    vec4 sphere;
+    uint firstIndex;
+    uint indexCount;
+    uint visibilitySlot;
+    uint padding;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(set = 0, binding = 0) uniform CullData {
+    mat4 view;
+    vec4 frustumPlanes[6];
+    // projection[0][0], |projection[1][1]|, near plane distance
+    vec4 projection;
+    // projection[2][2], projection[3][2]
+    vec2 depthTransform;
+    vec2 pyramidSize;
+    uint instanceCount;
+    uint pyramidLevels;
+} cull;
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(std430, set = 0, binding = 2) writeonly buffer DrawCommands {
+    DrawCommand commands[];
+};
+
+layout(std430, set = 0, binding = 3) buffer Visibility {
+    uint visibility[];
+};
+
+layout(std430, set = 0, binding = 4) buffer Counters {
+    uint earlyDrawn;
+    uint lateDrawn;
+    uint frustumCulled;
+    uint occlusionCulled;
+} counters;
+
+bool IsInFrustum(vec3 center, float radius) {
+    for (int i = 0; i < 6; ++i) {
+        if (dot(cull.frustumPlanes[i].xyz, center) + cull.frustumPlanes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+void WriteCommand(uint index, Instance instance, bool draw) {
+    commands[index].indexCount = instance.indexCount;
+    commands[index].instanceCount = draw ? 1 : 0;
+    commands[index].firstIndex = instance.firstIndex;
+    commands[index].vertexOffset = 0;
+    commands[index].firstInstance = index;
+}
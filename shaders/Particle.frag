@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragOffset;
+
+layout(location = 0) out vec4 outColor;
+
+// Round soft-edged sprite, blended additively so the order of the alive list does not matter.
+void main() {
+    float falloff = 1.0 - dot(fragOffset, fragOffset);
+    if (falloff <= 0.0)
+        discard;
+
+    outColor = vec4(fragColor.rgb, fragColor.a * falloff);
+}
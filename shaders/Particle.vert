@@ -0,0 +1,50 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "FrameData.glsl"
+
+// Matches ParticleSimulate.glsl.
+struct Particle {
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+    uint startColor;
+    uint endColor;
+    float startSize;
+    float endSize;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer AliveLists {
+    uint alive[];
+};
+
+layout(push_constant) uniform PushConstants {
+    // Start of the drawn alive list.
+    uint firstAlive;
+} push;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragOffset;
+
+void main() {
+    Particle particle = particles[alive[push.firstAlive + gl_InstanceIndex]];
+
+    float t = clamp(particle.age / particle.lifetime, 0.0, 1.0);
+    float size = mix(particle.startSize, particle.endSize, t);
+
+    // Triangle strip over a camera facing square, spanned by the view's right and up axes.
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1) * 2.0 - 1.0;
+    vec3 right = vec3(frame.view[0][0], frame.view[1][0], frame.view[2][0]);
+    vec3 up = vec3(frame.view[0][1], frame.view[1][1], frame.view[2][1]);
+    vec3 position = particle.position + (right * corner.x + up * corner.y) * (size * 0.5);
+
+    gl_Position = frame.viewProjection * vec4(position, 1.0);
+
+    fragColor = mix(unpackUnorm4x8(particle.startColor), unpackUnorm4x8(particle.endColor), t);
+    fragOffset = corner;
+}
@@ -0,0 +1,266 @@
+// Shared by the ParticleSimulate*.comp variants, which only differ in whether
+// and how they read the depth buffer for collisions. One dispatch updates a
+// whole particle group:
+//
+// - The first emitGroups workgroups emit. Emission thread k takes the k-th
+//   free index from the dead ring and appends it to the next alive list.
+// - Every other thread simulates one particle of the current alive list.
+//   Survivors are appended to the next alive list, dead particles push their
+//   index back onto the dead ring.
+//
+// Appends grow the next list's dispatch and draw commands, so this frame's
+// draw and the next frame's dispatch are both generated here.
+
+layout(local_size_x = 256) in;
+
+// Match ParticleSystem::s_GroupSize, s_EmitGroups and s_MaxEmitters.
+const uint groupSize = 256;
+const uint emitGroups = 256;
+const uint maxEmitters = 32;
+
+struct Emitter {
+    // xyz position, spawn sphere radius
+    vec4 positionRadius;
+    // xyz velocity, length of the random velocity added to it
+    vec4 velocitySpread;
+    vec4 startColor;
+    vec4 endColor;
+    // lifetime, lifetime variance, start size, end size
+    vec4 shape;
+    // first emission thread of the emitter
+    uvec4 range;
+};
+
+layout(set = 0, binding = 0) uniform Simulation {
+    mat4 viewProjection;
+    mat4 inverseViewProjection;
+    vec4 cameraPosition;
+    // xyz gravity, w drag
+    vec4 gravity;
+    vec2 depthSize;
+    float deltaTime;
+    float restitution;
+    float thickness;
+    uint emitCount;
+    uint emitterCount;
+    uint seed;
+    // A power of two, dead ring positions wrap with it.
+    uint capacity;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+    Emitter emitters[maxEmitters];
+} sim;
+
+struct Particle {
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+    uint startColor;
+    uint endColor;
+    float startSize;
+    float endSize;
+};
+
+layout(std430, set = 0, binding = 1) buffer Particles {
+    Particle particles[];
+};
+
+// Both alive lists, list i starts at i * capacity.
+layout(std430, set = 0, binding = 2) buffer AliveLists {
+    uint alive[];
+};
+
+// Ring of free particle indices between deadHead and deadTail.
+layout(std430, set = 0, binding = 3) buffer DeadRing {
+    uint dead[];
+};
+
+// Matches ParticleSystem::Counters.
+struct ListCounters {
+    // VkDispatchIndirectCommand that simulates the list.
+    uint dispatchX;
+    uint dispatchY;
+    uint dispatchZ;
+    // VkDrawIndirectCommand that draws the list, instanceCount is its length.
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+    uint deadHead;
+    uint deadTail;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+layout(std430, set = 0, binding = 4) buffer Counters {
+    ListCounters lists[2];
+};
+
+layout(push_constant) uniform PushConstants {
+    // Alive list simulated this frame, the other one is appended to.
+    uint current;
+} push;
+
+uint Hash(uint x) {
+    x = x * 747796405u + 2891336453u;
+    uint word = ((x >> ((x >> 28u) + 4u)) ^ x) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float Random(inout uint state) {
+    state = Hash(state);
+    return float(state) * (1.0 / 4294967295.0);
+}
+
+vec3 RandomInSphere(inout uint state) {
+    float z = Random(state) * 2.0 - 1.0;
+    float angle = Random(state) * 6.28318531;
+    float radius = sqrt(max(1.0 - z * z, 0.0));
+
+    return vec3(radius * cos(angle), radius * sin(angle), z) * pow(Random(state), 1.0 / 3.0);
+}
+
+void Append(uint list, uint index) {
+    uint slot = atomicAdd(lists[list].instanceCount, 1);
+
+    // Every groupSize-th particle adds a workgroup to the list's dispatch.
+    if (slot % groupSize == 0)
+        atomicAdd(lists[list].dispatchX, 1);
+
+    alive[list * sim.capacity + slot] = index;
+}
+
+void Emit(uint thread, uint current, uint next) {
+    uint head = lists[current].deadHead;
+    uint count = min(sim.emitCount, lists[current].deadTail - head);
+
+    if (thread == 0)
+        lists[next].deadHead = head + count;
+
+    if (thread >= count)
+        return;
+
+    uint index = 0;
+    while (index + 1 < sim.emitterCount && thread >= sim.emitters[index + 1].range.x)
+        index++;
+
+    Emitter emitter = sim.emitters[index];
+
+    // Seeded by the emission thread rather than the particle slot, so a run
+    // with a fixed time step spawns the same particles every time.
+    uint state = Hash(thread ^ Hash(sim.seed));
+
+    Particle particle;
+    particle.position = emitter.positionRadius.xyz + RandomInSphere(state) * emitter.positionRadius.w;
+    particle.age = 0.0;
+    particle.velocity = emitter.velocitySpread.xyz + RandomInSphere(state) * emitter.velocitySpread.w;
+    particle.lifetime = max(emitter.shape.x + (Random(state) * 2.0 - 1.0) * emitter.shape.y, 0.001);
+    particle.startColor = packUnorm4x8(emitter.startColor);
+    particle.endColor = packUnorm4x8(emitter.endColor);
+    particle.startSize = emitter.shape.z;
+    particle.endSize = emitter.shape.w;
+
+    uint slot = dead[(head + thread) & (sim.capacity - 1)];
+    particles[slot] = particle;
+
+    Append(next, slot);
+}
+
+#ifdef DEPTH_COLLISIONS
+// Defined by the variant for its depth buffer type.
+float LoadDepth(ivec2 texel);
+
+vec3 Unproject(ivec2 texel, float depth) {
+    vec2 ndc = (vec2(texel) + 0.5) / sim.depthSize * 2.0 - 1.0;
+    vec4 world = sim.inverseViewProjection * vec4(ndc, depth, 1.0);
+
+    return world.xyz / world.w;
+}
+
+// Bounces a particle that moved behind the visible surface by less than the
+// collision thickness. Only surfaces the camera sees can be hit, a particle
+// further behind is taken to be passing behind the object.
+void Collide(inout vec3 position, inout vec3 velocity) {
+    vec4 clip = sim.viewProjection * vec4(position, 1.0);
+    if (clip.w <= 0.0)
+        return;
+
+    vec3 ndc = clip.xyz / clip.w;
+    if (any(greaterThan(abs(ndc.xy), vec2(1.0))))
+        return;
+
+    ivec2 texel = clamp(ivec2((ndc.xy * 0.5 + 0.5) * sim.depthSize), ivec2(0), ivec2(sim.depthSize) - 2);
+    float depth = LoadDepth(texel);
+
+    // Reverse-Z: the cleared background is 0 and whatever lies behind the surface has a smaller depth.
+    if (depth == 0.0 || ndc.z >= depth)
+        return;
+
+    vec3 surface = Unproject(texel, depth);
+    vec3 toCamera = sim.cameraPosition.xyz - surface;
+
+    if (distance(position, sim.cameraPosition.xyz) - length(toCamera) > sim.thickness)
+        return;
+
+    // Normal from the neighbouring depth samples, facing the camera. Across a
+    // silhouette the neighbours belong to another surface, fall back to the view direction.
+    float rightDepth = LoadDepth(texel + ivec2(1, 0));
+    float downDepth = LoadDepth(texel + ivec2(0, 1));
+    vec3 normal = cross(Unproject(texel + ivec2(1, 0), rightDepth) - surface, Unproject(texel + ivec2(0, 1), downDepth) - surface);
+
+    if (rightDepth == 0.0 || downDepth == 0.0 || dot(normal, normal) < 1e-12)
+        normal = toCamera;
+
+    normal = normalize(normal);
+    if (dot(normal, toCamera) < 0.0)
+        normal = -normal;
+
+    position += normal * max(dot(surface - position, normal), 0.0);
+
+    float speed = dot(velocity, normal);
+    if (speed < 0.0)
+        velocity -= (1.0 + sim.restitution) * speed * normal;
+}
+#endif
+
+void Simulate(uint thread, uint current, uint next) {
+    if (thread >= lists[current].instanceCount)
+        return;
+
+    uint slot = alive[current * sim.capacity + thread];
+    Particle particle = particles[slot];
+
+    particle.age += sim.deltaTime;
+
+    if (particle.age >= particle.lifetime) {
+        uint tail = atomicAdd(lists[next].deadTail, 1);
+        dead[tail & (sim.capacity - 1)] = slot;
+        return;
+    }
+
+    vec3 velocity = (particle.velocity + sim.gravity.xyz * sim.deltaTime) / (1.0 + sim.gravity.w * sim.deltaTime);
+    vec3 position = particle.position + velocity * sim.deltaTime;
+
+#ifdef DEPTH_COLLISIONS
+    Collide(position, velocity);
+#endif
+
+    particles[slot].position = position;
+    particles[slot].age = particle.age;
+    particles[slot].velocity = velocity;
+
+    Append(next, slot);
+}
+
+void main() {
+    uint current = push.current;
+    uint next = current ^ 1;
+
+    if (gl_WorkGroupID.x < emitGroups)
+        Emit(gl_GlobalInvocationID.x, current, next);
+    else
+        Simulate(gl_GlobalInvocationID.x - emitGroups * groupSize, current, next);
+}
@@ -0,0 +1,31 @@
+#version 450
+
+// One instance per glyph or rectangle, matches PerfOverlay::GlyphInstance.
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inSize;
+layout(location = 2) in vec4 inColor;
+layout(location = 3) in uint inGlyph;
+
+layout(push_constant) uniform PushConstants {
+    vec2 invExtent;
+} push;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+// Atlas layout, matches PerfOverlay.cpp.
+const uint atlasColumns = 16;
+const vec2 cellSize = vec2(6.0, 8.0);
+const vec2 atlasSize = vec2(96.0, 48.0);
+
+void main() {
+    // Triangle strip over the corners of the instance's rectangle.
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    vec2 position = inPosition + corner * inSize;
+
+    gl_Position = vec4(position * push.invExtent * 2.0 - 1.0, 0.0, 1.0);
+
+    vec2 cell = vec2(inGlyph % atlasColumns, inGlyph / atlasColumns);
+    fragTexCoord = (cell + corner) * cellSize / atlasSize;
+    fragColor = inColor;
+}
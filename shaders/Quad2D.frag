@@ -0,0 +1,15 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTexIndex;
+
+layout(set = 0, binding = 0) uniform sampler2D textures[32];
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(textures[nonuniformEXT(fragTexIndex)], fragTexCoord) * fragColor;
+}
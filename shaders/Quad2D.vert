@@ -0,0 +1,21 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in uint inTexIndex;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} push;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTexIndex;
+
+void main() {
+    gl_Position = push.viewProjection * vec4(inPosition, 1.0);
+    fragColor = inColor;
+    fragTexCoord = inTexCoord;
+    fragTexIndex = inTexIndex;
+}
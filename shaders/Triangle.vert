@@ -1,11 +1,21 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "FrameData.glsl"
 
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+} push;
+
 layout(location = 0) out vec3 fragColor;
 
+// The depth prepass and the EQUAL-tested main pass must produce identical depth.
+invariant gl_Position;
+
 void main() {
-    gl_Position = vec4(inPosition, 0.0, 1.0);
+    gl_Position = frame.viewProjection * (push.model * vec4(inPosition, 0.0, 1.0));
     fragColor = inColor;
-}
\ No newline at end of file
+}
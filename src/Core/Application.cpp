@@ -1,8 +1,24 @@
 #include "Application.hpp"
 
+#include <algorithm>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "Log.hpp"
 #include "Window.hpp"
+#include "Timer.hpp"
+#include "KeyCodes.hpp"
 #include "Events/ApplicationEvent.hpp"
+#include "Events/KeyEvent.hpp"
+#include "Events/MouseEvent.hpp"
+#include "Renderer/Renderer2D.hpp"
+#include "Renderer/MeshRenderer.hpp"
+#include "Renderer/OcclusionCuller.hpp"
+#include "Renderer/FrameCapture.hpp"
+#include "Renderer/ParticleSystem.hpp"
+#include "Renderer/PostProcess.hpp"
+#include "Scene/Components.hpp"
 
 namespace Graphics {
 
@@ -17,19 +33,225 @@ namespace Graphics {
         m_Window->SetEventCallback(std::bind(&Application::EventHandler, this, std::placeholders::_1));
 
         m_Renderer = std::make_unique<Renderer>(m_Window);
+
+        m_JobSystem = std::make_unique<JobSystem>();
+        LOG_INFO("Job system running {} workers", m_JobSystem->GetWorkerCount());
+
+        CreateScene();
+        CreateMeshField();
+    }
+
+    void Application::CreateScene()
+    {
+        m_Scene = std::make_unique<Scene>(*m_JobSystem);
+
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+
+        for (u32 i = 0; i < 256; ++i) {
+            m_Scene->CreateSprite(
+                TransformComponent { glm::vec3(unit(rng), unit(rng), 0.0f), glm::vec2(0.03f), 0.0f },
+                VelocityComponent { glm::vec3(unit(rng), unit(rng), 0.0f) * 0.5f, unit(rng) * 3.0f },
+                SpriteComponent { glm::vec4(0.5f + 0.5f * unit(rng), 0.5f + 0.5f * unit(rng), 0.8f, 1.0f) }
+            );
+        }
+    }
+
+    void Application::CreateMeshField()
+    {
+        // 5120 triangles at full resolution, the LOD chain is built on creation.
+        m_FieldMesh = std::make_unique<Mesh>(*m_Renderer, MeshData::CreateIcosphere(4));
+
+        std::string levels;
+        for (u32 i = 0; i < m_FieldMesh->GetLODCount(); ++i)
+            levels += (i ? ", " : "") + std::to_string(m_FieldMesh->GetTriangleCount(i));
+        LOG_INFO("Field mesh LODs: {} triangles", levels);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<f32> jitter(-0.4f, 0.4f);
+        std::uniform_real_distribution<f32> size(0.3f, 1.0f);
+
+        constexpr i32 gridSize = 32;
+        constexpr f32 spacing = 6.0f;
+
+        for (i32 z = 0; z < gridSize; ++z) {
+            for (i32 x = 0; x < gridSize; ++x) {
+                glm::vec3 position((x - gridSize / 2 + jitter(rng)) * spacing, 0.0f, (z - gridSize / 2 + jitter(rng)) * spacing);
+                f32 scale = size(rng);
+
+                position.y = scale;
+                m_FieldInstances.push_back({ glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(scale)) });
+            }
+        }
+
+        m_FieldInstances.push_back({ glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 4.0f, 0.0f)), glm::vec3(10.0f)) });
     }
 
     void Application::Run()
     {
+        Timer frameTimer;
+
         while (m_Running) {
-            // TODO: Timer
+            f32 dt = frameTimer.Elapsed();
+            frameTimer.Reset();
 
             m_Window->PollEvents();
 
-            if (!m_Minimized) {
-                m_Renderer->Render(0.0f);
+            if (!m_Minimized && m_Renderer->BeginFrame()) {
+                DrawScene(dt);
+                m_Renderer->EndFrame();
+            }
+        }
+    }
+
+    void Application::DrawScene(f32 dt)
+    {
+        m_Time += dt;
+
+        f32 aspect = static_cast<f32>(m_Window->Width()) / static_cast<f32>(std::max(m_Window->Height(), 1));
+
+        glm::mat4 projection = glm::ortho(-aspect, aspect, -1.0f, 1.0f);
+        projection[1][1] *= -1.0f;
+        m_ViewProjection = projection;
+
+        DrawMeshField();
+
+        Renderer2D& renderer2D = m_Renderer->Get2D();
+        renderer2D.BeginScene(projection);
+
+        m_Scene->SetBounds(glm::vec2(aspect, 1.0f));
+        m_Scene->OnUpdate(dt);
+
+        Timer submitTimer;
+
+        if (m_Renderer2DStress) {
+            constexpr u32 gridSize = 1000;
+
+            glm::vec2 cellSize = glm::vec2(2.0f * aspect, 2.0f) / static_cast<f32>(gridSize);
+            glm::vec2 quadSize = cellSize * 0.8f;
+
+            for (u32 y = 0; y < gridSize; ++y) {
+                for (u32 x = 0; x < gridSize; ++x) {
+                    glm::vec3 position(-aspect + (x + 0.5f) * cellSize.x, -1.0f + (y + 0.5f) * cellSize.y, 0.0f);
+                    glm::vec4 color(static_cast<f32>(x) / gridSize, static_cast<f32>(y) / gridSize, 0.5f, 1.0f);
+
+                    renderer2D.DrawQuad(position, quadSize, color);
+                }
             }
+        } else {
+            renderer2D.DrawRect(glm::vec3(0.0f), glm::vec2(1.1f), glm::vec4(1.0f));
+            renderer2D.DrawRotatedQuad(glm::vec3(-0.8f * aspect, 0.7f, 0.0f), glm::vec2(0.2f), m_Time, glm::vec4(0.9f, 0.4f, 0.2f, 1.0f));
+            renderer2D.DrawCircle(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.8f * aspect, 0.7f, 0.0f)), glm::vec3(0.3f)), glm::vec4(0.2f, 0.6f, 0.9f, 1.0f), 0.2f);
+
+            m_Scene->OnRender(renderer2D, projection);
+        }
+
+        renderer2D.EndScene();
+
+        f32 submitTime = submitTimer.ElapsedMillis();
+
+        m_StatsTime += dt;
+        m_StatsFrames++;
+
+        if (m_Renderer2DStress && m_StatsTime >= 1.0f) {
+            const Renderer2DStats& stats = renderer2D.GetStats();
+            LOG_INFO("Renderer2D: {} quads in {} draw calls, {:.2f} ms/frame, {:.2f} ms CPU submit",
+                stats.QuadCount, stats.DrawCalls, m_StatsTime * 1000.0f / m_StatsFrames, submitTime);
+        }
+
+        if (m_StatsTime >= 1.0f) {
+            const MeshRendererStats& stats = m_Renderer->GetMeshRenderer().GetStats();
+            LOG_INFO("Meshes: {} draws, {} triangles ({:.1f}% of full detail), LOD {}",
+                stats.DrawCalls, stats.TriangleCount, 100.0 * stats.TriangleCount / std::max<u64>(stats.FullDetailTriangleCount, 1),
+                m_Renderer->GetMeshRenderer().IsLODEnabled() ? "on" : "off");
+
+            if (m_Renderer->IsOcclusionCullingEnabled()) {
+                const OcclusionCullerStats& culling = m_Renderer->GetOcclusionCuller().GetStats();
+                LOG_INFO("Culling: {} instances, {} drawn early, {} drawn late, {} frustum culled, {} occluded",
+                    culling.InstanceCount, culling.EarlyDrawn, culling.LateDrawn, culling.FrustumCulled, culling.OcclusionCulled);
+            }
+
+            if (m_ParticleGroup != ~0u) {
+                const ParticleSystemStats& particles = m_Renderer->GetParticleSystem().GetStats();
+                LOG_INFO("Particles: {} alive of {}, {} emitted per frame", particles.AliveCount, particles.Capacity, particles.Emitted);
+            }
+        }
+
+        if (m_StatsTime >= 1.0f) {
+            m_StatsTime = 0.0f;
+            m_StatsFrames = 0;
+        }
+    }
+
+    void Application::DrawMeshField()
+    {
+        f32 aspect = static_cast<f32>(m_Window->Width()) / static_cast<f32>(std::max(m_Window->Height(), 1));
+
+        // Low camera circling the field and looking across it towards the horizon.
+        f32 angle = m_Time * 0.1f;
+        glm::vec3 eye(std::cos(angle) * 20.0f, 3.0f, std::sin(angle) * 20.0f);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // Reverse-Z: near and far are swapped so the near plane maps to depth 1.
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), aspect, 500.0f, 0.1f);
+        projection[1][1] *= -1.0f;
+
+        m_Renderer->SetCamera(view, projection);
+
+        // The renderer's quad circles the central sphere, moved by its push constant transform alone.
+        f32 orbit = -m_Time * 0.3f;
+        glm::mat4 quad = glm::translate(glm::mat4(1.0f), glm::vec3(std::cos(orbit) * 14.0f, 4.0f, std::sin(orbit) * 14.0f));
+        m_Renderer->SetTriangleTransform(glm::scale(glm::rotate(quad, m_Time, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(4.0f)));
+
+        MeshRenderer& meshRenderer = m_Renderer->GetMeshRenderer();
+        meshRenderer.BeginScene(view, projection);
+
+        for (auto& instance : m_FieldInstances)
+            meshRenderer.Submit(*m_FieldMesh, instance.Transform, instance.State);
+
+        meshRenderer.EndScene();
+    }
+
+    void Application::ToggleParticles()
+    {
+        ParticleSystem& particles = m_Renderer->GetParticleSystem();
+
+        if (m_ParticleGroup != ~0u) {
+            particles.DestroyGroup(m_ParticleGroup);
+            m_ParticleGroup = ~0u;
+            return;
         }
+
+        ParticleGroupDesc desc;
+        desc.Capacity = 2u << 20;
+        desc.Drag = 0.1f;
+
+        m_ParticleGroup = particles.CreateGroup(desc);
+        if (m_ParticleGroup == ~0u)
+            return;
+
+        // About 1.6 million alive at a time, bouncing off the field and the sphere.
+        std::vector<ParticleEmitter> emitters;
+        for (u32 i = 0; i < 8; ++i) {
+            f32 angle = glm::radians(45.0f * i);
+
+            ParticleEmitter emitter;
+            emitter.Position = glm::vec3(std::cos(angle) * 16.0f, 0.5f, std::sin(angle) * 16.0f);
+            emitter.Radius = 0.3f;
+            emitter.Velocity = glm::vec3(0.0f, 14.0f, 0.0f);
+            emitter.Spread = 2.5f;
+            emitter.StartColor = glm::vec4(0.3f, 0.6f, 1.0f, 0.5f);
+            emitter.EndColor = glm::vec4(1.0f, 0.4f, 0.1f, 0.0f);
+            emitter.StartSize = 0.04f;
+            emitter.EndSize = 0.015f;
+            emitter.Lifetime = 2.0f;
+            emitter.LifetimeVariance = 0.5f;
+            emitter.Rate = 100000.0f;
+
+            emitters.push_back(emitter);
+        }
+
+        particles.SetEmitters(m_ParticleGroup, emitters);
     }
 
     void Application::EventHandler(Event& event)
@@ -53,6 +275,96 @@ namespace Graphics {
             return false;
         });
 
+        dispatcher.Dispatch<KeyPressedEvent>([&](KeyPressedEvent& e) -> bool {
+            if (e.GetRepeatCount() > 0)
+                return false;
+
+            if (e.GetKeyCode() == KEY_B)
+                m_Renderer2DStress = !m_Renderer2DStress;
+
+            if (e.GetKeyCode() == KEY_L)
+                m_Renderer->GetMeshRenderer().SetLODEnabled(!m_Renderer->GetMeshRenderer().IsLODEnabled());
+
+            if (e.GetKeyCode() == KEY_P)
+                m_Renderer->SetDepthPrepass(!m_Renderer->IsDepthPrepassEnabled());
+
+            if (e.GetKeyCode() == KEY_O)
+                m_Renderer->SetOcclusionCulling(!m_Renderer->IsOcclusionCullingEnabled());
+
+            if (e.GetKeyCode() == KEY_F3)
+                m_Renderer->SetPerfOverlay(!m_Renderer->IsPerfOverlayEnabled());
+
+            if (e.GetKeyCode() == KEY_F4)
+                ToggleParticles();
+
+            if (e.GetKeyCode() == KEY_F5) {
+                PostProcessSettings settings = m_Renderer->GetPostProcessSettings();
+                settings.Bloom = !settings.Bloom;
+                m_Renderer->SetPostProcessSettings(settings);
+            }
+
+            // Cycles clamp -> Reinhard -> ACES.
+            if (e.GetKeyCode() == KEY_T) {
+                PostProcessSettings settings = m_Renderer->GetPostProcessSettings();
+                settings.Tonemap = static_cast<Tonemapper>((static_cast<u32>(settings.Tonemap) + 1) % 3);
+                m_Renderer->SetPostProcessSettings(settings);
+
+                static constexpr const char* names[] = { "none", "Reinhard", "ACES" };
+                LOG_INFO("Tonemapper {}", names[static_cast<u32>(settings.Tonemap)]);
+            }
+
+            // Cycles 1x -> 2x -> 4x -> 8x -> 1x, stopping at the device limit.
+            if (e.GetKeyCode() == KEY_M) {
+                VkSampleCountFlagBits current = m_Renderer->GetSampleCount();
+                VkSampleCountFlagBits next = static_cast<VkSampleCountFlagBits>(current << 1);
+
+                m_Renderer->SetSampleCount(current == VK_SAMPLE_COUNT_8_BIT ? VK_SAMPLE_COUNT_1_BIT : next);
+                if (m_Renderer->GetSampleCount() == current)
+                    m_Renderer->SetSampleCount(VK_SAMPLE_COUNT_1_BIT);
+            }
+
+            if (e.GetKeyCode() == KEY_F12 && m_Renderer->CanCaptureSwapchain())
+                m_Renderer->GetFrameCapture().CaptureFrame("captures/screenshot_" + std::to_string(m_CaptureIndex++) + ".png");
+
+            // Records every frame until pressed again.
+            if (e.GetKeyCode() == KEY_F9 && m_Renderer->CanCaptureSwapchain()) {
+                FrameCapture& capture = m_Renderer->GetFrameCapture();
+
+                if (capture.IsRecording())
+                    capture.StopRecording();
+                else
+                    capture.StartRecording("captures/recording_" + std::to_string(m_CaptureIndex++));
+            }
+
+            if (e.GetKeyCode() == KEY_F8)
+                m_Renderer->GetMemoryTracker().DumpStats("captures/memory_" + std::to_string(m_CaptureIndex++) + ".json");
+
+            return false;
+        });
+
+        dispatcher.Dispatch<MouseMovedEvent>([&](MouseMovedEvent& e) -> bool {
+            m_MousePosition = glm::vec2(e.GetX(), e.GetY());
+            return false;
+        });
+
+        // Highlights the sprite under the cursor.
+        dispatcher.Dispatch<MouseButtonPressedEvent>([&](MouseButtonPressedEvent& e) -> bool {
+            if (e.GetMouseButton() != MOUSE_BUTTON_LEFT)
+                return false;
+
+            glm::vec2 extent(static_cast<f32>(std::max(m_Window->Width(), 1)), static_cast<f32>(std::max(m_Window->Height(), 1)));
+            glm::vec2 ndc = m_MousePosition / extent * 2.0f - 1.0f;
+            glm::vec4 world = glm::inverse(m_ViewProjection) * glm::vec4(ndc, 0.0f, 1.0f);
+
+            Entity entity = m_Scene->Pick(glm::vec2(world));
+            if (!entity.IsNull()) {
+                m_Scene->GetWorld().Get<SpriteComponent>(entity).Color = glm::vec4(1.0f);
+                LOG_INFO("Picked entity {}", entity.Index);
+            }
+
+            return false;
+        });
+
         //LOG_TRACE("{}", event.ToString());
     }
 
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "Window.hpp"
 #include "Events/Event.hpp"
+#include "JobSystem.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Renderer/Mesh.hpp"
+#include "Renderer/MeshRenderer.hpp"
+#include "Scene/Scene.hpp"
 
 namespace Graphics {
 
@@ -22,13 +27,50 @@ namespace Graphics {
     private:
         void EventHandler(Event& event);
 
+        void CreateScene();
+        void CreateMeshField();
+        void DrawScene(f32 dt);
+        void DrawMeshField();
+        void ToggleParticles();
+
     private:
         bool m_Running { true };
         bool m_Minimized { false };
 
+        // Draws a 1000x1000 sprite grid through Renderer2D and logs batch stats.
+        bool m_Renderer2DStress { false };
+        f32 m_StatsTime { 0.0f };
+        u32 m_StatsFrames { 0 };
+        f32 m_Time { 0.0f };
+        // Numbers screenshots and recordings under captures/.
+        u32 m_CaptureIndex { 0 };
+
+        glm::vec2 m_MousePosition { 0.0f };
+        glm::mat4 m_ViewProjection { 1.0f };
+
         std::shared_ptr<Window> m_Window;
         std::unique_ptr<Renderer> m_Renderer;
 
+        std::unique_ptr<JobSystem> m_JobSystem;
+        std::unique_ptr<Scene> m_Scene;
+
+        struct MeshInstance
+        {
+            glm::mat4 Transform;
+            // LOD and visibility slot kept across frames by the mesh renderer.
+            MeshInstanceState State;
+        };
+
+        // Wide field of instanced meshes viewed from a low orbiting camera,
+        // most of them far enough away to be drawn at a coarse LOD. A large
+        // sphere in the middle hides the far side of the field from the
+        // occlusion culler.
+        std::unique_ptr<Mesh> m_FieldMesh;
+        std::vector<MeshInstance> m_FieldInstances;
+
+        // Fountains around the central sphere, toggled with F4.
+        u32 m_ParticleGroup { ~0u };
+
     private:
         inline static Application* s_Instance { nullptr };
     };
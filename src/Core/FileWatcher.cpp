@@ -0,0 +1,138 @@
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#include "Log.hpp"
+
+namespace Graphics {
+
+    FileWatcher::FileWatcher(const std::filesystem::path& directory, const Callback& callback)
+        : m_Directory(directory), m_Callback(callback)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(m_Directory, error)) {
+            LOG_WARN("Cannot watch {}, not a directory", m_Directory.string());
+            return;
+        }
+
+#ifdef __linux__
+        m_Handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_Handle < 0) {
+            LOG_ERROR("Failed to initialize inotify");
+            return;
+        }
+
+        // Editors either rewrite the file in place or rename a temporary over it.
+        if (inotify_add_watch(m_Handle, m_Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            LOG_ERROR("Failed to watch {}", m_Directory.string());
+            close(m_Handle);
+            m_Handle = -1;
+            return;
+        }
+#else
+        for (const auto& entry : std::filesystem::directory_iterator(m_Directory, error)) {
+            if (entry.is_regular_file(error))
+                m_WriteTimes[entry.path().filename().string()] = entry.last_write_time(error);
+        }
+#endif
+
+        m_Running = true;
+        m_Thread = std::thread(&FileWatcher::WatchLoop, this);
+
+        LOG_INFO("Watching {}", m_Directory.string());
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        m_Running = false;
+
+        if (m_Thread.joinable())
+            m_Thread.join();
+
+#ifdef __linux__
+        if (m_Handle >= 0)
+            close(m_Handle);
+#endif
+    }
+
+    void FileWatcher::WatchLoop()
+    {
+        std::vector<std::string> changes;
+
+        while (m_Running) {
+            // Once something changed, only wait briefly for the rest of the batch.
+            bool changed = Poll(changes, changes.empty() ? s_PollInterval : s_SettleTime);
+
+            if (!changed && !changes.empty()) {
+                std::sort(changes.begin(), changes.end());
+                changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+
+                m_Callback(changes);
+                changes.clear();
+            }
+        }
+    }
+
+#ifdef __linux__
+
+    bool FileWatcher::Poll(std::vector<std::string>& changes, std::chrono::milliseconds timeout)
+    {
+        pollfd descriptor = { m_Handle, POLLIN, 0 };
+        if (poll(&descriptor, 1, static_cast<i32>(timeout.count())) <= 0)
+            return false;
+
+        usize count = changes.size();
+
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = read(m_Handle, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->len > 0 && !(event->mask & IN_ISDIR))
+                    changes.emplace_back(event->name);
+            }
+        }
+
+        return changes.size() > count;
+    }
+
+#else
+
+    bool FileWatcher::Poll(std::vector<std::string>& changes, std::chrono::milliseconds timeout)
+    {
+        std::this_thread::sleep_for(timeout);
+
+        usize count = changes.size();
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(m_Directory, error)) {
+            if (!entry.is_regular_file(error))
+                continue;
+
+            std::string name = entry.path().filename().string();
+            std::filesystem::file_time_type time = entry.last_write_time(error);
+
+            auto [it, inserted] = m_WriteTimes.try_emplace(name, time);
+            if (inserted || it->second != time) {
+                it->second = time;
+                changes.push_back(name);
+            }
+        }
+
+        return changes.size() > count;
+    }
+
+#endif
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // Watches the files directly inside one directory on a background thread.
+    // Uses inotify on Linux and polls modification times elsewhere. Editors
+    // often save a file in several steps, so changes are collected until the
+    // directory has been quiet for a moment and then reported as one batch.
+    class FileWatcher
+    {
+    public:
+        // Called on the watcher thread with the names of the changed files.
+        using Callback = std::function<void(const std::vector<std::string>& files)>;
+
+    public:
+        FileWatcher(const std::filesystem::path& directory, const Callback& callback);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        inline bool IsWatching() const { return m_Thread.joinable(); }
+        inline const std::filesystem::path& GetDirectory() const { return m_Directory; }
+
+    private:
+        void WatchLoop();
+
+        // Appends files changed since the last call, waiting at most timeout for
+        // the first one. Returns false if nothing changed.
+        bool Poll(std::vector<std::string>& changes, std::chrono::milliseconds timeout);
+
+    private:
+        inline static constexpr std::chrono::milliseconds s_PollInterval { 100 };
+        inline static constexpr std::chrono::milliseconds s_SettleTime { 50 };
+
+        std::filesystem::path m_Directory;
+        Callback m_Callback;
+
+#ifdef __linux__
+        i32 m_Handle { -1 };
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+#endif
+
+        std::atomic<bool> m_Running { false };
+        std::thread m_Thread;
+    };
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // 64-bit FNV-1a. Stable across runs and platforms, so it can key files on disk.
+    inline constexpr u64 s_HashSeed { 0xcbf29ce484222325ull };
+
+    inline u64 HashBytes(const void* data, usize size, u64 hash = s_HashSeed)
+    {
+        const u8* bytes = static_cast<const u8*>(data);
+        for (usize i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    inline u64 HashString(std::string_view string, u64 hash = s_HashSeed)
+    {
+        hash = HashBytes(string.data(), string.size(), hash);
+
+        // Hashing the length as well keeps "ab" + "c" apart from "a" + "bc".
+        u64 length = string.size();
+        return HashBytes(&length, sizeof(length), hash);
+    }
+
+    template<typename T>
+    inline u64 HashValue(const T& value, u64 hash = s_HashSeed)
+    {
+        return HashBytes(&value, sizeof(T), hash);
+    }
+
+    // Hasher for unordered_map keys flattened into a vector of plain values.
+    struct VectorHash
+    {
+        template<typename T>
+        usize operator()(const std::vector<T>& values) const
+        {
+            return static_cast<usize>(HashBytes(values.data(), values.size() * sizeof(T)));
+        }
+    };
+
+}
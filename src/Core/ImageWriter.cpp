@@ -0,0 +1,227 @@
+#include "ImageWriter.hpp"
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "Log.hpp"
+
+namespace Graphics {
+
+    static constexpr std::array<u32, 256> s_CrcTable = [] {
+        std::array<u32, 256> table {};
+
+        for (u32 i = 0; i < 256; ++i) {
+            u32 crc = i;
+            for (u32 bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+
+            table[i] = crc;
+        }
+
+        return table;
+    }();
+
+    static u32 UpdateCrc(u32 crc, const u8* data, usize size)
+    {
+        for (usize i = 0; i < size; ++i)
+            crc = s_CrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+        return crc;
+    }
+
+    static void AppendBigEndian(std::vector<u8>& out, u32 value)
+    {
+        out.push_back(static_cast<u8>(value >> 24));
+        out.push_back(static_cast<u8>(value >> 16));
+        out.push_back(static_cast<u8>(value >> 8));
+        out.push_back(static_cast<u8>(value));
+    }
+
+    // Both formats are little-endian, as is every platform the renderer runs on.
+    template<typename T>
+    static void AppendLittleEndian(std::vector<u8>& out, T value)
+    {
+        usize offset = out.size();
+        out.resize(offset + sizeof(T));
+        std::memcpy(out.data() + offset, &value, sizeof(T));
+    }
+
+    static void AppendString(std::vector<u8>& out, std::string_view string)
+    {
+        out.insert(out.end(), string.begin(), string.end());
+        out.push_back(0);
+    }
+
+    static void AppendChunk(std::vector<u8>& out, const char* type, const u8* data, usize size)
+    {
+        AppendBigEndian(out, static_cast<u32>(size));
+
+        usize start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+
+        AppendBigEndian(out, UpdateCrc(0xFFFFFFFFu, out.data() + start, size + 4) ^ 0xFFFFFFFFu);
+    }
+
+    static bool WriteFile(const std::filesystem::path& path, const std::vector<u8>& data)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        if (!file) {
+            LOG_ERROR("Failed to write {}", path.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool WritePNG(const std::filesystem::path& path, u32 width, u32 height, const u8* rgba, usize stride)
+    {
+        static constexpr std::array<u8, 8> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        static constexpr usize maxBlockSize = 65535;
+
+        // Every row starts with its filter type, 0 leaves the bytes as they are.
+        usize rowSize = static_cast<usize>(width) * 4 + 1;
+        usize rawSize = rowSize * height;
+
+        std::vector<u8> raw(rawSize);
+        for (u32 y = 0; y < height; ++y) {
+            raw[y * rowSize] = 0;
+            std::memcpy(&raw[y * rowSize + 1], rgba + y * stride, rowSize - 1);
+        }
+
+        // zlib stream of stored deflate blocks, each prefixed with its length and complement.
+        std::vector<u8> zlib;
+        zlib.reserve(rawSize + (rawSize / maxBlockSize + 1) * 5 + 6);
+        zlib.push_back(0x78);
+        zlib.push_back(0x01);
+
+        u32 adlerA = 1;
+        u32 adlerB = 0;
+
+        for (usize offset = 0; ; offset += maxBlockSize) {
+            u16 size = static_cast<u16>(std::min(maxBlockSize, rawSize - offset));
+            bool last = offset + size >= rawSize;
+
+            zlib.push_back(last ? 1 : 0);
+            AppendLittleEndian<u16>(zlib, size);
+            AppendLittleEndian<u16>(zlib, static_cast<u16>(~size));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+            // 5552 bytes is the most that can be summed before the modulo without overflowing.
+            for (usize i = 0; i < size; i += 5552) {
+                usize end = std::min<usize>(i + 5552, size);
+                for (usize j = i; j < end; ++j) {
+                    adlerA += raw[offset + j];
+                    adlerB += adlerA;
+                }
+
+                adlerA %= 65521;
+                adlerB %= 65521;
+            }
+
+            if (last)
+                break;
+        }
+
+        AppendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+        std::vector<u8> header;
+        AppendBigEndian(header, width);
+        AppendBigEndian(header, height);
+        header.push_back(8); // Bit depth
+        header.push_back(6); // RGBA
+        header.push_back(0); // Deflate
+        header.push_back(0); // Adaptive filtering
+        header.push_back(0); // Not interlaced
+
+        std::vector<u8> file(signature.begin(), signature.end());
+        file.reserve(zlib.size() + 64);
+
+        AppendChunk(file, "IHDR", header.data(), header.size());
+        AppendChunk(file, "IDAT", zlib.data(), zlib.size());
+        AppendChunk(file, "IEND", nullptr, 0);
+
+        return WriteFile(path, file);
+    }
+
+    bool WriteEXR(const std::filesystem::path& path, u32 width, u32 height, const f32* rgba)
+    {
+        static constexpr i32 pixelTypeFloat = 2;
+
+        // Channels are stored in alphabetical order, the source order is RGBA.
+        static constexpr std::array<std::pair<const char*, u32>, 4> channels = {{
+            { "A", 3 }, { "B", 2 }, { "G", 1 }, { "R", 0 }
+        }};
+
+        std::vector<u8> file;
+
+        AppendLittleEndian<u32>(file, 20000630);
+        AppendLittleEndian<u32>(file, 2);
+
+        auto attribute = [&](std::string_view name, std::string_view type, const std::vector<u8>& value) {
+            AppendString(file, name);
+            AppendString(file, type);
+            AppendLittleEndian<i32>(file, static_cast<i32>(value.size()));
+            file.insert(file.end(), value.begin(), value.end());
+        };
+
+        std::vector<u8> channelList;
+        for (const auto& [name, source] : channels) {
+            AppendString(channelList, name);
+            AppendLittleEndian<i32>(channelList, pixelTypeFloat);
+            AppendLittleEndian<u32>(channelList, 0); // pLinear and reserved
+            AppendLittleEndian<i32>(channelList, 1); // x sampling
+            AppendLittleEndian<i32>(channelList, 1); // y sampling
+        }
+        channelList.push_back(0);
+
+        std::vector<u8> window;
+        AppendLittleEndian<i32>(window, 0);
+        AppendLittleEndian<i32>(window, 0);
+        AppendLittleEndian<i32>(window, static_cast<i32>(width) - 1);
+        AppendLittleEndian<i32>(window, static_cast<i32>(height) - 1);
+
+        std::vector<u8> one;
+        AppendLittleEndian<f32>(one, 1.0f);
+
+        attribute("channels", "chlist", channelList);
+        attribute("compression", "compression", { 0 });
+        attribute("dataWindow", "box2i", window);
+        attribute("displayWindow", "box2i", window);
+        attribute("lineOrder", "lineOrder", { 0 });
+        attribute("pixelAspectRatio", "float", one);
+        attribute("screenWindowCenter", "v2f", std::vector<u8>(8, 0));
+        attribute("screenWindowWidth", "float", one);
+        file.push_back(0);
+
+        // Uncompressed files store one scanline per chunk, each listed in the offset table.
+        usize lineSize = static_cast<usize>(width) * channels.size() * sizeof(f32);
+        usize tableOffset = file.size();
+        usize dataOffset = tableOffset + static_cast<usize>(height) * sizeof(u64);
+
+        file.reserve(dataOffset + (lineSize + 8) * height);
+
+        for (u32 y = 0; y < height; ++y)
+            AppendLittleEndian<u64>(file, dataOffset + y * (lineSize + 8));
+
+        for (u32 y = 0; y < height; ++y) {
+            AppendLittleEndian<i32>(file, static_cast<i32>(y));
+            AppendLittleEndian<i32>(file, static_cast<i32>(lineSize));
+
+            const f32* row = rgba + static_cast<usize>(y) * width * 4;
+            for (const auto& [name, source] : channels) {
+                for (u32 x = 0; x < width; ++x)
+                    AppendLittleEndian<f32>(file, row[x * 4 + source]);
+            }
+        }
+
+        return WriteFile(path, file);
+    }
+
+}
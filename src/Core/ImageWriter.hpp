@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // Minimal encoders for captured frames, no external image library.
+    //
+    // PNGs are written with stored (uncompressed) deflate blocks: the files
+    // are as large as the raw pixels, but encoding is a CRC pass over the data
+    // and keeps up with continuous recording. EXRs are uncompressed scanline
+    // files with 32-bit float channels.
+
+    // 8-bit RGBA, rows are stride bytes apart.
+    bool WritePNG(const std::filesystem::path& path, u32 width, u32 height, const u8* rgba, usize stride);
+
+    // 32-bit float RGBA, tightly packed.
+    bool WriteEXR(const std::filesystem::path& path, u32 width, u32 height, const f32* rgba);
+
+}
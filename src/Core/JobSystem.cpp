@@ -0,0 +1,114 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace Graphics {
+
+    JobSystem::JobSystem(u32 threadCount)
+    {
+        // hardware_concurrency() may return 0 when it cannot tell.
+        if (threadCount == 0) {
+            u32 hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        m_Workers.reserve(threadCount);
+        for (u32 i = 0; i < threadCount; ++i)
+            m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Running = false;
+        }
+
+        m_QueueCondition.notify_all();
+
+        for (auto& worker : m_Workers)
+            worker.join();
+    }
+
+    void JobSystem::Execute(JobContext& context, const JobFn& job)
+    {
+        context.Pending.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Queue.push_back({ job, &context });
+        }
+
+        m_QueueCondition.notify_one();
+    }
+
+    void JobSystem::Dispatch(JobContext& context, u32 count, u32 groupSize, const RangeFn& fn)
+    {
+        if (count == 0 || groupSize == 0)
+            return;
+
+        u32 groupCount = (count + groupSize - 1) / groupSize;
+        context.Pending.fetch_add(groupCount, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            for (u32 group = 0; group < groupCount; ++group) {
+                u32 begin = group * groupSize;
+                u32 end = std::min(begin + groupSize, count);
+
+                m_Queue.push_back({ [fn, begin, end]() { fn(begin, end); }, &context });
+            }
+        }
+
+        m_QueueCondition.notify_all();
+    }
+
+    void JobSystem::Wait(JobContext& context)
+    {
+        while (IsBusy(context)) {
+            if (!TryRunOne())
+                std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::WorkerLoop()
+    {
+        while (true) {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock(m_QueueMutex);
+                m_QueueCondition.wait(lock, [this]() { return !m_Queue.empty() || !m_Running; });
+
+                if (!m_Running && m_Queue.empty())
+                    return;
+
+                job = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            }
+
+            job.Fn();
+            job.Context->Pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    bool JobSystem::TryRunOne()
+    {
+        Job job;
+
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            if (m_Queue.empty())
+                return false;
+
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+
+        job.Fn();
+        job.Context->Pending.fetch_sub(1, std::memory_order_release);
+
+        return true;
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // Tracks a group of jobs so the caller can wait for all of them.
+    struct JobContext
+    {
+        std::atomic<u32> Pending { 0 };
+    };
+
+    // Fixed pool of worker threads pulling from one shared queue. Waiting
+    // threads help execute queued jobs instead of blocking, so jobs may
+    // themselves dispatch and wait on nested work.
+    class JobSystem
+    {
+    public:
+        using JobFn = std::function<void()>;
+        using RangeFn = std::function<void(u32 begin, u32 end)>;
+
+    public:
+        // threadCount 0 uses one worker per hardware thread minus the caller.
+        JobSystem(u32 threadCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        void Execute(JobContext& context, const JobFn& job);
+
+        // Splits [0, count) into groups of groupSize and runs fn(begin, end) for each.
+        void Dispatch(JobContext& context, u32 count, u32 groupSize, const RangeFn& fn);
+
+        void Wait(JobContext& context);
+
+        inline bool IsBusy(const JobContext& context) const { return context.Pending.load(std::memory_order_acquire) > 0; }
+        inline u32 GetWorkerCount() const { return static_cast<u32>(m_Workers.size()); }
+
+    private:
+        struct Job
+        {
+            JobFn Fn;
+            JobContext* Context;
+        };
+
+        void WorkerLoop();
+        bool TryRunOne();
+
+    private:
+        std::vector<std::thread> m_Workers;
+
+        std::deque<Job> m_Queue;
+        std::mutex m_QueueMutex;
+        std::condition_variable m_QueueCondition;
+
+        bool m_Running { true };
+    };
+
+}
@@ -222,7 +222,7 @@ namespace Graphics {
 #define KEY_Q               ::Graphics::Key::Q
 #define KEY_R               ::Graphics::Key::R
 #define KEY_S               ::Graphics::Key::S
-#define KEY               ::Graphics::Key::T
+#define KEY_T               ::Graphics::Key::T
 #define KEY_U               ::Graphics::Key::U
 #define KEY_V               ::Graphics::Key::V
 #define KEY_W               ::Graphics::Key::W
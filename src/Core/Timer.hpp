@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    class Timer
+    {
+    public:
+        Timer() { Reset(); }
+
+        inline void Reset() { m_Start = std::chrono::high_resolution_clock::now(); }
+
+        inline f32 Elapsed() const { return std::chrono::duration<f32>(std::chrono::high_resolution_clock::now() - m_Start).count(); }
+        inline f32 ElapsedMillis() const { return Elapsed() * 1000.0f; }
+
+    private:
+        std::chrono::time_point<std::chrono::high_resolution_clock> m_Start;
+    };
+
+}
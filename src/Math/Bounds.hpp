@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    struct BoundingSphere
+    {
+        glm::vec3 Center { 0.0f };
+        f32 Radius { 0.0f };
+    };
+
+    struct AABB
+    {
+        glm::vec3 Min { 0.0f };
+        glm::vec3 Max { 0.0f };
+
+        inline glm::vec3 Center() const { return (Min + Max) * 0.5f; }
+        inline glm::vec3 Extents() const { return (Max - Min) * 0.5f; }
+
+        inline f32 SurfaceArea() const
+        {
+            glm::vec3 d = Max - Min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        inline bool Contains(const AABB& other) const
+        {
+            return Min.x <= other.Min.x && Min.y <= other.Min.y && Min.z <= other.Min.z
+                && Max.x >= other.Max.x && Max.y >= other.Max.y && Max.z >= other.Max.z;
+        }
+
+        inline bool Overlaps(const AABB& other) const
+        {
+            return Min.x <= other.Max.x && Max.x >= other.Min.x
+                && Min.y <= other.Max.y && Max.y >= other.Min.y
+                && Min.z <= other.Max.z && Max.z >= other.Min.z;
+        }
+
+        static inline AABB Union(const AABB& a, const AABB& b)
+        {
+            return { glm::min(a.Min, b.Min), glm::max(a.Max, b.Max) };
+        }
+    };
+
+    struct Ray
+    {
+        glm::vec3 Origin { 0.0f };
+        glm::vec3 Direction { 0.0f, 0.0f, -1.0f };
+    };
+
+    // Slab test against a box, invDirection is 1 / ray.Direction. On a hit
+    // distance is the entry distance along the ray, 0 if the origin is inside.
+    inline bool IntersectRay(const Ray& ray, const glm::vec3& invDirection, const AABB& box, f32 maxDistance, f32& distance)
+    {
+        glm::vec3 t0 = (box.Min - ray.Origin) * invDirection;
+        glm::vec3 t1 = (box.Max - ray.Origin) * invDirection;
+        glm::vec3 tMin = glm::min(t0, t1);
+        glm::vec3 tMax = glm::max(t0, t1);
+
+        f32 enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+        f32 exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+        distance = enter;
+        return enter <= exit;
+    }
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "Bounds.hpp"
+
+namespace Graphics {
+
+    enum class Containment : u8
+    {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+    // Six inward-facing planes (xyz normal, w distance) extracted from a
+    // view-projection matrix with Vulkan clip depth, so 0 <= z <= w. This holds
+    // for reverse-Z as well, near and far simply swap. A plane that degenerates
+    // (the far plane of an infinite projection) is replaced by one every point passes.
+    struct Frustum
+    {
+        enum Side : u32 { Left, Right, Bottom, Top, Near, Far, Count };
+
+        std::array<glm::vec4, Count> Planes;
+
+        static Frustum FromMatrix(const glm::mat4& m)
+        {
+            glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+            glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+            glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+            glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+            Frustum frustum;
+            frustum.Planes[Left] = row3 + row0;
+            frustum.Planes[Right] = row3 - row0;
+            frustum.Planes[Bottom] = row3 + row1;
+            frustum.Planes[Top] = row3 - row1;
+            frustum.Planes[Near] = row2;
+            frustum.Planes[Far] = row3 - row2;
+
+            for (glm::vec4& plane : frustum.Planes) {
+                f32 length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+                plane = length > 1e-6f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+
+            return frustum;
+        }
+
+        inline bool Intersects(const BoundingSphere& sphere) const
+        {
+            for (const glm::vec4& plane : Planes) {
+                if (plane.x * sphere.Center.x + plane.y * sphere.Center.y + plane.z * sphere.Center.z + plane.w < -sphere.Radius)
+                    return false;
+            }
+            return true;
+        }
+
+        inline bool Intersects(const AABB& box) const
+        {
+            glm::vec3 center = box.Center();
+            glm::vec3 extents = box.Extents();
+
+            for (const glm::vec4& plane : Planes) {
+                f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                f32 radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+                if (distance < -radius)
+                    return false;
+            }
+            return true;
+        }
+
+        inline Containment Classify(const AABB& box) const
+        {
+            glm::vec3 center = box.Center();
+            glm::vec3 extents = box.Extents();
+
+            Containment result = Containment::Inside;
+            for (const glm::vec4& plane : Planes) {
+                f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                f32 radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+                if (distance < -radius)
+                    return Containment::Outside;
+                if (distance < radius)
+                    result = Containment::Intersects;
+            }
+            return result;
+        }
+    };
+
+}
@@ -0,0 +1,190 @@
+#include "DescriptorAllocator.hpp"
+
+#include <array>
+#include <algorithm>
+
+#include "Vulkan.hpp"
+
+namespace Graphics {
+
+    struct PoolRatio
+    {
+        VkDescriptorType Type;
+        f32 PerSet;
+    };
+
+    // Descriptors of each type reserved per set. Batched texture arrays are
+    // the largest consumers, a set that does not fit moves on to the next pool.
+    static constexpr std::array<PoolRatio, 11> s_PoolRatios = {
+        PoolRatio { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 8.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 0.5f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 0.5f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f },
+        PoolRatio { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f }
+    };
+
+    static constexpr u32 s_InitialSetsPerPool = 64;
+    static constexpr u32 s_MaxSetsPerPool = 4096;
+
+    DescriptorAllocator::DescriptorAllocator(VkDevice device, usize framesInFlight)
+        : m_Device(device), m_Frames(framesInFlight), m_SetsPerPool(s_InitialSetsPerPool)
+    {
+        m_Frame = &m_Frames[0];
+    }
+
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+        for (auto& frame : m_Frames) {
+            for (VkDescriptorPool pool : frame.Pools)
+                vkDestroyDescriptorPool(m_Device, pool, nullptr);
+        }
+    }
+
+    void DescriptorAllocator::BeginFrame(usize frameIndex)
+    {
+        m_Frame = &m_Frames[frameIndex];
+
+        // Only the pools this slot used last time hold sets.
+        for (usize i = 0; i < std::min(m_Frame->PoolIndex + 1, m_Frame->Pools.size()); ++i)
+            VK_CHECK(vkResetDescriptorPool(m_Device, m_Frame->Pools[i], 0));
+
+        m_Frame->PoolIndex = 0;
+        m_Frame->Written.clear();
+
+        m_Stats.SetsAllocated = 0;
+        m_Stats.SetsReused = 0;
+    }
+
+    VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+    {
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        while (true) {
+            // Size of the pool if it was created for this attempt.
+            u32 created = 0;
+            if (m_Frame->PoolIndex == m_Frame->Pools.size()) {
+                created = m_SetsPerPool;
+                m_Frame->Pools.push_back(CreatePool());
+            }
+
+            allocInfo.descriptorPool = m_Frame->Pools[m_Frame->PoolIndex];
+
+            VkDescriptorSet set { VK_NULL_HANDLE };
+            VkResult result = vkAllocateDescriptorSets(m_Device, &allocInfo, &set);
+
+            if (result == VK_SUCCESS) {
+                m_Stats.SetsAllocated++;
+                return set;
+            }
+
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+                LOG_ERROR("Failed to allocate descriptor set ({})", static_cast<i32>(result));
+                return VK_NULL_HANDLE;
+            }
+
+            // An empty pool of the largest size that cannot hold the set never will.
+            if (created == s_MaxSetsPerPool) {
+                LOG_ERROR("Descriptor set layout does not fit an empty pool");
+                return VK_NULL_HANDLE;
+            }
+
+            m_Frame->PoolIndex++;
+        }
+    }
+
+    VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, std::span<const VkWriteDescriptorSet> writes)
+    {
+        std::vector<u64> key;
+        key.push_back(reinterpret_cast<u64>(layout));
+
+        for (const auto& write : writes) {
+            key.push_back(write.dstBinding);
+            key.push_back(write.dstArrayElement);
+            key.push_back(write.descriptorCount);
+            key.push_back(static_cast<u64>(write.descriptorType));
+
+            // Only the info array matching the type is valid to read.
+            for (u32 i = 0; i < write.descriptorCount; ++i) {
+                switch (write.descriptorType) {
+                    case VK_DESCRIPTOR_TYPE_SAMPLER:
+                    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                        key.push_back(reinterpret_cast<u64>(write.pImageInfo[i].sampler));
+                        key.push_back(reinterpret_cast<u64>(write.pImageInfo[i].imageView));
+                        key.push_back(static_cast<u64>(write.pImageInfo[i].imageLayout));
+                        break;
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                        key.push_back(reinterpret_cast<u64>(write.pBufferInfo[i].buffer));
+                        key.push_back(write.pBufferInfo[i].offset);
+                        key.push_back(write.pBufferInfo[i].range);
+                        break;
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                        key.push_back(reinterpret_cast<u64>(write.pTexelBufferView[i]));
+                        break;
+                    default:
+                        LOG_ERROR("Descriptor type {} cannot be cached", static_cast<i32>(write.descriptorType));
+                        return VK_NULL_HANDLE;
+                }
+            }
+        }
+
+        auto it = m_Frame->Written.find(key);
+        if (it != m_Frame->Written.end()) {
+            m_Stats.SetsReused++;
+            return it->second;
+        }
+
+        VkDescriptorSet set = Allocate(layout);
+        if (set == VK_NULL_HANDLE)
+            return VK_NULL_HANDLE;
+
+        std::vector<VkWriteDescriptorSet> targeted(writes.begin(), writes.end());
+        for (auto& write : targeted)
+            write.dstSet = set;
+
+        vkUpdateDescriptorSets(m_Device, static_cast<u32>(targeted.size()), targeted.data(), 0, nullptr);
+
+        m_Frame->Written.emplace(std::move(key), set);
+
+        return set;
+    }
+
+    VkDescriptorPool DescriptorAllocator::CreatePool()
+    {
+        // Each chained pool doubles, a frame that needs many sets settles on a few large pools.
+        u32 sets = m_SetsPerPool;
+        m_SetsPerPool = std::min(m_SetsPerPool * 2, s_MaxSetsPerPool);
+
+        std::array<VkDescriptorPoolSize, s_PoolRatios.size()> sizes;
+        for (usize i = 0; i < sizes.size(); ++i)
+            sizes[i] = { s_PoolRatios[i].Type, std::max(static_cast<u32>(s_PoolRatios[i].PerSet * sets), 1u) };
+
+        VkDescriptorPoolCreateInfo createInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        createInfo.maxSets = sets;
+        createInfo.poolSizeCount = static_cast<u32>(sizes.size());
+        createInfo.pPoolSizes = sizes.data();
+
+        VkDescriptorPool pool { VK_NULL_HANDLE };
+        VK_CHECK(vkCreateDescriptorPool(m_Device, &createInfo, nullptr, &pool));
+
+        m_Stats.PoolCount++;
+        LOG_DEBUG("Created descriptor pool for {} sets, {} pools in total", sets, m_Stats.PoolCount);
+
+        return pool;
+    }
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "Core/Hash.hpp"
+
+namespace Graphics {
+
+    struct DescriptorAllocatorStats
+    {
+        u32 PoolCount { 0 };
+        // Counted since the last BeginFrame().
+        u32 SetsAllocated { 0 };
+        u32 SetsReused { 0 };
+    };
+
+    // Hands out descriptor sets that live for one frame.
+    //
+    // Every frame in flight has its own chain of pools. BeginFrame() resets the
+    // whole chain of a slot at once, after its last frame completed, and a pool
+    // that runs out chains the next one, created larger than the last. Pools
+    // are kept across frames, so after warm-up a frame costs one reset per pool
+    // and no pool creation.
+    //
+    // Sets requested with their writes are cached for the frame: asking for the
+    // same layout and contents again returns the set written before without
+    // calling vkUpdateDescriptorSets. Not thread-safe, used while recording.
+    class DescriptorAllocator
+    {
+    public:
+        DescriptorAllocator(VkDevice device, usize framesInFlight);
+        ~DescriptorAllocator();
+
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+        void BeginFrame(usize frameIndex);
+
+        // Returns VK_NULL_HANDLE if no pool can hold the set.
+        VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+        // dstSet of the writes is ignored. Supports image, buffer and texel buffer writes.
+        VkDescriptorSet Allocate(VkDescriptorSetLayout layout, std::span<const VkWriteDescriptorSet> writes);
+
+        inline const DescriptorAllocatorStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct Frame
+        {
+            std::vector<VkDescriptorPool> Pools;
+            usize PoolIndex { 0 };
+
+            std::unordered_map<std::vector<u64>, VkDescriptorSet, VectorHash> Written;
+        };
+
+    private:
+        VkDescriptorPool CreatePool();
+
+    private:
+        VkDevice m_Device;
+
+        std::vector<Frame> m_Frames;
+        Frame* m_Frame { nullptr };
+
+        u32 m_SetsPerPool;
+
+        DescriptorAllocatorStats m_Stats;
+    };
+
+}
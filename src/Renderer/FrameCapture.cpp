@@ -0,0 +1,372 @@
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <limits>
+
+#include <glm/gtc/packing.hpp>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "QueueTimeline.hpp"
+#include "Core/ImageWriter.hpp"
+
+namespace Graphics {
+
+    // Remaining frames of a recording, which runs until it is stopped.
+    static constexpr u32 s_Unbounded = std::numeric_limits<u32>::max();
+
+    static u32 GetBytesPerPixel(VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return 4;
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+                return 8;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    static bool IsFloatFormat(VkFormat format)
+    {
+        return format == VK_FORMAT_R16G16B16A16_SFLOAT || format == VK_FORMAT_R32G32B32A32_SFLOAT;
+    }
+
+    FrameCapture::FrameCapture(Renderer& renderer, u32 bufferCount, u32 workerCount)
+        : m_Renderer(renderer), m_Device(renderer.GetDevice()), m_Slots(bufferCount), m_Jobs(workerCount)
+    {
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        Flush();
+
+        for (auto& slot : m_Slots)
+            FreeSlot(slot);
+    }
+
+    void FrameCapture::CaptureFrame(const std::filesystem::path& path)
+    {
+        Request request;
+        request.Path = path;
+
+        m_Requests.push_back(std::move(request));
+    }
+
+    void FrameCapture::CaptureSequence(const std::filesystem::path& directory, u32 count)
+    {
+        if (count == 0)
+            return;
+
+        Request request;
+        request.Path = directory;
+        request.Sequence = true;
+        request.Remaining = count;
+
+        m_Requests.push_back(std::move(request));
+    }
+
+    void FrameCapture::StartRecording(const std::filesystem::path& directory)
+    {
+        if (m_Recording)
+            return;
+
+        Request request;
+        request.Path = directory;
+        request.Sequence = true;
+        request.Remaining = s_Unbounded;
+
+        m_Recording = std::move(request);
+
+        LOG_INFO("Recording frames to {}", directory.string());
+    }
+
+    void FrameCapture::StopRecording()
+    {
+        if (!m_Recording)
+            return;
+
+        LOG_INFO("Recorded {} frames to {}", m_Recording->Index, m_Recording->Path.string());
+
+        m_Recording.reset();
+    }
+
+    void FrameCapture::RecordReadback(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkExtent2D extent)
+    {
+        if (!IsActive())
+            return;
+
+        if (!IsFormatSupported(format)) {
+            LOG_ERROR("Cannot capture images of format {}", static_cast<i32>(format));
+
+            m_Recording.reset();
+            if (!m_Requests.empty())
+                m_Requests.pop_front();
+            return;
+        }
+
+        std::array<Request*, 2> targets = {
+            m_Recording ? &*m_Recording : nullptr,
+            m_Requests.empty() ? nullptr : &m_Requests.front()
+        };
+
+        VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * GetBytesPerPixel(format);
+        bool copied = false;
+
+        for (Request* request : targets) {
+            if (!request)
+                continue;
+
+            // A capture that finds no buffer tries again next frame, a recording loses the frame.
+            Slot* slot = AcquireSlot(size);
+            if (!slot) {
+                m_Dropped++;
+                continue;
+            }
+
+            VkBufferImageCopy region {};
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = { extent.width, extent.height, 1 };
+
+            vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->Buffer, 1, &region);
+
+            slot->Value = m_Renderer.GetGraphicsTimeline().GetPendingValue();
+            slot->Format = format;
+            slot->Extent = extent;
+            slot->Path = NextPath(*request, format);
+            slot->State.store(SlotState::Pending, std::memory_order_relaxed);
+
+            copied = true;
+        }
+
+        if (!m_Requests.empty() && m_Requests.front().Remaining == 0)
+            m_Requests.pop_front();
+
+        if (!copied)
+            return;
+
+        // Waiting on the timeline from the host does not make the copy visible to it by itself.
+        VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+        VkDependencyInfo dependency = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependency.memoryBarrierCount = 1;
+        dependency.pMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependency);
+    }
+
+    void FrameCapture::Update()
+    {
+        QueueTimeline& timeline = m_Renderer.GetGraphicsTimeline();
+
+        for (auto& slot : m_Slots) {
+            if (slot.State.load(std::memory_order_relaxed) != SlotState::Pending || !timeline.IsComplete(slot.Value))
+                continue;
+
+            if (!slot.Coherent) {
+                VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+                range.memory = slot.Memory;
+                range.offset = 0;
+                range.size = VK_WHOLE_SIZE;
+
+                VK_CHECK(vkInvalidateMappedMemoryRanges(m_Device, 1, &range));
+            }
+
+            slot.State.store(SlotState::Encoding, std::memory_order_relaxed);
+            m_Encoding.fetch_add(1, std::memory_order_relaxed);
+            m_Captured++;
+
+            m_Jobs.Execute(m_Context, [this, &slot]() {
+                Encode(slot);
+
+                m_Encoding.fetch_sub(1, std::memory_order_relaxed);
+                slot.State.store(SlotState::Free, std::memory_order_release);
+            });
+        }
+    }
+
+    void FrameCapture::Flush()
+    {
+        u64 value = 0;
+        for (const auto& slot : m_Slots) {
+            if (slot.State.load(std::memory_order_relaxed) == SlotState::Pending)
+                value = std::max(value, slot.Value);
+        }
+
+        if (value > 0)
+            m_Renderer.GetGraphicsTimeline().Wait(value);
+
+        Update();
+        m_Jobs.Wait(m_Context);
+    }
+
+    FrameCaptureStats FrameCapture::GetStats() const
+    {
+        FrameCaptureStats stats;
+        stats.Captured = m_Captured;
+        stats.Dropped = m_Dropped;
+        stats.Encoding = m_Encoding.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    bool FrameCapture::IsFormatSupported(VkFormat format)
+    {
+        return GetBytesPerPixel(format) != 0;
+    }
+
+    FrameCapture::Slot* FrameCapture::AcquireSlot(VkDeviceSize size)
+    {
+        for (u32 i = 0; i < m_Slots.size(); ++i) {
+            Slot& slot = m_Slots[(m_NextSlot + i) % m_Slots.size()];
+            if (slot.State.load(std::memory_order_acquire) != SlotState::Free)
+                continue;
+
+            // Buffers grow with the captured extent and are kept for the next frames.
+            if (slot.Size < size) {
+                FreeSlot(slot);
+                AllocateSlot(slot, size);
+            }
+
+            m_NextSlot = (m_NextSlot + i + 1) % m_Slots.size();
+            return &slot;
+        }
+
+        return nullptr;
+    }
+
+    void FrameCapture::AllocateSlot(Slot& slot, VkDeviceSize size)
+    {
+        VkBufferCreateInfo createInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        createInfo.size = size;
+        createInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VK_CHECK(vkCreateBuffer(m_Device, &createInfo, nullptr, &slot.Buffer));
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(m_Device, slot.Buffer, &requirements);
+
+        // Reading uncached memory from the CPU is several times slower, coherent
+        // memory is only the fallback when no cached host-visible type exists.
+        u32 memoryType = m_Renderer.FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        if (memoryType == ~0u)
+            memoryType = m_Renderer.FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(m_Renderer.GetPhysicalDevice(), &memoryProperties);
+
+        VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = memoryType;
+
+        VK_CHECK(m_Renderer.AllocateMemory(allocInfo, MemoryCategory::Readback, "FrameCapture", slot.Memory));
+        VK_CHECK(vkBindBufferMemory(m_Device, slot.Buffer, slot.Memory, 0));
+
+        void* mapped = nullptr;
+        VK_CHECK(vkMapMemory(m_Device, slot.Memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+
+        slot.Mapped = static_cast<u8*>(mapped);
+        slot.Size = size;
+        slot.Coherent = (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    }
+
+    void FrameCapture::FreeSlot(Slot& slot)
+    {
+        if (slot.Buffer == VK_NULL_HANDLE)
+            return;
+
+        vkUnmapMemory(m_Device, slot.Memory);
+        vkDestroyBuffer(m_Device, slot.Buffer, nullptr);
+        m_Renderer.FreeMemory(slot.Memory);
+
+        slot.Buffer = VK_NULL_HANDLE;
+        slot.Memory = VK_NULL_HANDLE;
+        slot.Mapped = nullptr;
+        slot.Size = 0;
+    }
+
+    std::filesystem::path FrameCapture::NextPath(Request& request, VkFormat format)
+    {
+        const char* extension = IsFloatFormat(format) ? ".exr" : ".png";
+
+        std::filesystem::path path = request.Path;
+        if (request.Sequence) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%05u%s", request.Index, extension);
+            path /= name;
+        } else {
+            path.replace_extension(extension);
+        }
+
+        request.Index++;
+
+        if (request.Remaining != s_Unbounded && --request.Remaining == 0) {
+            if (request.Sequence)
+                LOG_INFO("Captured {} frames to {}", request.Index, request.Path.string());
+            else
+                LOG_INFO("Captured frame to {}", path.string());
+        }
+
+        return path;
+    }
+
+    void FrameCapture::Encode(Slot& slot)
+    {
+        std::error_code error;
+        if (slot.Path.has_parent_path())
+            std::filesystem::create_directories(slot.Path.parent_path(), error);
+
+        u32 width = slot.Extent.width;
+        u32 height = slot.Extent.height;
+        usize pixels = static_cast<usize>(width) * height;
+
+        switch (slot.Format) {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+                WritePNG(slot.Path, width, height, slot.Mapped, static_cast<usize>(width) * 4);
+                break;
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB: {
+                std::vector<u8> rgba(pixels * 4);
+                for (usize i = 0; i < pixels; ++i) {
+                    rgba[i * 4 + 0] = slot.Mapped[i * 4 + 2];
+                    rgba[i * 4 + 1] = slot.Mapped[i * 4 + 1];
+                    rgba[i * 4 + 2] = slot.Mapped[i * 4 + 0];
+                    rgba[i * 4 + 3] = slot.Mapped[i * 4 + 3];
+                }
+
+                WritePNG(slot.Path, width, height, rgba.data(), static_cast<usize>(width) * 4);
+                break;
+            }
+            case VK_FORMAT_R16G16B16A16_SFLOAT: {
+                const u16* halves = reinterpret_cast<const u16*>(slot.Mapped);
+
+                std::vector<f32> rgba(pixels * 4);
+                for (usize i = 0; i < rgba.size(); ++i)
+                    rgba[i] = glm::unpackHalf1x16(halves[i]);
+
+                WriteEXR(slot.Path, width, height, rgba.data());
+                break;
+            }
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                WriteEXR(slot.Path, width, height, reinterpret_cast<const f32*>(slot.Mapped));
+                break;
+            default:
+                break;
+        }
+    }
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    struct FrameCaptureStats
+    {
+        u32 Captured { 0 };
+        // Frames a capture wanted but found no free readback buffer for.
+        u32 Dropped { 0 };
+        u32 Encoding { 0 };
+    };
+
+    // Copies rendered frames into host memory and writes them to disk without
+    // stalling the frame.
+    //
+    // RecordReadback() copies an image into the next buffer of a small ring of
+    // host-cached buffers and tags it with the graphics timeline value of the
+    // frame being recorded. Update() picks up the buffers whose frame has
+    // completed a few frames later and hands them to the capture's own worker
+    // threads, which convert and encode straight from the mapped memory; the
+    // buffer returns to the ring once the file is written. When the ring is
+    // empty because encoding falls behind, frames are dropped rather than
+    // waited for.
+    //
+    // 8-bit color targets are written as PNG, float targets as EXR. Used from
+    // the render thread only.
+    class FrameCapture
+    {
+    public:
+        FrameCapture(Renderer& renderer, u32 bufferCount = 6, u32 workerCount = 2);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // The extension of path is replaced with the one matching the captured format.
+        void CaptureFrame(const std::filesystem::path& path);
+        // The next count frames, written to directory/frame_00000.png and on.
+        void CaptureSequence(const std::filesystem::path& directory, u32 count);
+        // Every frame until StopRecording(), numbered like a sequence.
+        void StartRecording(const std::filesystem::path& directory);
+        void StopRecording();
+
+        inline bool IsRecording() const { return m_Recording.has_value(); }
+        // True while a capture still wants frames, i.e. the next readback is used.
+        inline bool IsActive() const { return m_Recording || !m_Requests.empty(); }
+
+        // Records the copy of a frame of image for the recording and for the
+        // oldest pending capture, if there are any. image has to be in
+        // TRANSFER_SRC_OPTIMAL, e.g. read as RenderGraphAccess::TransferSrc by
+        // the calling pass.
+        void RecordReadback(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkExtent2D extent);
+
+        // Hands completed readbacks to the encoders. Call once per frame.
+        void Update();
+
+        // Blocks until every readback already recorded is on disk.
+        void Flush();
+
+        FrameCaptureStats GetStats() const;
+
+        static bool IsFormatSupported(VkFormat format);
+
+    private:
+        enum class SlotState : u8 { Free, Pending, Encoding };
+
+        struct Slot
+        {
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            VkDeviceSize Size { 0 };
+            u8* Mapped { nullptr };
+            bool Coherent { false };
+
+            std::atomic<SlotState> State { SlotState::Free };
+            // Graphics timeline value of the frame that wrote the buffer.
+            u64 Value { 0 };
+
+            VkFormat Format { VK_FORMAT_UNDEFINED };
+            VkExtent2D Extent { 0, 0 };
+            std::filesystem::path Path;
+        };
+
+        struct Request
+        {
+            std::filesystem::path Path;
+            // Single frames use Path as the file name, sequences as a directory.
+            bool Sequence { false };
+            u32 Remaining { 1 };
+            u32 Index { 0 };
+        };
+
+    private:
+        Slot* AcquireSlot(VkDeviceSize size);
+        void AllocateSlot(Slot& slot, VkDeviceSize size);
+        void FreeSlot(Slot& slot);
+
+        // Counts the frame against request, which is done once Remaining reaches 0.
+        std::filesystem::path NextPath(Request& request, VkFormat format);
+
+        void Encode(Slot& slot);
+
+    private:
+        Renderer& m_Renderer;
+        VkDevice m_Device;
+
+        std::vector<Slot> m_Slots;
+        u32 m_NextSlot { 0 };
+
+        // Captures and sequences, served one at a time. The recording runs
+        // alongside them so a capture taken while recording gets its frame.
+        std::deque<Request> m_Requests;
+        std::optional<Request> m_Recording;
+
+        u32 m_Captured { 0 };
+        u32 m_Dropped { 0 };
+        std::atomic<u32> m_Encoding { 0 };
+
+        JobSystem m_Jobs;
+        JobContext m_Context;
+    };
+
+}
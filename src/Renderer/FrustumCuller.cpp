@@ -0,0 +1,428 @@
+#include "FrustumCuller.hpp"
+
+#include <bit>
+#include <cmath>
+#include <algorithm>
+
+#include "Core/JobSystem.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define GRAPHICS_CULLING_X64 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define GRAPHICS_TARGET_AVX2
+    #else
+        #define GRAPHICS_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#else
+    #define GRAPHICS_CULLING_X64 0
+#endif
+
+namespace Graphics {
+
+    static u32 RoundUp(u32 count, u32 multiple)
+    {
+        return (count + multiple - 1) / multiple * multiple;
+    }
+
+    void SphereBoundsArray::Resize(u32 count)
+    {
+        u32 padded = RoundUp(count, s_Lanes);
+
+        m_Count = count;
+        m_CenterX.resize(padded, 0.0f);
+        m_CenterY.resize(padded, 0.0f);
+        m_CenterZ.resize(padded, 0.0f);
+        m_Radius.resize(padded, 0.0f);
+    }
+
+    void SphereBoundsArray::Set(u32 index, const BoundingSphere& sphere)
+    {
+        m_CenterX[index] = sphere.Center.x;
+        m_CenterY[index] = sphere.Center.y;
+        m_CenterZ[index] = sphere.Center.z;
+        m_Radius[index] = sphere.Radius;
+    }
+
+    void BoxBoundsArray::Resize(u32 count)
+    {
+        u32 padded = RoundUp(count, s_Lanes);
+
+        m_Count = count;
+        m_CenterX.resize(padded, 0.0f);
+        m_CenterY.resize(padded, 0.0f);
+        m_CenterZ.resize(padded, 0.0f);
+        m_ExtentX.resize(padded, 0.0f);
+        m_ExtentY.resize(padded, 0.0f);
+        m_ExtentZ.resize(padded, 0.0f);
+    }
+
+    void BoxBoundsArray::Set(u32 index, const AABB& box)
+    {
+        glm::vec3 center = box.Center();
+        glm::vec3 extents = box.Extents();
+
+        m_CenterX[index] = center.x;
+        m_CenterY[index] = center.y;
+        m_CenterZ[index] = center.z;
+        m_ExtentX[index] = extents.x;
+        m_ExtentY[index] = extents.y;
+        m_ExtentZ[index] = extents.z;
+    }
+
+    // Culls [begin, end) and writes survivors to out, returns how many were written.
+    // begin is always a multiple of the lane count.
+    using SphereCullFn = u32 (*)(const Frustum& frustum, const SphereBoundsArray& bounds, u32 begin, u32 end, u32* out);
+    using BoxCullFn = u32 (*)(const Frustum& frustum, const BoxBoundsArray& bounds, u32 begin, u32 end, u32* out);
+
+    // Appends the index of every set bit of mask, lane 0 first.
+    static inline u32 EmitVisible(u32 mask, u32 base, u32* out)
+    {
+        u32 count = 0;
+        while (mask) {
+            out[count++] = base + static_cast<u32>(std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+        return count;
+    }
+
+    static inline u32 TailMask(u32 begin, u32 end, u32 lanes)
+    {
+        u32 remaining = end - begin;
+        return remaining >= lanes ? ~0u : (1u << remaining) - 1;
+    }
+
+    // The scalar paths associate the plane equation the same way the SIMD
+    // paths do, so every path returns identical results on boundary cases.
+    static u32 CullSpheresScalar(const Frustum& frustum, const SphereBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        const f32* cx = bounds.CenterX();
+        const f32* cy = bounds.CenterY();
+        const f32* cz = bounds.CenterZ();
+        const f32* r = bounds.Radius();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; ++i) {
+            bool inside = true;
+            for (const glm::vec4& plane : frustum.Planes)
+                inside &= (plane.x * cx[i] + plane.y * cy[i]) + (plane.z * cz[i] + plane.w) >= -r[i];
+
+            if (inside)
+                out[count++] = i;
+        }
+
+        return count;
+    }
+
+    static u32 CullBoxesScalar(const Frustum& frustum, const BoxBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        const f32* cx = bounds.CenterX();
+        const f32* cy = bounds.CenterY();
+        const f32* cz = bounds.CenterZ();
+        const f32* ex = bounds.ExtentX();
+        const f32* ey = bounds.ExtentY();
+        const f32* ez = bounds.ExtentZ();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; ++i) {
+            bool inside = true;
+            for (const glm::vec4& plane : frustum.Planes) {
+                f32 distance = (plane.x * cx[i] + plane.y * cy[i]) + (plane.z * cz[i] + plane.w);
+                f32 radius = std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i] + std::abs(plane.z) * ez[i];
+                inside &= distance + radius >= 0.0f;
+            }
+
+            if (inside)
+                out[count++] = i;
+        }
+
+        return count;
+    }
+
+#if GRAPHICS_CULLING_X64
+
+    // SSE2 is part of the x86-64 baseline, no runtime check needed.
+    static u32 CullSpheresSSE(const Frustum& frustum, const SphereBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        __m128 px[Frustum::Count], py[Frustum::Count], pz[Frustum::Count], pw[Frustum::Count];
+        for (u32 p = 0; p < Frustum::Count; ++p) {
+            px[p] = _mm_set1_ps(frustum.Planes[p].x);
+            py[p] = _mm_set1_ps(frustum.Planes[p].y);
+            pz[p] = _mm_set1_ps(frustum.Planes[p].z);
+            pw[p] = _mm_set1_ps(frustum.Planes[p].w);
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; i += 4) {
+            __m128 cx = _mm_loadu_ps(bounds.CenterX() + i);
+            __m128 cy = _mm_loadu_ps(bounds.CenterY() + i);
+            __m128 cz = _mm_loadu_ps(bounds.CenterZ() + i);
+            __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(bounds.Radius() + i));
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (u32 p = 0; p < Frustum::Count; ++p) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+            }
+
+            u32 mask = static_cast<u32>(_mm_movemask_ps(inside)) & TailMask(i, end, 4);
+            count += EmitVisible(mask, i, out + count);
+        }
+
+        return count;
+    }
+
+    static u32 CullBoxesSSE(const Frustum& frustum, const BoxBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        __m128 px[Frustum::Count], py[Frustum::Count], pz[Frustum::Count], pw[Frustum::Count];
+        __m128 ax[Frustum::Count], ay[Frustum::Count], az[Frustum::Count];
+        for (u32 p = 0; p < Frustum::Count; ++p) {
+            const glm::vec4& plane = frustum.Planes[p];
+            px[p] = _mm_set1_ps(plane.x);
+            py[p] = _mm_set1_ps(plane.y);
+            pz[p] = _mm_set1_ps(plane.z);
+            pw[p] = _mm_set1_ps(plane.w);
+            ax[p] = _mm_set1_ps(std::abs(plane.x));
+            ay[p] = _mm_set1_ps(std::abs(plane.y));
+            az[p] = _mm_set1_ps(std::abs(plane.z));
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; i += 4) {
+            __m128 cx = _mm_loadu_ps(bounds.CenterX() + i);
+            __m128 cy = _mm_loadu_ps(bounds.CenterY() + i);
+            __m128 cz = _mm_loadu_ps(bounds.CenterZ() + i);
+            __m128 ex = _mm_loadu_ps(bounds.ExtentX() + i);
+            __m128 ey = _mm_loadu_ps(bounds.ExtentY() + i);
+            __m128 ez = _mm_loadu_ps(bounds.ExtentZ() + i);
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (u32 p = 0; p < Frustum::Count; ++p) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+                __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+            }
+
+            u32 mask = static_cast<u32>(_mm_movemask_ps(inside)) & TailMask(i, end, 4);
+            count += EmitVisible(mask, i, out + count);
+        }
+
+        return count;
+    }
+
+    GRAPHICS_TARGET_AVX2
+    static u32 CullSpheresAVX2(const Frustum& frustum, const SphereBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        __m256 px[Frustum::Count], py[Frustum::Count], pz[Frustum::Count], pw[Frustum::Count];
+        for (u32 p = 0; p < Frustum::Count; ++p) {
+            px[p] = _mm256_set1_ps(frustum.Planes[p].x);
+            py[p] = _mm256_set1_ps(frustum.Planes[p].y);
+            pz[p] = _mm256_set1_ps(frustum.Planes[p].z);
+            pw[p] = _mm256_set1_ps(frustum.Planes[p].w);
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; i += 8) {
+            __m256 cx = _mm256_loadu_ps(bounds.CenterX() + i);
+            __m256 cy = _mm256_loadu_ps(bounds.CenterY() + i);
+            __m256 cz = _mm256_loadu_ps(bounds.CenterZ() + i);
+            __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(bounds.Radius() + i));
+
+            __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+            for (u32 p = 0; p < Frustum::Count; ++p) {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)), _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+            }
+
+            u32 mask = static_cast<u32>(_mm256_movemask_ps(inside)) & TailMask(i, end, 8);
+            count += EmitVisible(mask, i, out + count);
+        }
+
+        return count;
+    }
+
+    GRAPHICS_TARGET_AVX2
+    static u32 CullBoxesAVX2(const Frustum& frustum, const BoxBoundsArray& bounds, u32 begin, u32 end, u32* out)
+    {
+        __m256 px[Frustum::Count], py[Frustum::Count], pz[Frustum::Count], pw[Frustum::Count];
+        __m256 ax[Frustum::Count], ay[Frustum::Count], az[Frustum::Count];
+        for (u32 p = 0; p < Frustum::Count; ++p) {
+            const glm::vec4& plane = frustum.Planes[p];
+            px[p] = _mm256_set1_ps(plane.x);
+            py[p] = _mm256_set1_ps(plane.y);
+            pz[p] = _mm256_set1_ps(plane.z);
+            pw[p] = _mm256_set1_ps(plane.w);
+            ax[p] = _mm256_set1_ps(std::abs(plane.x));
+            ay[p] = _mm256_set1_ps(std::abs(plane.y));
+            az[p] = _mm256_set1_ps(std::abs(plane.z));
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+
+        u32 count = 0;
+        for (u32 i = begin; i < end; i += 8) {
+            __m256 cx = _mm256_loadu_ps(bounds.CenterX() + i);
+            __m256 cy = _mm256_loadu_ps(bounds.CenterY() + i);
+            __m256 cz = _mm256_loadu_ps(bounds.CenterZ() + i);
+            __m256 ex = _mm256_loadu_ps(bounds.ExtentX() + i);
+            __m256 ey = _mm256_loadu_ps(bounds.ExtentY() + i);
+            __m256 ez = _mm256_loadu_ps(bounds.ExtentZ() + i);
+
+            __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+            for (u32 p = 0; p < Frustum::Count; ++p) {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)), _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+                __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+            }
+
+            u32 mask = static_cast<u32>(_mm256_movemask_ps(inside)) & TailMask(i, end, 8);
+            count += EmitVisible(mask, i, out + count);
+        }
+
+        return count;
+    }
+
+#endif
+
+    static SphereCullFn GetCullFunction(CullingPath path, const SphereBoundsArray&)
+    {
+#if GRAPHICS_CULLING_X64
+        switch (path) {
+            case CullingPath::AVX2: return CullSpheresAVX2;
+            case CullingPath::SSE: return CullSpheresSSE;
+            default: break;
+        }
+#else
+        (void)path;
+#endif
+        return CullSpheresScalar;
+    }
+
+    static BoxCullFn GetCullFunction(CullingPath path, const BoxBoundsArray&)
+    {
+#if GRAPHICS_CULLING_X64
+        switch (path) {
+            case CullingPath::AVX2: return CullBoxesAVX2;
+            case CullingPath::SSE: return CullBoxesSSE;
+            default: break;
+        }
+#else
+        (void)path;
+#endif
+        return CullBoxesScalar;
+    }
+
+    static bool SupportsAVX2()
+    {
+#if GRAPHICS_CULLING_X64
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // AVX state must be enabled by the OS, not only reported by the CPU.
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+#else
+        return false;
+#endif
+    }
+
+    FrustumCuller::FrustumCuller(JobSystem* jobs)
+        : m_Jobs(jobs), m_Path(GetBestPath())
+    {
+    }
+
+    void FrustumCuller::SetPath(CullingPath path)
+    {
+        m_Path = std::min(path, GetBestPath());
+    }
+
+    CullingPath FrustumCuller::GetBestPath()
+    {
+#if GRAPHICS_CULLING_X64
+        static const CullingPath s_BestPath = SupportsAVX2() ? CullingPath::AVX2 : CullingPath::SSE;
+        return s_BestPath;
+#else
+        return CullingPath::Scalar;
+#endif
+    }
+
+    const char* FrustumCuller::GetPathName(CullingPath path)
+    {
+        switch (path) {
+            case CullingPath::Scalar: return "Scalar";
+            case CullingPath::SSE: return "SSE";
+            case CullingPath::AVX2: return "AVX2";
+        }
+        return "Unknown";
+    }
+
+    u32 FrustumCuller::Cull(const Frustum& frustum, const SphereBoundsArray& bounds, std::vector<u32>& visible)
+    {
+        return CullBlocks(frustum, bounds, visible);
+    }
+
+    u32 FrustumCuller::Cull(const Frustum& frustum, const BoxBoundsArray& bounds, std::vector<u32>& visible)
+    {
+        return CullBlocks(frustum, bounds, visible);
+    }
+
+    template<typename Bounds>
+    u32 FrustumCuller::CullBlocks(const Frustum& frustum, const Bounds& bounds, std::vector<u32>& visible)
+    {
+        auto cull = GetCullFunction(m_Path, bounds);
+        u32 count = bounds.Size();
+
+        visible.clear();
+
+        // Blocks write into disjoint ranges of the scratch buffer, survivors
+        // are then appended in block order so the result stays sorted.
+        if (m_Scratch.size() < count)
+            m_Scratch.resize(count);
+
+        if (m_Jobs == nullptr || count < s_ParallelThreshold) {
+            u32 visibleCount = cull(frustum, bounds, 0, count, m_Scratch.data());
+            visible.assign(m_Scratch.begin(), m_Scratch.begin() + visibleCount);
+            return visibleCount;
+        }
+
+        u32 blockCount = (count + s_BlockSize - 1) / s_BlockSize;
+        m_BlockCounts.resize(blockCount);
+
+        JobContext context;
+        m_Jobs->Dispatch(context, blockCount, 1, [&](u32 first, u32 last) {
+            for (u32 block = first; block < last; ++block) {
+                u32 begin = block * s_BlockSize;
+                u32 end = std::min(begin + s_BlockSize, count);
+                m_BlockCounts[block] = cull(frustum, bounds, begin, end, m_Scratch.data() + begin);
+            }
+        });
+        m_Jobs->Wait(context);
+
+        for (u32 block = 0; block < blockCount; ++block) {
+            auto first = m_Scratch.begin() + block * s_BlockSize;
+            visible.insert(visible.end(), first, first + m_BlockCounts[block]);
+        }
+
+        return static_cast<u32>(visible.size());
+    }
+
+}
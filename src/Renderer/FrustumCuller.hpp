@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Frustum.hpp"
+
+namespace Graphics {
+
+    class JobSystem;
+
+    // Bounding spheres packed as structure-of-arrays. Storage is padded to
+    // s_Lanes so the SIMD paths never need a scalar tail loop.
+    class SphereBoundsArray
+    {
+    public:
+        void Resize(u32 count);
+        void Set(u32 index, const BoundingSphere& sphere);
+
+        inline u32 Size() const { return m_Count; }
+
+        inline const f32* CenterX() const { return m_CenterX.data(); }
+        inline const f32* CenterY() const { return m_CenterY.data(); }
+        inline const f32* CenterZ() const { return m_CenterZ.data(); }
+        inline const f32* Radius() const { return m_Radius.data(); }
+
+    public:
+        inline static constexpr u32 s_Lanes { 8 };
+
+    private:
+        u32 m_Count { 0 };
+        std::vector<f32> m_CenterX;
+        std::vector<f32> m_CenterY;
+        std::vector<f32> m_CenterZ;
+        std::vector<f32> m_Radius;
+    };
+
+    // Axis-aligned boxes packed as center/extents columns.
+    class BoxBoundsArray
+    {
+    public:
+        void Resize(u32 count);
+        void Set(u32 index, const AABB& box);
+
+        inline u32 Size() const { return m_Count; }
+
+        inline const f32* CenterX() const { return m_CenterX.data(); }
+        inline const f32* CenterY() const { return m_CenterY.data(); }
+        inline const f32* CenterZ() const { return m_CenterZ.data(); }
+        inline const f32* ExtentX() const { return m_ExtentX.data(); }
+        inline const f32* ExtentY() const { return m_ExtentY.data(); }
+        inline const f32* ExtentZ() const { return m_ExtentZ.data(); }
+
+    public:
+        inline static constexpr u32 s_Lanes { 8 };
+
+    private:
+        u32 m_Count { 0 };
+        std::vector<f32> m_CenterX;
+        std::vector<f32> m_CenterY;
+        std::vector<f32> m_CenterZ;
+        std::vector<f32> m_ExtentX;
+        std::vector<f32> m_ExtentY;
+        std::vector<f32> m_ExtentZ;
+    };
+
+    enum class CullingPath : u8
+    {
+        Scalar,
+        SSE,
+        AVX2
+    };
+
+    // Tests packed bounds against the six frustum planes, four (SSE) or eight
+    // (AVX2) objects at a time, and writes the indices of the survivors in
+    // ascending order. The widest path supported by the CPU is picked at
+    // runtime. Large inputs are split into blocks that are culled on the job
+    // system and compacted afterwards.
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller(JobSystem* jobs = nullptr);
+
+        // Requests a path, falls back to the widest supported one below it.
+        void SetPath(CullingPath path);
+        inline CullingPath GetPath() const { return m_Path; }
+
+        inline void SetJobSystem(JobSystem* jobs) { m_Jobs = jobs; }
+
+        // Not thread-safe, the culler reuses its scratch buffers between calls.
+        // Replaces visible with the indices of the objects inside the frustum and returns their count.
+        u32 Cull(const Frustum& frustum, const SphereBoundsArray& bounds, std::vector<u32>& visible);
+        u32 Cull(const Frustum& frustum, const BoxBoundsArray& bounds, std::vector<u32>& visible);
+
+        static CullingPath GetBestPath();
+        static const char* GetPathName(CullingPath path);
+
+    public:
+        inline static constexpr u32 s_BlockSize { 16384 };
+        inline static constexpr u32 s_ParallelThreshold { 2 * s_BlockSize };
+
+    private:
+        template<typename Bounds>
+        u32 CullBlocks(const Frustum& frustum, const Bounds& bounds, std::vector<u32>& visible);
+
+    private:
+        JobSystem* m_Jobs;
+        CullingPath m_Path;
+
+        std::vector<u32> m_Scratch;
+        std::vector<u32> m_BlockCounts;
+    };
+
+}
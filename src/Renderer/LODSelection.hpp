@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "Math/Bounds.hpp"
+#include "MeshData.hpp"
+
+namespace Graphics {
+
+    struct LODSelectionSettings
+    {
+        // Largest accepted simplification error on screen, in pixels.
+        f32 PixelError { 1.0f };
+        // Relative band around PixelError in which the current level is kept, so
+        // objects hovering at a threshold distance do not flip every frame.
+        f32 Hysteresis { 0.25f };
+    };
+
+    // Projected diameter of a world space sphere in pixels. projectionScale is
+    // projection[1][1] (cot(fovY / 2)), a camera inside the sphere yields infinity.
+    inline f32 ComputeScreenSize(const BoundingSphere& sphere, const glm::vec3& cameraPosition, f32 projectionScale, f32 viewportHeight)
+    {
+        f32 distance = glm::length(sphere.Center - cameraPosition);
+        if (distance <= sphere.Radius)
+            return std::numeric_limits<f32>::infinity();
+
+        return sphere.Radius * projectionScale * viewportHeight / distance;
+    }
+
+    // Picks the coarsest level whose error stays below settings.PixelError when
+    // the mesh covers screenSize pixels. LOD errors are object space and are
+    // scaled by radius, the object space bounding radius of the mesh, so the
+    // result does not depend on the instance scale. current is the level used
+    // last frame: moving to a finer level happens once the current error exceeds
+    // the tolerance by the hysteresis band, moving to a coarser one only once it
+    // is below the tolerance by the same band.
+    inline u32 SelectLOD(std::span<const MeshLOD> lods, f32 radius, f32 screenSize, u32 current, const LODSelectionSettings& settings = {})
+    {
+        if (lods.empty() || radius <= 0.0f)
+            return 0;
+
+        // Pixels per object space unit.
+        f32 scale = screenSize * 0.5f / radius;
+
+        f32 refine = settings.PixelError * (1.0f + settings.Hysteresis);
+        f32 coarsen = settings.PixelError * (1.0f - settings.Hysteresis);
+
+        u32 lod = std::min(current, static_cast<u32>(lods.size()) - 1);
+
+        while (lod > 0 && lods[lod].Error * scale > refine)
+            lod--;
+
+        while (lod + 1 < lods.size() && lods[lod + 1].Error * scale <= coarsen)
+            lod++;
+
+        return lod;
+    }
+
+}
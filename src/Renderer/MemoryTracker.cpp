@@ -0,0 +1,371 @@
+#include "MemoryTracker.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "Vulkan.hpp"
+
+namespace Graphics {
+
+    // Without VK_EXT_memory_budget assume the process may use most of each
+    // heap, the rest is left to the system and other applications.
+    static constexpr VkDeviceSize s_EstimatedBudgetPercent = 80;
+
+    static const char* s_Untagged = "Untagged";
+
+    const char* ToString(MemoryCategory category)
+    {
+        switch (category) {
+            case MemoryCategory::Buffer: return "Buffer";
+            case MemoryCategory::Image: return "Image";
+            case MemoryCategory::Staging: return "Staging";
+            case MemoryCategory::Readback: return "Readback";
+            case MemoryCategory::RenderTarget: return "RenderTarget";
+            default: return "Unknown";
+        }
+    }
+
+    static f64 ToMegabytes(VkDeviceSize bytes)
+    {
+        return static_cast<f64>(bytes) / (1024.0 * 1024.0);
+    }
+
+    MemoryTracker::MemoryTracker(VkDevice device, VkPhysicalDevice physicalDevice, bool budgetExtension)
+        : m_Device(device), m_PhysicalDevice(physicalDevice), m_BudgetSupported(budgetExtension)
+    {
+        vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_Properties);
+        m_Heaps.resize(m_Properties.memoryHeapCount);
+
+        std::lock_guard lock(m_Mutex);
+        QueryBudget();
+
+        for (u32 i = 0; i < m_Properties.memoryHeapCount; ++i) {
+            LOG_INFO("Memory heap {}: {:.0f} MB, budget {:.0f} MB{}", i, ToMegabytes(m_Properties.memoryHeaps[i].size),
+                ToMegabytes(m_Heaps[i].Budget), (m_Properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? ", device local" : "");
+        }
+    }
+
+    MemoryTracker::~MemoryTracker()
+    {
+        // Anything left was never freed by its owner.
+        for (const auto& [owner, usage] : m_Owners) {
+            if (usage.Allocations > 0)
+                LOG_WARN("{} leaked {} allocations, {:.2f} MB", owner, usage.Allocations, ToMegabytes(usage.Bytes));
+        }
+    }
+
+    VkResult MemoryTracker::Allocate(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, const char* owner, VkDeviceMemory& memory)
+    {
+        memory = VK_NULL_HANDLE;
+
+        if (allocInfo.memoryTypeIndex >= m_Properties.memoryTypeCount) {
+            LOG_ERROR("{} requested memory of a type the device does not have", owner ? owner : s_Untagged);
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        VkResult result = vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory);
+        if (result != VK_SUCCESS) {
+            LOG_ERROR("Allocating {:.2f} MB for {} failed", ToMegabytes(allocInfo.allocationSize), owner ? owner : s_Untagged);
+            return result;
+        }
+
+        std::lock_guard lock(m_Mutex);
+
+        u32 heapIndex = m_Properties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex;
+        Allocation& allocation = m_Allocations[memory];
+        allocation.Size = allocInfo.allocationSize;
+        allocation.HeapIndex = heapIndex;
+        allocation.Category = category;
+        allocation.Owner = owner ? owner : s_Untagged;
+
+        Heap& heap = m_Heaps[heapIndex];
+        heap.Tracked.Bytes += allocation.Size;
+        heap.Tracked.Allocations++;
+        heap.PeakTracked = std::max(heap.PeakTracked, heap.Tracked.Bytes);
+
+        MemoryUsage& categoryUsage = m_Categories[static_cast<usize>(category)];
+        categoryUsage.Bytes += allocation.Size;
+        categoryUsage.Allocations++;
+
+        MemoryUsage& ownerUsage = m_Owners[allocation.Owner];
+        ownerUsage.Bytes += allocation.Size;
+        ownerUsage.Allocations++;
+
+        // Logged once when the heap crosses its budget, Update() evicts.
+        bool over = GetUsage(heapIndex) > heap.Budget;
+        if (over && !heap.OverBudget)
+            LOG_WARN("Memory heap {} is over budget: {:.0f} of {:.0f} MB after {} allocated {:.2f} MB", heapIndex,
+                ToMegabytes(GetUsage(heapIndex)), ToMegabytes(heap.Budget), allocation.Owner, ToMegabytes(allocation.Size));
+        heap.OverBudget = over;
+
+        return VK_SUCCESS;
+    }
+
+    void MemoryTracker::Free(VkDeviceMemory memory)
+    {
+        if (memory == VK_NULL_HANDLE)
+            return;
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            auto it = m_Allocations.find(memory);
+            if (it != m_Allocations.end()) {
+                const Allocation& allocation = it->second;
+
+                Heap& heap = m_Heaps[allocation.HeapIndex];
+                heap.Tracked.Bytes -= allocation.Size;
+                heap.Tracked.Allocations--;
+
+                MemoryUsage& categoryUsage = m_Categories[static_cast<usize>(allocation.Category)];
+                categoryUsage.Bytes -= allocation.Size;
+                categoryUsage.Allocations--;
+
+                MemoryUsage& ownerUsage = m_Owners[allocation.Owner];
+                ownerUsage.Bytes -= allocation.Size;
+                ownerUsage.Allocations--;
+
+                m_Allocations.erase(it);
+            } else {
+                LOG_WARN("Freeing memory the tracker did not allocate");
+            }
+        }
+
+        vkFreeMemory(m_Device, memory, nullptr);
+    }
+
+    u32 MemoryTracker::FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        std::lock_guard lock(m_Mutex);
+
+        u32 fallback = UINT32_MAX;
+
+        for (u32 i = 0; i < m_Properties.memoryTypeCount; ++i) {
+            if (!(typeFilter & (1 << i)) || (m_Properties.memoryTypes[i].propertyFlags & properties) != properties)
+                continue;
+
+            u32 heapIndex = m_Properties.memoryTypes[i].heapIndex;
+            if (GetUsage(heapIndex) < m_Heaps[heapIndex].Budget)
+                return i;
+
+            if (fallback == UINT32_MAX)
+                fallback = i;
+        }
+
+        return fallback;
+    }
+
+    void MemoryTracker::Update()
+    {
+        std::vector<MemoryPressure> pressures;
+        std::vector<bool> newPressure;
+        std::vector<EvictionFn> callbacks;
+
+        {
+            std::lock_guard lock(m_Mutex);
+            QueryBudget();
+
+            for (u32 i = 0; i < static_cast<u32>(m_Heaps.size()); ++i) {
+                VkDeviceSize usage = GetUsage(i);
+                VkDeviceSize threshold = static_cast<VkDeviceSize>(static_cast<f64>(m_Heaps[i].Budget) * m_EvictionThreshold);
+
+                m_Heaps[i].OverBudget = usage > m_Heaps[i].Budget;
+
+                if (usage > threshold) {
+                    pressures.push_back({ i, usage, m_Heaps[i].Budget, usage - threshold });
+                    newPressure.push_back(!m_Heaps[i].UnderPressure);
+                }
+
+                m_Heaps[i].UnderPressure = usage > threshold;
+            }
+
+            if (pressures.empty() || m_EvictionCallbacks.empty())
+                return;
+
+            for (const auto& [id, callback] : m_EvictionCallbacks)
+                callbacks.push_back(callback);
+        }
+
+        // Callbacks free through Free(), so the lock is not held while they run.
+        for (usize i = 0; i < pressures.size(); ++i) {
+            MemoryPressure& pressure = pressures[i];
+
+            for (const EvictionFn& callback : callbacks) {
+                callback(pressure);
+
+                std::lock_guard lock(m_Mutex);
+                VkDeviceSize usage = GetUsage(pressure.HeapIndex);
+                VkDeviceSize threshold = static_cast<VkDeviceSize>(static_cast<f64>(pressure.Budget) * m_EvictionThreshold);
+
+                if (usage <= threshold) {
+                    pressure.Excess = 0;
+                    break;
+                }
+
+                pressure.Usage = usage;
+                pressure.Excess = usage - threshold;
+            }
+
+            // Logged when the pressure starts, not on every frame it lasts.
+            if (pressure.Excess > 0 && newPressure[i])
+                LOG_WARN("Memory heap {} stays {:.2f} MB over its eviction threshold after eviction", pressure.HeapIndex, ToMegabytes(pressure.Excess));
+        }
+    }
+
+    u32 MemoryTracker::AddEvictionCallback(EvictionFn callback)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        u32 id = m_NextCallbackId++;
+        m_EvictionCallbacks.emplace_back(id, std::move(callback));
+        return id;
+    }
+
+    void MemoryTracker::RemoveEvictionCallback(u32 id)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        std::erase_if(m_EvictionCallbacks, [id](const auto& entry) { return entry.first == id; });
+    }
+
+    MemoryStats MemoryTracker::GetStats() const
+    {
+        std::lock_guard lock(m_Mutex);
+
+        MemoryStats stats;
+        stats.BudgetSupported = m_BudgetSupported;
+        stats.Categories = m_Categories;
+
+        for (u32 i = 0; i < static_cast<u32>(m_Heaps.size()); ++i) {
+            const Heap& heap = m_Heaps[i];
+
+            MemoryHeapStats heapStats;
+            heapStats.Size = m_Properties.memoryHeaps[i].size;
+            heapStats.Budget = heap.Budget;
+            heapStats.Usage = GetUsage(i);
+            heapStats.Tracked = heap.Tracked;
+            heapStats.PeakTracked = heap.PeakTracked;
+            heapStats.DeviceLocal = (m_Properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            stats.Heaps.push_back(heapStats);
+
+            stats.Total.Bytes += heap.Tracked.Bytes;
+            stats.Total.Allocations += heap.Tracked.Allocations;
+        }
+
+        // Owners that freed everything they had are left out.
+        for (const auto& [owner, usage] : m_Owners) {
+            if (usage.Allocations > 0)
+                stats.Owners[owner] = usage;
+        }
+
+        return stats;
+    }
+
+    std::string MemoryTracker::GetStatsJson() const
+    {
+        MemoryStats stats = GetStats();
+
+        auto usage = [](std::ostream& out, const MemoryUsage& usage) {
+            out << "{ \"bytes\": " << usage.Bytes << ", \"allocations\": " << usage.Allocations << " }";
+        };
+
+        std::ostringstream out;
+        out << "{\n";
+        out << "  \"budget_supported\": " << (stats.BudgetSupported ? "true" : "false") << ",\n";
+        out << "  \"total\": ";
+        usage(out, stats.Total);
+        out << ",\n";
+
+        out << "  \"heaps\": [\n";
+        for (usize i = 0; i < stats.Heaps.size(); ++i) {
+            const MemoryHeapStats& heap = stats.Heaps[i];
+
+            out << "    { \"index\": " << i
+                << ", \"device_local\": " << (heap.DeviceLocal ? "true" : "false")
+                << ", \"size\": " << heap.Size
+                << ", \"budget\": " << heap.Budget
+                << ", \"usage\": " << heap.Usage
+                << ", \"tracked\": ";
+            usage(out, heap.Tracked);
+            out << ", \"peak_tracked\": " << heap.PeakTracked << " }" << (i + 1 < stats.Heaps.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n";
+
+        out << "  \"categories\": {\n";
+        for (usize i = 0; i < stats.Categories.size(); ++i) {
+            out << "    \"" << ToString(static_cast<MemoryCategory>(i)) << "\": ";
+            usage(out, stats.Categories[i]);
+            out << (i + 1 < stats.Categories.size() ? "," : "") << "\n";
+        }
+        out << "  },\n";
+
+        // Owner tags are identifiers chosen in code, they need no escaping.
+        out << "  \"owners\": {\n";
+        usize index = 0;
+        for (const auto& [owner, ownerUsage] : stats.Owners) {
+            out << "    \"" << owner << "\": ";
+            usage(out, ownerUsage);
+            out << (++index < stats.Owners.size() ? "," : "") << "\n";
+        }
+        out << "  }\n";
+        out << "}\n";
+
+        return out.str();
+    }
+
+    bool MemoryTracker::DumpStats(const std::filesystem::path& path) const
+    {
+        std::error_code error;
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path(), error);
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            LOG_ERROR("Failed to open {}", path.string());
+            return false;
+        }
+
+        file << GetStatsJson();
+        return static_cast<bool>(file);
+    }
+
+    void MemoryTracker::QueryBudget()
+    {
+        if (m_BudgetSupported) {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+            VkPhysicalDeviceMemoryProperties2 properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+            properties.pNext = &budget;
+
+            vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &properties);
+
+            for (u32 i = 0; i < static_cast<u32>(m_Heaps.size()); ++i) {
+                Heap& heap = m_Heaps[i];
+                heap.QueriedUsage = budget.heapUsage[i];
+                heap.QueriedTracked = heap.Tracked.Bytes;
+
+                // Some drivers report 0 for heaps they do not track.
+                heap.Budget = budget.heapBudget[i] > 0 ? std::min(budget.heapBudget[i], m_Properties.memoryHeaps[i].size) : m_Properties.memoryHeaps[i].size * s_EstimatedBudgetPercent / 100;
+            }
+        } else {
+            for (u32 i = 0; i < static_cast<u32>(m_Heaps.size()); ++i) {
+                Heap& heap = m_Heaps[i];
+                heap.QueriedUsage = heap.Tracked.Bytes;
+                heap.QueriedTracked = heap.Tracked.Bytes;
+                heap.Budget = m_Properties.memoryHeaps[i].size * s_EstimatedBudgetPercent / 100;
+            }
+        }
+    }
+
+    VkDeviceSize MemoryTracker::GetUsage(u32 heapIndex) const
+    {
+        const Heap& heap = m_Heaps[heapIndex];
+
+        // The driver's usage is only as recent as the last query.
+        if (heap.Tracked.Bytes >= heap.QueriedTracked)
+            return heap.QueriedUsage + (heap.Tracked.Bytes - heap.QueriedTracked);
+
+        VkDeviceSize freed = heap.QueriedTracked - heap.Tracked.Bytes;
+        return heap.QueriedUsage - std::min(heap.QueriedUsage, freed);
+    }
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    enum class MemoryCategory : u8
+    {
+        Buffer,
+        Image,
+        // Host visible source of a copy, freed once the copy has completed.
+        Staging,
+        // Host visible destination of a copy, e.g. frame captures.
+        Readback,
+        // Attachments and other images owned by the render graph or the swapchain.
+        RenderTarget,
+        Count
+    };
+
+    const char* ToString(MemoryCategory category);
+
+    struct MemoryUsage
+    {
+        VkDeviceSize Bytes { 0 };
+        u32 Allocations { 0 };
+    };
+
+    struct MemoryHeapStats
+    {
+        VkDeviceSize Size { 0 };
+        // What the process may use without hurting itself or other processes.
+        // Without VK_EXT_memory_budget it is estimated from the heap size.
+        VkDeviceSize Budget { 0 };
+        // The driver's view of the process' use of the heap, or the tracked
+        // allocations without the extension.
+        VkDeviceSize Usage { 0 };
+        // Allocated through the tracker.
+        MemoryUsage Tracked;
+        VkDeviceSize PeakTracked { 0 };
+        bool DeviceLocal { false };
+    };
+
+    struct MemoryStats
+    {
+        bool BudgetSupported { false };
+        std::vector<MemoryHeapStats> Heaps;
+        std::array<MemoryUsage, static_cast<usize>(MemoryCategory::Count)> Categories {};
+        std::map<std::string, MemoryUsage> Owners;
+        MemoryUsage Total;
+    };
+
+    // Handed to eviction callbacks when a heap runs over its budget.
+    struct MemoryPressure
+    {
+        u32 HeapIndex;
+        VkDeviceSize Usage;
+        VkDeviceSize Budget;
+        // Usage above the eviction threshold of the budget.
+        VkDeviceSize Excess;
+    };
+
+    // Every device allocation goes through the tracker, which accounts it per
+    // heap, category and owner tag (e.g. "Mesh", "RenderGraph") and keeps the
+    // per-heap budget from VK_EXT_memory_budget.
+    //
+    // Update() refreshes the budget once per frame. When a heap's usage is
+    // above the eviction threshold, the eviction callbacks are called in the
+    // order they were added until it is back under; they free whatever the GPU
+    // no longer needs (trimmed pools, cached resources). Callbacks run from
+    // Update() only, at the start of a frame, never from inside an allocation,
+    // so they may free anything whose last use has completed.
+    //
+    // Allocate and Free may be called from several threads.
+    class MemoryTracker
+    {
+    public:
+        using EvictionFn = std::function<void(const MemoryPressure& pressure)>;
+
+    public:
+        MemoryTracker(VkDevice device, VkPhysicalDevice physicalDevice, bool budgetExtension);
+        ~MemoryTracker();
+
+        MemoryTracker(const MemoryTracker&) = delete;
+        MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+        // owner is stored as a tag, nullptr counts as "Untagged".
+        VkResult Allocate(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, const char* owner, VkDeviceMemory& memory);
+        void Free(VkDeviceMemory memory);
+
+        // The first type with the properties whose heap is under budget, or the
+        // first type with the properties if every heap is full. UINT32_MAX if none has them.
+        u32 FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties) const;
+
+        void Update();
+
+        // Returns an id for RemoveEvictionCallback().
+        u32 AddEvictionCallback(EvictionFn callback);
+        void RemoveEvictionCallback(u32 id);
+
+        // Fraction of the budget above which eviction starts.
+        inline void SetEvictionThreshold(f32 fraction) { m_EvictionThreshold = fraction; }
+        inline f32 GetEvictionThreshold() const { return m_EvictionThreshold; }
+
+        inline bool IsBudgetSupported() const { return m_BudgetSupported; }
+
+        MemoryStats GetStats() const;
+
+        // Stats as JSON, sizes in bytes.
+        std::string GetStatsJson() const;
+        bool DumpStats(const std::filesystem::path& path) const;
+
+    private:
+        struct Allocation
+        {
+            VkDeviceSize Size;
+            u32 HeapIndex;
+            MemoryCategory Category;
+            std::string Owner;
+        };
+
+        struct Heap
+        {
+            VkDeviceSize Budget { 0 };
+            // Usage reported at the last budget query and how much the tracker
+            // had allocated then, later allocations are added to the estimate.
+            VkDeviceSize QueriedUsage { 0 };
+            VkDeviceSize QueriedTracked { 0 };
+
+            MemoryUsage Tracked;
+            VkDeviceSize PeakTracked { 0 };
+            bool OverBudget { false };
+            // Above the eviction threshold at the last Update().
+            bool UnderPressure { false };
+        };
+
+    private:
+        // Expect m_Mutex to be held.
+        void QueryBudget();
+        VkDeviceSize GetUsage(u32 heapIndex) const;
+
+    private:
+        VkDevice m_Device;
+        VkPhysicalDevice m_PhysicalDevice;
+        VkPhysicalDeviceMemoryProperties m_Properties;
+        bool m_BudgetSupported;
+
+        f32 m_EvictionThreshold { 0.95f };
+
+        mutable std::mutex m_Mutex;
+        std::unordered_map<VkDeviceMemory, Allocation> m_Allocations;
+        std::vector<Heap> m_Heaps;
+        std::array<MemoryUsage, static_cast<usize>(MemoryCategory::Count)> m_Categories {};
+        std::map<std::string, MemoryUsage> m_Owners;
+
+        std::vector<std::pair<u32, EvictionFn>> m_EvictionCallbacks;
+        u32 m_NextCallbackId { 0 };
+    };
+
+}
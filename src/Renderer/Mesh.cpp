@@ -0,0 +1,53 @@
+#include "Mesh.hpp"
+
+#include <cstring>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+
+namespace Graphics {
+
+    Mesh::Mesh(Renderer& renderer, const MeshData& data)
+        : m_Renderer(renderer), m_LODs(data.LODs), m_Bounds(data.Bounds)
+    {
+        // Meshes built by hand without GenerateLODs still get their single level.
+        if (m_LODs.empty())
+            m_LODs.push_back({ 0, static_cast<u32>(data.Indices.size()), 0.0f });
+
+        Upload(data.Vertices.data(), sizeof(MeshVertex) * data.Vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_VertexBuffer, m_VertexBufferMemory);
+        Upload(data.Indices.data(), sizeof(u32) * data.Indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_IndexBuffer, m_IndexBufferMemory);
+    }
+
+    Mesh::~Mesh()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        vkDestroyBuffer(device, m_IndexBuffer, nullptr);
+        m_Renderer.FreeMemory(m_IndexBufferMemory);
+
+        vkDestroyBuffer(device, m_VertexBuffer, nullptr);
+        m_Renderer.FreeMemory(m_VertexBufferMemory);
+    }
+
+    void Mesh::Upload(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& memory)
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        m_Renderer.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Mesh");
+
+        void* mapped;
+        vkMapMemory(device, stagingBufferMemory, 0, size, 0, &mapped);
+        memcpy(mapped, data, size);
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        m_Renderer.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory, "Mesh");
+
+        m_Renderer.CopyBuffer(stagingBuffer, buffer, size);
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        m_Renderer.FreeMemory(stagingBufferMemory);
+    }
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "VertexLayout.hpp"
+#include "MeshData.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    // GPU copy of a MeshData. One vertex buffer is shared by every LOD, the
+    // index buffer holds the index ranges of all levels back to back.
+    class Mesh
+    {
+    public:
+        Mesh(Renderer& renderer, const MeshData& data);
+        ~Mesh();
+
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
+        inline VkBuffer GetVertexBuffer() const { return m_VertexBuffer; }
+        inline VkBuffer GetIndexBuffer() const { return m_IndexBuffer; }
+
+        inline std::span<const MeshLOD> GetLODs() const { return m_LODs; }
+        inline u32 GetLODCount() const { return static_cast<u32>(m_LODs.size()); }
+        inline u32 GetTriangleCount(u32 lod = 0) const { return m_LODs[lod].IndexCount / 3; }
+
+        inline const BoundingSphere& GetBounds() const { return m_Bounds; }
+
+        static constexpr auto GetVertexLayout()
+        {
+            return MakeVertexLayout<MeshVertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                VERTEX_ATTRIBUTE(MeshVertex, Position),
+                VERTEX_ATTRIBUTE(MeshVertex, Normal)
+            );
+        }
+
+    private:
+        void Upload(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& memory);
+
+    private:
+        Renderer& m_Renderer;
+
+        VkBuffer m_VertexBuffer { VK_NULL_HANDLE };
+        VkDeviceMemory m_VertexBufferMemory { VK_NULL_HANDLE };
+
+        VkBuffer m_IndexBuffer { VK_NULL_HANDLE };
+        VkDeviceMemory m_IndexBufferMemory { VK_NULL_HANDLE };
+
+        std::vector<MeshLOD> m_LODs;
+        BoundingSphere m_Bounds;
+    };
+
+}
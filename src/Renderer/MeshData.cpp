@@ -0,0 +1,232 @@
+#include "MeshData.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "Core/Log.hpp"
+
+namespace Graphics {
+
+    void MeshData::GenerateLODs(const MeshLODSettings& settings)
+    {
+        if (Vertices.empty() || Indices.empty())
+            return;
+
+        u32 baseCount = LODs.empty() ? static_cast<u32>(Indices.size()) : LODs[0].IndexCount;
+        u32 baseOffset = LODs.empty() ? 0 : LODs[0].FirstIndex;
+
+        MeshSimplifier simplifier(&Vertices[0].Position, static_cast<u32>(Vertices.size()), sizeof(MeshVertex));
+        std::vector<MeshSimplifierLevel> levels = simplifier.BuildChain(std::span<const u32>(Indices.data() + baseOffset, baseCount), settings);
+
+        Indices.clear();
+        LODs.clear();
+
+        for (auto& level : levels) {
+            LODs.push_back({ static_cast<u32>(Indices.size()), static_cast<u32>(level.Indices.size()), level.Error });
+            Indices.insert(Indices.end(), level.Indices.begin(), level.Indices.end());
+        }
+    }
+
+    void MeshData::ComputeBounds()
+    {
+        if (Vertices.empty()) {
+            Bounds = BoundingSphere();
+            return;
+        }
+
+        glm::vec3 min = Vertices[0].Position;
+        glm::vec3 max = Vertices[0].Position;
+        for (const auto& vertex : Vertices) {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+
+        Bounds.Center = (min + max) * 0.5f;
+        Bounds.Radius = 0.0f;
+        for (const auto& vertex : Vertices)
+            Bounds.Radius = std::max(Bounds.Radius, glm::length(vertex.Position - Bounds.Center));
+    }
+
+    void MeshData::ComputeNormals()
+    {
+        for (auto& vertex : Vertices)
+            vertex.Normal = glm::vec3(0.0f);
+
+        // Unnormalized cross products weight each face by its area.
+        for (usize i = 0; i + 2 < Indices.size(); i += 3) {
+            MeshVertex& v0 = Vertices[Indices[i + 0]];
+            MeshVertex& v1 = Vertices[Indices[i + 1]];
+            MeshVertex& v2 = Vertices[Indices[i + 2]];
+
+            glm::vec3 normal = glm::cross(v1.Position - v0.Position, v2.Position - v0.Position);
+            v0.Normal += normal;
+            v1.Normal += normal;
+            v2.Normal += normal;
+        }
+
+        for (auto& vertex : Vertices) {
+            f32 length = glm::length(vertex.Normal);
+            vertex.Normal = length > 0.0f ? vertex.Normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    MeshData MeshData::LoadOBJ(const std::string& filepath, const MeshLODSettings& settings)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open()) {
+            LOG_ERROR("Failed to open file {}", filepath);
+            return MeshData();
+        }
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+
+        MeshData mesh;
+        std::unordered_map<u64, u32> vertexLookup;
+
+        // OBJ indices are 1-based, negative values are relative to the end of the list.
+        auto resolve = [](i64 index, usize count) -> i64 {
+            return index < 0 ? static_cast<i64>(count) + index : index - 1;
+        };
+
+        std::string line;
+        std::vector<u32> face;
+
+        while (std::getline(file, line)) {
+            std::istringstream stream(line);
+            std::string type;
+            stream >> type;
+
+            if (type == "v") {
+                glm::vec3 p(0.0f);
+                stream >> p.x >> p.y >> p.z;
+                positions.push_back(p);
+            } else if (type == "vn") {
+                glm::vec3 n(0.0f);
+                stream >> n.x >> n.y >> n.z;
+                normals.push_back(n);
+            } else if (type == "f") {
+                face.clear();
+
+                std::string corner;
+                while (stream >> corner) {
+                    // v, v/vt, v//vn or v/vt/vn
+                    const char* cursor = corner.c_str();
+                    char* end = nullptr;
+
+                    i64 positionIndex = resolve(std::strtoll(cursor, &end, 10), positions.size());
+                    i64 normalIndex = -1;
+
+                    if (*end == '/') {
+                        cursor = end + 1;
+                        std::strtoll(cursor, &end, 10);
+                        if (*end == '/')
+                            normalIndex = resolve(std::strtoll(end + 1, &end, 10), normals.size());
+                    }
+
+                    if (positionIndex < 0 || positionIndex >= static_cast<i64>(positions.size())) {
+                        LOG_ERROR("Invalid face index in {}", filepath);
+                        return MeshData();
+                    }
+
+                    if (normalIndex >= static_cast<i64>(normals.size()))
+                        normalIndex = -1;
+
+                    u64 key = (static_cast<u64>(positionIndex) << 32) | static_cast<u32>(normalIndex);
+                    auto [it, inserted] = vertexLookup.try_emplace(key, static_cast<u32>(mesh.Vertices.size()));
+                    if (inserted)
+                        mesh.Vertices.push_back({ positions[positionIndex], normalIndex >= 0 ? normals[normalIndex] : glm::vec3(0.0f) });
+
+                    face.push_back(it->second);
+                }
+
+                for (usize i = 2; i < face.size(); ++i) {
+                    mesh.Indices.push_back(face[0]);
+                    mesh.Indices.push_back(face[i - 1]);
+                    mesh.Indices.push_back(face[i]);
+                }
+            }
+        }
+
+        if (mesh.Indices.empty()) {
+            LOG_ERROR("No faces in {}", filepath);
+            return MeshData();
+        }
+
+        if (normals.empty())
+            mesh.ComputeNormals();
+
+        mesh.ComputeBounds();
+        mesh.GenerateLODs(settings);
+
+        LOG_INFO("Loaded {}: {} vertices, {} triangles, {} LODs", filepath, mesh.Vertices.size(), mesh.GetTriangleCount(), mesh.LODs.size());
+
+        return mesh;
+    }
+
+    MeshData MeshData::CreateIcosphere(u32 subdivisions, const MeshLODSettings& settings)
+    {
+        const f32 t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+        std::vector<glm::vec3> positions = {
+            { -1.0f,  t, 0.0f }, { 1.0f,  t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f,  t }, { 0.0f, 1.0f,  t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            {  t, 0.0f, -1.0f }, {  t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f }
+        };
+
+        std::vector<u32> indices = {
+            0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+            1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+            3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+            4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+        };
+
+        for (auto& p : positions)
+            p = glm::normalize(p);
+
+        // Each edge midpoint is created once and shared by both neighbouring triangles.
+        for (u32 level = 0; level < subdivisions; ++level) {
+            std::unordered_map<u64, u32> midpoints;
+            std::vector<u32> subdivided;
+            subdivided.reserve(indices.size() * 4);
+
+            auto midpoint = [&](u32 a, u32 b) {
+                u64 key = a < b ? (static_cast<u64>(a) << 32) | b : (static_cast<u64>(b) << 32) | a;
+                auto [it, inserted] = midpoints.try_emplace(key, static_cast<u32>(positions.size()));
+                if (inserted)
+                    positions.push_back(glm::normalize(positions[a] + positions[b]));
+                return it->second;
+            };
+
+            for (usize i = 0; i < indices.size(); i += 3) {
+                u32 a = indices[i + 0];
+                u32 b = indices[i + 1];
+                u32 c = indices[i + 2];
+
+                u32 ab = midpoint(a, b);
+                u32 bc = midpoint(b, c);
+                u32 ca = midpoint(c, a);
+
+                subdivided.insert(subdivided.end(), { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca });
+            }
+
+            indices = std::move(subdivided);
+        }
+
+        MeshData mesh;
+        mesh.Vertices.reserve(positions.size());
+        for (const auto& p : positions)
+            mesh.Vertices.push_back({ p, p });
+
+        mesh.Indices = std::move(indices);
+
+        mesh.ComputeBounds();
+        mesh.GenerateLODs(settings);
+
+        return mesh;
+    }
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "Math/Bounds.hpp"
+#include "MeshSimplifier.hpp"
+
+namespace Graphics {
+
+    struct MeshVertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+    };
+
+    struct MeshLOD
+    {
+        u32 FirstIndex { 0 };
+        u32 IndexCount { 0 };
+        // Object space distance between this level and the full resolution surface.
+        f32 Error { 0.0f };
+    };
+
+    // CPU side mesh as produced by the importers. All levels share the vertex
+    // array, their index ranges are stored back to back in Indices with the full
+    // resolution level first.
+    struct MeshData
+    {
+        std::vector<MeshVertex> Vertices;
+        std::vector<u32> Indices;
+        std::vector<MeshLOD> LODs;
+        BoundingSphere Bounds;
+
+        inline u32 GetTriangleCount(u32 lod = 0) const { return LODs[lod].IndexCount / 3; }
+
+        // Replaces the LOD chain with one simplified from level 0.
+        void GenerateLODs(const MeshLODSettings& settings = {});
+
+        // Wavefront OBJ, faces are triangulated as fans and vertices deduplicated
+        // per position/normal pair. Missing normals are generated. The LOD chain is
+        // built on import. Returns an empty mesh if the file cannot be read.
+        static MeshData LoadOBJ(const std::string& filepath, const MeshLODSettings& settings = {});
+
+        // Unit icosphere, 20 * 4^subdivisions triangles.
+        static MeshData CreateIcosphere(u32 subdivisions, const MeshLODSettings& settings = {});
+
+    private:
+        void ComputeBounds();
+        void ComputeNormals();
+    };
+
+}
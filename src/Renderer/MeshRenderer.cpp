@@ -0,0 +1,302 @@
+#include "MeshRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "Mesh.hpp"
+#include "PipelineLayoutCache.hpp"
+
+namespace Graphics {
+
+    MeshRenderer::MeshRenderer(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        // Set 0 holds the instance buffer, the push constants the view projection.
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+        m_PipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "Mesh.vert", "Mesh.frag" }));
+        m_DescriptorSetLayout = layouts.GetSetLayouts(m_PipelineLayout).at(0);
+
+        m_Frames.resize(Renderer::GetFramesInFlight());
+
+        VkDescriptorPoolSize poolSize;
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = static_cast<u32>(m_Frames.size());
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = static_cast<u32>(m_Frames.size());
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        static constexpr VkDeviceSize instanceBufferSize = sizeof(GPUInstance) * OcclusionCuller::s_MaxInstances;
+
+        for (auto& frame : m_Frames) {
+            m_Renderer.CreateBuffer(instanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.InstanceBuffer, frame.InstanceMemory, "MeshRenderer");
+            VK_CHECK(vkMapMemory(device, frame.InstanceMemory, 0, instanceBufferSize, 0, reinterpret_cast<void**>(&frame.Instances)));
+
+            VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+            allocInfo.descriptorPool = m_DescriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+
+            VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &frame.DescriptorSet));
+
+            VkDescriptorBufferInfo bufferInfo = { frame.InstanceBuffer, 0, VK_WHOLE_SIZE };
+
+            VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+            write.dstSet = frame.DescriptorSet;
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = &bufferInfo;
+
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+        }
+
+        m_Frame = &m_Frames[0];
+
+        CreatePipelines();
+    }
+
+    MeshRenderer::~MeshRenderer()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        for (auto& frame : m_Frames) {
+            vkUnmapMemory(device, frame.InstanceMemory);
+            vkDestroyBuffer(device, frame.InstanceBuffer, nullptr);
+            m_Renderer.FreeMemory(frame.InstanceMemory);
+        }
+
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    }
+
+    void MeshRenderer::CreatePipelines()
+    {
+        PipelineCache& cache = m_Renderer.GetPipelineCache();
+
+        // Meshes are drawn flat while the lit pipeline compiles.
+        m_Pipeline = GetPipelineDesc(false);
+        m_FallbackPipeline = m_Pipeline.GetFallback();
+        cache.Prewarm(m_FallbackPipeline);
+        cache.Prewarm(m_Pipeline);
+
+        if (m_Renderer.IsDepthPrepassEnabled()) {
+            m_DepthPrepassPipeline = GetPipelineDesc(true);
+            cache.Prewarm(m_DepthPrepassPipeline);
+        }
+    }
+
+    PipelineDesc MeshRenderer::GetPipelineDesc(bool depthOnly) const
+    {
+        static constexpr auto vertexLayout = Mesh::GetVertexLayout();
+        static_assert(vertexLayout.IsValid(), "Vertex attributes overlap or exceed the stride");
+
+        PipelineDesc desc;
+        desc.Shaders = { "Mesh.vert", "Mesh.frag" };
+        desc.Layout = m_PipelineLayout;
+        desc.SetVertexLayout(vertexLayout);
+
+        desc.CullMode = VK_CULL_MODE_BACK_BIT;
+        desc.FrontFace = VK_FRONT_FACE_CLOCKWISE;
+
+        // Same depth setup as the renderer's own pipeline: reverse-Z, and an
+        // EQUAL test without writes when the prepass already laid down depth.
+        bool prepass = m_Renderer.IsDepthPrepassEnabled();
+        desc.DepthWrite = !prepass;
+        desc.DepthCompare = prepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_GREATER_OR_EQUAL;
+
+        desc.ColorFormats = { m_Renderer.GetSceneColorFormat() };
+        desc.DepthFormat = m_Renderer.GetDepthFormat();
+        desc.StencilFormat = m_Renderer.GetStencilFormat();
+        desc.Samples = m_Renderer.GetSampleCount();
+
+        if (depthOnly) {
+            desc.Shaders = { "Mesh.vert" };
+            desc.DepthWrite = true;
+            desc.DepthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL;
+            desc.ColorFormats.clear();
+        }
+
+        return desc;
+    }
+
+    void MeshRenderer::BeginFrame()
+    {
+        m_Frame = &m_Frames[m_Renderer.GetFrameIndex()];
+
+        m_Draws.clear();
+        m_Batches.clear();
+        m_Stats = MeshRendererStats();
+    }
+
+    void MeshRenderer::BeginScene(const glm::mat4& view, const glm::mat4& projection)
+    {
+        m_View = view;
+        m_Projection = projection;
+        m_ViewProjection = projection * view;
+        m_CameraPosition = glm::vec3(glm::inverse(view)[3]);
+        // Absolute value, the Y axis is flipped for Vulkan.
+        m_ProjectionScale = std::abs(projection[1][1]);
+    }
+
+    void MeshRenderer::Submit(const Mesh& mesh, const glm::mat4& transform, MeshInstanceState& state)
+    {
+        if (m_Draws.size() >= OcclusionCuller::s_MaxInstances) {
+            if (!m_OverflowReported)
+                LOG_ERROR("MeshRenderer: more than {} instances submitted in one frame, the rest is dropped", OcclusionCuller::s_MaxInstances);
+            m_OverflowReported = true;
+            return;
+        }
+
+        if (state.VisibilitySlot == ~0u) {
+            if (!m_FreeSlots.empty()) {
+                state.VisibilitySlot = m_FreeSlots.back();
+                m_FreeSlots.pop_back();
+            } else {
+                // Past s_MaxInstances live objects slots are shared, which only costs culling accuracy.
+                state.VisibilitySlot = m_NextSlot++ % OcclusionCuller::s_MaxInstances;
+            }
+        }
+
+        const BoundingSphere& bounds = mesh.GetBounds();
+
+        f32 scale = std::max({
+            glm::length(glm::vec3(transform[0])),
+            glm::length(glm::vec3(transform[1])),
+            glm::length(glm::vec3(transform[2]))
+        });
+
+        BoundingSphere world;
+        world.Center = glm::vec3(transform * glm::vec4(bounds.Center, 1.0f));
+        world.Radius = bounds.Radius * scale;
+
+        if (m_LODEnabled) {
+            f32 screenSize = ComputeScreenSize(world, m_CameraPosition, m_ProjectionScale, static_cast<f32>(m_Renderer.GetExtent().height));
+            state.LOD = SelectLOD(mesh.GetLODs(), bounds.Radius, screenSize, state.LOD, m_LODSettings);
+        } else {
+            state.LOD = 0;
+        }
+
+        const MeshLOD& lod = mesh.GetLODs()[state.LOD];
+
+        Draw draw;
+        draw.Geometry = &mesh;
+        draw.Instance.Model = transform;
+        draw.Instance.Sphere = glm::vec4(world.Center, world.Radius);
+        draw.Instance.FirstIndex = lod.FirstIndex;
+        draw.Instance.IndexCount = lod.IndexCount;
+        draw.Instance.VisibilitySlot = state.VisibilitySlot;
+        draw.Instance.Padding = 0;
+
+        m_Draws.push_back(draw);
+
+        m_Stats.DrawCalls++;
+        m_Stats.TriangleCount += lod.IndexCount / 3;
+        m_Stats.FullDetailTriangleCount += mesh.GetTriangleCount(0);
+    }
+
+    void MeshRenderer::EndScene()
+    {
+        // Instances of one mesh have to be contiguous to be drawn by one indirect call.
+        std::stable_sort(m_Draws.begin(), m_Draws.end(), [](const Draw& a, const Draw& b) {
+            return std::less<const Mesh*>()(a.Geometry, b.Geometry);
+        });
+
+        m_Batches.clear();
+
+        for (u32 i = 0; i < m_Draws.size(); ++i) {
+            m_Frame->Instances[i] = m_Draws[i].Instance;
+
+            if (m_Batches.empty() || m_Batches.back().Geometry != m_Draws[i].Geometry)
+                m_Batches.push_back({ m_Draws[i].Geometry, i, 0 });
+            m_Batches.back().InstanceCount++;
+        }
+
+        if (m_Renderer.IsOcclusionCullingEnabled())
+            m_Renderer.GetOcclusionCuller().SetScene(m_View, m_Projection, m_Frame->InstanceBuffer, static_cast<u32>(m_Draws.size()));
+    }
+
+    void MeshRenderer::ReleaseInstance(MeshInstanceState& state)
+    {
+        if (state.VisibilitySlot != ~0u)
+            m_FreeSlots.push_back(state.VisibilitySlot);
+
+        state = MeshInstanceState();
+    }
+
+    void MeshRenderer::RecordDepthPrepass(VkCommandBuffer commandBuffer, CullPhase phase)
+    {
+        // The main pass only shades where the prepass wrote depth, it has to
+        // draw something as well or the meshes leave holes.
+        PipelineCache& cache = m_Renderer.GetPipelineCache();
+        VkPipeline pipeline = cache.Get(m_DepthPrepassPipeline);
+        if (pipeline == VK_NULL_HANDLE || cache.Get(m_Pipeline, m_FallbackPipeline) == VK_NULL_HANDLE)
+            return;
+
+        if (m_Renderer.IsOcclusionCullingEnabled())
+            RecordDraws(commandBuffer, pipeline, m_Renderer.GetOcclusionCuller().GetDrawBuffer(phase));
+        else
+            RecordDraws(commandBuffer, pipeline, VK_NULL_HANDLE);
+    }
+
+    void MeshRenderer::Record(VkCommandBuffer commandBuffer)
+    {
+        VkPipeline pipeline = m_Renderer.GetPipelineCache().Get(m_Pipeline, m_FallbackPipeline);
+        if (pipeline == VK_NULL_HANDLE)
+            return;
+
+        if (m_Renderer.IsOcclusionCullingEnabled()) {
+            const OcclusionCuller& culler = m_Renderer.GetOcclusionCuller();
+            RecordDraws(commandBuffer, pipeline, culler.GetDrawBuffer(CullPhase::Early));
+            RecordDraws(commandBuffer, pipeline, culler.GetDrawBuffer(CullPhase::Late));
+        } else {
+            RecordDraws(commandBuffer, pipeline, VK_NULL_HANDLE);
+        }
+    }
+
+    void MeshRenderer::RecordDraws(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkBuffer drawBuffer)
+    {
+        if (m_Batches.empty())
+            return;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_Frame->DescriptorSet, 0, nullptr);
+
+        PushConstants constants;
+        constants.ViewProjection = m_ViewProjection;
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &constants);
+
+        constexpr u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+        bool multiDraw = m_Renderer.SupportsMultiDrawIndirect();
+
+        for (const auto& batch : m_Batches) {
+            VkBuffer vertexBuffer = batch.Geometry->GetVertexBuffer();
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+            vkCmdBindIndexBuffer(commandBuffer, batch.Geometry->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+            if (drawBuffer != VK_NULL_HANDLE && multiDraw) {
+                vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, static_cast<VkDeviceSize>(batch.FirstInstance) * stride, batch.InstanceCount, stride);
+                continue;
+            }
+
+            for (u32 i = batch.FirstInstance; i < batch.FirstInstance + batch.InstanceCount; ++i) {
+                if (drawBuffer != VK_NULL_HANDLE) {
+                    vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, static_cast<VkDeviceSize>(i) * stride, 1, stride);
+                } else {
+                    const GPUInstance& instance = m_Draws[i].Instance;
+                    vkCmdDrawIndexed(commandBuffer, instance.IndexCount, 1, instance.FirstIndex, 0, i);
+                }
+            }
+        }
+    }
+
+}
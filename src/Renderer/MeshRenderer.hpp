@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "LODSelection.hpp"
+#include "OcclusionCuller.hpp"
+#include "PipelineCache.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+    class Mesh;
+
+    // Per-object state kept by the caller across frames.
+    struct MeshInstanceState
+    {
+        // Level selected last frame, for LOD hysteresis.
+        u32 LOD { 0 };
+        // Persistent slot in the occlusion culler's visibility buffer, assigned on first submit.
+        u32 VisibilitySlot { ~0u };
+    };
+
+    struct MeshRendererStats
+    {
+        u32 DrawCalls { 0 };
+        // Triangles submitted at the selected levels.
+        u64 TriangleCount { 0 };
+        // Triangles the same draws would have cost at full resolution.
+        u64 FullDetailTriangleCount { 0 };
+    };
+
+    // Draws lit meshes into the main pass, and into the depth prepass when it
+    // is enabled. Every submission picks its level of detail from the projected
+    // size of the mesh bounds, the caller keeps the selected level per object so
+    // the selection can apply hysteresis across frames.
+    //
+    // Submissions are sorted by mesh at EndScene and written to a per-frame
+    // instance buffer that the vertex shader indexes with gl_InstanceIndex. With
+    // occlusion culling enabled the draws come from the OcclusionCuller's
+    // indirect buffers, one vkCmdDrawIndexedIndirect per mesh and cull phase.
+    class MeshRenderer
+    {
+    public:
+        MeshRenderer(Renderer& renderer);
+        ~MeshRenderer();
+
+        MeshRenderer(const MeshRenderer&) = delete;
+        MeshRenderer& operator=(const MeshRenderer&) = delete;
+
+        // Pipelines depend on the attachment formats, sample count and prepass
+        // mode, each call queues the compiles for the current ones.
+        void CreatePipelines();
+
+        void BeginFrame();
+
+        // The projection is needed on its own to turn bounds into a screen size.
+        void BeginScene(const glm::mat4& view, const glm::mat4& projection);
+
+        // state.LOD is the level the object used last frame and receives the new one.
+        void Submit(const Mesh& mesh, const glm::mat4& transform, MeshInstanceState& state);
+        // Sorts the submissions and uploads the instance data, call once all meshes are submitted.
+        void EndScene();
+
+        // Returns the visibility slot of an object that is no longer drawn.
+        void ReleaseInstance(MeshInstanceState& state);
+
+        void SetLODSettings(const LODSelectionSettings& settings) { m_LODSettings = settings; }
+        inline const LODSelectionSettings& GetLODSettings() const { return m_LODSettings; }
+
+        // With LOD disabled every mesh is drawn at full resolution, for comparison.
+        void SetLODEnabled(bool enabled) { m_LODEnabled = enabled; }
+        inline bool IsLODEnabled() const { return m_LODEnabled; }
+
+        // With occlusion culling each phase renders its own part of the depth
+        // prepass, the main pass draws both.
+        void RecordDepthPrepass(VkCommandBuffer commandBuffer, CullPhase phase = CullPhase::Early);
+        void Record(VkCommandBuffer commandBuffer);
+
+        inline const MeshRendererStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct PushConstants
+        {
+            glm::mat4 ViewProjection;
+        };
+
+        // Matches Instance in Mesh.vert and OcclusionCull.glsl.
+        struct GPUInstance
+        {
+            glm::mat4 Model;
+            // World space bounding sphere, center and radius.
+            glm::vec4 Sphere;
+            u32 FirstIndex;
+            u32 IndexCount;
+            u32 VisibilitySlot;
+            u32 Padding;
+        };
+
+        struct Draw
+        {
+            const Mesh* Geometry;
+            GPUInstance Instance;
+        };
+
+        // Consecutive instances of one mesh after sorting.
+        struct Batch
+        {
+            const Mesh* Geometry;
+            u32 FirstInstance;
+            u32 InstanceCount;
+        };
+
+        struct FrameData
+        {
+            VkBuffer InstanceBuffer { VK_NULL_HANDLE };
+            VkDeviceMemory InstanceMemory { VK_NULL_HANDLE };
+            GPUInstance* Instances { nullptr };
+            VkDescriptorSet DescriptorSet { VK_NULL_HANDLE };
+        };
+
+    private:
+        PipelineDesc GetPipelineDesc(bool depthOnly) const;
+
+        // drawBuffer holds one indirect command per instance, without it every instance is drawn directly.
+        void RecordDraws(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkBuffer drawBuffer);
+
+    private:
+        Renderer& m_Renderer;
+
+        VkDescriptorSetLayout m_DescriptorSetLayout { VK_NULL_HANDLE };
+        VkDescriptorPool m_DescriptorPool { VK_NULL_HANDLE };
+        VkPipelineLayout m_PipelineLayout { VK_NULL_HANDLE };
+        PipelineDesc m_Pipeline;
+        PipelineDesc m_FallbackPipeline;
+        PipelineDesc m_DepthPrepassPipeline;
+
+        glm::mat4 m_View { 1.0f };
+        glm::mat4 m_Projection { 1.0f };
+        glm::mat4 m_ViewProjection { 1.0f };
+        glm::vec3 m_CameraPosition { 0.0f };
+        f32 m_ProjectionScale { 1.0f };
+
+        LODSelectionSettings m_LODSettings;
+        bool m_LODEnabled { true };
+
+        std::vector<FrameData> m_Frames;
+        FrameData* m_Frame { nullptr };
+
+        std::vector<Draw> m_Draws;
+        std::vector<Batch> m_Batches;
+
+        std::vector<u32> m_FreeSlots;
+        u32 m_NextSlot { 0 };
+        bool m_OverflowReported { false };
+
+        MeshRendererStats m_Stats;
+    };
+
+}
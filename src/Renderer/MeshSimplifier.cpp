@@ -0,0 +1,353 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace Graphics {
+
+    // Symmetric 4x4 error quadric, sum of squared distances to a set of planes
+    // weighted by triangle area. Weight is kept so the error can be normalized
+    // back to an average squared distance.
+    struct Quadric
+    {
+        f32 A00 { 0.0f }, A11 { 0.0f }, A22 { 0.0f };
+        f32 A10 { 0.0f }, A20 { 0.0f }, A21 { 0.0f };
+        f32 B0 { 0.0f }, B1 { 0.0f }, B2 { 0.0f };
+        f32 C { 0.0f };
+        f32 W { 0.0f };
+
+        static Quadric FromPlane(const glm::vec3& n, f32 d, f32 weight)
+        {
+            Quadric q;
+            q.A00 = n.x * n.x * weight;
+            q.A11 = n.y * n.y * weight;
+            q.A22 = n.z * n.z * weight;
+            q.A10 = n.y * n.x * weight;
+            q.A20 = n.z * n.x * weight;
+            q.A21 = n.z * n.y * weight;
+            q.B0 = n.x * d * weight;
+            q.B1 = n.y * d * weight;
+            q.B2 = n.z * d * weight;
+            q.C = d * d * weight;
+            q.W = weight;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            A00 += other.A00; A11 += other.A11; A22 += other.A22;
+            A10 += other.A10; A20 += other.A20; A21 += other.A21;
+            B0 += other.B0; B1 += other.B1; B2 += other.B2;
+            C += other.C;
+            W += other.W;
+            return *this;
+        }
+
+        // Average squared distance of p to the accumulated planes.
+        f32 Evaluate(const glm::vec3& p) const
+        {
+            f32 rx = A00 * p.x + A10 * p.y + A20 * p.z + B0;
+            f32 ry = A10 * p.x + A11 * p.y + A21 * p.z + B1;
+            f32 rz = A20 * p.x + A21 * p.y + A22 * p.z + B2;
+
+            f32 error = rx * p.x + ry * p.y + rz * p.z + B0 * p.x + B1 * p.y + B2 * p.z + C;
+            return W > 0.0f ? std::max(error / W, 0.0f) : 0.0f;
+        }
+    };
+
+    struct EdgeCollapse
+    {
+        u32 From;
+        u32 To;
+        f32 Cost;
+    };
+
+    static inline u64 EdgeKey(u32 a, u32 b)
+    {
+        return a < b ? (static_cast<u64>(a) << 32) | b : (static_cast<u64>(b) << 32) | a;
+    }
+
+    MeshSimplifier::MeshSimplifier(const glm::vec3* positions, u32 vertexCount, usize stride)
+        : m_Positions(vertexCount), m_Seam(vertexCount, 0)
+    {
+        const u8* bytes = reinterpret_cast<const u8*>(positions);
+
+        glm::vec3 min(std::numeric_limits<f32>::max());
+        glm::vec3 max(std::numeric_limits<f32>::lowest());
+
+        for (u32 i = 0; i < vertexCount; ++i) {
+            std::memcpy(&m_Positions[i], bytes + i * stride, sizeof(glm::vec3));
+            min = glm::min(min, m_Positions[i]);
+            max = glm::max(max, m_Positions[i]);
+        }
+
+        if (vertexCount == 0)
+            return;
+
+        glm::vec3 extent = max - min;
+        m_Scale = std::max({ extent.x, extent.y, extent.z, std::numeric_limits<f32>::min() });
+
+        // Vertices are matched by exact position, importers emit identical
+        // positions for split vertices.
+        struct PositionHash
+        {
+            usize operator()(const glm::vec3& p) const
+            {
+                // Adding zero folds -0.0 into 0.0, they compare equal and must hash equal.
+                glm::vec3 folded = p + glm::vec3(0.0f);
+
+                u32 bits[3];
+                std::memcpy(bits, &folded, sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+
+        std::unordered_map<glm::vec3, u32, PositionHash> firstVertex;
+        firstVertex.reserve(vertexCount);
+
+        for (u32 i = 0; i < vertexCount; ++i) {
+            auto [it, inserted] = firstVertex.try_emplace(m_Positions[i], i);
+            if (!inserted) {
+                m_Seam[it->second] = 1;
+                m_Seam[i] = 1;
+            }
+        }
+
+        f32 invScale = 1.0f / m_Scale;
+        for (auto& position : m_Positions)
+            position = (position - min) * invScale;
+    }
+
+    std::vector<u32> MeshSimplifier::Simplify(std::span<const u32> indices, u32 targetIndexCount, f32 targetError, f32* error) const
+    {
+        std::vector<u32> result(indices.begin(), indices.end());
+        u32 vertexCount = static_cast<u32>(m_Positions.size());
+
+        f32 normalizedError = targetError / m_Scale;
+        f32 errorLimit = normalizedError * normalizedError;
+        f32 maxError = 0.0f;
+
+        // Vertices on edges that are not shared by exactly two triangles are
+        // borders (or non-manifold) and stay where they are.
+        std::vector<u8> locked(m_Seam);
+        {
+            std::unordered_map<u64, u32> edgeUse;
+            edgeUse.reserve(result.size());
+
+            for (usize i = 0; i < result.size(); i += 3) {
+                for (u32 e = 0; e < 3; ++e)
+                    edgeUse[EdgeKey(result[i + e], result[i + (e + 1) % 3])]++;
+            }
+
+            for (const auto& [key, count] : edgeUse) {
+                if (count != 2) {
+                    locked[static_cast<u32>(key >> 32)] = 1;
+                    locked[static_cast<u32>(key)] = 1;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for (usize i = 0; i < result.size(); i += 3) {
+            const glm::vec3& p0 = m_Positions[result[i + 0]];
+            const glm::vec3& p1 = m_Positions[result[i + 1]];
+            const glm::vec3& p2 = m_Positions[result[i + 2]];
+
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            f32 length = glm::length(normal);
+            if (length == 0.0f)
+                continue;
+
+            normal /= length;
+
+            // Weighted by area so large triangles dominate the error.
+            Quadric q = Quadric::FromPlane(normal, -glm::dot(normal, p0), length * 0.5f);
+            quadrics[result[i + 0]] += q;
+            quadrics[result[i + 1]] += q;
+            quadrics[result[i + 2]] += q;
+        }
+
+        std::vector<u32> triangleOffsets(vertexCount + 1);
+        std::vector<u32> vertexTriangles;
+        std::vector<EdgeCollapse> collapses;
+        std::vector<u32> remap(vertexCount);
+        std::vector<u8> touched(vertexCount);
+
+        // Each pass picks the cheapest independent collapses, applies them and
+        // rebuilds the triangle list. A collapse marks the one-ring of the removed
+        // vertex so later collapses in the same pass never see stale triangles.
+        while (result.size() > targetIndexCount) {
+            u32 triangleCount = static_cast<u32>(result.size() / 3);
+
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (u32 index : result)
+                triangleOffsets[index + 1]++;
+            for (u32 v = 0; v < vertexCount; ++v)
+                triangleOffsets[v + 1] += triangleOffsets[v];
+
+            vertexTriangles.resize(result.size());
+            {
+                std::vector<u32> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                for (u32 t = 0; t < triangleCount; ++t) {
+                    for (u32 c = 0; c < 3; ++c)
+                        vertexTriangles[cursor[result[t * 3 + c]]++] = t;
+                }
+            }
+
+            collapses.clear();
+            for (u32 t = 0; t < triangleCount; ++t) {
+                for (u32 e = 0; e < 3; ++e) {
+                    u32 a = result[t * 3 + e];
+                    u32 b = result[t * 3 + (e + 1) % 3];
+
+                    // Interior edges are seen from both triangles, keep one of them.
+                    if (a > b || (locked[a] && locked[b]))
+                        continue;
+
+                    Quadric q = quadrics[a];
+                    q += quadrics[b];
+
+                    f32 costAB = locked[a] ? std::numeric_limits<f32>::max() : q.Evaluate(m_Positions[b]);
+                    f32 costBA = locked[b] ? std::numeric_limits<f32>::max() : q.Evaluate(m_Positions[a]);
+
+                    collapses.push_back(costAB <= costBA ? EdgeCollapse { a, b, costAB } : EdgeCollapse { b, a, costBA });
+                }
+            }
+
+            if (collapses.empty())
+                break;
+
+            std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& lhs, const EdgeCollapse& rhs) {
+                return lhs.Cost < rhs.Cost;
+            });
+
+            if (collapses.front().Cost > errorLimit)
+                break;
+
+            for (u32 v = 0; v < vertexCount; ++v)
+                remap[v] = v;
+            std::fill(touched.begin(), touched.end(), 0);
+
+            // Every collapse of an interior edge removes two triangles.
+            u32 removeBudget = (static_cast<u32>(result.size()) - targetIndexCount + 2) / 3;
+            u32 removed = 0;
+            u32 applied = 0;
+
+            for (const auto& collapse : collapses) {
+                if (collapse.Cost > errorLimit || removed >= removeBudget)
+                    break;
+
+                if (touched[collapse.From] || touched[collapse.To])
+                    continue;
+
+                const glm::vec3& target = m_Positions[collapse.To];
+
+                // Reject collapses that flip or degenerate one of the remaining triangles.
+                bool valid = true;
+                u32 collapsed = 0;
+
+                for (u32 i = triangleOffsets[collapse.From]; i < triangleOffsets[collapse.From + 1] && valid; ++i) {
+                    const u32* triangle = &result[vertexTriangles[i] * 3];
+
+                    if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To) {
+                        collapsed++;
+                        continue;
+                    }
+
+                    glm::vec3 p[3] = { m_Positions[triangle[0]], m_Positions[triangle[1]], m_Positions[triangle[2]] };
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+                    for (u32 c = 0; c < 3; ++c) {
+                        if (triangle[c] == collapse.From)
+                            p[c] = target;
+                    }
+
+                    // Also rejects large rotations, a chain of small flips in one pass adds up.
+                    glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    valid = glm::dot(before, after) > 0.25f * glm::length(before) * glm::length(after);
+                }
+
+                if (!valid)
+                    continue;
+
+                for (u32 i = triangleOffsets[collapse.From]; i < triangleOffsets[collapse.From + 1]; ++i) {
+                    const u32* triangle = &result[vertexTriangles[i] * 3];
+                    touched[triangle[0]] = 1;
+                    touched[triangle[1]] = 1;
+                    touched[triangle[2]] = 1;
+                }
+
+                remap[collapse.From] = collapse.To;
+                quadrics[collapse.To] += quadrics[collapse.From];
+
+                maxError = std::max(maxError, collapse.Cost);
+                removed += collapsed;
+                applied++;
+            }
+
+            if (applied == 0)
+                break;
+
+            usize write = 0;
+            for (usize i = 0; i < result.size(); i += 3) {
+                u32 a = remap[result[i + 0]];
+                u32 b = remap[result[i + 1]];
+                u32 c = remap[result[i + 2]];
+
+                if (a == b || b == c || c == a)
+                    continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+
+            result.resize(write);
+        }
+
+        if (error)
+            *error = std::sqrt(maxError) * m_Scale;
+
+        return result;
+    }
+
+    std::vector<MeshSimplifierLevel> MeshSimplifier::BuildChain(std::span<const u32> indices, const MeshLODSettings& settings) const
+    {
+        std::vector<MeshSimplifierLevel> levels;
+        levels.push_back({ std::vector<u32>(indices.begin(), indices.end()), 0.0f });
+
+        f32 maxError = settings.MaxError * m_Scale;
+
+        while (levels.size() < settings.MaxLevels) {
+            const MeshSimplifierLevel& previous = levels.back();
+
+            u32 triangleCount = static_cast<u32>(previous.Indices.size() / 3);
+            if (triangleCount <= settings.MinTriangles)
+                break;
+
+            f32 budget = maxError - previous.Error;
+            if (budget <= 0.0f)
+                break;
+
+            u32 targetTriangles = std::max(static_cast<u32>(triangleCount * settings.Reduction), settings.MinTriangles);
+
+            // Each level is measured against the previous one, so the remaining
+            // budget shrinks as errors accumulate down the chain.
+            f32 error = 0.0f;
+            std::vector<u32> simplified = Simplify(previous.Indices, targetTriangles * 3, budget, &error);
+
+            // Locked borders or the error budget stalled the reduction, further levels would be near copies.
+            if (simplified.size() > previous.Indices.size() * 9 / 10)
+                break;
+
+            f32 levelError = previous.Error + error;
+            levels.push_back({ std::move(simplified), levelError });
+        }
+
+        return levels;
+    }
+
+}
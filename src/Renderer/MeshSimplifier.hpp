@@ -0,0 +1,66 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    struct MeshLODSettings
+    {
+        // Number of levels including the full resolution one.
+        u32 MaxLevels { 6 };
+        // Triangle count of each level relative to the previous one.
+        f32 Reduction { 0.5f };
+        // Levels are not simplified below this many triangles.
+        u32 MinTriangles { 32 };
+        // Largest accepted deviation, relative to the largest extent of the mesh.
+        f32 MaxError { 0.05f };
+    };
+
+    struct MeshSimplifierLevel
+    {
+        std::vector<u32> Indices;
+        // Upper bound of the distance between this level and the source surface, in object space.
+        f32 Error { 0.0f };
+    };
+
+    // Quadric error metric simplification (Garland-Heckbert) using half-edge
+    // collapses: a vertex is always merged into one of its neighbours, so every
+    // level is a new index list over the original vertex buffer and the vertex
+    // data can be shared between levels.
+    //
+    // Vertices on open borders and on attribute seams (several vertices with the
+    // same position) are never removed, which keeps silhouettes of open meshes
+    // and UV/normal seams intact.
+    class MeshSimplifier
+    {
+    public:
+        // positions are read with the given byte stride so interleaved vertex arrays can be passed directly.
+        MeshSimplifier(const glm::vec3* positions, u32 vertexCount, usize stride = sizeof(glm::vec3));
+
+        // Collapses edges until at most targetIndexCount indices remain or the
+        // cheapest collapse would move the surface further than targetError.
+        // error receives the largest deviation introduced, in object space.
+        std::vector<u32> Simplify(std::span<const u32> indices, u32 targetIndexCount, f32 targetError, f32* error = nullptr) const;
+
+        // Builds a LOD chain starting with the given indices as level 0, each
+        // level is simplified from the previous one. Stops early once a level
+        // no longer reduces meaningfully.
+        std::vector<MeshSimplifierLevel> BuildChain(std::span<const u32> indices, const MeshLODSettings& settings = {}) const;
+
+        // Largest extent of the positions, the unit of MeshLODSettings::MaxError.
+        inline f32 GetScale() const { return m_Scale; }
+
+    private:
+        // Positions are normalized to the unit cube so quadrics stay well conditioned in single precision.
+        std::vector<glm::vec3> m_Positions;
+        // Set for vertices that share their position with another vertex.
+        std::vector<u8> m_Seam;
+        f32 m_Scale { 1.0f };
+    };
+
+}
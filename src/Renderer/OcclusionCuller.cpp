@@ -0,0 +1,469 @@
+#include "OcclusionCuller.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cmath>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "ShaderReloader.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "Math/Frustum.hpp"
+
+namespace Graphics {
+
+    static constexpr u32 s_MaxPyramidLevels = 16;
+    static constexpr u32 s_CullGroupSize = 64;
+    static constexpr u32 s_PyramidGroupSize = 8;
+
+    OcclusionCuller::OcclusionCuller(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        CreateDescriptors();
+        CreatePipelines();
+
+        VkSamplerCreateInfo samplerInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+        VK_CHECK(vkCreateSampler(m_Renderer.GetDevice(), &samplerInfo, nullptr, &m_Sampler));
+
+        // Everything starts out invisible, so the first frame draws all of it in the late phase.
+        m_Visibility = CreateBuffer(GetVisibilityBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_Renderer.ImmediateSubmit([&](VkCommandBuffer commandBuffer) {
+            vkCmdFillBuffer(commandBuffer, m_Visibility.Buffer, 0, VK_WHOLE_SIZE, 0);
+        });
+
+        m_Frames.resize(Renderer::GetFramesInFlight());
+
+        for (auto& frame : m_Frames) {
+            frame.CullData = CreateBuffer(sizeof(CullData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            frame.Counters = CreateBuffer(sizeof(Counters), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            std::memset(frame.Counters.Mapped, 0, sizeof(Counters));
+
+            for (auto& draws : frame.Draws)
+                draws = CreateBuffer(GetDrawBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            std::array<VkDescriptorSetLayout, 2> layouts = { m_CullSetLayout, m_CullSetLayout };
+
+            VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+            allocInfo.descriptorPool = m_DescriptorPool;
+            allocInfo.descriptorSetCount = static_cast<u32>(layouts.size());
+            allocInfo.pSetLayouts = layouts.data();
+
+            VK_CHECK(vkAllocateDescriptorSets(m_Renderer.GetDevice(), &allocInfo, frame.CullSets.data()));
+
+            for (u32 phase = 0; phase < 2; ++phase) {
+                VkDescriptorBufferInfo cullInfo = { frame.CullData.Buffer, 0, sizeof(CullData) };
+                VkDescriptorBufferInfo drawInfo = { frame.Draws[phase].Buffer, 0, VK_WHOLE_SIZE };
+                VkDescriptorBufferInfo visibilityInfo = { m_Visibility.Buffer, 0, VK_WHOLE_SIZE };
+                VkDescriptorBufferInfo counterInfo = { frame.Counters.Buffer, 0, sizeof(Counters) };
+
+                std::array<VkWriteDescriptorSet, 4> writes;
+                for (auto& write : writes) {
+                    write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+                    write.dstSet = frame.CullSets[phase];
+                    write.descriptorCount = 1;
+                    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                }
+
+                writes[0].dstBinding = 0;
+                writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                writes[0].pBufferInfo = &cullInfo;
+                writes[1].dstBinding = 2;
+                writes[1].pBufferInfo = &drawInfo;
+                writes[2].dstBinding = 3;
+                writes[2].pBufferInfo = &visibilityInfo;
+                writes[3].dstBinding = 4;
+                writes[3].pBufferInfo = &counterInfo;
+
+                vkUpdateDescriptorSets(m_Renderer.GetDevice(), static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+            }
+        }
+    }
+
+    OcclusionCuller::~OcclusionCuller()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        ReleaseTargets();
+
+        for (auto& frame : m_Frames) {
+            DestroyBuffer(frame.CullData);
+            DestroyBuffer(frame.Counters);
+            for (auto& draws : frame.Draws)
+                DestroyBuffer(draws);
+        }
+
+        DestroyBuffer(m_Visibility);
+
+        vkDestroySampler(device, m_Sampler, nullptr);
+
+        ShaderReloader& reloader = m_Renderer.GetShaderReloader();
+        for (VkPipeline* pipeline : { &m_CullEarlyPipeline, &m_CullLatePipeline, &m_DepthPipeline, &m_DepthMSPipeline, &m_ReducePipeline })
+            reloader.Unwatch(*pipeline);
+
+        vkDestroyPipeline(device, m_CullEarlyPipeline, nullptr);
+        vkDestroyPipeline(device, m_CullLatePipeline, nullptr);
+        vkDestroyPipeline(device, m_DepthPipeline, nullptr);
+        vkDestroyPipeline(device, m_DepthMSPipeline, nullptr);
+        vkDestroyPipeline(device, m_ReducePipeline, nullptr);
+
+        vkDestroyDescriptorPool(device, m_PyramidDescriptorPool, nullptr);
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    }
+
+    void OcclusionCuller::BeginFrame()
+    {
+        m_FrameIndex = m_Renderer.GetFrameIndex();
+        FrameData& frame = m_Frames[m_FrameIndex];
+
+        // The slot's last frame has completed, the late phase made the counters host visible.
+        Counters* counters = static_cast<Counters*>(frame.Counters.Mapped);
+
+        m_Stats.InstanceCount = frame.InstanceCount;
+        m_Stats.EarlyDrawn = counters->EarlyDrawn;
+        m_Stats.LateDrawn = counters->LateDrawn;
+        m_Stats.FrustumCulled = counters->FrustumCulled;
+        m_Stats.OcclusionCulled = counters->OcclusionCulled;
+
+        std::memset(counters, 0, sizeof(Counters));
+        frame.InstanceCount = 0;
+    }
+
+    RenderGraphImageDesc OcclusionCuller::GetPyramidDesc(VkExtent2D extent)
+    {
+        RenderGraphImageDesc desc;
+        desc.Format = VK_FORMAT_R32_SFLOAT;
+        desc.Extent = { std::bit_floor(std::max(extent.width, 1u)), std::bit_floor(std::max(extent.height, 1u)) };
+        desc.MipLevels = std::min(static_cast<u32>(std::bit_width(std::max(desc.Extent.width, desc.Extent.height))), s_MaxPyramidLevels);
+
+        return desc;
+    }
+
+    void OcclusionCuller::SetTargets(const RenderGraph& graph, RenderGraphResource depth, RenderGraphResource pyramid)
+    {
+        ReleaseTargets();
+
+        VkDevice device = m_Renderer.GetDevice();
+
+        const RenderGraphImageDesc& depthDesc = graph.GetImageDesc(depth);
+        const RenderGraphImageDesc& pyramidDesc = graph.GetImageDesc(pyramid);
+
+        m_DepthSamples = depthDesc.Samples;
+        m_PyramidExtent = pyramidDesc.Extent;
+
+        VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        viewInfo.image = graph.GetImage(depth);
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = depthDesc.Format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+        VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &m_DepthView));
+
+        viewInfo.image = graph.GetImage(pyramid);
+        viewInfo.format = pyramidDesc.Format;
+
+        m_PyramidLevelViews.resize(pyramidDesc.MipLevels);
+        for (u32 level = 0; level < pyramidDesc.MipLevels; ++level) {
+            viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+            VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &m_PyramidLevelViews[level]));
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(pyramidDesc.MipLevels, m_PyramidSetLayout);
+        m_PyramidSets.resize(pyramidDesc.MipLevels);
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_PyramidDescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<u32>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, m_PyramidSets.data()));
+
+        std::vector<VkDescriptorImageInfo> imageInfos(pyramidDesc.MipLevels * 2);
+        std::vector<VkWriteDescriptorSet> writes(pyramidDesc.MipLevels * 2, { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+
+        for (u32 level = 0; level < pyramidDesc.MipLevels; ++level) {
+            VkDescriptorImageInfo& source = imageInfos[level * 2 + 0];
+            source.sampler = m_Sampler;
+            source.imageView = level == 0 ? m_DepthView : m_PyramidLevelViews[level - 1];
+            source.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+            VkDescriptorImageInfo& destination = imageInfos[level * 2 + 1];
+            destination.sampler = VK_NULL_HANDLE;
+            destination.imageView = m_PyramidLevelViews[level];
+            destination.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            writes[level * 2 + 0].dstSet = m_PyramidSets[level];
+            writes[level * 2 + 0].dstBinding = 0;
+            writes[level * 2 + 0].descriptorCount = 1;
+            writes[level * 2 + 0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[level * 2 + 0].pImageInfo = &source;
+
+            writes[level * 2 + 1].dstSet = m_PyramidSets[level];
+            writes[level * 2 + 1].dstBinding = 1;
+            writes[level * 2 + 1].descriptorCount = 1;
+            writes[level * 2 + 1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes[level * 2 + 1].pImageInfo = &destination;
+        }
+
+        // The late phase samples the whole chain through the graph's view.
+        VkDescriptorImageInfo pyramidInfo;
+        pyramidInfo.sampler = m_Sampler;
+        pyramidInfo.imageView = graph.GetImageView(pyramid);
+        pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        for (auto& frame : m_Frames) {
+            VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+            write.dstSet = frame.CullSets[static_cast<u32>(CullPhase::Late)];
+            write.dstBinding = 5;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo = &pyramidInfo;
+
+            writes.push_back(write);
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void OcclusionCuller::ReleaseTargets()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        for (VkImageView view : m_PyramidLevelViews)
+            vkDestroyImageView(device, view, nullptr);
+        m_PyramidLevelViews.clear();
+
+        if (m_DepthView != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, m_DepthView, nullptr);
+            m_DepthView = VK_NULL_HANDLE;
+        }
+
+        if (!m_PyramidSets.empty()) {
+            VK_CHECK(vkResetDescriptorPool(device, m_PyramidDescriptorPool, 0));
+            m_PyramidSets.clear();
+        }
+
+        m_PyramidExtent = { 0, 0 };
+    }
+
+    void OcclusionCuller::SetScene(const glm::mat4& view, const glm::mat4& projection, VkBuffer instances, u32 instanceCount)
+    {
+        FrameData& frame = m_Frames[m_FrameIndex];
+
+        if (frame.Instances != instances) {
+            VkDescriptorBufferInfo instanceInfo = { instances, 0, VK_WHOLE_SIZE };
+
+            std::array<VkWriteDescriptorSet, 2> writes;
+            for (u32 phase = 0; phase < 2; ++phase) {
+                writes[phase] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+                writes[phase].dstSet = frame.CullSets[phase];
+                writes[phase].dstBinding = 1;
+                writes[phase].descriptorCount = 1;
+                writes[phase].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[phase].pBufferInfo = &instanceInfo;
+            }
+
+            vkUpdateDescriptorSets(m_Renderer.GetDevice(), static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+            frame.Instances = instances;
+        }
+
+        frame.InstanceCount = std::min(instanceCount, s_MaxInstances);
+
+        Frustum frustum = Frustum::FromMatrix(projection * view);
+
+        // Reverse-Z puts the near plane at depth 1.
+        glm::vec4 nearPoint = glm::inverse(projection) * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        CullData data;
+        data.View = view;
+        for (u32 i = 0; i < Frustum::Count; ++i)
+            data.FrustumPlanes[i] = frustum.Planes[i];
+        data.Projection = glm::vec4(projection[0][0], std::abs(projection[1][1]), -nearPoint.z / nearPoint.w, 0.0f);
+        data.DepthTransform = glm::vec2(projection[2][2], projection[3][2]);
+        data.PyramidSize = glm::vec2(static_cast<f32>(m_PyramidExtent.width), static_cast<f32>(m_PyramidExtent.height));
+        data.InstanceCount = frame.InstanceCount;
+        data.PyramidLevels = static_cast<u32>(m_PyramidLevelViews.size());
+
+        std::memcpy(frame.CullData.Mapped, &data, sizeof(CullData));
+    }
+
+    void OcclusionCuller::RecordCull(VkCommandBuffer commandBuffer, CullPhase phase)
+    {
+        const FrameData& frame = m_Frames[m_FrameIndex];
+        if (frame.InstanceCount == 0)
+            return;
+
+        u32 index = static_cast<u32>(phase);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, phase == CullPhase::Early ? m_CullEarlyPipeline : m_CullLatePipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipelineLayout, 0, 1, &frame.CullSets[index], 0, nullptr);
+        vkCmdDispatch(commandBuffer, (frame.InstanceCount + s_CullGroupSize - 1) / s_CullGroupSize, 1, 1);
+
+        if (phase == CullPhase::Late) {
+            // Counters are read on the host once the frame slot comes around again.
+            VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+            VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+            dependencyInfo.memoryBarrierCount = 1;
+            dependencyInfo.pMemoryBarriers = &barrier;
+
+            vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+        }
+    }
+
+    void OcclusionCuller::RecordPyramid(VkCommandBuffer commandBuffer)
+    {
+        if (m_PyramidSets.empty())
+            return;
+
+        // Each level reads the previous one, the graph only synchronizes the pass as a whole.
+        VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+
+        VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        if (m_DepthSamples != VK_SAMPLE_COUNT_1_BIT) {
+            i32 samples = static_cast<i32>(m_DepthSamples);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_DepthMSPipeline);
+            vkCmdPushConstants(commandBuffer, m_PyramidPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(i32), &samples);
+        } else {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_DepthPipeline);
+        }
+
+        for (u32 level = 0; level < m_PyramidSets.size(); ++level) {
+            if (level > 0) {
+                vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+                if (level == 1)
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ReducePipeline);
+            }
+
+            u32 width = std::max(m_PyramidExtent.width >> level, 1u);
+            u32 height = std::max(m_PyramidExtent.height >> level, 1u);
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PyramidPipelineLayout, 0, 1, &m_PyramidSets[level], 0, nullptr);
+            vkCmdDispatch(commandBuffer, (width + s_PyramidGroupSize - 1) / s_PyramidGroupSize, (height + s_PyramidGroupSize - 1) / s_PyramidGroupSize, 1);
+        }
+    }
+
+    void OcclusionCuller::CreateDescriptors()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+
+        // Only the late phase samples the pyramid, both phases share one layout.
+        m_CullPipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "OcclusionCullEarly.comp", "OcclusionCullLate.comp" }));
+        m_CullSetLayout = layouts.GetSetLayouts(m_CullPipelineLayout).at(0);
+
+        // The push constant is the sample count of the multisampled depth variant.
+        m_PyramidPipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "HiZDepth.comp", "HiZDepthMS.comp", "HiZReduce.comp" }));
+        m_PyramidSetLayout = layouts.GetSetLayouts(m_PyramidPipelineLayout).at(0);
+
+        u32 frames = static_cast<u32>(Renderer::GetFramesInFlight());
+
+        std::array<VkDescriptorPoolSize, 3> cullPoolSizes = {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frames * 2 },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frames * 2 * 4 },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frames * 2 }
+        };
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = frames * 2;
+        poolInfo.poolSizeCount = static_cast<u32>(cullPoolSizes.size());
+        poolInfo.pPoolSizes = cullPoolSizes.data();
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        std::array<VkDescriptorPoolSize, 2> pyramidPoolSizes = {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, s_MaxPyramidLevels },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, s_MaxPyramidLevels }
+        };
+
+        poolInfo.maxSets = s_MaxPyramidLevels;
+        poolInfo.poolSizeCount = static_cast<u32>(pyramidPoolSizes.size());
+        poolInfo.pPoolSizes = pyramidPoolSizes.data();
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_PyramidDescriptorPool));
+    }
+
+    void OcclusionCuller::CreatePipelines()
+    {
+        auto create = [this](VkPipeline& pipeline, const std::string& name, VkPipelineLayout layout) {
+            auto build = [this, name, layout]() { return CreateComputePipeline("shaders/" + name + ".spv", layout); };
+
+            pipeline = build();
+            m_Renderer.GetShaderReloader().Watch(pipeline, layout, { name }, build);
+        };
+
+        create(m_CullEarlyPipeline, "OcclusionCullEarly.comp", m_CullPipelineLayout);
+        create(m_CullLatePipeline, "OcclusionCullLate.comp", m_CullPipelineLayout);
+        create(m_DepthPipeline, "HiZDepth.comp", m_PyramidPipelineLayout);
+        create(m_DepthMSPipeline, "HiZDepthMS.comp", m_PyramidPipelineLayout);
+        create(m_ReducePipeline, "HiZReduce.comp", m_PyramidPipelineLayout);
+    }
+
+    VkPipeline OcclusionCuller::CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout)
+    {
+        VkShaderModule shader = m_Renderer.LoadShader(filepath);
+
+        VkComputePipelineCreateInfo createInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+        createInfo.stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+        createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        createInfo.stage.module = shader;
+        createInfo.stage.pName = "main";
+        createInfo.layout = layout;
+        createInfo.basePipelineIndex = -1;
+
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK(vkCreateComputePipelines(m_Renderer.GetDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline));
+
+        vkDestroyShaderModule(m_Renderer.GetDevice(), shader, nullptr);
+
+        return pipeline;
+    }
+
+    OcclusionCuller::Buffer OcclusionCuller::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    {
+        Buffer buffer;
+        m_Renderer.CreateBuffer(size, usage, properties, buffer.Buffer, buffer.Memory, "OcclusionCuller");
+
+        if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            VK_CHECK(vkMapMemory(m_Renderer.GetDevice(), buffer.Memory, 0, size, 0, &buffer.Mapped));
+
+        return buffer;
+    }
+
+    void OcclusionCuller::DestroyBuffer(Buffer& buffer)
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        if (buffer.Mapped != nullptr)
+            vkUnmapMemory(device, buffer.Memory);
+
+        vkDestroyBuffer(device, buffer.Buffer, nullptr);
+        m_Renderer.FreeMemory(buffer.Memory);
+
+        buffer = Buffer();
+    }
+
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "RenderGraph.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    struct OcclusionCullerStats
+    {
+        u32 InstanceCount { 0 };
+        // Visible last frame and drawn before the pyramid is built.
+        u32 EarlyDrawn { 0 };
+        // Newly visible this frame, drawn after the second test.
+        u32 LateDrawn { 0 };
+        u32 FrustumCulled { 0 };
+        u32 OcclusionCulled { 0 };
+    };
+
+    enum class CullPhase : u8
+    {
+        Early,
+        Late
+    };
+
+    // Two phase GPU occlusion culling against a hierarchical depth buffer.
+    //
+    // The early phase draws every instance that was visible last frame into the
+    // depth prepass, a min-reduced depth pyramid (Hi-Z) is built from that depth,
+    // and the late phase tests every instance against the pyramid. Instances that
+    // pass the late test but were not drawn early are drawn in a second depth
+    // pass, so objects that become visible are never missing for a frame. The
+    // visibility written by the late phase feeds the early phase of the next frame.
+    //
+    // Each phase writes one VkDrawIndexedIndirectCommand per instance, culled
+    // instances get an instance count of 0. Counters are read back once the
+    // frame slot is reused, so GetStats() lags by the frames in flight.
+    class OcclusionCuller
+    {
+    public:
+        OcclusionCuller(Renderer& renderer);
+        ~OcclusionCuller();
+
+        OcclusionCuller(const OcclusionCuller&) = delete;
+        OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+        // Collects the counters of the frame that last used this frame slot.
+        void BeginFrame();
+
+        // Points the pyramid passes at the depth buffer and pyramid image of a
+        // freshly compiled graph. Must be called whenever the graph is rebuilt.
+        void SetTargets(const RenderGraph& graph, RenderGraphResource depth, RenderGraphResource pyramid);
+        void ReleaseTargets();
+
+        // instances holds instanceCount MeshRenderer instance records for this frame.
+        void SetScene(const glm::mat4& view, const glm::mat4& projection, VkBuffer instances, u32 instanceCount);
+
+        void RecordCull(VkCommandBuffer commandBuffer, CullPhase phase);
+        void RecordPyramid(VkCommandBuffer commandBuffer);
+
+        inline VkBuffer GetDrawBuffer(CullPhase phase) const { return m_Frames[m_FrameIndex].Draws[static_cast<u32>(phase)].Buffer; }
+        inline VkBuffer GetVisibilityBuffer() const { return m_Visibility.Buffer; }
+        inline static constexpr VkDeviceSize GetDrawBufferSize() { return sizeof(VkDrawIndexedIndirectCommand) * s_MaxInstances; }
+        inline static constexpr VkDeviceSize GetVisibilityBufferSize() { return sizeof(u32) * s_MaxInstances; }
+
+        // Level 0 is the largest power of two that fits the depth buffer, so
+        // every level halves exactly and texel footprints line up across levels.
+        static RenderGraphImageDesc GetPyramidDesc(VkExtent2D extent);
+
+        inline const OcclusionCullerStats& GetStats() const { return m_Stats; }
+
+    public:
+        inline static constexpr u32 s_MaxInstances { 65536 };
+
+    private:
+        struct CullData
+        {
+            glm::mat4 View;
+            std::array<glm::vec4, 6> FrustumPlanes;
+            glm::vec4 Projection;
+            glm::vec2 DepthTransform;
+            glm::vec2 PyramidSize;
+            u32 InstanceCount;
+            u32 PyramidLevels;
+            u32 Padding[2];
+        };
+
+        struct Counters
+        {
+            u32 EarlyDrawn;
+            u32 LateDrawn;
+            u32 FrustumCulled;
+            u32 OcclusionCulled;
+        };
+
+        struct Buffer
+        {
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            void* Mapped { nullptr };
+        };
+
+        struct FrameData
+        {
+            Buffer CullData;
+            Buffer Counters;
+            std::array<Buffer, 2> Draws;
+            std::array<VkDescriptorSet, 2> CullSets { VK_NULL_HANDLE, VK_NULL_HANDLE };
+
+            // Instance buffer the sets currently point at.
+            VkBuffer Instances { VK_NULL_HANDLE };
+            u32 InstanceCount { 0 };
+        };
+
+    private:
+        void CreateDescriptors();
+        void CreatePipelines();
+
+        VkPipeline CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout);
+
+        Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        void DestroyBuffer(Buffer& buffer);
+
+    private:
+        Renderer& m_Renderer;
+
+        VkDescriptorSetLayout m_CullSetLayout { VK_NULL_HANDLE };
+        VkDescriptorSetLayout m_PyramidSetLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_CullPipelineLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_PyramidPipelineLayout { VK_NULL_HANDLE };
+
+        VkPipeline m_CullEarlyPipeline { VK_NULL_HANDLE };
+        VkPipeline m_CullLatePipeline { VK_NULL_HANDLE };
+        VkPipeline m_DepthPipeline { VK_NULL_HANDLE };
+        VkPipeline m_DepthMSPipeline { VK_NULL_HANDLE };
+        VkPipeline m_ReducePipeline { VK_NULL_HANDLE };
+
+        VkDescriptorPool m_DescriptorPool { VK_NULL_HANDLE };
+        // Reset whenever the targets change, the level count follows the extent.
+        VkDescriptorPool m_PyramidDescriptorPool { VK_NULL_HANDLE };
+
+        VkSampler m_Sampler { VK_NULL_HANDLE };
+
+        // Indexed by MeshInstanceState::VisibilitySlot, persists across frames.
+        Buffer m_Visibility;
+
+        std::vector<FrameData> m_Frames;
+        usize m_FrameIndex { 0 };
+
+        // Depth-only view of the graph's depth buffer, the graph's own view
+        // includes the stencil aspect for combined formats.
+        VkImageView m_DepthView { VK_NULL_HANDLE };
+        VkSampleCountFlagBits m_DepthSamples { VK_SAMPLE_COUNT_1_BIT };
+
+        // One storage view per level, the culling pass samples the graph's view of the whole chain.
+        std::vector<VkImageView> m_PyramidLevelViews;
+        std::vector<VkDescriptorSet> m_PyramidSets;
+        VkExtent2D m_PyramidExtent { 0, 0 };
+
+        OcclusionCullerStats m_Stats;
+    };
+
+}
@@ -0,0 +1,594 @@
+#include "ParticleSystem.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "QueueTimeline.hpp"
+#include "ShaderReloader.hpp"
+#include "PipelineLayoutCache.hpp"
+
+namespace Graphics {
+
+    // Large steps after a hitch would throw particles through surfaces.
+    static constexpr f32 s_MaxTimeStep = 1.0f / 20.0f;
+
+    ParticleSystem::ParticleSystem(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        static_assert(offsetof(SimulationData, Emitters) == 208, "SimulationData does not match ParticleSimulate.glsl");
+        static_assert(sizeof(Counters) == 48, "Counters do not match ParticleSimulate.glsl");
+        static_assert(sizeof(Particle) == 48, "Particle does not match ParticleSimulate.glsl");
+
+        CreateDescriptors();
+        CreateSimulationPipelines();
+        CreatePipelines();
+
+        VkSamplerCreateInfo samplerInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+        VK_CHECK(vkCreateSampler(m_Renderer.GetDevice(), &samplerInfo, nullptr, &m_Sampler));
+
+        m_Frames.resize(Renderer::GetFramesInFlight());
+
+        for (auto& frame : m_Frames) {
+            frame.Readback = CreateBuffer(sizeof(u32) * s_MaxGroups, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+    }
+
+    ParticleSystem::~ParticleSystem()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        ReleaseTargets();
+
+        for (auto& group : m_Groups)
+            FreeGroup(group);
+        for (auto& group : m_Retired)
+            FreeGroup(group);
+
+        for (auto& frame : m_Frames)
+            DestroyBuffer(frame.Readback);
+
+        vkDestroySampler(device, m_Sampler, nullptr);
+
+        ShaderReloader& reloader = m_Renderer.GetShaderReloader();
+        for (VkPipeline* pipeline : { &m_SimulatePipeline, &m_SimulateDepthPipeline, &m_SimulateDepthMSPipeline })
+            reloader.Unwatch(*pipeline);
+
+        vkDestroyPipeline(device, m_SimulatePipeline, nullptr);
+        vkDestroyPipeline(device, m_SimulateDepthPipeline, nullptr);
+        vkDestroyPipeline(device, m_SimulateDepthMSPipeline, nullptr);
+    }
+
+    void ParticleSystem::BeginFrame()
+    {
+        m_FrameIndex = m_Renderer.GetFrameIndex();
+        FrameData& frame = m_Frames[m_FrameIndex];
+
+        // The slot's last frame has completed, its copies made the counts host visible.
+        const u32* counts = static_cast<const u32*>(frame.Readback.Mapped);
+
+        m_Stats.AliveCount = std::accumulate(counts, counts + frame.GroupCount, u64 { 0 });
+        m_Stats.Emitted = frame.Emitted;
+        m_Stats.GroupCount = static_cast<u32>(m_Groups.size());
+        m_Stats.Capacity = 0;
+        for (const auto& group : m_Groups)
+            m_Stats.Capacity += group.Desc.Capacity;
+
+        frame.GroupCount = 0;
+        frame.Emitted = 0;
+
+        QueueTimeline& timeline = m_Renderer.GetGraphicsTimeline();
+
+        std::erase_if(m_Retired, [&](Group& group) {
+            if (!timeline.IsComplete(group.RetireValue))
+                return false;
+
+            FreeGroup(group);
+            return true;
+        });
+    }
+
+    void ParticleSystem::CreatePipelines()
+    {
+        m_DrawPipeline.Shaders = { "Particle.vert", "Particle.frag" };
+        m_DrawPipeline.Layout = m_DrawPipelineLayout;
+        m_DrawPipeline.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+        // Tested against the scene but never written, particles do not occlude each other.
+        m_DrawPipeline.DepthWrite = false;
+        m_DrawPipeline.DepthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL;
+
+        m_DrawPipeline.Blend = { VK_TRUE,
+            VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE, VK_BLEND_OP_ADD,
+            VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ONE, VK_BLEND_OP_ADD,
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+
+        m_DrawPipeline.ColorFormats = { m_Renderer.GetSceneColorFormat() };
+        m_DrawPipeline.DepthFormat = m_Renderer.GetDepthFormat();
+        m_DrawPipeline.StencilFormat = m_Renderer.GetStencilFormat();
+        m_DrawPipeline.Samples = m_Renderer.GetSampleCount();
+
+        // Particles are drawn as flat sprites while the draw pipeline compiles.
+        m_DrawFallbackPipeline = m_DrawPipeline.GetFallback();
+        m_Renderer.GetPipelineCache().Prewarm(m_DrawFallbackPipeline);
+        m_Renderer.GetPipelineCache().Prewarm(m_DrawPipeline);
+    }
+
+    u32 ParticleSystem::CreateGroup(const ParticleGroupDesc& desc)
+    {
+        if (m_Groups.size() == s_MaxGroups) {
+            LOG_ERROR("Cannot create more than {} particle groups", s_MaxGroups);
+            return ~0u;
+        }
+
+        VkDevice device = m_Renderer.GetDevice();
+
+        Group group;
+        group.Id = m_NextGroupId++;
+        group.Desc = desc;
+        group.Desc.Capacity = std::bit_ceil(std::max(desc.Capacity, s_GroupSize));
+
+        u32 capacity = group.Desc.Capacity;
+
+        group.Particles = CreateBuffer(sizeof(Particle) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        group.Alive = CreateBuffer(sizeof(u32) * capacity * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        group.Dead = CreateBuffer(sizeof(u32) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        group.Counters = CreateBuffer(sizeof(Counters) * 2,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Every particle starts out dead, both lists empty.
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        VkDeviceSize deadSize = sizeof(u32) * capacity;
+        m_Renderer.CreateBuffer(deadSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory, "ParticleSystem");
+
+        void* data;
+        VK_CHECK(vkMapMemory(device, stagingBufferMemory, 0, deadSize, 0, &data));
+        std::iota(static_cast<u32*>(data), static_cast<u32*>(data) + capacity, 0u);
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        std::array<Counters, 2> counters {};
+        for (auto& list : counters) {
+            list.Dispatch = { s_EmitGroups, 1, 1 };
+            list.Draw = { 4, 0, 0, 0 };
+            list.DeadHead = 0;
+            list.DeadTail = capacity;
+        }
+
+        m_Renderer.ImmediateSubmit([&](VkCommandBuffer commandBuffer) {
+            VkBufferCopy region = { 0, 0, deadSize };
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer, group.Dead.Buffer, 1, &region);
+            vkCmdUpdateBuffer(commandBuffer, group.Counters.Buffer, 0, sizeof(counters), counters.data());
+        });
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        m_Renderer.FreeMemory(stagingBufferMemory);
+
+        u32 frames = static_cast<u32>(Renderer::GetFramesInFlight());
+
+        std::array<VkDescriptorPoolSize, 3> poolSizes = {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frames },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frames * 4 + 2 },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frames }
+        };
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = frames + 1;
+        poolInfo.poolSizeCount = static_cast<u32>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &group.DescriptorPool));
+
+        std::vector<VkDescriptorSetLayout> layouts(frames, m_SimulationSetLayout);
+        layouts.push_back(m_DrawSetLayout);
+
+        std::vector<VkDescriptorSet> sets(layouts.size());
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = group.DescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<u32>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, sets.data()));
+
+        group.DrawSet = sets.back();
+        group.SimulationSets.assign(sets.begin(), sets.end() - 1);
+
+        VkDescriptorBufferInfo particleInfo = { group.Particles.Buffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo aliveInfo = { group.Alive.Buffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo deadInfo = { group.Dead.Buffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo counterInfo = { group.Counters.Buffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorImageInfo depthInfo = { m_Sampler, m_DepthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        group.Simulation.resize(frames);
+        std::vector<VkDescriptorBufferInfo> simulationInfos(frames);
+        std::vector<VkWriteDescriptorSet> writes;
+
+        auto write = [&](VkDescriptorSet set, u32 binding, VkDescriptorType type, const VkDescriptorBufferInfo* bufferInfo, const VkDescriptorImageInfo* imageInfo = nullptr) {
+            VkWriteDescriptorSet& entry = writes.emplace_back(VkWriteDescriptorSet { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+            entry.dstSet = set;
+            entry.dstBinding = binding;
+            entry.descriptorCount = 1;
+            entry.descriptorType = type;
+            entry.pBufferInfo = bufferInfo;
+            entry.pImageInfo = imageInfo;
+        };
+
+        for (u32 i = 0; i < frames; ++i) {
+            group.Simulation[i] = CreateBuffer(sizeof(SimulationData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            simulationInfos[i] = { group.Simulation[i].Buffer, 0, sizeof(SimulationData) };
+
+            write(group.SimulationSets[i], 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &simulationInfos[i]);
+            write(group.SimulationSets[i], 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &particleInfo);
+            write(group.SimulationSets[i], 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &aliveInfo);
+            write(group.SimulationSets[i], 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &deadInfo);
+            write(group.SimulationSets[i], 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &counterInfo);
+
+            if (m_DepthView != VK_NULL_HANDLE)
+                write(group.SimulationSets[i], 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nullptr, &depthInfo);
+        }
+
+        write(group.DrawSet, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &particleInfo);
+        write(group.DrawSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &aliveInfo);
+
+        vkUpdateDescriptorSets(device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+
+        LOG_INFO("Particle group {}: {} particles, {:.1f} MiB", group.Id, capacity,
+            static_cast<f64>((sizeof(Particle) + sizeof(u32) * 3) * capacity) / (1024.0 * 1024.0));
+
+        m_Groups.push_back(std::move(group));
+
+        return m_Groups.back().Id;
+    }
+
+    void ParticleSystem::DestroyGroup(u32 group)
+    {
+        auto it = std::find_if(m_Groups.begin(), m_Groups.end(), [&](const Group& candidate) { return candidate.Id == group; });
+        if (it == m_Groups.end())
+            return;
+
+        // The frame being recorded may already reference it.
+        it->RetireValue = m_Renderer.GetGraphicsTimeline().GetPendingValue();
+
+        m_Retired.push_back(std::move(*it));
+        m_Groups.erase(it);
+    }
+
+    void ParticleSystem::SetEmitters(u32 group, std::span<const ParticleEmitter> emitters)
+    {
+        Group* target = FindGroup(group);
+        if (target == nullptr)
+            return;
+
+        if (emitters.size() > s_MaxEmitters) {
+            LOG_WARN("Particle group {} has {} emitters, only the first {} emit", group, emitters.size(), s_MaxEmitters);
+            emitters = emitters.first(s_MaxEmitters);
+        }
+
+        target->Emitters.assign(emitters.begin(), emitters.end());
+        target->EmitRemainders.resize(emitters.size(), 0.0f);
+    }
+
+    void ParticleSystem::SetTargets(const RenderGraph& graph, RenderGraphResource depth)
+    {
+        ReleaseTargets();
+
+        const RenderGraphImageDesc& depthDesc = graph.GetImageDesc(depth);
+
+        m_DepthSamples = depthDesc.Samples;
+        m_DepthExtent = depthDesc.Extent;
+
+        // The graph's own view includes the stencil aspect for combined formats.
+        VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        viewInfo.image = graph.GetImage(depth);
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = depthDesc.Format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+        VK_CHECK(vkCreateImageView(m_Renderer.GetDevice(), &viewInfo, nullptr, &m_DepthView));
+
+        VkDescriptorImageInfo depthInfo = { m_Sampler, m_DepthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        std::vector<VkWriteDescriptorSet> writes;
+
+        for (const auto& group : m_Groups) {
+            for (VkDescriptorSet set : group.SimulationSets) {
+                VkWriteDescriptorSet& write = writes.emplace_back(VkWriteDescriptorSet { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+                write.dstSet = set;
+                write.dstBinding = 5;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                write.pImageInfo = &depthInfo;
+            }
+        }
+
+        vkUpdateDescriptorSets(m_Renderer.GetDevice(), static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void ParticleSystem::ReleaseTargets()
+    {
+        if (m_DepthView != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_Renderer.GetDevice(), m_DepthView, nullptr);
+            m_DepthView = VK_NULL_HANDLE;
+        }
+
+        m_DepthExtent = { 0, 0 };
+    }
+
+    u32 ParticleSystem::UpdateSimulation(Group& group, f32 deltaTime)
+    {
+        const Graphics::FrameData& frameData = m_Renderer.GetFrameData();
+
+        SimulationData data {};
+        data.ViewProjection = frameData.ViewProjection;
+        data.InverseViewProjection = glm::inverse(frameData.ViewProjection);
+        data.CameraPosition = frameData.CameraPosition;
+        data.Gravity = glm::vec4(group.Desc.Gravity, group.Desc.Drag);
+        data.DepthSize = glm::vec2(static_cast<f32>(m_DepthExtent.width), static_cast<f32>(m_DepthExtent.height));
+        data.DeltaTime = deltaTime;
+        data.Restitution = group.Desc.Restitution;
+        data.Thickness = group.Desc.Thickness;
+        data.EmitterCount = static_cast<u32>(group.Emitters.size());
+        data.Seed = m_FrameCount * 0x9E3779B9u ^ group.Id;
+        data.Capacity = group.Desc.Capacity;
+
+        // Emission threads are handed out to the emitters in order, each
+        // emitter's first thread is the sum of the counts before it.
+        u32 maxEmitted = std::min(s_EmitGroups * s_GroupSize, group.Desc.Capacity);
+        u32 emitted = 0;
+
+        for (usize i = 0; i < group.Emitters.size(); ++i) {
+            const ParticleEmitter& emitter = group.Emitters[i];
+
+            f32& remainder = group.EmitRemainders[i];
+            remainder += std::max(emitter.Rate, 0.0f) * deltaTime;
+
+            u32 count = std::min(static_cast<u32>(remainder), maxEmitted - emitted);
+            remainder -= std::floor(remainder);
+
+            EmitterData& target = data.Emitters[i];
+            target.PositionRadius = glm::vec4(emitter.Position, emitter.Radius);
+            target.VelocitySpread = glm::vec4(emitter.Velocity, emitter.Spread);
+            target.StartColor = emitter.StartColor;
+            target.EndColor = emitter.EndColor;
+            target.Shape = glm::vec4(emitter.Lifetime, emitter.LifetimeVariance, emitter.StartSize, emitter.EndSize);
+            target.Range = glm::uvec4(emitted, count, 0, 0);
+
+            emitted += count;
+        }
+
+        data.EmitCount = emitted;
+
+        // Copied up to the last emitter, the rest of the array is never read.
+        usize size = offsetof(SimulationData, Emitters) + sizeof(EmitterData) * group.Emitters.size();
+        std::memcpy(group.Simulation[m_FrameIndex].Mapped, &data, size);
+
+        return emitted;
+    }
+
+    void ParticleSystem::RecordSimulation(VkCommandBuffer commandBuffer)
+    {
+        if (m_Groups.empty())
+            return;
+
+        FrameData& frame = m_Frames[m_FrameIndex];
+
+        f32 deltaTime = m_FixedTimeStep > 0.0f ? m_FixedTimeStep : std::min(m_Renderer.GetFrameData().DeltaTime, s_MaxTimeStep);
+
+        for (auto& group : m_Groups)
+            frame.Emitted += UpdateSimulation(group, deltaTime);
+
+        m_FrameCount++;
+
+        // Last frame's dispatch, draw and count copies are done with the
+        // buffers before the lists are reset and simulated again.
+        VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+        VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+        // The list appended to this frame starts out empty with only the
+        // emission groups to dispatch, and inherits the dead ring.
+        static constexpr std::array<u32, 7> emptyList = { s_EmitGroups, 1, 1, 4, 0, 0, 0 };
+        static_assert(sizeof(emptyList) == offsetof(Counters, DeadHead));
+
+        for (const auto& group : m_Groups) {
+            VkDeviceSize current = sizeof(Counters) * group.Current;
+            VkDeviceSize next = sizeof(Counters) * (group.Current ^ 1);
+
+            vkCmdUpdateBuffer(commandBuffer, group.Counters.Buffer, next, sizeof(emptyList), emptyList.data());
+
+            VkBufferCopy region = { current + offsetof(Counters, DeadHead), next + offsetof(Counters, DeadHead), sizeof(u32) * 2 };
+            vkCmdCopyBuffer(commandBuffer, group.Counters.Buffer, group.Counters.Buffer, 1, &region);
+        }
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+        VkPipeline bound = VK_NULL_HANDLE;
+
+        for (auto& group : m_Groups) {
+            VkPipeline pipeline = m_SimulatePipeline;
+            if (group.Desc.Collisions && m_DepthView != VK_NULL_HANDLE)
+                pipeline = m_DepthSamples != VK_SAMPLE_COUNT_1_BIT ? m_SimulateDepthMSPipeline : m_SimulateDepthPipeline;
+
+            if (pipeline != bound) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                bound = pipeline;
+            }
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_SimulationPipelineLayout, 0, 1, &group.SimulationSets[m_FrameIndex], 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_SimulationPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(u32), &group.Current);
+            vkCmdDispatchIndirect(commandBuffer, group.Counters.Buffer, sizeof(Counters) * group.Current);
+
+            // What the dispatch appended to is drawn, and simulated next frame.
+            group.Current ^= 1;
+        }
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+        // Alive counts are read on the host once the frame slot comes around again.
+        for (u32 i = 0; i < m_Groups.size(); ++i) {
+            const Group& group = m_Groups[i];
+
+            VkBufferCopy region = { sizeof(Counters) * group.Current + offsetof(Counters, Draw) + offsetof(VkDrawIndirectCommand, instanceCount), sizeof(u32) * i, sizeof(u32) };
+            vkCmdCopyBuffer(commandBuffer, group.Counters.Buffer, frame.Readback.Buffer, 1, &region);
+        }
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+        frame.GroupCount = static_cast<u32>(m_Groups.size());
+    }
+
+    void ParticleSystem::Record(VkCommandBuffer commandBuffer)
+    {
+        if (m_Groups.empty())
+            return;
+
+        VkPipeline pipeline = m_Renderer.GetPipelineCache().Get(m_DrawPipeline, m_DrawFallbackPipeline);
+        if (pipeline == VK_NULL_HANDLE)
+            return;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        m_Renderer.BindFrameData(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DrawPipelineLayout);
+
+        for (const auto& group : m_Groups) {
+            u32 firstAlive = group.Current * group.Desc.Capacity;
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DrawPipelineLayout, 1, 1, &group.DrawSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_DrawPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(u32), &firstAlive);
+            vkCmdDrawIndirect(commandBuffer, group.Counters.Buffer, sizeof(Counters) * group.Current + offsetof(Counters, Draw), 1, sizeof(VkDrawIndirectCommand));
+        }
+    }
+
+    void ParticleSystem::CreateDescriptors()
+    {
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+
+        // The variants share one layout, only the depth ones read binding 5.
+        m_SimulationPipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "ParticleSimulate.comp", "ParticleSimulateDepth.comp", "ParticleSimulateDepthMS.comp" }));
+        m_SimulationSetLayout = layouts.GetSetLayouts(m_SimulationPipelineLayout).at(0);
+
+        // Set 0 is the frame data, set 1 the group's particles and alive lists.
+        ShaderReflection reflection = m_Renderer.ReflectShaders({ "Particle.vert", "Particle.frag" });
+        m_Renderer.DeclareFrameData(reflection);
+
+        m_DrawPipelineLayout = layouts.GetPipelineLayout(reflection);
+        m_DrawSetLayout = layouts.GetSetLayouts(m_DrawPipelineLayout).at(1);
+    }
+
+    void ParticleSystem::CreateSimulationPipelines()
+    {
+        auto create = [this](VkPipeline& pipeline, const std::string& name) {
+            auto build = [this, name]() { return CreateComputePipeline("shaders/" + name + ".spv", m_SimulationPipelineLayout); };
+
+            pipeline = build();
+            m_Renderer.GetShaderReloader().Watch(pipeline, m_SimulationPipelineLayout, { name }, build);
+        };
+
+        create(m_SimulatePipeline, "ParticleSimulate.comp");
+        create(m_SimulateDepthPipeline, "ParticleSimulateDepth.comp");
+        create(m_SimulateDepthMSPipeline, "ParticleSimulateDepthMS.comp");
+    }
+
+    VkPipeline ParticleSystem::CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout)
+    {
+        VkShaderModule shader = m_Renderer.LoadShader(filepath);
+
+        VkComputePipelineCreateInfo createInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+        createInfo.stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+        createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        createInfo.stage.module = shader;
+        createInfo.stage.pName = "main";
+        createInfo.layout = layout;
+        createInfo.basePipelineIndex = -1;
+
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK(vkCreateComputePipelines(m_Renderer.GetDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline));
+
+        vkDestroyShaderModule(m_Renderer.GetDevice(), shader, nullptr);
+
+        return pipeline;
+    }
+
+    ParticleSystem::Group* ParticleSystem::FindGroup(u32 id)
+    {
+        auto it = std::find_if(m_Groups.begin(), m_Groups.end(), [&](const Group& group) { return group.Id == id; });
+        return it != m_Groups.end() ? &*it : nullptr;
+    }
+
+    void ParticleSystem::FreeGroup(Group& group)
+    {
+        DestroyBuffer(group.Particles);
+        DestroyBuffer(group.Alive);
+        DestroyBuffer(group.Dead);
+        DestroyBuffer(group.Counters);
+
+        for (auto& buffer : group.Simulation)
+            DestroyBuffer(buffer);
+
+        vkDestroyDescriptorPool(m_Renderer.GetDevice(), group.DescriptorPool, nullptr);
+        group.DescriptorPool = VK_NULL_HANDLE;
+    }
+
+    ParticleSystem::Buffer ParticleSystem::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    {
+        Buffer buffer;
+        m_Renderer.CreateBuffer(size, usage, properties, buffer.Buffer, buffer.Memory, "ParticleSystem");
+
+        if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            VK_CHECK(vkMapMemory(m_Renderer.GetDevice(), buffer.Memory, 0, size, 0, &buffer.Mapped));
+
+        return buffer;
+    }
+
+    void ParticleSystem::DestroyBuffer(Buffer& buffer)
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        if (buffer.Mapped != nullptr)
+            vkUnmapMemory(device, buffer.Memory);
+
+        vkDestroyBuffer(device, buffer.Buffer, nullptr);
+        m_Renderer.FreeMemory(buffer.Memory);
+
+        buffer = Buffer();
+    }
+
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "RenderGraph.hpp"
+#include "PipelineCache.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    struct ParticleEmitter
+    {
+        glm::vec3 Position { 0.0f };
+        // Particles spawn anywhere inside a sphere of this radius.
+        f32 Radius { 0.0f };
+        glm::vec3 Velocity { 0.0f, 1.0f, 0.0f };
+        // Length of a random velocity added in any direction.
+        f32 Spread { 0.5f };
+
+        // Interpolated over each particle's lifetime, like the size.
+        glm::vec4 StartColor { 1.0f };
+        glm::vec4 EndColor { 1.0f, 1.0f, 1.0f, 0.0f };
+        f32 StartSize { 0.05f };
+        f32 EndSize { 0.05f };
+
+        // Seconds, each particle lives up to LifetimeVariance longer or shorter.
+        f32 Lifetime { 2.0f };
+        f32 LifetimeVariance { 0.0f };
+        // Particles per second.
+        f32 Rate { 1000.0f };
+    };
+
+    struct ParticleGroupDesc
+    {
+        // Rounded up to a power of two. Emission stops while every particle is alive.
+        u32 Capacity { 1u << 20 };
+
+        glm::vec3 Gravity { 0.0f, -9.81f, 0.0f };
+        // Velocity is divided by 1 + Drag * dt every step.
+        f32 Drag { 0.0f };
+
+        // Against the depth buffer, so only with the depth prepass and only
+        // with what the camera sees.
+        bool Collisions { true };
+        // Fraction of the velocity into a surface that is kept, reversed.
+        f32 Restitution { 0.4f };
+        // How far behind the visible surface a particle still collides.
+        f32 Thickness { 0.5f };
+    };
+
+    struct ParticleSystemStats
+    {
+        u32 GroupCount { 0 };
+        u64 Capacity { 0 };
+        u64 AliveCount { 0 };
+        // Particles requested from the emitters for the frame.
+        u32 Emitted { 0 };
+    };
+
+    // GPU particles in groups that share a pool, forces and collision settings.
+    //
+    // A group's frame is a single indirect dispatch that emits, simulates and
+    // compacts: emission threads take indices from a ring of dead particles,
+    // simulation threads walk this frame's alive list, and both append what is
+    // alive to the other list. Appends build that list's dispatch and draw
+    // commands on the GPU, so the CPU only uploads the emitters and records one
+    // vkCmdDispatchIndirect and one vkCmdDrawIndirect per group, whatever the
+    // number of particles.
+    //
+    // Alive counts are read back once the frame slot is reused, so GetStats()
+    // lags by the frames in flight.
+    class ParticleSystem
+    {
+    public:
+        ParticleSystem(Renderer& renderer);
+        ~ParticleSystem();
+
+        ParticleSystem(const ParticleSystem&) = delete;
+        ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+        // Collects the counts of the frame that last used this frame slot and
+        // frees destroyed groups the GPU is done with.
+        void BeginFrame();
+
+        // The draw pipeline depends on the attachment formats and sample count.
+        void CreatePipelines();
+
+        // Returns a handle for the other calls, or ~0u once s_MaxGroups exist.
+        // Waits for the initial upload of the dead ring.
+        u32 CreateGroup(const ParticleGroupDesc& desc);
+        // The group's particles disappear from the next frame on.
+        void DestroyGroup(u32 group);
+        inline bool HasGroups() const { return !m_Groups.empty(); }
+
+        // Replaces the group's emitters, at most s_MaxEmitters.
+        void SetEmitters(u32 group, std::span<const ParticleEmitter> emitters);
+
+        // Steps by a fixed time instead of the frame time, 0 to follow the
+        // frame time again. Runs with a fixed step spawn the same particles.
+        inline void SetFixedTimeStep(f32 seconds) { m_FixedTimeStep = seconds; }
+
+        // Points collisions at the depth buffer of a freshly compiled graph.
+        // Must be called whenever the graph is rebuilt.
+        void SetTargets(const RenderGraph& graph, RenderGraphResource depth);
+        void ReleaseTargets();
+
+        // Emits and simulates every group, in a compute pass after the depth
+        // prepass. Record() draws them in a pass over the scene's attachments.
+        void RecordSimulation(VkCommandBuffer commandBuffer);
+        void Record(VkCommandBuffer commandBuffer);
+
+        inline const ParticleSystemStats& GetStats() const { return m_Stats; }
+
+    public:
+        inline static constexpr u32 s_GroupSize { 256 };
+        // Workgroups of every dispatch that emit, so up to 65536 particles per
+        // group and frame. The dispatch is built before the emitter counts are known.
+        inline static constexpr u32 s_EmitGroups { 256 };
+        inline static constexpr u32 s_MaxEmitters { 32 };
+        inline static constexpr u32 s_MaxGroups { 16 };
+
+    private:
+        struct EmitterData
+        {
+            glm::vec4 PositionRadius;
+            glm::vec4 VelocitySpread;
+            glm::vec4 StartColor;
+            glm::vec4 EndColor;
+            glm::vec4 Shape;
+            glm::uvec4 Range;
+        };
+
+        struct SimulationData
+        {
+            glm::mat4 ViewProjection;
+            glm::mat4 InverseViewProjection;
+            glm::vec4 CameraPosition;
+            glm::vec4 Gravity;
+            glm::vec2 DepthSize;
+            f32 DeltaTime;
+            f32 Restitution;
+            f32 Thickness;
+            u32 EmitCount;
+            u32 EmitterCount;
+            u32 Seed;
+            u32 Capacity;
+            u32 Padding[3];
+            std::array<EmitterData, s_MaxEmitters> Emitters;
+        };
+
+        // Matches ParticleSimulate.glsl, one per alive list.
+        struct Counters
+        {
+            VkDispatchIndirectCommand Dispatch;
+            VkDrawIndirectCommand Draw;
+            u32 DeadHead;
+            u32 DeadTail;
+            u32 Padding[3];
+        };
+
+        struct Particle
+        {
+            glm::vec3 Position;
+            f32 Age;
+            glm::vec3 Velocity;
+            f32 Lifetime;
+            u32 StartColor;
+            u32 EndColor;
+            f32 StartSize;
+            f32 EndSize;
+        };
+
+        struct Buffer
+        {
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            void* Mapped { nullptr };
+        };
+
+        struct Group
+        {
+            u32 Id;
+            ParticleGroupDesc Desc;
+
+            Buffer Particles;
+            Buffer Alive;
+            Buffer Dead;
+            Buffer Counters;
+
+            // Simulation data and the set pointing at it, per frame slot.
+            std::vector<Buffer> Simulation;
+            std::vector<VkDescriptorSet> SimulationSets;
+            VkDescriptorSet DrawSet { VK_NULL_HANDLE };
+            VkDescriptorPool DescriptorPool { VK_NULL_HANDLE };
+
+            std::vector<ParticleEmitter> Emitters;
+            // Fractions of a particle carried over to the next frame.
+            std::vector<f32> EmitRemainders;
+
+            // Alive list the next dispatch simulates, and the last frame drew.
+            u32 Current { 0 };
+            // Graphics timeline value after which a destroyed group may be freed.
+            u64 RetireValue { 0 };
+        };
+
+        struct FrameData
+        {
+            // Alive count of each group simulated in the frame.
+            Buffer Readback;
+            u32 GroupCount { 0 };
+            u32 Emitted { 0 };
+        };
+
+    private:
+        void CreateDescriptors();
+        void CreateSimulationPipelines();
+
+        VkPipeline CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout);
+
+        Group* FindGroup(u32 id);
+        void FreeGroup(Group& group);
+        // Returns the number of particles requested for the frame.
+        u32 UpdateSimulation(Group& group, f32 deltaTime);
+
+        Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        void DestroyBuffer(Buffer& buffer);
+
+    private:
+        Renderer& m_Renderer;
+
+        VkDescriptorSetLayout m_SimulationSetLayout { VK_NULL_HANDLE };
+        VkDescriptorSetLayout m_DrawSetLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_SimulationPipelineLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_DrawPipelineLayout { VK_NULL_HANDLE };
+
+        VkPipeline m_SimulatePipeline { VK_NULL_HANDLE };
+        VkPipeline m_SimulateDepthPipeline { VK_NULL_HANDLE };
+        VkPipeline m_SimulateDepthMSPipeline { VK_NULL_HANDLE };
+        PipelineDesc m_DrawPipeline;
+        PipelineDesc m_DrawFallbackPipeline;
+
+        VkSampler m_Sampler { VK_NULL_HANDLE };
+
+        std::vector<Group> m_Groups;
+        // Destroyed, waiting for the GPU to finish with them.
+        std::vector<Group> m_Retired;
+        u32 m_NextGroupId { 0 };
+
+        std::vector<FrameData> m_Frames;
+        usize m_FrameIndex { 0 };
+        u32 m_FrameCount { 0 };
+
+        f32 m_FixedTimeStep { 0.0f };
+
+        // Depth-only view of the graph's depth buffer, like the occlusion culler's.
+        VkImageView m_DepthView { VK_NULL_HANDLE };
+        VkSampleCountFlagBits m_DepthSamples { VK_SAMPLE_COUNT_1_BIT };
+        VkExtent2D m_DepthExtent { 0, 0 };
+
+        ParticleSystemStats m_Stats;
+    };
+
+}
@@ -0,0 +1,402 @@
+#include "PerfOverlay.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+#include "Renderer2D.hpp"
+#include "MeshRenderer.hpp"
+#include "MemoryTracker.hpp"
+#include "PipelineLayoutCache.hpp"
+
+namespace Graphics {
+
+    // Printable ASCII from ' ' to '~', 5x7 pixels each. Rows are packed top to
+    // bottom, five bits per row with the leftmost pixel in the highest bit.
+    static constexpr std::array<u64, 95> s_Font = {
+        0x000000000, 0x108421004, 0x294a00000, 0x295f57d4a, 0x11f4717c4, 0x632222263,
+        0x32544564d, 0x108800000, 0x088842082, 0x208210888, 0x009575480, 0x0084f9080,
+        0x000003088, 0x0000f8000, 0x00000018c, 0x002222200, 0x3a33ae62e, 0x11842108e,
+        0x3a211111f, 0x7c441062e, 0x08ca97c42, 0x7e1e0862e, 0x1910f462e, 0x7c2222108,
+        0x3a317462e, 0x3a317844c, 0x018c03180, 0x018c03088, 0x088882082, 0x001f07c00,
+        0x208208888, 0x3a2111004, 0x3a216d6ae, 0x3a318fe31, 0x7a31f463e, 0x3a308422e,
+        0x72518c65c, 0x7e10f421f, 0x7e10f4210, 0x3a30bc62f, 0x4631fc631, 0x38842108e,
+        0x1c4210a4c, 0x4654c5251, 0x42108421f, 0x4775ac631, 0x4639ace31, 0x3a318c62e,
+        0x7a31f4210, 0x3a318d64d, 0x7a31f5251, 0x3e107043e, 0x7c8421084, 0x46318c62e,
+        0x46318c544, 0x4631ad6aa, 0x462a22a31, 0x463151084, 0x7c222221f, 0x39084210e,
+        0x020820820, 0x38421084e, 0x115100000, 0x00000001f, 0x208200000, 0x000e0be2f,
+        0x4216cc63e, 0x000e8422e, 0x042d9c62f, 0x000e8fe0e, 0x1928e2108, 0x01f18bc2e,
+        0x4216cc631, 0x100c2108e, 0x080610a4c, 0x4212a6292, 0x30842108e, 0x001aad631,
+        0x0016cc631, 0x000e8c62e, 0x001e8fa10, 0x000d9bc21, 0x0016cc210, 0x000e8383e,
+        0x211c42126, 0x00118c66d, 0x00118c544, 0x00118d6aa, 0x001151151, 0x00118bc2e,
+        0x001f1111f, 0x088441082, 0x108421084, 0x208411088, 0x0008a8800
+    };
+
+    // Atlas of 16x6 cells, a glyph in the top left 5x7 pixels of each 6x8
+    // cell so neighbouring characters are spaced apart. Matches PerfOverlay.vert.
+    static constexpr u32 s_GlyphWidth = 5;
+    static constexpr u32 s_GlyphHeight = 7;
+    static constexpr u32 s_CellWidth = 6;
+    static constexpr u32 s_CellHeight = 8;
+    static constexpr u32 s_AtlasColumns = 16;
+    static constexpr u32 s_AtlasRows = 6;
+    // The cell after '~' is filled, rectangles sample it.
+    static constexpr u32 s_SolidGlyph = static_cast<u32>(s_Font.size());
+
+    // Top of the frame time graph.
+    static constexpr f32 s_GraphMaxTime = 100.0f / 3.0f;
+
+    static constexpr glm::u8vec4 s_BackgroundColor { 0, 0, 0, 160 };
+    static constexpr glm::u8vec4 s_TextColor { 255, 255, 255, 255 };
+    static constexpr glm::u8vec4 s_HeaderColor { 255, 210, 90, 255 };
+    static constexpr glm::u8vec4 s_CPUColor { 90, 170, 255, 255 };
+    static constexpr glm::u8vec4 s_GPUColor { 120, 230, 110, 255 };
+    static constexpr glm::u8vec4 s_TargetColor { 255, 255, 255, 80 };
+
+    PerfOverlay::PerfOverlay(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        CreateAtlas();
+
+        // Set 0 holds the atlas, the push constants the extent.
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+        m_PipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "PerfOverlay.vert", "PerfOverlay.frag" }));
+        VkDescriptorSetLayout setLayout = layouts.GetSetLayouts(m_PipelineLayout).at(0);
+
+        VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &setLayout;
+
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &m_DescriptorSet));
+
+        VkDescriptorImageInfo imageInfo = { m_Atlas->GetSampler(), m_Atlas->GetImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet = m_DescriptorSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+        static constexpr auto instanceLayout = GlyphInstance::Layout();
+        static_assert(instanceLayout.IsValid(), "Vertex attributes overlap or exceed the stride");
+
+        m_Pipeline.Shaders = { "PerfOverlay.vert", "PerfOverlay.frag" };
+        m_Pipeline.Layout = m_PipelineLayout;
+        m_Pipeline.SetVertexLayout(instanceLayout);
+        m_Pipeline.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        m_Pipeline.DepthTest = false;
+        m_Pipeline.DepthWrite = false;
+        m_Pipeline.Blend = { VK_TRUE,
+            VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+            VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+        m_Pipeline.ColorFormats = { m_Renderer.GetColorFormat() };
+
+        // Compiled ahead so the overlay shows up on the first frame it is
+        // enabled, as flat boxes if the text pipeline is not ready yet.
+        m_FallbackPipeline = m_Pipeline.GetFallback();
+        m_Renderer.GetPipelineCache().Prewarm(m_FallbackPipeline);
+        m_Renderer.GetPipelineCache().Prewarm(m_Pipeline);
+
+        m_Frames.resize(Renderer::GetFramesInFlight());
+
+        static constexpr VkDeviceSize bufferSize = sizeof(GlyphInstance) * s_MaxInstances;
+
+        for (auto& frame : m_Frames) {
+            m_Renderer.CreateBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.Buffer, frame.Memory, "PerfOverlay");
+            VK_CHECK(vkMapMemory(device, frame.Memory, 0, bufferSize, 0, reinterpret_cast<void**>(&frame.Instances)));
+        }
+
+        m_Text.reserve(s_MaxInstances);
+        m_Graph.reserve(s_HistorySize * 2);
+    }
+
+    PerfOverlay::~PerfOverlay()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        for (auto& frame : m_Frames) {
+            vkUnmapMemory(device, frame.Memory);
+            vkDestroyBuffer(device, frame.Buffer, nullptr);
+            m_Renderer.FreeMemory(frame.Memory);
+        }
+
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+
+        m_Atlas.reset();
+    }
+
+    void PerfOverlay::CreateAtlas()
+    {
+        constexpr u32 width = s_AtlasColumns * s_CellWidth;
+        constexpr u32 height = s_AtlasRows * s_CellHeight;
+        static_assert(s_SolidGlyph < s_AtlasColumns * s_AtlasRows);
+
+        // White with the glyph coverage in alpha, the instance color tints it.
+        std::vector<u32> pixels(static_cast<usize>(width) * height, 0x00ffffff);
+
+        for (u32 glyph = 0; glyph <= s_SolidGlyph; ++glyph) {
+            u32 originX = (glyph % s_AtlasColumns) * s_CellWidth;
+            u32 originY = (glyph / s_AtlasColumns) * s_CellHeight;
+
+            for (u32 y = 0; y < s_CellHeight; ++y) {
+                for (u32 x = 0; x < s_CellWidth; ++x) {
+                    bool set = glyph == s_SolidGlyph;
+                    if (glyph < s_SolidGlyph && x < s_GlyphWidth && y < s_GlyphHeight)
+                        set = (s_Font[glyph] >> (s_GlyphWidth * s_GlyphHeight - 1 - (y * s_GlyphWidth + x))) & 1;
+
+                    if (set)
+                        pixels[(originY + y) * width + originX + x] = 0xffffffff;
+                }
+            }
+        }
+
+        m_Atlas = std::make_unique<Texture>(m_Renderer, width, height, pixels.data(), VK_FILTER_NEAREST);
+    }
+
+    void PerfOverlay::Reset()
+    {
+        m_CPUHistory.fill(0.0f);
+        m_GPUHistory.fill(0.0f);
+        m_HistoryHead = 0;
+
+        m_SampleCount = 0;
+        m_CPUTime = 0.0;
+        m_GPUTime = 0.0;
+        m_PassTimes.clear();
+
+        m_Text.clear();
+        m_FirstFrame = true;
+    }
+
+    void PerfOverlay::Record(VkCommandBuffer commandBuffer)
+    {
+        Sample();
+
+        // A few refreshes per second keep the numbers readable.
+        if (m_Text.empty() || m_RefreshTimer.Elapsed() >= 0.25f) {
+            BuildText();
+            m_RefreshTimer.Reset();
+        }
+
+        u32 instanceCount = BuildInstances();
+
+        // Rebuilt in place, the swapchain format can change on recreation.
+        m_Pipeline.ColorFormats[0] = m_Renderer.GetColorFormat();
+        m_FallbackPipeline.ColorFormats[0] = m_Renderer.GetColorFormat();
+
+        VkPipeline pipeline = m_Renderer.GetPipelineCache().Get(m_Pipeline, m_FallbackPipeline);
+        if (pipeline == VK_NULL_HANDLE || instanceCount == 0)
+            return;
+
+        VkExtent2D extent = m_Renderer.GetExtent();
+
+        PushConstants constants;
+        constants.InvExtent = 1.0f / glm::vec2(static_cast<f32>(extent.width), static_cast<f32>(extent.height));
+
+        const FrameData& frame = m_Frames[m_Renderer.GetFrameIndex()];
+        VkDeviceSize offset = 0;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &constants);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.Buffer, &offset);
+
+        vkCmdDraw(commandBuffer, 4, instanceCount, 0, 0);
+    }
+
+    void PerfOverlay::Sample()
+    {
+        // The time between two recorded frames, the first one after a pause would be the whole pause.
+        f32 cpuTime = m_FirstFrame ? 0.0f : m_FrameTimer.ElapsedMillis();
+        m_FrameTimer.Reset();
+        m_FirstFrame = false;
+
+        f32 gpuTime = m_Renderer.GetGPUFrameTime();
+
+        m_CPUHistory[m_HistoryHead] = cpuTime;
+        m_GPUHistory[m_HistoryHead] = gpuTime;
+        m_HistoryHead = (m_HistoryHead + 1) % s_HistorySize;
+
+        const std::vector<RenderPassTiming>& passes = m_Renderer.GetPassTimings();
+        if (m_PassTimes.size() != passes.size()) {
+            m_PassTimes.assign(passes.size(), 0.0);
+            m_SampleCount = 0;
+            m_CPUTime = 0.0;
+            m_GPUTime = 0.0;
+        }
+
+        for (usize i = 0; i < passes.size(); ++i)
+            m_PassTimes[i] += passes[i].Time;
+
+        m_CPUTime += cpuTime;
+        m_GPUTime += gpuTime;
+        m_SampleCount++;
+
+        // The stats of the frame being recorded, complete once its scenes have ended.
+        const MeshRendererStats& meshes = m_Renderer.GetMeshRenderer().GetStats();
+        const Renderer2DStats& sprites = m_Renderer.Get2D().GetStats();
+
+        m_DrawCalls = meshes.DrawCalls + sprites.DrawCalls;
+        m_Triangles = meshes.TriangleCount + 2ull * (sprites.QuadCount + sprites.CircleCount);
+    }
+
+    void PerfOverlay::BuildText()
+    {
+        m_Text.clear();
+
+        f32 scale = static_cast<f32>(m_Scale);
+        f32 lineHeight = s_CellHeight * scale;
+        f32 padding = 4.0f * scale;
+
+        glm::vec2 cursor(padding);
+        char line[128];
+
+        // Filled in once the text is laid out and its size is known.
+        AddRect(glm::vec2(0.0f), glm::vec2(0.0f), s_BackgroundColor, m_Text);
+
+        f64 samples = std::max(m_SampleCount, 1u);
+        f64 cpuTime = m_CPUTime / samples;
+        f64 gpuTime = m_GPUTime / samples;
+
+        std::snprintf(line, sizeof(line), "%6.1f FPS", cpuTime > 0.0 ? 1000.0 / cpuTime : 0.0);
+        AddText(cursor, line, s_HeaderColor);
+        cursor.y += lineHeight;
+
+        std::snprintf(line, sizeof(line), "CPU %6.2f ms", cpuTime);
+        AddText(cursor, line, s_CPUColor);
+        std::snprintf(line, sizeof(line), "GPU %6.2f ms", gpuTime);
+        AddText(cursor + glm::vec2(15.0f * s_CellWidth * scale, 0.0f), line, s_GPUColor);
+        cursor.y += lineHeight;
+
+        // One column per frame, the marker at 60 Hz.
+        glm::vec2 graphSize(static_cast<f32>(s_HistorySize) * scale, 32.0f * scale);
+        m_GraphPosition = cursor + glm::vec2(0.0f, scale);
+        AddRect(m_GraphPosition, graphSize, s_BackgroundColor, m_Text);
+        AddRect(m_GraphPosition + glm::vec2(0.0f, graphSize.y * (1.0f - 1000.0f / 60.0f / s_GraphMaxTime)), glm::vec2(graphSize.x, scale), s_TargetColor, m_Text);
+        cursor.y += graphSize.y + 2.0f * scale + lineHeight * 0.5f;
+
+        std::snprintf(line, sizeof(line), "Draws %u  Triangles %.2fM", m_DrawCalls, static_cast<f64>(m_Triangles) / 1e6);
+        AddText(cursor, line, s_TextColor);
+        cursor.y += lineHeight * 1.5f;
+
+        const std::vector<RenderPassTiming>& passes = m_Renderer.GetPassTimings();
+        if (!passes.empty() && passes.size() == m_PassTimes.size()) {
+            AddText(cursor, "Pass              GPU ms", s_HeaderColor);
+            cursor.y += lineHeight;
+
+            for (usize i = 0; i < passes.size(); ++i) {
+                std::snprintf(line, sizeof(line), "%-16.16s %7.3f", passes[i].Name.c_str(), m_PassTimes[i] / samples);
+                AddText(cursor, line, s_TextColor);
+                cursor.y += lineHeight;
+            }
+
+            cursor.y += lineHeight * 0.5f;
+        }
+
+        MemoryStats memory = m_Renderer.GetMemoryTracker().GetStats();
+
+        std::snprintf(line, sizeof(line), "Memory    used / budget MB%s", memory.BudgetSupported ? "" : " (est.)");
+        AddText(cursor, line, s_HeaderColor);
+        cursor.y += lineHeight;
+
+        for (usize i = 0; i < memory.Heaps.size(); ++i) {
+            const MemoryHeapStats& heap = memory.Heaps[i];
+            std::snprintf(line, sizeof(line), "Heap %zu%s %8.1f / %8.1f", i, heap.DeviceLocal ? " VRAM" : " Host",
+                static_cast<f64>(heap.Usage) / (1024.0 * 1024.0), static_cast<f64>(heap.Budget) / (1024.0 * 1024.0));
+            AddText(cursor, line, s_TextColor);
+            cursor.y += lineHeight;
+        }
+
+        for (usize i = 0; i < memory.Categories.size(); ++i) {
+            const MemoryUsage& usage = memory.Categories[i];
+            if (usage.Allocations == 0)
+                continue;
+
+            std::snprintf(line, sizeof(line), "%-12s %8.1f  %5u", ToString(static_cast<MemoryCategory>(i)),
+                static_cast<f64>(usage.Bytes) / (1024.0 * 1024.0), usage.Allocations);
+            AddText(cursor, line, s_TextColor);
+            cursor.y += lineHeight;
+        }
+
+        // Wide enough for the longest line.
+        f32 width = graphSize.x;
+        for (const GlyphInstance& instance : m_Text)
+            width = std::max(width, instance.Position.x + instance.Size.x - padding);
+
+        m_Text[0].Size = glm::vec2(width + 2.0f * padding, cursor.y + padding);
+
+        m_SampleCount = 0;
+        m_CPUTime = 0.0;
+        m_GPUTime = 0.0;
+        std::fill(m_PassTimes.begin(), m_PassTimes.end(), 0.0);
+    }
+
+    u32 PerfOverlay::BuildInstances()
+    {
+        m_Graph.clear();
+
+        f32 scale = static_cast<f32>(m_Scale);
+        f32 graphHeight = 32.0f * scale;
+
+        // Oldest frame on the left, the GPU bar in front of the CPU bar of the same frame.
+        for (u32 i = 0; i < s_HistorySize; ++i) {
+            u32 index = (m_HistoryHead + i) % s_HistorySize;
+            f32 x = m_GraphPosition.x + static_cast<f32>(i) * scale;
+
+            for (auto [time, color] : { std::pair { m_CPUHistory[index], s_CPUColor }, std::pair { m_GPUHistory[index], s_GPUColor } }) {
+                f32 height = std::min(time / s_GraphMaxTime, 1.0f) * graphHeight;
+                if (height > 0.0f)
+                    AddRect(glm::vec2(x, m_GraphPosition.y + graphHeight - height), glm::vec2(scale, height), color, m_Graph);
+            }
+        }
+
+        usize textCount = std::min<usize>(m_Text.size(), s_MaxInstances);
+        usize graphCount = std::min<usize>(m_Graph.size(), s_MaxInstances - textCount);
+
+        // The slot's previous frame has completed, BeginFrame waited for it.
+        GlyphInstance* instances = m_Frames[m_Renderer.GetFrameIndex()].Instances;
+        std::memcpy(instances, m_Text.data(), textCount * sizeof(GlyphInstance));
+        std::memcpy(instances + textCount, m_Graph.data(), graphCount * sizeof(GlyphInstance));
+
+        return static_cast<u32>(textCount + graphCount);
+    }
+
+    void PerfOverlay::AddText(glm::vec2 position, const char* text, glm::u8vec4 color)
+    {
+        glm::vec2 size = glm::vec2(s_CellWidth, s_CellHeight) * static_cast<f32>(m_Scale);
+
+        for (const char* c = text; *c != '\0'; ++c, position.x += size.x) {
+            // Spaces only advance, anything outside printable ASCII shows as '?'.
+            if (*c == ' ')
+                continue;
+
+            u32 glyph = (*c > ' ' && *c <= '~') ? static_cast<u32>(*c - ' ') : static_cast<u32>('?' - ' ');
+            m_Text.push_back({ position, size, color, glyph });
+        }
+    }
+
+    void PerfOverlay::AddRect(glm::vec2 position, glm::vec2 size, glm::u8vec4 color, std::vector<GlyphInstance>& instances)
+    {
+        instances.push_back({ position, size, color, s_SolidGlyph });
+    }
+
+}
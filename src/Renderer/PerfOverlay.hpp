@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include "Types.hpp"
+#include "VertexLayout.hpp"
+#include "PipelineCache.hpp"
+#include "Core/Timer.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+    class Texture;
+
+    // Performance numbers drawn in the top left corner of the backbuffer:
+    // CPU and GPU frame times with a graph of the recent frames, the GPU time
+    // of every render graph pass, draw and triangle counts and device memory
+    // against the budget.
+    //
+    // Text comes from a 5x7 bitmap font baked into the executable and uploaded
+    // once as an atlas. Every glyph and rectangle of the overlay is an instance
+    // of a single quad, so the whole overlay is one instanced draw from a per
+    // frame buffer. Numbers are averaged and the text rebuilt a few times per
+    // second, only the graph changes every frame.
+    class PerfOverlay
+    {
+    public:
+        PerfOverlay(Renderer& renderer);
+        ~PerfOverlay();
+
+        PerfOverlay(const PerfOverlay&) = delete;
+        PerfOverlay& operator=(const PerfOverlay&) = delete;
+
+        // Pixels per font pixel.
+        inline void SetScale(u32 scale) { m_Scale = std::max(scale, 1u); }
+        inline u32 GetScale() const { return m_Scale; }
+
+        // Forgets the history, for when the overlay was not drawn for a while.
+        void Reset();
+
+        // Samples the frame's stats and draws, in a rendering pass over the
+        // single sampled backbuffer.
+        void Record(VkCommandBuffer commandBuffer);
+
+    public:
+        inline static constexpr u32 s_MaxInstances { 4096 };
+        inline static constexpr u32 s_HistorySize { 128 };
+
+    private:
+        // Matches the vertex inputs of PerfOverlay.vert.
+        struct GlyphInstance
+        {
+            // Top left corner and size in pixels.
+            glm::vec2 Position;
+            glm::vec2 Size;
+            glm::u8vec4 Color;
+            // Atlas cell, a character minus ' ' or s_SolidGlyph.
+            u32 Glyph;
+
+            static constexpr auto Layout()
+            {
+                return MakeVertexLayout<GlyphInstance>(VK_VERTEX_INPUT_RATE_INSTANCE,
+                    VERTEX_ATTRIBUTE(GlyphInstance, Position),
+                    VERTEX_ATTRIBUTE(GlyphInstance, Size),
+                    VERTEX_ATTRIBUTE(GlyphInstance, Color),
+                    VERTEX_ATTRIBUTE(GlyphInstance, Glyph)
+                );
+            }
+        };
+
+        struct PushConstants
+        {
+            glm::vec2 InvExtent;
+        };
+
+        struct FrameData
+        {
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            GlyphInstance* Instances { nullptr };
+        };
+
+    private:
+        void CreateAtlas();
+
+        void Sample();
+        void BuildText();
+        // Returns the number of instances written to the frame's buffer.
+        u32 BuildInstances();
+
+        void AddText(glm::vec2 position, const char* text, glm::u8vec4 color);
+        void AddRect(glm::vec2 position, glm::vec2 size, glm::u8vec4 color, std::vector<GlyphInstance>& instances);
+
+    private:
+        Renderer& m_Renderer;
+
+        std::unique_ptr<Texture> m_Atlas;
+        VkDescriptorPool m_DescriptorPool { VK_NULL_HANDLE };
+        VkDescriptorSet m_DescriptorSet { VK_NULL_HANDLE };
+        VkPipelineLayout m_PipelineLayout { VK_NULL_HANDLE };
+        PipelineDesc m_Pipeline;
+        PipelineDesc m_FallbackPipeline;
+
+        std::vector<FrameData> m_Frames;
+
+        u32 m_Scale { 2 };
+
+        Timer m_FrameTimer;
+        Timer m_RefreshTimer;
+        bool m_FirstFrame { true };
+
+        // Ring buffers of the last frames, in milliseconds.
+        std::array<f32, s_HistorySize> m_CPUHistory {};
+        std::array<f32, s_HistorySize> m_GPUHistory {};
+        u32 m_HistoryHead { 0 };
+
+        // Sums since the text was last rebuilt.
+        u32 m_SampleCount { 0 };
+        f64 m_CPUTime { 0.0 };
+        f64 m_GPUTime { 0.0 };
+        std::vector<f64> m_PassTimes;
+
+        u32 m_DrawCalls { 0 };
+        u64 m_Triangles { 0 };
+
+        // Rebuilt with the text, copied into the frame's buffer behind the graph.
+        std::vector<GlyphInstance> m_Text;
+        std::vector<GlyphInstance> m_Graph;
+        glm::vec2 m_GraphPosition { 0.0f };
+    };
+
+}
@@ -0,0 +1,407 @@
+#include "PipelineCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "QueueTimeline.hpp"
+#include "Core/Hash.hpp"
+
+namespace Graphics {
+
+    static VkShaderStageFlagBits GetShaderStage(const std::string& source)
+    {
+        std::string extension = std::filesystem::path(source).extension().string();
+
+        if (extension == ".vert") return VK_SHADER_STAGE_VERTEX_BIT;
+        if (extension == ".frag") return VK_SHADER_STAGE_FRAGMENT_BIT;
+        if (extension == ".geom") return VK_SHADER_STAGE_GEOMETRY_BIT;
+        if (extension == ".tesc") return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        if (extension == ".tese") return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+
+        return static_cast<VkShaderStageFlagBits>(0);
+    }
+
+    PipelineDesc PipelineDesc::GetFallback() const
+    {
+        PipelineDesc fallback = *this;
+        for (auto& shader : fallback.Shaders) {
+            if (GetShaderStage(shader) == VK_SHADER_STAGE_FRAGMENT_BIT)
+                shader = "Fallback.frag";
+        }
+
+        return fallback;
+    }
+
+    u64 PipelineDesc::Hash() const
+    {
+        u64 hash = s_HashSeed;
+
+        for (const auto& shader : Shaders)
+            hash = HashString(shader, hash);
+
+        hash = HashValue(Shaders.size(), hash);
+        hash = HashValue(Layout, hash);
+
+        // The Vulkan structs below are made of 32-bit fields only, no padding to skip.
+        hash = HashValue(VertexBindings.size(), hash);
+        hash = HashBytes(VertexBindings.data(), VertexBindings.size() * sizeof(VkVertexInputBindingDescription), hash);
+        hash = HashValue(VertexAttributes.size(), hash);
+        hash = HashBytes(VertexAttributes.data(), VertexAttributes.size() * sizeof(VkVertexInputAttributeDescription), hash);
+        hash = HashValue(Topology, hash);
+
+        hash = HashValue(PolygonMode, hash);
+        hash = HashValue(CullMode, hash);
+        hash = HashValue(FrontFace, hash);
+
+        hash = HashValue(DepthTest, hash);
+        hash = HashValue(DepthWrite, hash);
+        hash = HashValue(DepthCompare, hash);
+
+        hash = HashValue(Blend, hash);
+
+        hash = HashValue(ColorFormats.size(), hash);
+        hash = HashBytes(ColorFormats.data(), ColorFormats.size() * sizeof(VkFormat), hash);
+        hash = HashValue(DepthFormat, hash);
+        hash = HashValue(StencilFormat, hash);
+
+        return HashValue(Samples, hash);
+    }
+
+    bool PipelineDesc::operator==(const PipelineDesc& other) const
+    {
+        // Same reasoning as Hash(), the Vulkan structs compare byte for byte.
+        auto sameBytes = [](const auto& a, const auto& b) {
+            return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+        };
+
+        return Shaders == other.Shaders && Layout == other.Layout
+            && sameBytes(VertexBindings, other.VertexBindings) && sameBytes(VertexAttributes, other.VertexAttributes) && Topology == other.Topology
+            && PolygonMode == other.PolygonMode && CullMode == other.CullMode && FrontFace == other.FrontFace
+            && DepthTest == other.DepthTest && DepthWrite == other.DepthWrite && DepthCompare == other.DepthCompare
+            && std::memcmp(&Blend, &other.Blend, sizeof(Blend)) == 0
+            && ColorFormats == other.ColorFormats && DepthFormat == other.DepthFormat && StencilFormat == other.StencilFormat
+            && Samples == other.Samples;
+    }
+
+    PipelineCache::PipelineCache(Renderer& renderer, u32 workerCount)
+        : m_Renderer(renderer), m_Device(renderer.GetDevice()), m_Jobs(workerCount)
+    {
+        VkPipelineCacheCreateInfo createInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+        VK_CHECK(vkCreatePipelineCache(m_Device, &createInfo, nullptr, &m_DriverCache));
+    }
+
+    PipelineCache::~PipelineCache()
+    {
+        // Compiles still running write into the entries.
+        m_Jobs.Wait(m_Context);
+
+        for (auto& [desc, entry] : m_Entries) {
+            vkDestroyPipeline(m_Device, entry.Pipeline, nullptr);
+            vkDestroyPipeline(m_Device, entry.Compiled, nullptr);
+        }
+
+        for (auto& retired : m_Retired)
+            vkDestroyPipeline(m_Device, retired.Pipeline, nullptr);
+
+        vkDestroyPipelineCache(m_Device, m_DriverCache, nullptr);
+    }
+
+    VkPipeline PipelineCache::Get(const PipelineDesc& desc)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        VkPipeline pipeline = FindOrQueue(desc).Pipeline;
+        if (pipeline == VK_NULL_HANDLE)
+            m_Stats.DrawsSkipped++;
+
+        return pipeline;
+    }
+
+    VkPipeline PipelineCache::Get(const PipelineDesc& desc, const PipelineDesc& fallback)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        VkPipeline pipeline = FindOrQueue(desc).Pipeline;
+        if (pipeline != VK_NULL_HANDLE)
+            return pipeline;
+
+        pipeline = FindOrQueue(fallback).Pipeline;
+        if (pipeline != VK_NULL_HANDLE)
+            m_Stats.DrawsFallenBack++;
+        else
+            m_Stats.DrawsSkipped++;
+
+        return pipeline;
+    }
+
+    VkPipeline PipelineCache::GetBlocking(const PipelineDesc& desc)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            auto it = m_Entries.find(desc);
+            if (it != m_Entries.end() && it->second.Pipeline != VK_NULL_HANDLE)
+                return it->second.Pipeline;
+        }
+
+        // A worker may be compiling the same pipeline, whichever finishes second retires its copy.
+        VkPipeline pipeline = Compile(desc);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Entry& entry = m_Entries[desc];
+        if (pipeline == VK_NULL_HANDLE) {
+            entry.Failed = true;
+            return entry.Pipeline;
+        }
+
+        // Handed out in the meantime, ours was never used.
+        if (entry.Pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(m_Device, pipeline, nullptr);
+            return entry.Pipeline;
+        }
+
+        entry.Pipeline = pipeline;
+        entry.Failed = false;
+        m_Stats.PipelineCount++;
+
+        return pipeline;
+    }
+
+    void PipelineCache::Prewarm(const PipelineDesc& desc)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        FindOrQueue(desc);
+    }
+
+    void PipelineCache::Invalidate(const std::vector<std::string>& changed, const std::vector<std::string>& failed)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        u32 count = 0;
+        for (auto& [desc, entry] : m_Entries) {
+            auto uses = [&](const std::vector<std::string>& names) {
+                return std::any_of(desc.Shaders.begin(), desc.Shaders.end(), [&](const std::string& shader) {
+                    return std::find(names.begin(), names.end(), shader) != names.end();
+                });
+            };
+
+            if (!uses(changed) || uses(failed))
+                continue;
+
+            entry.Version++;
+            entry.Failed = false;
+            count++;
+
+            // A running compile notices the new version when it finishes.
+            if (!entry.Compiling)
+                Queue(desc, entry);
+        }
+
+        if (count > 0)
+            LOG_INFO("Recompiling {} cached pipelines", count);
+    }
+
+    void PipelineCache::Update()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        QueueTimeline& timeline = m_Renderer.GetGraphicsTimeline();
+
+        // Called before the frame is recorded, the last submission is the last
+        // one that can use the replaced pipelines.
+        for (auto& [desc, entry] : m_Entries) {
+            if (entry.Compiled == VK_NULL_HANDLE)
+                continue;
+
+            if (entry.Pipeline != VK_NULL_HANDLE)
+                m_Retired.push_back({ entry.Pipeline, timeline.GetSubmittedValue() });
+            else
+                m_Stats.PipelineCount++;
+
+            entry.Pipeline = entry.Compiled;
+            entry.Compiled = VK_NULL_HANDLE;
+            m_Stats.Compiling--;
+        }
+
+        std::erase_if(m_Retired, [&](const Retired& retired) {
+            if (!timeline.IsComplete(retired.Value))
+                return false;
+
+            vkDestroyPipeline(m_Device, retired.Pipeline, nullptr);
+            return true;
+        });
+
+        m_Stats.DrawsSkipped = 0;
+        m_Stats.DrawsFallenBack = 0;
+    }
+
+    PipelineCacheStats PipelineCache::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Stats;
+    }
+
+    PipelineCache::Entry& PipelineCache::FindOrQueue(const PipelineDesc& desc)
+    {
+        auto [it, inserted] = m_Entries.try_emplace(desc);
+        if (inserted)
+            Queue(it->first, it->second);
+
+        return it->second;
+    }
+
+    void PipelineCache::Queue(const PipelineDesc& desc, Entry& entry)
+    {
+        entry.Compiling = true;
+        m_Stats.Compiling++;
+
+        // Entries are never erased, the key and entry stay valid for the job.
+        m_Jobs.Execute(m_Context, [this, &desc, &entry, version = entry.Version]() {
+            VkPipeline pipeline = Compile(desc);
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            entry.Compiling = false;
+
+            // Counted as compiling until Update() hands it out. A result that
+            // was never handed out is replaced by the newer one.
+            if (pipeline != VK_NULL_HANDLE) {
+                if (entry.Compiled != VK_NULL_HANDLE) {
+                    vkDestroyPipeline(m_Device, entry.Compiled, nullptr);
+                    m_Stats.Compiling--;
+                }
+
+                entry.Compiled = pipeline;
+            } else {
+                // Not retried on every Get(), only when its shaders change.
+                entry.Failed = true;
+                m_Stats.Compiling--;
+            }
+
+            if (entry.Version != version)
+                Queue(desc, entry);
+        });
+    }
+
+    VkPipeline PipelineCache::Compile(const PipelineDesc& desc)
+    {
+        ShaderReflection reflection = m_Renderer.ReflectShaders(desc.Shaders);
+        if (!reflection.IsValid())
+            return VK_NULL_HANDLE;
+
+        if (!m_Renderer.GetPipelineLayoutCache().IsCompatible(desc.Layout, reflection)) {
+            LOG_ERROR("Resources of {} do not match the pipeline layout", desc.Shaders.front());
+            return VK_NULL_HANDLE;
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertexInputState = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+        vertexInputState.vertexBindingDescriptionCount = static_cast<u32>(desc.VertexBindings.size());
+        vertexInputState.pVertexBindingDescriptions = desc.VertexBindings.data();
+        vertexInputState.vertexAttributeDescriptionCount = static_cast<u32>(desc.VertexAttributes.size());
+        vertexInputState.pVertexAttributeDescriptions = desc.VertexAttributes.data();
+
+        if (!reflection.ValidateVertexInput(vertexInputState))
+            return VK_NULL_HANDLE;
+
+        std::vector<VkPipelineShaderStageCreateInfo> stages;
+        for (const auto& shader : desc.Shaders) {
+            VkPipelineShaderStageCreateInfo stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+            stage.stage = GetShaderStage(shader);
+            stage.module = m_Renderer.LoadShader("shaders/" + shader + ".spv");
+            stage.pName = "main";
+
+            stages.push_back(stage);
+        }
+
+        auto destroyModules = [&]() {
+            for (const auto& stage : stages)
+                vkDestroyShaderModule(m_Device, stage.module, nullptr);
+        };
+
+        if (std::any_of(stages.begin(), stages.end(), [](const VkPipelineShaderStageCreateInfo& stage) { return stage.module == VK_NULL_HANDLE || stage.stage == 0; })) {
+            LOG_ERROR("Failed to load the shaders of {}", desc.Shaders.front());
+            destroyModules();
+            return VK_NULL_HANDLE;
+        }
+
+        std::array<VkDynamicState, 2> dynamicStates = {
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+        };
+
+        VkPipelineDynamicStateCreateInfo dynamicState = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+        dynamicState.dynamicStateCount = static_cast<u32>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+        inputAssemblyState.topology = desc.Topology;
+
+        VkPipelineViewportStateCreateInfo viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        VkPipelineRasterizationStateCreateInfo rasterizationState = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+        rasterizationState.polygonMode = desc.PolygonMode;
+        rasterizationState.cullMode = desc.CullMode;
+        rasterizationState.frontFace = desc.FrontFace;
+        rasterizationState.lineWidth = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisampleState = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+        multisampleState.rasterizationSamples = desc.Samples;
+        multisampleState.minSampleShading = 1.0f;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencilState = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
+        depthStencilState.depthTestEnable = desc.DepthTest ? VK_TRUE : VK_FALSE;
+        depthStencilState.depthWriteEnable = desc.DepthWrite ? VK_TRUE : VK_FALSE;
+        depthStencilState.depthCompareOp = desc.DepthCompare;
+        depthStencilState.maxDepthBounds = 1.0f;
+
+        std::vector<VkPipelineColorBlendAttachmentState> blendAttachments(desc.ColorFormats.size(), desc.Blend);
+
+        VkPipelineColorBlendStateCreateInfo colorBlendState = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+        colorBlendState.logicOp = VK_LOGIC_OP_COPY;
+        colorBlendState.attachmentCount = static_cast<u32>(blendAttachments.size());
+        colorBlendState.pAttachments = blendAttachments.data();
+
+        VkPipelineRenderingCreateInfo renderingInfo = { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
+        renderingInfo.colorAttachmentCount = static_cast<u32>(desc.ColorFormats.size());
+        renderingInfo.pColorAttachmentFormats = desc.ColorFormats.data();
+        renderingInfo.depthAttachmentFormat = desc.DepthFormat;
+        renderingInfo.stencilAttachmentFormat = desc.StencilFormat;
+
+        VkGraphicsPipelineCreateInfo createInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+        createInfo.pNext = &renderingInfo;
+        createInfo.stageCount = static_cast<u32>(stages.size());
+        createInfo.pStages = stages.data();
+        createInfo.pVertexInputState = &vertexInputState;
+        createInfo.pInputAssemblyState = &inputAssemblyState;
+        createInfo.pViewportState = &viewportState;
+        createInfo.pRasterizationState = &rasterizationState;
+        createInfo.pMultisampleState = &multisampleState;
+        createInfo.pDepthStencilState = &depthStencilState;
+        createInfo.pColorBlendState = &colorBlendState;
+        createInfo.pDynamicState = &dynamicState;
+        createInfo.layout = desc.Layout;
+        createInfo.basePipelineIndex = -1;
+
+        // The driver cache is internally synchronized, workers share it.
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VkResult result = vkCreateGraphicsPipelines(m_Device, m_DriverCache, 1, &createInfo, nullptr, &pipeline);
+
+        destroyModules();
+
+        if (result != VK_SUCCESS) {
+            LOG_ERROR("Failed to create pipeline for {} ({})", desc.Shaders.front(), static_cast<i32>(result));
+            return VK_NULL_HANDLE;
+        }
+
+        return pipeline;
+    }
+
+}
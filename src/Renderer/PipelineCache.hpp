@@ -0,0 +1,171 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "VertexLayout.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    // Every piece of state that goes into a graphics pipeline. Viewport and
+    // scissor are always dynamic, so the description does not depend on the
+    // swapchain extent.
+    struct PipelineDesc
+    {
+        // Sources in the shader directory, one per stage, e.g. { "Mesh.vert", "Mesh.frag" }.
+        std::vector<std::string> Shaders;
+        // Has to come from the PipelineLayoutCache, compiles check the shaders against it.
+        VkPipelineLayout Layout { VK_NULL_HANDLE };
+
+        std::vector<VkVertexInputBindingDescription> VertexBindings;
+        std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+        VkPrimitiveTopology Topology { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+
+        VkPolygonMode PolygonMode { VK_POLYGON_MODE_FILL };
+        VkCullModeFlags CullMode { VK_CULL_MODE_NONE };
+        VkFrontFace FrontFace { VK_FRONT_FACE_CLOCKWISE };
+
+        bool DepthTest { true };
+        bool DepthWrite { true };
+        VkCompareOp DepthCompare { VK_COMPARE_OP_GREATER_OR_EQUAL };
+
+        // Applied to every color attachment. No color formats makes a depth-only pipeline.
+        VkPipelineColorBlendAttachmentState Blend { VK_FALSE,
+            VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+            VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+
+        std::vector<VkFormat> ColorFormats;
+        VkFormat DepthFormat { VK_FORMAT_UNDEFINED };
+        VkFormat StencilFormat { VK_FORMAT_UNDEFINED };
+        VkSampleCountFlagBits Samples { VK_SAMPLE_COUNT_1_BIT };
+
+        template<usize N>
+        void SetVertexLayout(const VertexLayout<N>& layout)
+        {
+            auto attributes = layout.AttributeDescriptions();
+
+            VertexBindings = { layout.BindingDescription() };
+            VertexAttributes.assign(attributes.begin(), attributes.end());
+        }
+
+        // The same state with the fragment shader replaced by Fallback.frag, a
+        // flat color that compiles quickly. Draws use it through Get(desc, fallback)
+        // while desc compiles. Depth-only descriptions have nothing to replace.
+        PipelineDesc GetFallback() const;
+
+        u64 Hash() const;
+        bool operator==(const PipelineDesc& other) const;
+    };
+
+    struct PipelineDescHash
+    {
+        inline usize operator()(const PipelineDesc& desc) const { return static_cast<usize>(desc.Hash()); }
+    };
+
+    struct PipelineCacheStats
+    {
+        u32 PipelineCount { 0 };
+        u32 Compiling { 0 };
+        // Counted since the last Update().
+        u32 DrawsSkipped { 0 };
+        u32 DrawsFallenBack { 0 };
+    };
+
+    // Graphics pipelines keyed by their PipelineDesc.
+    //
+    // A pipeline that is not in the cache yet is compiled on the cache's own
+    // worker threads while the frame carries on and handed out from the next
+    // Update() on. Until then Get() returns VK_NULL_HANDLE
+    // and the draw is skipped, or draws with a fallback variant, until it is
+    // ready. The workers are kept apart from the application's job system so a
+    // long driver compile never ends up on a thread that waits for frame work.
+    //
+    // Pipelines stay cached until the renderer is destroyed, switching back to
+    // a previous state (sample count, prepass mode) costs nothing. Safe to call
+    // from several threads.
+    class PipelineCache
+    {
+    public:
+        PipelineCache(Renderer& renderer, u32 workerCount = 2);
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        // Returns VK_NULL_HANDLE while the pipeline compiles or if it failed to.
+        VkPipeline Get(const PipelineDesc& desc);
+        // Returns the fallback while desc compiles, which is queued as well.
+        VkPipeline Get(const PipelineDesc& desc, const PipelineDesc& fallback);
+        // Compiles on the calling thread if needed, for pipelines without which nothing can be drawn.
+        VkPipeline GetBlocking(const PipelineDesc& desc);
+
+        // Queues the compile ahead of the first draw that needs it.
+        void Prewarm(const PipelineDesc& desc);
+
+        // Recompiles the pipelines built from changed shaders. The old pipeline
+        // is used until its replacement is ready. Pipelines that also use a
+        // stage that failed to compile keep the old pipeline.
+        void Invalidate(const std::vector<std::string>& changed, const std::vector<std::string>& failed = {});
+
+        // Hands out the pipelines the workers finished, destroys replaced ones
+        // the graphics timeline has finished with and resets the per-frame
+        // stats. Call once per frame, before recording it.
+        void Update();
+
+        PipelineCacheStats GetStats() const;
+
+    private:
+        struct Entry
+        {
+            VkPipeline Pipeline { VK_NULL_HANDLE };
+            // Finished by a worker, becomes Pipeline in the next Update() so
+            // the handle never changes while a frame is being recorded.
+            VkPipeline Compiled { VK_NULL_HANDLE };
+
+            // Bumped by Invalidate(), a compile of an older version is queued again.
+            u32 Version { 0 };
+            bool Compiling { false };
+            bool Failed { false };
+        };
+
+        struct Retired
+        {
+            VkPipeline Pipeline;
+            // Graphics timeline value after which no submission uses it.
+            u64 Value;
+        };
+
+    private:
+        // Both expect m_Mutex to be held.
+        Entry& FindOrQueue(const PipelineDesc& desc);
+        void Queue(const PipelineDesc& desc, Entry& entry);
+
+        VkPipeline Compile(const PipelineDesc& desc);
+
+    private:
+        Renderer& m_Renderer;
+        VkDevice m_Device;
+        VkPipelineCache m_DriverCache { VK_NULL_HANDLE };
+
+        mutable std::mutex m_Mutex;
+        // Compared in full on lookup, two descs whose hashes collide still get their own pipelines.
+        std::unordered_map<PipelineDesc, Entry, PipelineDescHash> m_Entries;
+
+        std::vector<Retired> m_Retired;
+
+        PipelineCacheStats m_Stats;
+
+        JobSystem m_Jobs;
+        JobContext m_Context;
+    };
+
+}
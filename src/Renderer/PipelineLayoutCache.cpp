@@ -0,0 +1,153 @@
+#include "PipelineLayoutCache.hpp"
+
+#include <algorithm>
+
+#include "Vulkan.hpp"
+
+namespace Graphics {
+
+    // The type a shader sees, dynamic offsets are a property of the layout only.
+    static VkDescriptorType GetShaderType(VkDescriptorType type)
+    {
+        switch (type) {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC: return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            default: return type;
+        }
+    }
+
+    PipelineLayoutCache::PipelineLayoutCache(VkDevice device)
+        : m_Device(device)
+    {
+    }
+
+    PipelineLayoutCache::~PipelineLayoutCache()
+    {
+        for (auto& [key, layout] : m_PipelineLayouts)
+            vkDestroyPipelineLayout(m_Device, layout.Layout, nullptr);
+
+        for (auto& [key, layout] : m_SetLayouts)
+            vkDestroyDescriptorSetLayout(m_Device, layout, nullptr);
+    }
+
+    VkDescriptorSetLayout PipelineLayoutCache::GetSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return CreateSetLayout(bindings);
+    }
+
+    VkPipelineLayout PipelineLayoutCache::GetPipelineLayout(const ShaderReflection& reflection)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        std::vector<VkDescriptorSetLayout> setLayouts;
+        for (u32 set = 0; set < reflection.GetSetCount(); ++set)
+            setLayouts.push_back(CreateSetLayout(reflection.GetSetBindings(set)));
+
+        // Set layouts are already deduplicated, their handles identify them.
+        std::vector<u64> key;
+        for (VkDescriptorSetLayout setLayout : setLayouts)
+            key.push_back(reinterpret_cast<u64>(setLayout));
+
+        key.push_back(reflection.GetPushConstantSize());
+        key.push_back(reflection.GetPushConstantStages());
+
+        auto it = m_PipelineLayouts.find(key);
+        if (it != m_PipelineLayouts.end())
+            return it->second.Layout;
+
+        VkPushConstantRange pushConstant;
+        pushConstant.stageFlags = reflection.GetPushConstantStages();
+        pushConstant.offset = 0;
+        pushConstant.size = reflection.GetPushConstantSize();
+
+        VkPipelineLayoutCreateInfo createInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+        createInfo.setLayoutCount = static_cast<u32>(setLayouts.size());
+        createInfo.pSetLayouts = setLayouts.data();
+        createInfo.pushConstantRangeCount = pushConstant.size > 0 ? 1 : 0;
+        createInfo.pPushConstantRanges = &pushConstant;
+
+        VkPipelineLayout layout { VK_NULL_HANDLE };
+        VK_CHECK(vkCreatePipelineLayout(m_Device, &createInfo, nullptr, &layout));
+
+        PipelineLayout& entry = m_PipelineLayouts[key];
+        entry.Layout = layout;
+        entry.SetLayouts = std::move(setLayouts);
+        entry.Reflection = reflection;
+
+        m_Lookup[layout] = &entry;
+
+        LOG_DEBUG("Created pipeline layout with {} sets and {} bytes of push constants", entry.SetLayouts.size(), pushConstant.size);
+
+        return layout;
+    }
+
+    const std::vector<VkDescriptorSetLayout>& PipelineLayoutCache::GetSetLayouts(VkPipelineLayout layout) const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        // Entries are never removed, the reference stays valid without the lock.
+        return m_Lookup.at(layout)->SetLayouts;
+    }
+
+    bool PipelineLayoutCache::IsCompatible(VkPipelineLayout layout, const ShaderReflection& reflection) const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto it = m_Lookup.find(layout);
+        if (it == m_Lookup.end())
+            return false;
+
+        const ShaderReflection& declared = it->second->Reflection;
+        const auto& bindings = declared.GetBindings();
+
+        for (const auto& binding : reflection.GetBindings()) {
+            auto match = std::find_if(bindings.begin(), bindings.end(), [&](const ReflectedBinding& candidate) {
+                return candidate.Set == binding.Set && candidate.Binding == binding.Binding;
+            });
+
+            if (match == bindings.end() || GetShaderType(match->Type) != GetShaderType(binding.Type) || match->Count < binding.Count || (binding.Stages & ~match->Stages) != 0)
+                return false;
+        }
+
+        if (reflection.GetPushConstantSize() > declared.GetPushConstantSize())
+            return false;
+
+        return (reflection.GetPushConstantStages() & ~declared.GetPushConstantStages()) == 0;
+    }
+
+    VkDescriptorSetLayout PipelineLayoutCache::CreateSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> sorted(bindings.begin(), bindings.end());
+        std::sort(sorted.begin(), sorted.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+            return a.binding < b.binding;
+        });
+
+        std::vector<u64> key;
+        for (const auto& binding : sorted) {
+            key.push_back(binding.binding);
+            key.push_back(static_cast<u64>(binding.descriptorType));
+            key.push_back(binding.descriptorCount);
+            key.push_back(binding.stageFlags);
+
+            for (u32 i = 0; binding.pImmutableSamplers && i < binding.descriptorCount; ++i)
+                key.push_back(reinterpret_cast<u64>(binding.pImmutableSamplers[i]));
+        }
+
+        auto it = m_SetLayouts.find(key);
+        if (it != m_SetLayouts.end())
+            return it->second;
+
+        VkDescriptorSetLayoutCreateInfo createInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+        createInfo.bindingCount = static_cast<u32>(sorted.size());
+        createInfo.pBindings = sorted.data();
+
+        VkDescriptorSetLayout layout { VK_NULL_HANDLE };
+        VK_CHECK(vkCreateDescriptorSetLayout(m_Device, &createInfo, nullptr, &layout));
+
+        m_SetLayouts.emplace(std::move(key), layout);
+
+        return layout;
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "ShaderReflection.hpp"
+#include "Core/Hash.hpp"
+
+namespace Graphics {
+
+    // Creates descriptor set and pipeline layouts from shader reflection and
+    // hands out the same handle for every request with the same description,
+    // so pipelines with matching interfaces share one layout and can be bound
+    // without rebinding their descriptor sets.
+    //
+    // The cache owns everything it creates, layouts live until the renderer is
+    // destroyed. Safe to call from several threads.
+    class PipelineLayoutCache
+    {
+    public:
+        PipelineLayoutCache(VkDevice device);
+        ~PipelineLayoutCache();
+
+        PipelineLayoutCache(const PipelineLayoutCache&) = delete;
+        PipelineLayoutCache& operator=(const PipelineLayoutCache&) = delete;
+
+        VkDescriptorSetLayout GetSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+        // Sets the shaders skip get an empty set layout so later sets keep their
+        // numbers. The push constant range starts at 0 and covers every stage
+        // that declares the block.
+        VkPipelineLayout GetPipelineLayout(const ShaderReflection& reflection);
+
+        // Set layouts of a pipeline layout from this cache, indexed by set number.
+        const std::vector<VkDescriptorSetLayout>& GetSetLayouts(VkPipelineLayout layout) const;
+
+        // Whether pipelines built from the reflected shaders can use the layout:
+        // each binding is declared with the same type, at least the same count
+        // and all of its stages, and the push constant range covers the block.
+        // A dynamic buffer binding matches the plain type the shaders reflect.
+        bool IsCompatible(VkPipelineLayout layout, const ShaderReflection& reflection) const;
+
+    private:
+        struct PipelineLayout
+        {
+            VkPipelineLayout Layout;
+            std::vector<VkDescriptorSetLayout> SetLayouts;
+            ShaderReflection Reflection;
+        };
+
+    private:
+        VkDescriptorSetLayout CreateSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+    private:
+        VkDevice m_Device;
+
+        mutable std::mutex m_Mutex;
+        std::unordered_map<std::vector<u64>, VkDescriptorSetLayout, VectorHash> m_SetLayouts;
+        std::unordered_map<std::vector<u64>, PipelineLayout, VectorHash> m_PipelineLayouts;
+        std::unordered_map<VkPipelineLayout, const PipelineLayout*> m_Lookup;
+    };
+
+}
@@ -0,0 +1,345 @@
+#include "PostProcess.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "ShaderReloader.hpp"
+#include "PipelineLayoutCache.hpp"
+
+namespace Graphics {
+
+    static constexpr u32 s_BloomGroupSize = 8;
+
+    PostProcess::PostProcess(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        CreateDescriptors();
+        CreatePipelines();
+
+        // Bilinear taps do half of the bloom filtering.
+        VkSamplerCreateInfo samplerInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+        VK_CHECK(vkCreateSampler(m_Renderer.GetDevice(), &samplerInfo, nullptr, &m_Sampler));
+    }
+
+    PostProcess::~PostProcess()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        ReleaseTargets();
+
+        vkDestroySampler(device, m_Sampler, nullptr);
+
+        ShaderReloader& reloader = m_Renderer.GetShaderReloader();
+        for (VkPipeline* pipeline : { &m_DownsamplePipeline, &m_UpsamplePipeline })
+            reloader.Unwatch(*pipeline);
+
+        vkDestroyPipeline(device, m_DownsamplePipeline, nullptr);
+        vkDestroyPipeline(device, m_UpsamplePipeline, nullptr);
+
+        vkDestroyDescriptorPool(device, m_BloomDescriptorPool, nullptr);
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    }
+
+    RenderGraphImageDesc PostProcess::GetBloomDesc(VkExtent2D extent)
+    {
+        RenderGraphImageDesc desc;
+        desc.Format = Renderer::GetSceneColorFormat();
+        desc.Extent = { std::max((extent.width + 1) / 2, 1u), std::max((extent.height + 1) / 2, 1u) };
+
+        u32 smallest = std::min(desc.Extent.width, desc.Extent.height);
+        while (desc.MipLevels < s_MaxBloomLevels && (smallest >> desc.MipLevels) >= s_MinBloomSize)
+            desc.MipLevels++;
+
+        return desc;
+    }
+
+    void PostProcess::SetTargets(const RenderGraph& graph, RenderGraphResource sceneColor, RenderGraphResource bloom)
+    {
+        ReleaseTargets();
+
+        VkDevice device = m_Renderer.GetDevice();
+
+        m_SceneExtent = graph.GetImageDesc(sceneColor).Extent;
+
+        // Without bloom the composite samples the scene a second time and adds nothing.
+        std::array<VkDescriptorImageInfo, 2> compositeInfos;
+        compositeInfos[0] = { m_Sampler, graph.GetImageView(sceneColor), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        compositeInfos[1] = { m_Sampler, graph.GetImageView(bloom.IsValid() ? bloom : sceneColor), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        std::vector<VkWriteDescriptorSet> writes;
+
+        for (u32 binding = 0; binding < 2; ++binding) {
+            VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+            write.dstSet = m_CompositeSet;
+            write.dstBinding = binding;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo = &compositeInfos[binding];
+
+            writes.push_back(write);
+        }
+
+        if (!bloom.IsValid()) {
+            vkUpdateDescriptorSets(device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+            return;
+        }
+
+        const RenderGraphImageDesc& bloomDesc = graph.GetImageDesc(bloom);
+        u32 levels = bloomDesc.MipLevels;
+
+        m_BloomExtent = bloomDesc.Extent;
+
+        VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        viewInfo.image = graph.GetImage(bloom);
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = bloomDesc.Format;
+
+        m_BloomLevelViews.resize(levels);
+        for (u32 level = 0; level < levels; ++level) {
+            viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+            VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &m_BloomLevelViews[level]));
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(levels * 2 - 1, m_BloomSetLayout);
+        std::vector<VkDescriptorSet> sets(layouts.size());
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_BloomDescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<u32>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, sets.data()));
+
+        m_DownsampleSets.assign(sets.begin(), sets.begin() + levels);
+        m_UpsampleSets.assign(sets.begin() + levels, sets.end());
+
+        // Reserved up front, the writes point into it.
+        std::vector<VkDescriptorImageInfo> imageInfos;
+        imageInfos.reserve(sets.size() * 2);
+
+        auto write = [&](VkDescriptorSet set, VkImageView source, VkImageLayout sourceLayout, VkImageView destination) {
+            imageInfos.push_back({ m_Sampler, source, sourceLayout });
+            imageInfos.push_back({ VK_NULL_HANDLE, destination, VK_IMAGE_LAYOUT_GENERAL });
+
+            for (u32 binding = 0; binding < 2; ++binding) {
+                VkWriteDescriptorSet setWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+                setWrite.dstSet = set;
+                setWrite.dstBinding = binding;
+                setWrite.descriptorCount = 1;
+                setWrite.descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                setWrite.pImageInfo = &imageInfos[imageInfos.size() - 2 + binding];
+
+                writes.push_back(setWrite);
+            }
+        };
+
+        for (u32 level = 0; level < levels; ++level) {
+            if (level == 0)
+                write(m_DownsampleSets[level], graph.GetImageView(sceneColor), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_BloomLevelViews[0]);
+            else
+                write(m_DownsampleSets[level], m_BloomLevelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL, m_BloomLevelViews[level]);
+        }
+
+        for (u32 level = 0; level + 1 < levels; ++level)
+            write(m_UpsampleSets[level], m_BloomLevelViews[level + 1], VK_IMAGE_LAYOUT_GENERAL, m_BloomLevelViews[level]);
+
+        vkUpdateDescriptorSets(device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void PostProcess::ReleaseTargets()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        for (VkImageView view : m_BloomLevelViews)
+            vkDestroyImageView(device, view, nullptr);
+        m_BloomLevelViews.clear();
+
+        if (!m_DownsampleSets.empty()) {
+            VK_CHECK(vkResetDescriptorPool(device, m_BloomDescriptorPool, 0));
+            m_DownsampleSets.clear();
+            m_UpsampleSets.clear();
+        }
+
+        m_SceneExtent = { 0, 0 };
+        m_BloomExtent = { 0, 0 };
+    }
+
+    void PostProcess::RecordBloom(VkCommandBuffer commandBuffer)
+    {
+        if (m_DownsampleSets.empty())
+            return;
+
+        // Each level reads the one written before it, the graph only synchronizes the pass as a whole.
+        VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+
+        VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        f32 threshold = std::max(m_Settings.BloomThreshold, 0.0f);
+        f32 knee = std::max(threshold * m_Settings.BloomKnee, 1e-5f);
+
+        BloomConstants constants;
+        constants.Threshold = glm::vec4(threshold, threshold - knee, knee * 2.0f, 0.25f / knee);
+        constants.Radius = std::max(m_Settings.BloomRadius, 0.0f);
+
+        auto levelExtent = [this](u32 level) {
+            return VkExtent2D { std::max(m_BloomExtent.width >> level, 1u), std::max(m_BloomExtent.height >> level, 1u) };
+        };
+
+        auto dispatch = [&](VkDescriptorSet set, VkExtent2D source, VkExtent2D destination) {
+            constants.TexelSize = 1.0f / glm::vec2(static_cast<f32>(source.width), static_cast<f32>(source.height));
+
+            vkCmdPushConstants(commandBuffer, m_BloomPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BloomConstants), &constants);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_BloomPipelineLayout, 0, 1, &set, 0, nullptr);
+            vkCmdDispatch(commandBuffer, (destination.width + s_BloomGroupSize - 1) / s_BloomGroupSize, (destination.height + s_BloomGroupSize - 1) / s_BloomGroupSize, 1);
+        };
+
+        u32 levels = static_cast<u32>(m_DownsampleSets.size());
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_DownsamplePipeline);
+
+        for (u32 level = 0; level < levels; ++level) {
+            if (level > 0)
+                vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+            constants.Prefilter = level == 0 ? 1 : 0;
+            dispatch(m_DownsampleSets[level], level == 0 ? m_SceneExtent : levelExtent(level - 1), levelExtent(level));
+        }
+
+        if (levels > 1)
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_UpsamplePipeline);
+
+        constants.Prefilter = 0;
+
+        for (u32 level = levels - 1; level-- > 0;) {
+            vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+            dispatch(m_UpsampleSets[level], levelExtent(level + 1), levelExtent(level));
+        }
+    }
+
+    void PostProcess::RecordComposite(VkCommandBuffer commandBuffer)
+    {
+        // Rebuilt in place, the swapchain format can change on recreation.
+        m_CompositePipeline.ColorFormats[0] = m_Renderer.GetColorFormat();
+        m_CompositeFallbackPipeline.ColorFormats[0] = m_Renderer.GetColorFormat();
+
+        VkPipeline pipeline = m_Renderer.GetPipelineCache().Get(m_CompositePipeline, m_CompositeFallbackPipeline);
+        if (pipeline == VK_NULL_HANDLE)
+            return;
+
+        CompositeConstants constants;
+        constants.FilterExposure = glm::vec4(m_Settings.ColorFilter, std::exp2(m_Settings.Exposure));
+        constants.BloomIntensity = m_DownsampleSets.empty() ? 0.0f : m_Settings.BloomIntensity;
+        constants.Contrast = std::max(m_Settings.Contrast, 0.01f);
+        constants.Saturation = std::max(m_Settings.Saturation, 0.0f);
+        constants.Tonemapper = static_cast<u32>(m_Settings.Tonemap);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_CompositePipelineLayout, 0, 1, &m_CompositeSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_CompositePipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(CompositeConstants), &constants);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    void PostProcess::CreateDescriptors()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+
+        // Both directions sample one level and write another, they share a layout.
+        m_BloomPipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "BloomDownsample.comp", "BloomUpsample.comp" }));
+        m_BloomSetLayout = layouts.GetSetLayouts(m_BloomPipelineLayout).at(0);
+
+        m_CompositePipelineLayout = layouts.GetPipelineLayout(m_Renderer.ReflectShaders({ "Composite.vert", "Composite.frag" }));
+        m_CompositeSetLayout = layouts.GetSetLayouts(m_CompositePipelineLayout).at(0);
+
+        VkDescriptorPoolSize compositePoolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 };
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &compositePoolSize;
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_CompositeSetLayout;
+
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &m_CompositeSet));
+
+        // A downsample set per level and an upsample set per level but the last.
+        std::array<VkDescriptorPoolSize, 2> bloomPoolSizes = {
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, s_MaxBloomLevels * 2 },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, s_MaxBloomLevels * 2 }
+        };
+
+        poolInfo.maxSets = s_MaxBloomLevels * 2;
+        poolInfo.poolSizeCount = static_cast<u32>(bloomPoolSizes.size());
+        poolInfo.pPoolSizes = bloomPoolSizes.data();
+
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_BloomDescriptorPool));
+    }
+
+    void PostProcess::CreatePipelines()
+    {
+        auto create = [this](VkPipeline& pipeline, const std::string& name) {
+            auto build = [this, name]() { return CreateComputePipeline("shaders/" + name + ".spv", m_BloomPipelineLayout); };
+
+            pipeline = build();
+            m_Renderer.GetShaderReloader().Watch(pipeline, m_BloomPipelineLayout, { name }, build);
+        };
+
+        create(m_DownsamplePipeline, "BloomDownsample.comp");
+        create(m_UpsamplePipeline, "BloomUpsample.comp");
+
+        m_CompositePipeline.Shaders = { "Composite.vert", "Composite.frag" };
+        m_CompositePipeline.Layout = m_CompositePipelineLayout;
+        m_CompositePipeline.DepthTest = false;
+        m_CompositePipeline.DepthWrite = false;
+        m_CompositePipeline.ColorFormats = { m_Renderer.GetColorFormat() };
+
+        // Nothing reaches the backbuffer without it. After a format change the
+        // backbuffer is filled flat until the new variant is compiled.
+        m_CompositeFallbackPipeline = m_CompositePipeline.GetFallback();
+        m_Renderer.GetPipelineCache().GetBlocking(m_CompositePipeline);
+    }
+
+    VkPipeline PostProcess::CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout)
+    {
+        VkShaderModule shader = m_Renderer.LoadShader(filepath);
+
+        VkComputePipelineCreateInfo createInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+        createInfo.stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+        createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        createInfo.stage.module = shader;
+        createInfo.stage.pName = "main";
+        createInfo.layout = layout;
+        createInfo.basePipelineIndex = -1;
+
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK(vkCreateComputePipelines(m_Renderer.GetDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline));
+
+        vkDestroyShaderModule(m_Renderer.GetDevice(), shader, nullptr);
+
+        return pipeline;
+    }
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "RenderGraph.hpp"
+#include "PipelineCache.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    enum class Tonemapper : u8
+    {
+        // Clamps to [0, 1].
+        None,
+        Reinhard,
+        ACES
+    };
+
+    struct PostProcessSettings
+    {
+        // Toggling it rebuilds the render graph, the other settings are free to change every frame.
+        bool Bloom { true };
+        // Scene brightness bloom starts at, fading in over Knee * Threshold below it.
+        f32 BloomThreshold { 1.0f };
+        f32 BloomKnee { 0.5f };
+        f32 BloomIntensity { 0.5f };
+        // Tent radius of the upsample in texels, larger spreads the glow wider.
+        f32 BloomRadius { 1.0f };
+
+        // In stops, applied to the scene and the bloom before grading.
+        f32 Exposure { 0.0f };
+
+        // Grading in linear HDR ahead of the tonemapper.
+        glm::vec3 ColorFilter { 1.0f };
+        f32 Contrast { 1.0f };
+        f32 Saturation { 1.0f };
+
+        Tonemapper Tonemap { Tonemapper::ACES };
+    };
+
+    // Everything between the HDR scene color and the backbuffer.
+    //
+    // Bloom is a compute pass over a mip chain at half resolution: the first
+    // downsample thresholds the scene, each level is downsampled from the one
+    // above with a 13 tap filter, and walking back up adds a tent filtered
+    // copy of every smaller level to the next larger one. The composite then
+    // adds the bloom and applies exposure, grading and the tonemapper in a
+    // single fullscreen pass, so the HDR color is read once and the backbuffer
+    // written once.
+    //
+    // The composite draws rather than dispatches because the swapchain images
+    // are sRGB, which cannot be bound as storage images.
+    class PostProcess
+    {
+    public:
+        PostProcess(Renderer& renderer);
+        ~PostProcess();
+
+        PostProcess(const PostProcess&) = delete;
+        PostProcess& operator=(const PostProcess&) = delete;
+
+        // Renderer::SetPostProcessSettings() rebuilds the graph when bloom is toggled.
+        inline void SetSettings(const PostProcessSettings& settings) { m_Settings = settings; }
+        inline const PostProcessSettings& GetSettings() const { return m_Settings; }
+
+        // Points the passes at the scene color and bloom chain of a freshly
+        // compiled graph, bloom is invalid without the bloom pass. Must be
+        // called whenever the graph is rebuilt.
+        void SetTargets(const RenderGraph& graph, RenderGraphResource sceneColor, RenderGraphResource bloom);
+        void ReleaseTargets();
+
+        void RecordBloom(VkCommandBuffer commandBuffer);
+        // In a rendering pass over the backbuffer.
+        void RecordComposite(VkCommandBuffer commandBuffer);
+
+        // Level 0 is half the scene resolution, levels stop before they get
+        // smaller than s_MinBloomSize.
+        static RenderGraphImageDesc GetBloomDesc(VkExtent2D extent);
+
+    public:
+        inline static constexpr u32 s_MaxBloomLevels { 8 };
+        inline static constexpr u32 s_MinBloomSize { 8 };
+
+    private:
+        // Matches Bloom.glsl.
+        struct BloomConstants
+        {
+            glm::vec4 Threshold;
+            glm::vec2 TexelSize;
+            f32 Radius;
+            u32 Prefilter;
+        };
+
+        // Matches Composite.frag.
+        struct CompositeConstants
+        {
+            glm::vec4 FilterExposure;
+            f32 BloomIntensity;
+            f32 Contrast;
+            f32 Saturation;
+            u32 Tonemapper;
+        };
+
+    private:
+        void CreateDescriptors();
+        void CreatePipelines();
+
+        VkPipeline CreateComputePipeline(const std::string& filepath, VkPipelineLayout layout);
+
+    private:
+        Renderer& m_Renderer;
+
+        PostProcessSettings m_Settings;
+
+        VkDescriptorSetLayout m_BloomSetLayout { VK_NULL_HANDLE };
+        VkDescriptorSetLayout m_CompositeSetLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_BloomPipelineLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_CompositePipelineLayout { VK_NULL_HANDLE };
+
+        VkPipeline m_DownsamplePipeline { VK_NULL_HANDLE };
+        VkPipeline m_UpsamplePipeline { VK_NULL_HANDLE };
+        PipelineDesc m_CompositePipeline;
+        PipelineDesc m_CompositeFallbackPipeline;
+
+        VkDescriptorPool m_DescriptorPool { VK_NULL_HANDLE };
+        VkDescriptorSet m_CompositeSet { VK_NULL_HANDLE };
+        // Reset whenever the targets change, the level count follows the extent.
+        VkDescriptorPool m_BloomDescriptorPool { VK_NULL_HANDLE };
+
+        VkSampler m_Sampler { VK_NULL_HANDLE };
+
+        // One storage view per level. Downsample set i writes level i, upsample
+        // set i adds level i + 1 into level i.
+        std::vector<VkImageView> m_BloomLevelViews;
+        std::vector<VkDescriptorSet> m_DownsampleSets;
+        std::vector<VkDescriptorSet> m_UpsampleSets;
+        VkExtent2D m_SceneExtent { 0, 0 };
+        VkExtent2D m_BloomExtent { 0, 0 };
+    };
+
+}
@@ -0,0 +1,97 @@
+#include "QueueTimeline.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "Vulkan.hpp"
+
+namespace Graphics {
+
+    QueueTimeline::QueueTimeline(VkDevice device, VkQueue queue)
+        : m_Device(device), m_Queue(queue)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo createInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        createInfo.pNext = &typeInfo;
+
+        VK_CHECK(vkCreateSemaphore(m_Device, &createInfo, nullptr, &m_Semaphore));
+    }
+
+    QueueTimeline::~QueueTimeline()
+    {
+        vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+    }
+
+    u64 QueueTimeline::Submit(std::span<const VkCommandBufferSubmitInfo> commandBuffers, std::span<const VkSemaphoreSubmitInfo> waits, std::span<const VkSemaphoreSubmitInfo> signals)
+    {
+        std::lock_guard<std::mutex> lock(m_SubmitMutex);
+
+        u64 value = m_Submitted.load(std::memory_order_relaxed) + 1;
+
+        std::vector<VkSemaphoreSubmitInfo> signalInfos(signals.begin(), signals.end());
+
+        VkSemaphoreSubmitInfo timelineSignal = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+        timelineSignal.semaphore = m_Semaphore;
+        timelineSignal.value = value;
+        timelineSignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        signalInfos.push_back(timelineSignal);
+
+        VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+        submitInfo.waitSemaphoreInfoCount = static_cast<u32>(waits.size());
+        submitInfo.pWaitSemaphoreInfos = waits.data();
+        submitInfo.commandBufferInfoCount = static_cast<u32>(commandBuffers.size());
+        submitInfo.pCommandBufferInfos = commandBuffers.data();
+        submitInfo.signalSemaphoreInfoCount = static_cast<u32>(signalInfos.size());
+        submitInfo.pSignalSemaphoreInfos = signalInfos.data();
+
+        VK_CHECK(vkQueueSubmit2(m_Queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+        m_Submitted.store(value, std::memory_order_release);
+
+        return value;
+    }
+
+    u64 QueueTimeline::GetCompletedValue()
+    {
+        u64 value = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &value));
+
+        // Concurrent readers may race, keep whichever saw the GPU further along.
+        u64 completed = m_Completed.load(std::memory_order_relaxed);
+        while (completed < value && !m_Completed.compare_exchange_weak(completed, value, std::memory_order_relaxed)) {}
+
+        return std::max(completed, value);
+    }
+
+    bool QueueTimeline::IsComplete(u64 value)
+    {
+        if (value <= m_Completed.load(std::memory_order_relaxed))
+            return true;
+
+        return value <= GetCompletedValue();
+    }
+
+    bool QueueTimeline::Wait(u64 value, u64 timeout)
+    {
+        if (IsComplete(value))
+            return true;
+
+        VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_Semaphore;
+        waitInfo.pValues = &value;
+
+        VkResult result = vkWaitSemaphores(m_Device, &waitInfo, timeout);
+        if (result == VK_TIMEOUT)
+            return false;
+
+        VK_CHECK(result);
+
+        GetCompletedValue();
+        return true;
+    }
+
+}
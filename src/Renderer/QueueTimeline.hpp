@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <span>
+
+#include <volk.h>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // Timeline semaphore of one queue. Every submission through it signals the
+    // next value, so "the GPU reached value X" means everything submitted up
+    // to and including submission X has finished. Work that has to outlive
+    // the GPU's use of a resource remembers a value instead of owning a fence:
+    // polling it is an atomic load in the common case and one
+    // vkGetSemaphoreCounterValue otherwise.
+    //
+    // Submit() may be called from several threads. Another queue can wait on
+    // GetSemaphore() at a value to order cross-queue work.
+    class QueueTimeline
+    {
+    public:
+        QueueTimeline(VkDevice device, VkQueue queue);
+        ~QueueTimeline();
+
+        QueueTimeline(const QueueTimeline&) = delete;
+        QueueTimeline& operator=(const QueueTimeline&) = delete;
+
+        // Submits the command buffers and returns the value signaled once they
+        // complete. waits and signals carry binary semaphores, e.g. for the swapchain.
+        u64 Submit(std::span<const VkCommandBufferSubmitInfo> commandBuffers,
+            std::span<const VkSemaphoreSubmitInfo> waits = {}, std::span<const VkSemaphoreSubmitInfo> signals = {});
+
+        // Signaled by the last submission so far.
+        inline u64 GetSubmittedValue() const { return m_Submitted.load(std::memory_order_acquire); }
+        // Signaled by the next submission, for resources used by work that is still being recorded.
+        inline u64 GetPendingValue() const { return GetSubmittedValue() + 1; }
+
+        u64 GetCompletedValue();
+        bool IsComplete(u64 value);
+
+        // Returns false if the timeout (in nanoseconds) expired first.
+        bool Wait(u64 value, u64 timeout = std::numeric_limits<u64>::max());
+        inline void WaitIdle() { Wait(GetSubmittedValue()); }
+
+        inline VkSemaphore GetSemaphore() const { return m_Semaphore; }
+
+    private:
+        VkDevice m_Device;
+        VkQueue m_Queue;
+        VkSemaphore m_Semaphore { VK_NULL_HANDLE };
+
+        // Queue submission has to be externally synchronized.
+        std::mutex m_SubmitMutex;
+        std::atomic<u64> m_Submitted { 0 };
+        // Last value read back from the semaphore, never ahead of the GPU.
+        std::atomic<u64> m_Completed { 0 };
+    };
+
+}
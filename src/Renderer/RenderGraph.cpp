@@ -0,0 +1,729 @@
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+
+#include "Vulkan.hpp"
+
+namespace Graphics {
+
+    static VkImageAspectFlags AspectFromFormat(VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    static VkImageUsageFlags UsageFromAccess(RenderGraphAccess access)
+    {
+        switch (access) {
+            case RenderGraphAccess::ColorAttachment:        return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            case RenderGraphAccess::DepthAttachment:
+            case RenderGraphAccess::DepthAttachmentRead:    return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            case RenderGraphAccess::SampledFragment:
+            case RenderGraphAccess::SampledCompute:         return VK_IMAGE_USAGE_SAMPLED_BIT;
+            case RenderGraphAccess::StorageReadCompute:
+            case RenderGraphAccess::StorageWriteCompute:    return VK_IMAGE_USAGE_STORAGE_BIT;
+            case RenderGraphAccess::TransferSrc:            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            case RenderGraphAccess::TransferDst:            return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            default:                                        return 0;
+        }
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::CreateImage(const std::string& name, const RenderGraphImageDesc& desc)
+    {
+        RenderGraph::Resource resource;
+        resource.Name = name;
+        resource.Type = RenderGraph::ResourceType::Image;
+        resource.Imported = false;
+        resource.ImageDesc = desc;
+
+        m_Graph.m_Resources.push_back(resource);
+
+        return { static_cast<u32>(m_Graph.m_Resources.size() - 1) };
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::Read(RenderGraphResource resource, RenderGraphAccess access)
+    {
+        m_Graph.m_Passes[m_Pass].Reads.push_back({ resource.Index, access });
+        return resource;
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::Write(RenderGraphResource resource, RenderGraphAccess access)
+    {
+        m_Graph.m_Passes[m_Pass].Writes.push_back({ resource.Index, access });
+        return resource;
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::WriteColor(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue, VkAttachmentStoreOp storeOp)
+    {
+        m_Graph.m_Passes[m_Pass].ColorAttachments.push_back({ resource.Index, loadOp, storeOp, clearValue });
+        return Write(resource, RenderGraphAccess::ColorAttachment);
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::WriteDepth(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue, VkAttachmentStoreOp storeOp)
+    {
+        m_Graph.m_Passes[m_Pass].DepthAttachment = RenderGraph::Attachment { resource.Index, loadOp, storeOp, clearValue };
+        return Write(resource, RenderGraphAccess::DepthAttachment);
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::ResolveColor(RenderGraphResource source, RenderGraphResource target)
+    {
+        for (auto& attachment : m_Graph.m_Passes[m_Pass].ColorAttachments) {
+            if (attachment.Resource == source.Index)
+                attachment.Resolve = target.Index;
+        }
+
+        return Write(target, RenderGraphAccess::ColorAttachment);
+    }
+
+    RenderGraphResource RenderGraphPassBuilder::ReadDepth(RenderGraphResource resource)
+    {
+        m_Graph.m_Passes[m_Pass].DepthAttachment = RenderGraph::Attachment { resource.Index, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_NONE, {} };
+        return Read(resource, RenderGraphAccess::DepthAttachmentRead);
+    }
+
+    void RenderGraphPassBuilder::SideEffect()
+    {
+        m_Graph.m_Passes[m_Pass].SideEffect = true;
+    }
+
+    RenderGraph::RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice, MemoryTracker& memory)
+        : m_Device(device), m_PhysicalDevice(physicalDevice), m_Memory(memory)
+    {
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        Reset();
+    }
+
+    RenderGraphResource RenderGraph::ImportImage(const std::string& name, const RenderGraphImageDesc& desc,
+        VkImageLayout initialLayout, VkImageLayout finalLayout, VkPipelineStageFlags2 initialStage)
+    {
+        Resource resource;
+        resource.Name = name;
+        resource.Type = ResourceType::Image;
+        resource.Imported = true;
+        resource.ImageDesc = desc;
+        resource.InitialLayout = initialLayout;
+        resource.FinalLayout = finalLayout;
+        resource.InitialStage = initialStage;
+
+        m_Resources.push_back(resource);
+
+        return { static_cast<u32>(m_Resources.size() - 1) };
+    }
+
+    RenderGraphResource RenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size)
+    {
+        Resource resource;
+        resource.Name = name;
+        resource.Type = ResourceType::Buffer;
+        resource.Imported = true;
+        resource.Buffer = buffer;
+        resource.BufferSize = size;
+
+        m_Resources.push_back(resource);
+
+        return { static_cast<u32>(m_Resources.size() - 1) };
+    }
+
+    void RenderGraph::SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView view)
+    {
+        m_Resources[resource.Index].Image = image;
+        m_Resources[resource.Index].View = view;
+    }
+
+    void RenderGraph::SetImportedBuffer(RenderGraphResource resource, VkBuffer buffer, VkDeviceSize size)
+    {
+        m_Resources[resource.Index].Buffer = buffer;
+        m_Resources[resource.Index].BufferSize = size;
+    }
+
+    void RenderGraph::AddPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute)
+    {
+        Pass pass;
+        pass.Name = name;
+        pass.Execute = execute;
+
+        m_Passes.push_back(pass);
+
+        RenderGraphPassBuilder builder(*this, static_cast<u32>(m_Passes.size() - 1));
+        setup(builder);
+    }
+
+    void RenderGraph::Compile()
+    {
+        CullPasses();
+        ComputeLifetimes();
+        CreateTransientImages();
+        ComputeBarriers();
+
+        LOG_DEBUG("Render graph compiled: {}/{} passes, {} transient memory blocks", m_ExecutionOrder.size(), m_Passes.size(), m_MemoryBlocks.size());
+    }
+
+    void RenderGraph::Execute(VkCommandBuffer commandBuffer, VkQueryPool timestamps, u32 firstQuery)
+    {
+        // Each pass is timed including the barriers in front of it.
+        if (timestamps != VK_NULL_HANDLE)
+            vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, timestamps, firstQuery);
+
+        for (usize i = 0; i < m_ExecutionOrder.size(); ++i) {
+            const Pass& pass = m_Passes[m_ExecutionOrder[i]];
+            bool rendering = !pass.ColorAttachments.empty() || pass.DepthAttachment.has_value();
+
+            EmitBarriers(commandBuffer, m_PassBarriers[i]);
+
+            if (rendering)
+                BeginRendering(commandBuffer, pass);
+
+            pass.Execute(commandBuffer, *this);
+
+            if (rendering)
+                vkCmdEndRendering(commandBuffer);
+
+            if (timestamps != VK_NULL_HANDLE)
+                vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, timestamps, firstQuery + static_cast<u32>(i) + 1);
+        }
+
+        EmitBarriers(commandBuffer, m_FinalBarriers);
+    }
+
+    void RenderGraph::Reset()
+    {
+        for (auto& resource : m_Resources) {
+            if (resource.Imported || resource.Type != ResourceType::Image)
+                continue;
+
+            if (resource.View != VK_NULL_HANDLE)
+                vkDestroyImageView(m_Device, resource.View, nullptr);
+            if (resource.Image != VK_NULL_HANDLE)
+                vkDestroyImage(m_Device, resource.Image, nullptr);
+        }
+
+        for (auto& block : m_MemoryBlocks)
+            m_Memory.Free(block.Memory);
+
+        m_Resources.clear();
+        m_Passes.clear();
+        m_ExecutionOrder.clear();
+        m_PassBarriers.clear();
+        m_FinalBarriers = BarrierBatch();
+        m_MemoryBlocks.clear();
+    }
+
+    VkImage RenderGraph::GetImage(RenderGraphResource resource) const
+    {
+        return m_Resources[resource.Index].Image;
+    }
+
+    VkImageView RenderGraph::GetImageView(RenderGraphResource resource) const
+    {
+        return m_Resources[resource.Index].View;
+    }
+
+    VkBuffer RenderGraph::GetBuffer(RenderGraphResource resource) const
+    {
+        return m_Resources[resource.Index].Buffer;
+    }
+
+    const RenderGraphImageDesc& RenderGraph::GetImageDesc(RenderGraphResource resource) const
+    {
+        return m_Resources[resource.Index].ImageDesc;
+    }
+
+    std::vector<RenderGraphBarrier> RenderGraph::GetPassBarriers(u32 index) const
+    {
+        std::vector<RenderGraphBarrier> barriers;
+        for (const auto& barrier : m_PassBarriers[index].Barriers) {
+            RenderGraphBarrier& info = barriers.emplace_back();
+            info.Resource = { barrier.Resource };
+            info.SrcStage = barrier.Src.Stage;
+            info.SrcAccess = barrier.Src.Access;
+            info.DstStage = barrier.Dst.Stage;
+            info.DstAccess = barrier.Dst.Access;
+            info.OldLayout = barrier.Src.Layout;
+            info.NewLayout = barrier.Dst.Layout;
+        }
+
+        return barriers;
+    }
+
+    RenderGraph::AccessInfo RenderGraph::GetAccessInfo(RenderGraphAccess access)
+    {
+        switch (access) {
+            case RenderGraphAccess::ColorAttachment:
+                return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+            case RenderGraphAccess::DepthAttachment:
+                return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+            case RenderGraphAccess::DepthAttachmentRead:
+                return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false };
+            case RenderGraphAccess::SampledFragment:
+                return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+            case RenderGraphAccess::SampledCompute:
+                return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+            case RenderGraphAccess::StorageReadCompute:
+                return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+            case RenderGraphAccess::StorageWriteCompute:
+                return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+            case RenderGraphAccess::TransferSrc:
+                return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+            case RenderGraphAccess::TransferDst:
+                return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+            case RenderGraphAccess::VertexBuffer:
+                return { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+            case RenderGraphAccess::IndexBuffer:
+                return { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+            case RenderGraphAccess::IndirectBuffer:
+                return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+            case RenderGraphAccess::UniformBuffer:
+                return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+        }
+
+        return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        std::vector<bool> needed(m_Resources.size(), false);
+        for (usize i = 0; i < m_Resources.size(); ++i)
+            needed[i] = m_Resources[i].Imported;
+
+        for (usize i = m_Passes.size(); i-- > 0;) {
+            Pass& pass = m_Passes[i];
+
+            bool alive = pass.SideEffect;
+            for (const auto& write : pass.Writes)
+                alive = alive || needed[write.Resource];
+
+            pass.Culled = !alive;
+            if (!alive) {
+                LOG_DEBUG("Render graph culled pass {}", pass.Name);
+                continue;
+            }
+
+            for (const auto& read : pass.Reads)
+                needed[read.Resource] = true;
+        }
+
+        m_ExecutionOrder.clear();
+        for (usize i = 0; i < m_Passes.size(); ++i) {
+            if (!m_Passes[i].Culled)
+                m_ExecutionOrder.push_back(static_cast<u32>(i));
+        }
+    }
+
+    void RenderGraph::ComputeLifetimes()
+    {
+        for (usize order = 0; order < m_ExecutionOrder.size(); ++order) {
+            const Pass& pass = m_Passes[m_ExecutionOrder[order]];
+
+            auto touch = [&](const ResourceAccess& access) {
+                Resource& resource = m_Resources[access.Resource];
+                resource.FirstPass = std::min(resource.FirstPass, static_cast<u32>(order));
+                resource.LastPass = std::max(resource.LastPass, static_cast<u32>(order));
+                resource.ImageUsage |= UsageFromAccess(access.Access);
+            };
+
+            for (const auto& read : pass.Reads) touch(read);
+            for (const auto& write : pass.Writes) touch(write);
+        }
+    }
+
+    void RenderGraph::CreateTransientImages()
+    {
+        std::vector<VkMemoryRequirements> requirements(m_Resources.size());
+        std::vector<u32> transients;
+
+        // Attachment-only images (MSAA targets, depth) never need to leave tile
+        // memory, so on devices with lazily allocated memory they get their own
+        // lazy allocation instead of a slot in an aliased block.
+        u32 lazyMemoryTypeBits = 0;
+        {
+            VkPhysicalDeviceMemoryProperties memProperties;
+            vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &memProperties);
+
+            for (u32 i = 0; i < memProperties.memoryTypeCount; ++i) {
+                if (memProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+                    lazyMemoryTypeBits |= 1u << i;
+            }
+        }
+
+        constexpr VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+        for (usize i = 0; i < m_Resources.size(); ++i) {
+            Resource& resource = m_Resources[i];
+            if (resource.Imported || resource.Type != ResourceType::Image || resource.FirstPass == ~0u)
+                continue;
+
+            VkImageCreateInfo createInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+            createInfo.imageType = VK_IMAGE_TYPE_2D;
+            createInfo.format = resource.ImageDesc.Format;
+            createInfo.extent = { resource.ImageDesc.Extent.width, resource.ImageDesc.Extent.height, 1 };
+            createInfo.mipLevels = resource.ImageDesc.MipLevels;
+            createInfo.arrayLayers = 1;
+            createInfo.samples = resource.ImageDesc.Samples;
+            createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            createInfo.usage = resource.ImageUsage;
+            createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            if (lazyMemoryTypeBits != 0 && (resource.ImageUsage & ~attachmentUsage) == 0) {
+                resource.ImageUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+                createInfo.usage = resource.ImageUsage;
+            }
+
+            VK_CHECK(vkCreateImage(m_Device, &createInfo, nullptr, &resource.Image));
+            vkGetImageMemoryRequirements(m_Device, resource.Image, &requirements[i]);
+
+            transients.push_back(static_cast<u32>(i));
+        }
+
+        // Largest first, each image shares a block with images whose lifetimes
+        // do not overlap with any current occupant of that block.
+        std::sort(transients.begin(), transients.end(), [&](u32 a, u32 b) {
+            return requirements[a].size > requirements[b].size;
+        });
+
+        for (u32 index : transients) {
+            Resource& resource = m_Resources[index];
+            const VkMemoryRequirements& req = requirements[index];
+
+            if ((resource.ImageUsage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) && (req.memoryTypeBits & lazyMemoryTypeBits)) {
+                MemoryBlock block;
+                block.Size = req.size;
+                block.MemoryTypeBits = req.memoryTypeBits & lazyMemoryTypeBits;
+                block.Lazy = true;
+                block.Resources.push_back(index);
+
+                m_MemoryBlocks.push_back(block);
+                resource.MemoryBlock = static_cast<u32>(m_MemoryBlocks.size() - 1);
+                continue;
+            }
+
+            for (usize b = 0; b < m_MemoryBlocks.size() && resource.MemoryBlock == ~0u; ++b) {
+                MemoryBlock& block = m_MemoryBlocks[b];
+                if (block.Lazy || (block.MemoryTypeBits & req.memoryTypeBits) == 0)
+                    continue;
+
+                bool overlaps = false;
+                for (u32 other : block.Resources) {
+                    const Resource& occupant = m_Resources[other];
+                    if (resource.FirstPass <= occupant.LastPass && occupant.FirstPass <= resource.LastPass) {
+                        overlaps = true;
+                        break;
+                    }
+                }
+
+                if (overlaps)
+                    continue;
+
+                block.MemoryTypeBits &= req.memoryTypeBits;
+                block.Size = std::max(block.Size, req.size);
+                block.Resources.push_back(index);
+                resource.MemoryBlock = static_cast<u32>(b);
+            }
+
+            if (resource.MemoryBlock == ~0u) {
+                MemoryBlock block;
+                block.Size = req.size;
+                block.MemoryTypeBits = req.memoryTypeBits;
+                block.Resources.push_back(index);
+
+                m_MemoryBlocks.push_back(block);
+                resource.MemoryBlock = static_cast<u32>(m_MemoryBlocks.size() - 1);
+            }
+        }
+
+        for (auto& block : m_MemoryBlocks) {
+            VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+            allocInfo.allocationSize = block.Size;
+            allocInfo.memoryTypeIndex = m_Memory.FindMemoryType(block.MemoryTypeBits, block.Lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VK_CHECK(m_Memory.Allocate(allocInfo, MemoryCategory::RenderTarget, "RenderGraph", block.Memory));
+
+            std::sort(block.Resources.begin(), block.Resources.end(), [&](u32 a, u32 b) {
+                return m_Resources[a].FirstPass < m_Resources[b].FirstPass;
+            });
+
+            for (u32 index : block.Resources) {
+                Resource& resource = m_Resources[index];
+                VK_CHECK(vkBindImageMemory(m_Device, resource.Image, block.Memory, 0));
+
+                VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+                viewInfo.image = resource.Image;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = resource.ImageDesc.Format;
+                viewInfo.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+                viewInfo.subresourceRange.aspectMask = AspectFromFormat(resource.ImageDesc.Format);
+                viewInfo.subresourceRange.baseMipLevel = 0;
+                viewInfo.subresourceRange.levelCount = resource.ImageDesc.MipLevels;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+
+                VK_CHECK(vkCreateImageView(m_Device, &viewInfo, nullptr, &resource.View));
+            }
+        }
+    }
+
+    void RenderGraph::ComputeBarriers()
+    {
+        auto simulate = [&](std::vector<ResourceState>& states, bool emit) {
+            m_PassBarriers.assign(m_ExecutionOrder.size(), BarrierBatch());
+
+            for (usize order = 0; order < m_ExecutionOrder.size(); ++order) {
+                const Pass& pass = m_Passes[m_ExecutionOrder[order]];
+
+                // A pass may touch a resource more than once (e.g. depth read and
+                // write), merge those into one access before deciding on a barrier.
+                std::vector<std::pair<u32, AccessInfo>> accesses;
+                auto merge = [&](const ResourceAccess& access) {
+                    AccessInfo info = GetAccessInfo(access.Access);
+                    for (auto& [resource, merged] : accesses) {
+                        if (resource != access.Resource)
+                            continue;
+
+                        if (merged.Layout != info.Layout)
+                            LOG_WARN("Render graph pass {} uses {} in conflicting layouts", pass.Name, m_Resources[resource].Name);
+
+                        merged.Stage |= info.Stage;
+                        merged.Access |= info.Access;
+                        merged.Write = merged.Write || info.Write;
+                        if (info.Write) merged.Layout = info.Layout;
+                        return;
+                    }
+                    accesses.emplace_back(access.Resource, info);
+                };
+
+                for (const auto& read : pass.Reads) merge(read);
+                for (const auto& write : pass.Writes) merge(write);
+
+                for (const auto& [index, info] : accesses) {
+                    ResourceState& state = states[index];
+                    bool isImage = m_Resources[index].Type == ResourceType::Image;
+
+                    bool layoutChange = isImage && state.Layout != info.Layout;
+                    bool hazard = state.Written || info.Write;
+                    // An earlier read only made the write visible to its own
+                    // stages, a read anywhere else still has to wait on the write.
+                    bool unseen = (info.Stage & ~state.VisibleStage) != 0 || (info.Access & ~state.VisibleAccess) != 0;
+                    bool readAfterWrite = !info.Write && state.WriteStage != VK_PIPELINE_STAGE_2_NONE && unseen;
+
+                    if (!layoutChange && !hazard && !readAfterWrite) {
+                        state.Stage |= info.Stage;
+                        state.Access |= info.Access;
+                        continue;
+                    }
+
+                    ResourceState dst = state;
+                    dst.Layout = isImage ? info.Layout : VK_IMAGE_LAYOUT_UNDEFINED;
+                    dst.Written = info.Write;
+
+                    if (info.Write) {
+                        dst.Stage = info.Stage;
+                        dst.Access = info.Access;
+                        dst.WriteStage = info.Stage;
+                        dst.WriteAccess = info.Access;
+                        dst.VisibleStage = VK_PIPELINE_STAGE_2_NONE;
+                        dst.VisibleAccess = VK_ACCESS_2_NONE;
+                    } else {
+                        // Reads since the write keep piling up for the next write
+                        // to wait on, unless this barrier already waited on them.
+                        bool waited = layoutChange || state.Written;
+                        dst.Stage = waited ? info.Stage : state.Stage | info.Stage;
+                        dst.Access = waited ? info.Access : state.Access | info.Access;
+                        dst.VisibleStage = state.Written ? info.Stage : state.VisibleStage | info.Stage;
+                        dst.VisibleAccess = state.Written ? info.Access : state.VisibleAccess | info.Access;
+                    }
+
+                    if (emit) {
+                        ResourceState src = state;
+                        if (!src.Written)
+                            src.Access = VK_ACCESS_2_NONE;
+
+                        if (readAfterWrite && !layoutChange && !state.Written) {
+                            src.Stage = state.WriteStage;
+                            src.Access = state.WriteAccess;
+                        } else if (readAfterWrite) {
+                            src.Stage |= state.WriteStage;
+                            src.Access |= state.WriteAccess;
+                        }
+
+                        // Only the fields EmitBarriers reads matter for the destination.
+                        ResourceState to;
+                        to.Stage = info.Stage;
+                        to.Access = info.Access;
+                        to.Layout = dst.Layout;
+                        to.Written = info.Write;
+
+                        m_PassBarriers[order].Barriers.push_back({ index, src, to });
+                    }
+
+                    state = dst;
+                }
+            }
+        };
+
+        std::vector<ResourceState> initial(m_Resources.size());
+        for (usize i = 0; i < m_Resources.size(); ++i) {
+            if (m_Resources[i].Imported && m_Resources[i].Type == ResourceType::Image) {
+                initial[i].Stage = m_Resources[i].InitialStage;
+                initial[i].Layout = m_Resources[i].InitialLayout;
+                initial[i].Written = true;
+                initial[i].WriteStage = m_Resources[i].InitialStage;
+            }
+        }
+
+        // First run finds the state every resource is left in at the end of the
+        // frame, which is what the next frame (or the next alias) has to wait on.
+        std::vector<ResourceState> end = initial;
+        simulate(end, false);
+
+        for (usize i = 0; i < m_Resources.size(); ++i) {
+            const Resource& resource = m_Resources[i];
+            if (resource.Imported && resource.Type == ResourceType::Image)
+                continue;
+
+            u32 previous = static_cast<u32>(i);
+            if (resource.MemoryBlock != ~0u) {
+                const auto& occupants = m_MemoryBlocks[resource.MemoryBlock].Resources;
+                auto it = std::find(occupants.begin(), occupants.end(), static_cast<u32>(i));
+                previous = it == occupants.begin() ? occupants.back() : *(it - 1);
+            }
+
+            initial[i].Stage = end[previous].Stage;
+            initial[i].Access = end[previous].Access;
+            initial[i].Written = true;
+            initial[i].WriteStage = end[previous].Stage;
+            initial[i].WriteAccess = end[previous].Access;
+            initial[i].Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        std::vector<ResourceState> states = initial;
+        simulate(states, true);
+
+        m_FinalBarriers = BarrierBatch();
+        for (usize i = 0; i < m_Resources.size(); ++i) {
+            const Resource& resource = m_Resources[i];
+            if (!resource.Imported || resource.Type != ResourceType::Image || resource.FirstPass == ~0u)
+                continue;
+            if (resource.FinalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.FinalLayout == states[i].Layout)
+                continue;
+
+            ResourceState dst;
+            dst.Stage = VK_PIPELINE_STAGE_2_NONE;
+            dst.Access = VK_ACCESS_2_NONE;
+            dst.Layout = resource.FinalLayout;
+
+            m_FinalBarriers.Barriers.push_back({ static_cast<u32>(i), states[i], dst });
+        }
+    }
+
+    void RenderGraph::EmitBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const
+    {
+        if (batch.Barriers.empty())
+            return;
+
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        VkMemoryBarrier2 memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        bool hasMemoryBarrier = false;
+
+        for (const auto& barrier : batch.Barriers) {
+            const Resource& resource = m_Resources[barrier.Resource];
+
+            if (resource.Type == ResourceType::Buffer) {
+                // All buffer hazards in a batch collapse into one global barrier.
+                memoryBarrier.srcStageMask |= barrier.Src.Stage;
+                memoryBarrier.srcAccessMask |= barrier.Src.Access;
+                memoryBarrier.dstStageMask |= barrier.Dst.Stage;
+                memoryBarrier.dstAccessMask |= barrier.Dst.Access;
+                hasMemoryBarrier = true;
+                continue;
+            }
+
+            VkImageMemoryBarrier2 imageBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+            imageBarrier.srcStageMask = barrier.Src.Stage;
+            imageBarrier.srcAccessMask = barrier.Src.Access;
+            imageBarrier.dstStageMask = barrier.Dst.Stage;
+            imageBarrier.dstAccessMask = barrier.Dst.Access;
+            imageBarrier.oldLayout = barrier.Src.Layout;
+            imageBarrier.newLayout = barrier.Dst.Layout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = resource.Image;
+            imageBarrier.subresourceRange.aspectMask = AspectFromFormat(resource.ImageDesc.Format);
+            imageBarrier.subresourceRange.baseMipLevel = 0;
+            imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            imageBarrier.subresourceRange.baseArrayLayer = 0;
+            imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+            imageBarriers.push_back(imageBarrier);
+        }
+
+        VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = hasMemoryBarrier ? 1 : 0;
+        dependencyInfo.pMemoryBarriers = hasMemoryBarrier ? &memoryBarrier : nullptr;
+        dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    }
+
+    void RenderGraph::BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass) const
+    {
+        auto makeAttachment = [&](const Attachment& attachment, VkImageLayout layout) {
+            VkRenderingAttachmentInfo info = { VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+            info.imageView = m_Resources[attachment.Resource].View;
+            info.imageLayout = layout;
+            info.resolveMode = VK_RESOLVE_MODE_NONE;
+
+            if (attachment.Resolve != ~0u) {
+                info.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+                info.resolveImageView = m_Resources[attachment.Resolve].View;
+                info.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+
+            info.loadOp = attachment.LoadOp;
+            info.storeOp = attachment.StoreOp;
+            info.clearValue = attachment.ClearValue;
+            return info;
+        };
+
+        std::vector<VkRenderingAttachmentInfo> colorAttachments;
+        for (const auto& attachment : pass.ColorAttachments)
+            colorAttachments.push_back(makeAttachment(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+        VkRenderingAttachmentInfo depthAttachment;
+        if (pass.DepthAttachment.has_value()) {
+            bool readOnly = pass.DepthAttachment->StoreOp == VK_ATTACHMENT_STORE_OP_NONE;
+            depthAttachment = makeAttachment(*pass.DepthAttachment, readOnly ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        }
+
+        u32 extentSource = !pass.ColorAttachments.empty() ? pass.ColorAttachments[0].Resource : pass.DepthAttachment->Resource;
+
+        VkRenderingInfo renderingInfo = { VK_STRUCTURE_TYPE_RENDERING_INFO };
+        renderingInfo.renderArea.offset = VkOffset2D{ 0, 0 };
+        renderingInfo.renderArea.extent = m_Resources[extentSource].ImageDesc.Extent;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = static_cast<u32>(colorAttachments.size());
+        renderingInfo.pColorAttachments = colorAttachments.data();
+        renderingInfo.pDepthAttachment = pass.DepthAttachment.has_value() ? &depthAttachment : nullptr;
+
+        if (pass.DepthAttachment.has_value() && (AspectFromFormat(m_Resources[pass.DepthAttachment->Resource].ImageDesc.Format) & VK_IMAGE_ASPECT_STENCIL_BIT))
+            renderingInfo.pStencilAttachment = &depthAttachment;
+
+        vkCmdBeginRendering(commandBuffer, &renderingInfo);
+    }
+
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <optional>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "MemoryTracker.hpp"
+
+namespace Graphics {
+
+    class RenderGraph;
+
+    struct RenderGraphResource
+    {
+        u32 Index { ~0u };
+
+        inline bool IsValid() const { return Index != ~0u; }
+    };
+
+    enum class RenderGraphAccess : u8
+    {
+        ColorAttachment,
+        DepthAttachment,
+        DepthAttachmentRead,
+        SampledFragment,
+        SampledCompute,
+        StorageReadCompute,
+        StorageWriteCompute,
+        TransferSrc,
+        TransferDst,
+        VertexBuffer,
+        IndexBuffer,
+        IndirectBuffer,
+        UniformBuffer
+    };
+
+    struct RenderGraphImageDesc
+    {
+        VkFormat Format { VK_FORMAT_UNDEFINED };
+        VkExtent2D Extent { 0, 0 };
+        VkSampleCountFlagBits Samples { VK_SAMPLE_COUNT_1_BIT };
+        u32 MipLevels { 1 };
+    };
+
+    // A barrier in front of a pass, for inspecting what the graph compiled to.
+    struct RenderGraphBarrier
+    {
+        RenderGraphResource Resource;
+        VkPipelineStageFlags2 SrcStage { VK_PIPELINE_STAGE_2_NONE };
+        VkAccessFlags2 SrcAccess { VK_ACCESS_2_NONE };
+        VkPipelineStageFlags2 DstStage { VK_PIPELINE_STAGE_2_NONE };
+        VkAccessFlags2 DstAccess { VK_ACCESS_2_NONE };
+        VkImageLayout OldLayout { VK_IMAGE_LAYOUT_UNDEFINED };
+        VkImageLayout NewLayout { VK_IMAGE_LAYOUT_UNDEFINED };
+    };
+
+    class RenderGraphPassBuilder
+    {
+    public:
+        RenderGraphResource CreateImage(const std::string& name, const RenderGraphImageDesc& desc);
+
+        RenderGraphResource Read(RenderGraphResource resource, RenderGraphAccess access);
+        RenderGraphResource Write(RenderGraphResource resource, RenderGraphAccess access);
+
+        // Attachments make the graph wrap the pass in vkCmdBeginRendering/vkCmdEndRendering.
+        RenderGraphResource WriteColor(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue = {},
+            VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE);
+        RenderGraphResource WriteDepth(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue = {},
+            VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE);
+        RenderGraphResource ReadDepth(RenderGraphResource resource);
+
+        // Resolves a multisampled color attachment of this pass into target at the end of rendering.
+        RenderGraphResource ResolveColor(RenderGraphResource source, RenderGraphResource target);
+
+        // Keeps the pass alive even if nothing reads what it writes.
+        void SideEffect();
+
+    private:
+        friend class RenderGraph;
+
+        RenderGraphPassBuilder(RenderGraph& graph, u32 pass)
+            : m_Graph(graph), m_Pass(pass) {}
+
+        RenderGraph& m_Graph;
+        u32 m_Pass;
+    };
+
+    class RenderGraph
+    {
+    public:
+        using SetupFn = std::function<void(RenderGraphPassBuilder&)>;
+        using ExecuteFn = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+
+    public:
+        RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice, MemoryTracker& memory);
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph&) = delete;
+        RenderGraph& operator=(const RenderGraph&) = delete;
+
+        // Imported images live outside the graph. The graph transitions them from
+        // initialLayout (made visible at initialStage, e.g. the acquire semaphore
+        // wait stage) and leaves them in finalLayout at the end of the frame.
+        RenderGraphResource ImportImage(const std::string& name, const RenderGraphImageDesc& desc,
+            VkImageLayout initialLayout, VkImageLayout finalLayout, VkPipelineStageFlags2 initialStage);
+        RenderGraphResource ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size);
+
+        void SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+        void SetImportedBuffer(RenderGraphResource resource, VkBuffer buffer, VkDeviceSize size);
+
+        void AddPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute);
+
+        // Culls passes that do not contribute to an imported resource or side
+        // effect, computes batched barriers and creates the aliased transient images.
+        void Compile();
+        // With a query pool, writes a timestamp before the first pass and after
+        // every pass, GetActivePassCount() + 1 queries starting at firstQuery.
+        void Execute(VkCommandBuffer commandBuffer, VkQueryPool timestamps = VK_NULL_HANDLE, u32 firstQuery = 0);
+
+        // Destroys every pass and transient resource so the graph can be rebuilt.
+        void Reset();
+
+        VkImage GetImage(RenderGraphResource resource) const;
+        VkImageView GetImageView(RenderGraphResource resource) const;
+        VkBuffer GetBuffer(RenderGraphResource resource) const;
+        const RenderGraphImageDesc& GetImageDesc(RenderGraphResource resource) const;
+
+        inline u32 GetActivePassCount() const { return static_cast<u32>(m_ExecutionOrder.size()); }
+        // Name of the index-th pass in execution order.
+        inline const std::string& GetActivePassName(u32 index) const { return m_Passes[m_ExecutionOrder[index]].Name; }
+        // Barriers recorded in front of the index-th pass in execution order.
+        std::vector<RenderGraphBarrier> GetPassBarriers(u32 index) const;
+        inline u32 GetPassCount() const { return static_cast<u32>(m_Passes.size()); }
+        inline u32 GetMemoryBlockCount() const { return static_cast<u32>(m_MemoryBlocks.size()); }
+        // Memory block a transient image is bound to, ~0u for imported or unused resources.
+        inline u32 GetMemoryBlock(RenderGraphResource resource) const { return m_Resources[resource.Index].MemoryBlock; }
+        inline bool IsMemoryBlockLazy(u32 block) const { return m_MemoryBlocks[block].Lazy; }
+
+    private:
+        friend class RenderGraphPassBuilder;
+
+        enum class ResourceType : u8 { Image, Buffer };
+
+        struct AccessInfo
+        {
+            VkPipelineStageFlags2 Stage;
+            VkAccessFlags2 Access;
+            VkImageLayout Layout;
+            bool Write;
+        };
+
+        struct ResourceState
+        {
+            // Everything since the last write, what the next write or layout change waits on.
+            VkPipelineStageFlags2 Stage { VK_PIPELINE_STAGE_2_NONE };
+            VkAccessFlags2 Access { VK_ACCESS_2_NONE };
+            VkImageLayout Layout { VK_IMAGE_LAYOUT_UNDEFINED };
+            bool Written { false };
+
+            // The last write, and the reads it has been made visible to so far.
+            // A read outside of those needs its own barrier on the write.
+            VkPipelineStageFlags2 WriteStage { VK_PIPELINE_STAGE_2_NONE };
+            VkAccessFlags2 WriteAccess { VK_ACCESS_2_NONE };
+            VkPipelineStageFlags2 VisibleStage { VK_PIPELINE_STAGE_2_NONE };
+            VkAccessFlags2 VisibleAccess { VK_ACCESS_2_NONE };
+        };
+
+        struct Resource
+        {
+            std::string Name;
+            ResourceType Type;
+            bool Imported;
+
+            RenderGraphImageDesc ImageDesc;
+            VkImageUsageFlags ImageUsage { 0 };
+            VkImage Image { VK_NULL_HANDLE };
+            VkImageView View { VK_NULL_HANDLE };
+
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceSize BufferSize { 0 };
+
+            VkImageLayout InitialLayout { VK_IMAGE_LAYOUT_UNDEFINED };
+            VkImageLayout FinalLayout { VK_IMAGE_LAYOUT_UNDEFINED };
+            VkPipelineStageFlags2 InitialStage { VK_PIPELINE_STAGE_2_NONE };
+
+            u32 FirstPass { ~0u };
+            u32 LastPass { 0 };
+            u32 MemoryBlock { ~0u };
+        };
+
+        struct ResourceAccess
+        {
+            u32 Resource;
+            RenderGraphAccess Access;
+        };
+
+        struct Attachment
+        {
+            u32 Resource;
+            VkAttachmentLoadOp LoadOp;
+            VkAttachmentStoreOp StoreOp;
+            VkClearValue ClearValue;
+            u32 Resolve { ~0u };
+        };
+
+        struct Pass
+        {
+            std::string Name;
+            ExecuteFn Execute;
+
+            std::vector<ResourceAccess> Reads;
+            std::vector<ResourceAccess> Writes;
+            std::vector<Attachment> ColorAttachments;
+            std::optional<Attachment> DepthAttachment;
+            bool SideEffect { false };
+            bool Culled { true };
+        };
+
+        struct Barrier
+        {
+            u32 Resource;
+            ResourceState Src;
+            ResourceState Dst;
+        };
+
+        struct BarrierBatch
+        {
+            std::vector<Barrier> Barriers;
+        };
+
+        struct MemoryBlock
+        {
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            VkDeviceSize Size { 0 };
+            u32 MemoryTypeBits { ~0u };
+            bool Lazy { false };
+            std::vector<u32> Resources;
+        };
+
+    private:
+        static AccessInfo GetAccessInfo(RenderGraphAccess access);
+
+        void CullPasses();
+        void ComputeLifetimes();
+        void CreateTransientImages();
+        void ComputeBarriers();
+
+        void EmitBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const;
+        void BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass) const;
+
+
+    private:
+        VkDevice m_Device;
+        VkPhysicalDevice m_PhysicalDevice;
+        MemoryTracker& m_Memory;
+
+        std::vector<Resource> m_Resources;
+        std::vector<Pass> m_Passes;
+
+        std::vector<u32> m_ExecutionOrder;
+        std::vector<BarrierBatch> m_PassBarriers;
+        BarrierBatch m_FinalBarriers;
+
+        std::vector<MemoryBlock> m_MemoryBlocks;
+    };
+
+}
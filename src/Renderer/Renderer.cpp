@@ -2,15 +2,29 @@
 
 #include <sstream>
 #include <fstream>
+#include <filesystem>
 #include <set>
 #include <algorithm>
+#include <cstring>
 
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 
 #include "Core/Log.hpp"
-
-#define VK_CHECK(fn) do { VkResult res_ = fn; if (res_ != VK_SUCCESS) { LOG_ERROR("VK_CHECK Failed: {}", #fn); } } while (false)
+#include "Vulkan.hpp"
+#include "Renderer2D.hpp"
+#include "MeshRenderer.hpp"
+#include "OcclusionCuller.hpp"
+#include "ShaderCompiler.hpp"
+#include "ShaderReloader.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "PipelineCache.hpp"
+#include "QueueTimeline.hpp"
+#include "FrameCapture.hpp"
+#include "DescriptorAllocator.hpp"
+#include "PerfOverlay.hpp"
+#include "ParticleSystem.hpp"
+#include "PostProcess.hpp"
 
 namespace Graphics {
 
@@ -23,24 +37,50 @@ namespace Graphics {
 
     Renderer::Renderer(const std::shared_ptr<Window>& window)
         : m_Window(window)
+    {
+        Init();
+    }
+
+    Renderer::Renderer(VkExtent2D extent)
+        : m_HeadlessExtent(extent)
+    {
+        Init();
+    }
+
+    void Renderer::Init()
     {
         VK_CHECK(volkInitialize());
         CreateInstance();
 
-        VK_CHECK(glfwCreateWindowSurface(s_Instance, static_cast<GLFWwindow*>(m_Window->GetNative()), nullptr, &m_Surface));
+        if (!IsHeadless())
+            VK_CHECK(glfwCreateWindowSurface(s_Instance, static_cast<GLFWwindow*>(m_Window->GetNative()), nullptr, &m_Surface));
 
         PickPhysicalDevice();
         CreateDevice();
 
+        m_MemoryTracker = std::make_unique<MemoryTracker>(m_Device, m_PhysicalDevice, m_MemoryBudget);
+
+        m_GraphicsTimeline = std::make_unique<QueueTimeline>(m_Device, m_GraphicQueue.Queue);
+
+        m_ShaderCompiler = std::make_unique<ShaderCompiler>();
+        m_PipelineLayoutCache = std::make_unique<PipelineLayoutCache>(m_Device);
+        m_DescriptorAllocator = std::make_unique<DescriptorAllocator>(m_Device, s_FrameInFlight);
+        m_PipelineCache = std::make_unique<PipelineCache>(*this);
+        m_ShaderReloader = std::make_unique<ShaderReloader>(*this);
+        m_FrameCapture = std::make_unique<FrameCapture>(*this);
+
         QuerySwapchainCapabilities();
         CreateSwapchain();
 
-        CreateRenderPass();
+        m_DepthFormat = FindDepthFormat();
 
-        CreateFramebuffers();
+        m_MaxSamples = GetMaxSampleCount();
+        m_Samples = std::min(m_Samples, m_MaxSamples);
 
         CreateGraphicsPipeline();
 
+        m_RenderGraph = std::make_unique<RenderGraph>(m_Device, m_PhysicalDevice, *m_MemoryTracker);
+
         CreateCommandPool();
 
         m_Vertices = {
@@ -55,45 +95,74 @@ namespace Graphics {
         CreateVertexBuffer();
         CreateIndexBuffer();
 
+        CreateFrameData();
+
         AllocateCommandBuffers();
 
         CreateSyncObjects();
+        CreateTimestampQueries();
+
+        m_Renderer2D = std::make_unique<Renderer2D>(*this);
+        m_OcclusionCuller = std::make_unique<OcclusionCuller>(*this);
+        m_MeshRenderer = std::make_unique<MeshRenderer>(*this);
+        m_ParticleSystem = std::make_unique<ParticleSystem>(*this);
+        m_PerfOverlay = std::make_unique<PerfOverlay>(*this);
+        m_PostProcess = std::make_unique<PostProcess>(*this);
+
+        // The occlusion culler, particle system and post-processing have to exist before the graph can point them at their targets.
+        BuildRenderGraph();
     }
 
     Renderer::~Renderer()
     {
         vkDeviceWaitIdle(m_Device);
 
-        for (usize i = 0; i < s_FrameInFlight; ++i) {
-			vkDestroyFence(m_Device, m_InFlightFences[i], nullptr);
-			vkDestroySemaphore(m_Device, m_RenderFinishedSemphores[i], nullptr);
-			vkDestroySemaphore(m_Device, m_ImageAvailableSemaphores[i], nullptr);
-        }
+        // Writes out what is still being encoded.
+        m_FrameCapture.reset();
+
+        m_PostProcess.reset();
+        m_PerfOverlay.reset();
+        m_ParticleSystem.reset();
+        m_MeshRenderer.reset();
+        m_OcclusionCuller.reset();
+        m_Renderer2D.reset();
+
+        m_DescriptorAllocator.reset();
+
+        for (VkSemaphore semaphore : m_ImageAvailableSemaphores)
+            vkDestroySemaphore(m_Device, semaphore, nullptr);
 
         vkDestroyBuffer(m_Device, m_IndexBuffer, nullptr);
-        vkFreeMemory(m_Device, m_IndexBufferMemory, nullptr);
+        FreeMemory(m_IndexBufferMemory);
 
         vkDestroyBuffer(m_Device, m_VertexBuffer, nullptr);
-        vkFreeMemory(m_Device, m_VertexBufferMemory, nullptr);
+        FreeMemory(m_VertexBufferMemory);
+
+        DestroyFrameData();
 
         vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
 
-        vkDestroyPipeline(m_Device, m_GraphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(m_Device, m_GraphicsPipelineLayout, nullptr);
+        m_RenderGraph.reset();
 
-        for (auto& framebuffer : m_Swapchain.Framebuffers)
-            vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+        // The reloader's watcher thread invalidates cached pipelines.
+        m_ShaderReloader.reset();
+        m_PipelineCache.reset();
+        m_PipelineLayoutCache.reset();
 
-        vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
+        DestroySwapchain();
 
-        for (auto& imageView : m_Swapchain.ImageViews)
-            vkDestroyImageView(m_Device, imageView, nullptr);
+        if (m_TimestampPool != VK_NULL_HANDLE)
+            vkDestroyQueryPool(m_Device, m_TimestampPool, nullptr);
 
-        vkDestroySwapchainKHR(m_Device, m_Swapchain.Swapchain, nullptr);
+        m_GraphicsTimeline.reset();
+
+        // Last, it reports what the owners above failed to free.
+        m_MemoryTracker.reset();
 
         vkDestroyDevice(m_Device, nullptr);
 
-        vkDestroySurfaceKHR(s_Instance, m_Surface, nullptr);
+        if (!IsHeadless())
+            vkDestroySurfaceKHR(s_Instance, m_Surface, nullptr);
 
 #ifndef NDEBUG
         vkDestroyDebugUtilsMessengerEXT(s_Instance, m_Messenger, nullptr);
@@ -101,54 +170,85 @@ namespace Graphics {
         vkDestroyInstance(s_Instance, nullptr);
     }
 
-    void Renderer::Render(f32 dt)
+    bool Renderer::BeginFrame()
     {
-        (void)dt;
-
-		vkWaitForFences(m_Device, 1, &m_InFlightFences[m_FrameIndex], VK_TRUE, std::numeric_limits<u64>::max());
+        // The slot's previous frame has to finish before its resources are reused.
+        m_GraphicsTimeline->Wait(m_FrameValues[m_FrameIndex]);
 
-        u32 imageIndex;
-        VkResult result = vkAcquireNextImageKHR(m_Device, m_Swapchain.Swapchain, std::numeric_limits<u64>::max(), m_ImageAvailableSemaphores[m_FrameIndex], VK_NULL_HANDLE, &imageIndex);
+        ReadTimestamps();
 
-        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-            Resize();
-            return;
-        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-            LOG_ERROR("Failed to acquire swapchain image");
-            return;
+        if (IsHeadless()) {
+            // Each frame slot renders into its own image, which the wait above freed.
+            m_ImageIndex = static_cast<u32>(m_FrameIndex);
+        } else {
+            VkResult result = vkAcquireNextImageKHR(m_Device, m_Swapchain.Swapchain, std::numeric_limits<u64>::max(), m_ImageAvailableSemaphores[m_FrameIndex], VK_NULL_HANDLE, &m_ImageIndex);
+
+            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                Resize();
+                return false;
+            } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+                LOG_ERROR("Failed to acquire swapchain image");
+                return false;
+            }
         }
 
-        vkResetFences(m_Device, 1, &m_InFlightFences[m_FrameIndex]);
+        m_ShaderReloader->Update();
+        m_PipelineCache->Update();
+        m_FrameCapture->Update();
+        // Evicts before the frame's allocations, while the slot's old resources are known to be idle.
+        m_MemoryTracker->Update();
+        m_DescriptorAllocator->BeginFrame(m_FrameIndex);
+
+        m_Renderer2D->BeginFrame();
+        m_OcclusionCuller->BeginFrame();
+        m_MeshRenderer->BeginFrame();
+        m_ParticleSystem->BeginFrame();
+
+        return true;
+    }
+
+    void Renderer::EndFrame()
+    {
+        u32 imageIndex = m_ImageIndex;
+
+        UpdateFrameData();
 
         vkResetCommandBuffer(m_CommandBuffers[m_FrameIndex], 0);
         RecordCommandBuffer(m_CommandBuffers[m_FrameIndex], imageIndex);
 
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+        VkCommandBufferSubmitInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+        commandBufferInfo.commandBuffer = m_CommandBuffers[m_FrameIndex];
+
+        // Nothing to acquire or present, the frame is done once it is submitted.
+        if (IsHeadless()) {
+            m_FrameValues[m_FrameIndex] = m_GraphicsTimeline->Submit({ &commandBufferInfo, 1 });
+            m_FrameIndex = (m_FrameIndex + 1) % s_FrameInFlight;
+            return;
+        }
+
+        VkSemaphoreSubmitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+        waitInfo.semaphore = m_ImageAvailableSemaphores[m_FrameIndex];
+        waitInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 
-        VkSubmitInfo submitInfo;
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = &m_ImageAvailableSemaphores[m_FrameIndex];
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &m_CommandBuffers[m_FrameIndex];
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &m_RenderFinishedSemphores[m_FrameIndex];
+        // Presentation only takes binary semaphores, one per image so a semaphore
+        // is never signaled again before the present that waits on it.
+        VkSemaphoreSubmitInfo signalInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+        signalInfo.semaphore = m_RenderFinishedSemaphores[imageIndex];
+        signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
-        VK_CHECK(vkQueueSubmit(m_GraphicQueue.Queue, 1, &submitInfo, m_InFlightFences[m_FrameIndex]));
+        m_FrameValues[m_FrameIndex] = m_GraphicsTimeline->Submit({ &commandBufferInfo, 1 }, { &waitInfo, 1 }, { &signalInfo, 1 });
 
         VkPresentInfoKHR presentInfo;
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.pNext = nullptr;
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_RenderFinishedSemphores[m_FrameIndex];
+        presentInfo.pWaitSemaphores = &m_RenderFinishedSemaphores[imageIndex];
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = &m_Swapchain.Swapchain;
         presentInfo.pImageIndices = &imageIndex;
         presentInfo.pResults = NULL;
 
-        result = vkQueuePresentKHR(m_PresentQueue.Queue, &presentInfo);
+        VkResult result = vkQueuePresentKHR(m_PresentQueue.Queue, &presentInfo);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
             Resize();
@@ -157,9 +257,6 @@ namespace Graphics {
             return;
         }
 
-        // TODO: fix validation error -> 1 semaphore per image?
-        vkDeviceWaitIdle(m_Device);
-
         m_FrameIndex = (m_FrameIndex + 1) % s_FrameInFlight;
     }
 
@@ -167,16 +264,111 @@ namespace Graphics {
     {
         vkDeviceWaitIdle(m_Device);
 
-        for (auto& framebuffer : m_Swapchain.Framebuffers)
-            vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+        // Pipeline rebuilds read the swapchain color format.
+        auto suspend = m_ShaderReloader->Suspend();
 
-        for (auto& imageView : m_Swapchain.ImageViews)
-            vkDestroyImageView(m_Device, imageView, nullptr);
+        DestroySwapchain();
+        CreateSwapchain();
 
-        vkDestroySwapchainKHR(m_Device, m_Swapchain.Swapchain, nullptr);
+        BuildRenderGraph();
+    }
 
-        CreateSwapchain();
-        CreateFramebuffers();
+    void Renderer::SetDepthPrepass(bool enabled)
+    {
+        if (enabled == m_DepthPrepass)
+            return;
+
+        vkDeviceWaitIdle(m_Device);
+
+        auto suspend = m_ShaderReloader->Suspend();
+
+        m_DepthPrepass = enabled;
+
+        CreateGraphicsPipeline();
+
+        m_MeshRenderer->CreatePipelines();
+
+        BuildRenderGraph();
+
+        LOG_INFO("Depth prepass {}", m_DepthPrepass ? "enabled" : "disabled");
+    }
+
+    void Renderer::SetOcclusionCulling(bool enabled)
+    {
+        if (enabled == m_OcclusionCulling)
+            return;
+
+        vkDeviceWaitIdle(m_Device);
+
+        m_OcclusionCulling = enabled;
+
+        BuildRenderGraph();
+
+        if (m_OcclusionCulling && !IsOcclusionCullingEnabled())
+            LOG_WARN("Occlusion culling needs the depth prepass and drawIndirectFirstInstance");
+
+        LOG_INFO("Occlusion culling {}", m_OcclusionCulling ? "enabled" : "disabled");
+    }
+
+    void Renderer::SetPerfOverlay(bool enabled)
+    {
+        if (enabled == m_PerfOverlayEnabled)
+            return;
+
+        vkDeviceWaitIdle(m_Device);
+
+        m_PerfOverlayEnabled = enabled;
+
+        // The frame times would include the time it was hidden.
+        if (m_PerfOverlayEnabled)
+            m_PerfOverlay->Reset();
+
+        BuildRenderGraph();
+    }
+
+    void Renderer::SetPostProcessSettings(const PostProcessSettings& settings)
+    {
+        bool rebuild = settings.Bloom != m_PostProcess->GetSettings().Bloom;
+
+        if (rebuild)
+            vkDeviceWaitIdle(m_Device);
+
+        m_PostProcess->SetSettings(settings);
+
+        if (rebuild) {
+            BuildRenderGraph();
+            LOG_INFO("Bloom {}", settings.Bloom ? "enabled" : "disabled");
+        }
+    }
+
+    const PostProcessSettings& Renderer::GetPostProcessSettings() const
+    {
+        return m_PostProcess->GetSettings();
+    }
+
+    void Renderer::SetSampleCount(VkSampleCountFlagBits samples)
+    {
+        samples = std::min(samples, m_MaxSamples);
+        if (samples == m_Samples)
+            return;
+
+        vkDeviceWaitIdle(m_Device);
+
+        auto suspend = m_ShaderReloader->Suspend();
+
+        m_Samples = samples;
+
+        CreateGraphicsPipeline();
+
+        m_Renderer2D->CreatePipelines();
+
+        m_MeshRenderer->CreatePipelines();
+
+        m_ParticleSystem->CreatePipelines();
+
+        BuildRenderGraph();
+
+        LOG_INFO("MSAA {}x", static_cast<u32>(m_Samples));
     }
 
     void Renderer::CreateInstance()
@@ -184,7 +376,7 @@ namespace Graphics {
         VkApplicationInfo info;
         info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
         info.pNext = nullptr;
-        info.pApplicationName = m_Window->Title().c_str();
+        info.pApplicationName = IsHeadless() ? "Graphics" : m_Window->Title().c_str();
         info.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
         info.pEngineName = "Graphics";
         info.engineVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
@@ -193,10 +385,12 @@ namespace Graphics {
         std::vector<const char*> layers;
         std::vector<const char*> extensions;
 
-        extensions.push_back("VK_KHR_surface");
+        if (!IsHeadless()) {
+            extensions.push_back("VK_KHR_surface");
 #ifdef VK_USE_PLATFORM_WIN32_KHR
-        extensions.push_back("VK_KHR_win32_surface");
+            extensions.push_back("VK_KHR_win32_surface");
 #endif
+        }
 
 #ifndef NDEBUG
         layers.push_back("VK_LAYER_KHRONOS_validation");
@@ -251,7 +445,8 @@ namespace Graphics {
             VkPhysicalDeviceProperties props;
             vkGetPhysicalDeviceProperties(device, &props);
 
-            if (props.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+            // Headless rendering also runs on integrated and software devices, e.g. lavapipe in CI.
+            if (!IsHeadless() && props.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
                 continue;
 
             m_GraphicQueue.Index.reset();
@@ -268,7 +463,8 @@ namespace Graphics {
                     m_GraphicQueue.Index = idx;
 
                 VkBool32 presentSupport = VK_FALSE;
-                vkGetPhysicalDeviceSurfaceSupportKHR(device, idx, m_Surface, &presentSupport);
+                if (!IsHeadless())
+                    vkGetPhysicalDeviceSurfaceSupportKHR(device, idx, m_Surface, &presentSupport);
 
                 if (presentSupport == VK_TRUE)
                     m_PresentQueue.Index = idx;
@@ -276,16 +472,31 @@ namespace Graphics {
                 idx++;
             }
 
+            if (IsHeadless())
+                m_PresentQueue.Index = m_GraphicQueue.Index;
+
             if (!m_GraphicQueue.Index.has_value()) continue;
             if (!m_PresentQueue.Index.has_value()) continue;
 
-            u32 formatCount = 0;
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_Surface, &formatCount, nullptr);
-            if (formatCount <= 0) continue;
+            if (!IsHeadless()) {
+                u32 formatCount = 0;
+                vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_Surface, &formatCount, nullptr);
+                if (formatCount <= 0) continue;
+
+                u32 presentModeCount = 0;
+                vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_Surface, &presentModeCount, nullptr);
+                if (presentModeCount <= 0) continue;
+            }
 
-            u32 presentModeCount = 0;
-            vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_Surface, &presentModeCount, nullptr);
-            if (presentModeCount <= 0) continue;
+            VkPhysicalDeviceVulkan13Features features13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+            VkPhysicalDeviceVulkan12Features features12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+            features12.pNext = &features13;
+            VkPhysicalDeviceFeatures2 features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features2.pNext = &features12;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            if (!features13.dynamicRendering || !features13.synchronization2) continue;
+            if (!features12.shaderSampledImageArrayNonUniformIndexing || !features12.timelineSemaphore) continue;
 
             m_PhysicalDevice = device;
             LOG_INFO("Physical device: {}", props.deviceName);
@@ -315,15 +526,48 @@ namespace Graphics {
             });
         }
 
-        VkPhysicalDeviceFeatures features {};
+        VkPhysicalDeviceVulkan13Features features13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+        features13.synchronization2 = VK_TRUE;
+        features13.dynamicRendering = VK_TRUE;
 
-        std::vector<const char*> extensions = {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME
-        };
+        VkPhysicalDeviceVulkan12Features features12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+        features12.pNext = &features13;
+        features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        features12.timelineSemaphore = VK_TRUE;
+
+        VkPhysicalDeviceFeatures supported;
+        vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supported);
+
+        // Optional, occlusion culling draws through indirect commands that index
+        // the instance buffer with firstInstance.
+        m_MultiDrawIndirect = supported.multiDrawIndirect == VK_TRUE;
+        m_DrawIndirectFirstInstance = supported.drawIndirectFirstInstance == VK_TRUE;
+
+        VkPhysicalDeviceFeatures2 features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        features.pNext = &features12;
+        features.features.multiDrawIndirect = supported.multiDrawIndirect;
+        features.features.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+
+        std::vector<const char*> extensions;
+        if (!IsHeadless())
+            extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+        u32 extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> available(extensionCount);
+        vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, available.data());
+
+        // Optional, without it the memory tracker estimates budgets from the heap sizes.
+        m_MemoryBudget = std::any_of(available.begin(), available.end(), [](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+        });
+
+        if (m_MemoryBudget)
+            extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
         VkDeviceCreateInfo createInfo;
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        createInfo.pNext = nullptr;
+        createInfo.pNext = &features;
         createInfo.flags = 0;
         createInfo.queueCreateInfoCount = queueCreateInfos.size();
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -331,7 +575,7 @@ namespace Graphics {
         createInfo.ppEnabledLayerNames = nullptr;
         createInfo.enabledExtensionCount = extensions.size();
         createInfo.ppEnabledExtensionNames = extensions.data();
-        createInfo.pEnabledFeatures = &features;
+        createInfo.pEnabledFeatures = nullptr;
 
         VK_CHECK(vkCreateDevice(m_PhysicalDevice, &createInfo, nullptr, &m_Device));
         volkLoadDevice(m_Device);
@@ -342,6 +586,13 @@ namespace Graphics {
 
     void Renderer::QuerySwapchainCapabilities()
     {
+        // Headless images use the format a desktop surface usually picks, so
+        // tests see the same output as the window.
+        if (IsHeadless()) {
+            m_Swapchain.SurfaceFormat = { VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+            return;
+        }
+
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_PhysicalDevice, m_Surface, &m_Swapchain.Capabilities);
 
 		u32 formatCount = 0;
@@ -385,6 +636,11 @@ namespace Graphics {
 
     void Renderer::CreateSwapchain()
     {
+        if (IsHeadless()) {
+            CreateHeadlessImages();
+            return;
+        }
+
         m_Swapchain.Extent = GetSwapchainExtent();
 
         m_Swapchain.ImageCount = m_Swapchain.Capabilities.minImageCount + 1;
@@ -403,6 +659,12 @@ namespace Graphics {
         createInfo.imageArrayLayers = 1;
         createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+        // Frames can only be captured from swapchains that allow copies out of their images.
+        if (m_Swapchain.Capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+            createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+        m_Swapchain.Capturable = (createInfo.imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) && FrameCapture::IsFormatSupported(m_Swapchain.SurfaceFormat.format);
+
         if (m_GraphicQueue.Index.value() != m_PresentQueue.Index.value()) {
             std::array<u32, 2> indices = {
                 m_GraphicQueue.Index.value(),
@@ -451,105 +713,181 @@ namespace Graphics {
 
             VK_CHECK(vkCreateImageView(m_Device, &imageViewCreateInfo, nullptr, &m_Swapchain.ImageViews[i]));
         }
-    }
 
-    void Renderer::CreateRenderPass()
-	{
-		VkAttachmentDescription colorAttachment;
-		colorAttachment.flags = 0;
-		colorAttachment.format = m_Swapchain.SurfaceFormat.format;
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkAttachmentReference colorAttachmentRef;
-		colorAttachmentRef.attachment = 0;
-		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass;
-		subpass.flags = 0;
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.inputAttachmentCount = 0;
-		subpass.pInputAttachments = nullptr;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
-		subpass.pResolveAttachments = nullptr;
-		subpass.pDepthStencilAttachment = nullptr;
-		subpass.preserveAttachmentCount = 0;
-		subpass.pPreserveAttachments = nullptr;
-
-		VkSubpassDependency dependency;
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependency.dependencyFlags = 0;
-
-		VkRenderPassCreateInfo createInfo;
-		createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		createInfo.pNext = nullptr;
-		createInfo.flags = 0;
-		createInfo.attachmentCount = 1;
-		createInfo.pAttachments = &colorAttachment;
-		createInfo.subpassCount = 1;
-		createInfo.pSubpasses = &subpass;
-		createInfo.dependencyCount = 1;
-		createInfo.pDependencies = &dependency;
-
-		VK_CHECK(vkCreateRenderPass(m_Device, &createInfo, nullptr, &m_RenderPass));
-	}
+        VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+
+        m_RenderFinishedSemaphores.resize(m_Swapchain.ImageCount);
+        for (auto& semaphore : m_RenderFinishedSemaphores)
+            VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &semaphore));
+    }
 
-    void Renderer::CreateFramebuffers()
+    void Renderer::CreateHeadlessImages()
     {
-        m_Swapchain.Framebuffers.resize(m_Swapchain.ImageCount);
+        m_Swapchain.Extent = m_HeadlessExtent;
+        m_Swapchain.ImageCount = static_cast<u32>(s_FrameInFlight);
+        m_Swapchain.Capturable = FrameCapture::IsFormatSupported(m_Swapchain.SurfaceFormat.format);
+
+        m_Swapchain.Images.resize(m_Swapchain.ImageCount);
+        m_Swapchain.ImageViews.resize(m_Swapchain.ImageCount);
+        m_Swapchain.ImageMemory.resize(m_Swapchain.ImageCount);
 
         for (usize i = 0; i < m_Swapchain.ImageCount; ++i) {
-            VkImageView attachment[] = { m_Swapchain.ImageViews[i] };
+            VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = m_Swapchain.SurfaceFormat.format;
+            imageInfo.extent = { m_Swapchain.Extent.width, m_Swapchain.Extent.height, 1 };
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VK_CHECK(vkCreateImage(m_Device, &imageInfo, nullptr, &m_Swapchain.Images[i]));
+
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(m_Device, m_Swapchain.Images[i], &requirements);
+
+            VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+            allocInfo.allocationSize = requirements.size;
+            allocInfo.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VK_CHECK(AllocateMemory(allocInfo, MemoryCategory::RenderTarget, "Swapchain", m_Swapchain.ImageMemory[i]));
+            VK_CHECK(vkBindImageMemory(m_Device, m_Swapchain.Images[i], m_Swapchain.ImageMemory[i], 0));
+
+            VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+            viewInfo.image = m_Swapchain.Images[i];
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = m_Swapchain.SurfaceFormat.format;
+            viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+            VK_CHECK(vkCreateImageView(m_Device, &viewInfo, nullptr, &m_Swapchain.ImageViews[i]));
+        }
+    }
+
+    void Renderer::DestroySwapchain()
+    {
+        for (auto& imageView : m_Swapchain.ImageViews)
+            vkDestroyImageView(m_Device, imageView, nullptr);
+
+        for (VkSemaphore semaphore : m_RenderFinishedSemaphores)
+            vkDestroySemaphore(m_Device, semaphore, nullptr);
+
+        m_RenderFinishedSemaphores.clear();
+
+        if (IsHeadless()) {
+            for (usize i = 0; i < m_Swapchain.Images.size(); ++i) {
+                vkDestroyImage(m_Device, m_Swapchain.Images[i], nullptr);
+                FreeMemory(m_Swapchain.ImageMemory[i]);
+            }
+        } else {
+            vkDestroySwapchainKHR(m_Device, m_Swapchain.Swapchain, nullptr);
+        }
+    }
+
+    VkFormat Renderer::FindDepthFormat()
+    {
+        // D32 keeps enough precision for reverse-Z, stencil formats are fallbacks.
+        std::array<VkFormat, 3> candidates = {
+            VK_FORMAT_D32_SFLOAT,
+            VK_FORMAT_D32_SFLOAT_S8_UINT,
+            VK_FORMAT_D24_UNORM_S8_UINT
+        };
+
+        for (VkFormat format : candidates) {
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &props);
+
+            if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+                return format;
+        }
 
-            VkFramebufferCreateInfo createInfo;
-			createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			createInfo.pNext = nullptr;
-			createInfo.flags = 0;
-			createInfo.renderPass = m_RenderPass;
-			createInfo.attachmentCount = 1;
-			createInfo.pAttachments = attachment;
-			createInfo.width = m_Swapchain.Extent.width;
-			createInfo.height = m_Swapchain.Extent.height;
-			createInfo.layers = 1;
+        LOG_ERROR("No supported depth format found");
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    VkSampleCountFlagBits Renderer::GetMaxSampleCount()
+    {
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(m_PhysicalDevice, &props);
 
-            VK_CHECK(vkCreateFramebuffer(m_Device, &createInfo, nullptr, &m_Swapchain.Framebuffers[i]));
+        VkSampleCountFlags counts = props.limits.framebufferColorSampleCounts & props.limits.framebufferDepthSampleCounts;
+
+        for (VkSampleCountFlagBits samples : { VK_SAMPLE_COUNT_8_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT }) {
+            if (counts & samples)
+                return samples;
         }
+
+        return VK_SAMPLE_COUNT_1_BIT;
     }
 
     VkShaderModule Renderer::LoadShader(const std::string& filepath)
     {
         LOG_DEBUG("Loading shader {}", filepath);
 
-        std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-        if (!file.is_open()) {
-            LOG_ERROR("Failed to open file {}", filepath);
+        std::vector<u32> code = LoadShaderCode(filepath);
+        if (code.empty())
+            return VK_NULL_HANDLE;
+
+        return CreateShaderModule(code);
+    }
+
+    VkShaderModule Renderer::CompileShader(const std::string& source, const std::vector<ShaderDefine>& defines)
+    {
+        std::vector<u32> code = m_ShaderCompiler->Compile(source, defines);
+        if (code.empty())
             return VK_NULL_HANDLE;
+
+        return CreateShaderModule(code);
+    }
+
+    ShaderReflection Renderer::ReflectShaders(const std::vector<std::string>& sources)
+    {
+        ShaderReflection reflection;
+
+        for (const auto& source : sources) {
+            ShaderReflection stage = ShaderReflection::Reflect(LoadShaderCode("shaders/" + source + ".spv"));
+            if (!stage.IsValid()) {
+                LOG_ERROR("Failed to reflect {}", source);
+                return ShaderReflection();
+            }
+
+            reflection.Merge(stage);
         }
 
-        usize fileSize = static_cast<usize>(file.tellg());
-        std::vector<char> buffer(fileSize);
+        return reflection;
+    }
 
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
+    std::vector<u32> Renderer::LoadShaderCode(const std::string& filepath)
+    {
+        std::vector<u32> code = ShaderCompiler::ReadBinary(filepath);
 
+        // Binaries are named after their source, shaders/Mesh.vert.spv comes
+        // from Mesh.vert, so a missing one can be compiled at runtime.
+        if (code.empty()) {
+            std::string source = std::filesystem::path(filepath).stem().string();
+
+            if (!ShaderCompiler::IsShaderStage(source)) {
+                LOG_ERROR("Failed to open file {}", filepath);
+                return {};
+            }
+
+            LOG_WARN("Missing {}, compiling {} at runtime", filepath, source);
+            code = m_ShaderCompiler->Compile(source);
+        }
+
+        return code;
+    }
+
+    VkShaderModule Renderer::CreateShaderModule(const std::vector<u32>& code)
+    {
         VkShaderModuleCreateInfo createInfo;
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         createInfo.pNext = nullptr;
         createInfo.flags = 0;
-        createInfo.codeSize = buffer.size();
-        createInfo.pCode = reinterpret_cast<const u32*>(buffer.data());
+        createInfo.codeSize = code.size() * sizeof(u32);
+        createInfo.pCode = code.data();
 
         VkShaderModule shaderModule;
         VK_CHECK(vkCreateShaderModule(m_Device, &createInfo, nullptr, &shaderModule));
@@ -559,167 +897,58 @@ namespace Graphics {
 
 	void Renderer::CreateGraphicsPipeline()
 	{
-		VkShaderModule vertShader = LoadShader("shaders/Triangle.vert.spv");
-		VkShaderModule fragShader = LoadShader("shaders/Triangle.frag.spv");
-
-		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {
-			VkPipelineShaderStageCreateInfo {
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.stage = VK_SHADER_STAGE_VERTEX_BIT,
-				.module = vertShader,
-				.pName = "main",
-				.pSpecializationInfo = nullptr
-			},
-			{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-				.module = fragShader,
-				.pName = "main",
-				.pSpecializationInfo = nullptr
-			}
-		};
-
-		std::array<VkDynamicState, 2> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-		VkPipelineDynamicStateCreateInfo dynamicState;
-		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicState.pNext = nullptr;
-		dynamicState.flags = 0;
-		dynamicState.dynamicStateCount = dynamicStates.size();
-		dynamicState.pDynamicStates = dynamicStates.data();
-
-        VkVertexInputBindingDescription bindingDescription = Vertex::BindingDescription();
-        std::array<VkVertexInputAttributeDescription, 2> attributeDescription = Vertex::AttributeDescription();
-
-		VkPipelineVertexInputStateCreateInfo vertexInputState;
-		vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputState.pNext = nullptr;
-		vertexInputState.flags = 0;
-		vertexInputState.vertexBindingDescriptionCount = 1;
-		vertexInputState.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputState.vertexAttributeDescriptionCount = attributeDescription.size();
-		vertexInputState.pVertexAttributeDescriptions = attributeDescription.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState;
-		inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyState.pNext = nullptr;
-		inputAssemblyState.flags = 0;
-		inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyState.primitiveRestartEnable = VK_FALSE;
-
-		VkViewport viewport;
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = m_Swapchain.Extent.width;
-		viewport.height = m_Swapchain.Extent.height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+		ShaderReflection reflection = ReflectShaders({ "Triangle.vert", "Triangle.frag" });
+		DeclareFrameData(reflection);
+
+		// Owned by the layout cache, shared with any pipeline of the same interface.
+		m_GraphicsPipelineLayout = m_PipelineLayoutCache->GetPipelineLayout(reflection);
+
+		// Compiled on the pipeline cache's workers, the quad is drawn flat until
+		// the main pipeline is ready. The fallback is queued first so it is.
+		m_TrianglePipeline = GetTrianglePipelineDesc(false);
+		m_TriangleFallbackPipeline = m_TrianglePipeline.GetFallback();
+		m_PipelineCache->Prewarm(m_TriangleFallbackPipeline);
+		m_PipelineCache->Prewarm(m_TrianglePipeline);
+
+		if (m_DepthPrepass) {
+			m_TriangleDepthPipeline = GetTrianglePipelineDesc(true);
+			m_PipelineCache->Prewarm(m_TriangleDepthPipeline);
+		}
+	}
 
-		VkRect2D scissor;
-		scissor.offset = VkOffset2D{ 0, 0 };
-		scissor.extent = m_Swapchain.Extent;
+	PipelineDesc Renderer::GetTrianglePipelineDesc(bool depthOnly) const
+	{
+		static constexpr auto vertexLayout = Vertex::Layout();
+		static_assert(vertexLayout.IsValid(), "Vertex attributes overlap or exceed the stride");
+
+		PipelineDesc desc;
+		desc.Shaders = { "Triangle.vert", "Triangle.frag" };
+		desc.Layout = m_GraphicsPipelineLayout;
+		desc.SetVertexLayout(vertexLayout);
+
+		// The quad is flat and may be seen from either side of the camera.
+		desc.CullMode = VK_CULL_MODE_NONE;
+
+		// Reverse-Z: depth is cleared to 0 and nearer fragments have larger depth.
+		// With the prepass the main pass only shades the fragment that won the
+		// prepass, so every pixel is shaded once.
+		desc.DepthWrite = !m_DepthPrepass;
+		desc.DepthCompare = m_DepthPrepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_GREATER_OR_EQUAL;
+
+		desc.ColorFormats = { s_SceneColorFormat };
+		desc.DepthFormat = m_DepthFormat;
+		desc.StencilFormat = GetStencilFormat();
+		desc.Samples = m_Samples;
+
+		if (depthOnly) {
+			// Vertex-only variant of the same pipeline that writes depth and nothing else.
+			desc.Shaders = { "Triangle.vert" };
+			desc.DepthWrite = true;
+			desc.DepthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL;
+			desc.ColorFormats.clear();
+		}
 
-		VkPipelineViewportStateCreateInfo viewportState;
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.pNext = nullptr;
-		viewportState.flags = 0;
-		viewportState.viewportCount = 1;
-		viewportState.pViewports = &viewport;
-		viewportState.scissorCount = 1;
-		viewportState.pScissors = &scissor;
-
-		VkPipelineRasterizationStateCreateInfo rasterizationState;
-		rasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizationState.pNext = nullptr;
-		rasterizationState.flags = 0;
-		rasterizationState.depthClampEnable = VK_FALSE;
-		rasterizationState.rasterizerDiscardEnable = VK_FALSE;
-		rasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		rasterizationState.depthBiasEnable = VK_FALSE;
-		rasterizationState.depthBiasConstantFactor = 0.0f;
-		rasterizationState.depthBiasClamp = 0.0f;
-		rasterizationState.depthBiasSlopeFactor = 0.0f;
-		rasterizationState.lineWidth = 1.0f;
-
-		VkPipelineMultisampleStateCreateInfo multisampleState;
-		multisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampleState.pNext = nullptr;
-		multisampleState.flags = 0;
-		multisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisampleState.sampleShadingEnable = VK_FALSE;
-		multisampleState.minSampleShading = 1.0f;
-		multisampleState.pSampleMask = nullptr;
-		multisampleState.alphaToCoverageEnable = VK_FALSE;
-		multisampleState.alphaToOneEnable = VK_FALSE;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachment;
-		colorBlendAttachment.blendEnable = VK_FALSE;
-		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendState;
-		colorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendState.pNext = nullptr;
-		colorBlendState.flags = 0;
-		colorBlendState.logicOpEnable = VK_FALSE;
-		colorBlendState.logicOp = VK_LOGIC_OP_COPY;
-		colorBlendState.attachmentCount = 1;
-		colorBlendState.pAttachments = &colorBlendAttachment;
-		colorBlendState.blendConstants[0] = 0.0f;
-		colorBlendState.blendConstants[1] = 0.0f;
-		colorBlendState.blendConstants[2] = 0.0f;
-		colorBlendState.blendConstants[3] = 0.0f;
-
-		VkPipelineLayoutCreateInfo layoutCreateInfo;
-		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		layoutCreateInfo.pNext = nullptr;
-		layoutCreateInfo.flags = 0;
-		layoutCreateInfo.setLayoutCount = 0;
-		layoutCreateInfo.pSetLayouts = nullptr;
-		layoutCreateInfo.pushConstantRangeCount = 0;
-		layoutCreateInfo.pPushConstantRanges = nullptr;
-
-		VK_CHECK(vkCreatePipelineLayout(m_Device, &layoutCreateInfo, nullptr, &m_GraphicsPipelineLayout));
-
-		VkGraphicsPipelineCreateInfo createInfo;
-		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		createInfo.pNext = nullptr;
-		createInfo.flags = 0;
-		createInfo.stageCount = shaderStages.size();
-		createInfo.pStages = shaderStages.data();
-		createInfo.pVertexInputState = &vertexInputState;
-		createInfo.pInputAssemblyState = &inputAssemblyState;
-		createInfo.pTessellationState = nullptr;
-		createInfo.pViewportState = &viewportState;
-		createInfo.pRasterizationState = &rasterizationState;
-		createInfo.pMultisampleState = &multisampleState;
-		createInfo.pDepthStencilState = nullptr;
-		createInfo.pColorBlendState = &colorBlendState;
-		createInfo.pDynamicState = &dynamicState;
-		createInfo.layout = m_GraphicsPipelineLayout;
-        createInfo.renderPass = m_RenderPass;
-		createInfo.subpass = 0;
-		createInfo.basePipelineHandle = VK_NULL_HANDLE;
-		createInfo.basePipelineIndex = -1;
-
-		VK_CHECK(vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &m_GraphicsPipeline));
-
-		vkDestroyShaderModule(m_Device, vertShader, nullptr);
-		vkDestroyShaderModule(m_Device, fragShader, nullptr);
+		return desc;
 	}
 
     void Renderer::CreateCommandPool()
@@ -739,19 +968,19 @@ namespace Graphics {
 
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
-        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Renderer");
 
         void* data;
         vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &data);
         memcpy(data, m_Vertices.data(), bufferSize);
         vkUnmapMemory(m_Device, stagingBufferMemory);
 
-        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory, "Renderer");
 
         CopyBuffer(stagingBuffer, m_VertexBuffer, bufferSize);
 
         vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
-        vkFreeMemory(m_Device, stagingBufferMemory, nullptr);
+        FreeMemory(stagingBufferMemory);
     }
 
     void Renderer::CreateIndexBuffer()
@@ -760,19 +989,19 @@ namespace Graphics {
 
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
-        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Renderer");
 
         void* data;
         vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &data);
         memcpy(data, m_Indices.data(), bufferSize);
         vkUnmapMemory(m_Device, stagingBufferMemory);
 
-        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory, "Renderer");
 
         CopyBuffer(stagingBuffer, m_IndexBuffer, bufferSize);
 
         vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
-        vkFreeMemory(m_Device, stagingBufferMemory, nullptr);
+        FreeMemory(stagingBufferMemory);
     }
 
     void Renderer::AllocateCommandBuffers()
@@ -798,27 +1027,402 @@ namespace Graphics {
 
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
-		VkClearValue clearColor = {{{ 0.0f, 0.0f, 0.0f, 1.0f }}};
+		u32 firstQuery = static_cast<u32>(m_FrameIndex) * s_TimestampsPerFrame;
+
+		if (m_TimestampPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, m_TimestampPool, firstQuery, s_TimestampsPerFrame);
+			vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_TimestampPool, firstQuery);
+		}
+
+		// Passes are only timed if all of them fit in the slot's queries.
+		u32 passCount = m_RenderGraph->GetActivePassCount();
+		bool timePasses = m_TimestampPool != VK_NULL_HANDLE && passCount <= s_MaxTimedPasses;
 
-		VkRenderPassBeginInfo renderPassInfo;
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.pNext = nullptr;
-		renderPassInfo.renderPass = m_RenderPass;
-		renderPassInfo.framebuffer = m_Swapchain.Framebuffers[imageIndex];
-		renderPassInfo.renderArea.offset = VkOffset2D{ 0, 0 };
-		renderPassInfo.renderArea.extent = m_Swapchain.Extent;
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
+		std::vector<std::string>& timedPasses = m_TimedPasses[m_FrameIndex];
+		timedPasses.resize(timePasses ? passCount : 0);
+		for (u32 i = 0; i < timedPasses.size(); ++i)
+			timedPasses[i] = m_RenderGraph->GetActivePassName(i);
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		m_RenderGraph->SetImportedImage(m_BackbufferResource, m_Swapchain.Images[imageIndex], m_Swapchain.ImageViews[imageIndex]);
 
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+		if (IsOcclusionCullingEnabled()) {
+			m_RenderGraph->SetImportedBuffer(m_DrawResources[0], m_OcclusionCuller->GetDrawBuffer(CullPhase::Early), OcclusionCuller::GetDrawBufferSize());
+			m_RenderGraph->SetImportedBuffer(m_DrawResources[1], m_OcclusionCuller->GetDrawBuffer(CullPhase::Late), OcclusionCuller::GetDrawBufferSize());
+		}
+
+		m_RenderGraph->Execute(commandBuffer, timePasses ? m_TimestampPool : VK_NULL_HANDLE, firstQuery + 2);
+
+		if (m_TimestampPool != VK_NULL_HANDLE) {
+			vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_TimestampPool, firstQuery + 1);
+			m_TimestampsWritten[m_FrameIndex] = true;
+		}
+
+		VK_CHECK(vkEndCommandBuffer(commandBuffer));
+    }
+
+    void Renderer::BuildRenderGraph()
+    {
+        // Views of the previous graph's images go first.
+        m_OcclusionCuller->ReleaseTargets();
+        m_ParticleSystem->ReleaseTargets();
+        m_PostProcess->ReleaseTargets();
+        m_RenderGraph->Reset();
+
+        RenderGraphImageDesc backbufferDesc;
+        backbufferDesc.Format = m_Swapchain.SurfaceFormat.format;
+        backbufferDesc.Extent = m_Swapchain.Extent;
+
+        // PRESENT_SRC needs the swapchain extension, headless images end up ready to be copied out.
+        VkImageLayout finalLayout = IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        m_BackbufferResource = m_RenderGraph->ImportImage("Backbuffer", backbufferDesc,
+            VK_IMAGE_LAYOUT_UNDEFINED, finalLayout, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+        RenderGraphImageDesc depthDesc;
+        depthDesc.Format = m_DepthFormat;
+        depthDesc.Extent = m_Swapchain.Extent;
+        depthDesc.Samples = m_Samples;
+
+        VkClearValue clearDepth;
+        clearDepth.depthStencil = { 0.0f, 0 };
+
+        // Occlusion culling splits the prepass in two: what was visible last frame
+        // is drawn first, the depth pyramid is built from it, and the second half
+        // draws whatever the pyramid test finds newly visible.
+        bool occlusion = IsOcclusionCullingEnabled();
+
+        if (occlusion) {
+            m_VisibilityResource = m_RenderGraph->ImportBuffer("Visibility", m_OcclusionCuller->GetVisibilityBuffer(), OcclusionCuller::GetVisibilityBufferSize());
+            m_DrawResources[0] = m_RenderGraph->ImportBuffer("EarlyDraws", VK_NULL_HANDLE, OcclusionCuller::GetDrawBufferSize());
+            m_DrawResources[1] = m_RenderGraph->ImportBuffer("LateDraws", VK_NULL_HANDLE, OcclusionCuller::GetDrawBufferSize());
+
+            m_RenderGraph->AddPass("CullEarly",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.Read(m_VisibilityResource, RenderGraphAccess::StorageReadCompute);
+                    builder.Write(m_DrawResources[0], RenderGraphAccess::StorageWriteCompute);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    m_OcclusionCuller->RecordCull(commandBuffer, CullPhase::Early);
+                }
+            );
+        }
+
+        if (m_DepthPrepass) {
+            m_RenderGraph->AddPass("DepthPrepass",
+                [&](RenderGraphPassBuilder& builder) {
+                    m_DepthResource = builder.CreateImage("Depth", depthDesc);
+                    builder.WriteDepth(m_DepthResource, VK_ATTACHMENT_LOAD_OP_CLEAR, clearDepth);
+
+                    if (occlusion)
+                        builder.Read(m_DrawResources[0], RenderGraphAccess::IndirectBuffer);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    RecordDepthPrepass(commandBuffer);
+                }
+            );
+        }
+
+        if (occlusion) {
+            m_RenderGraph->AddPass("HiZ",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.Read(m_DepthResource, RenderGraphAccess::SampledCompute);
+
+                    m_PyramidResource = builder.CreateImage("HiZ", OcclusionCuller::GetPyramidDesc(m_Swapchain.Extent));
+                    builder.Write(m_PyramidResource, RenderGraphAccess::StorageWriteCompute);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    m_OcclusionCuller->RecordPyramid(commandBuffer);
+                }
+            );
+
+            m_RenderGraph->AddPass("CullLate",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.Read(m_PyramidResource, RenderGraphAccess::SampledCompute);
+                    builder.Write(m_VisibilityResource, RenderGraphAccess::StorageWriteCompute);
+                    builder.Write(m_DrawResources[1], RenderGraphAccess::StorageWriteCompute);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    m_OcclusionCuller->RecordCull(commandBuffer, CullPhase::Late);
+                }
+            );
+
+            m_RenderGraph->AddPass("DepthPrepassLate",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.WriteDepth(m_DepthResource, VK_ATTACHMENT_LOAD_OP_LOAD);
+                    builder.Read(m_DrawResources[1], RenderGraphAccess::IndirectBuffer);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    SetViewport(commandBuffer);
+                    m_MeshRenderer->RecordDepthPrepass(commandBuffer, CullPhase::Late);
+                }
+            );
+        }
+
+        // Emits and simulates after the prepass so particles collide with this
+        // frame's depth. Always part of the graph and records nothing without
+        // particle groups, so creating or destroying groups never rebuilds it.
+        m_RenderGraph->AddPass("Particles",
+            [&](RenderGraphPassBuilder& builder) {
+                if (m_DepthPrepass)
+                    builder.Read(m_DepthResource, RenderGraphAccess::SampledCompute);
+
+                builder.SideEffect();
+            },
+            [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                m_ParticleSystem->RecordSimulation(commandBuffer);
+            }
+        );
+
+        // The scene is drawn in HDR, post-processing brings it to the backbuffer.
+        RenderGraphImageDesc sceneColorDesc;
+        sceneColorDesc.Format = s_SceneColorFormat;
+        sceneColorDesc.Extent = m_Swapchain.Extent;
+
+        m_RenderGraph->AddPass("Main",
+            [&](RenderGraphPassBuilder& builder) {
+                VkClearValue clearColor = {{{ 0.0f, 0.0f, 0.0f, 1.0f }}};
+
+                m_SceneColorResource = builder.CreateImage("SceneColor", sceneColorDesc);
+
+                if (m_Samples != VK_SAMPLE_COUNT_1_BIT) {
+                    // The multisampled target is resolved into the scene color at the end
+                    // of the pass and never stored, so it can stay in tile memory.
+                    RenderGraphImageDesc colorDesc = sceneColorDesc;
+                    colorDesc.Samples = m_Samples;
+
+                    RenderGraphResource color = builder.CreateImage("ColorMSAA", colorDesc);
+                    builder.WriteColor(color, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+                    builder.ResolveColor(color, m_SceneColorResource);
+                } else {
+                    builder.WriteColor(m_SceneColorResource, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor);
+                }
+
+                if (m_DepthPrepass) {
+                    builder.ReadDepth(m_DepthResource);
+                } else {
+                    m_DepthResource = builder.CreateImage("Depth", depthDesc);
+                    builder.WriteDepth(m_DepthResource, VK_ATTACHMENT_LOAD_OP_CLEAR, clearDepth, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+                }
+
+                if (occlusion) {
+                    builder.Read(m_DrawResources[0], RenderGraphAccess::IndirectBuffer);
+                    builder.Read(m_DrawResources[1], RenderGraphAccess::IndirectBuffer);
+                }
+            },
+            [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                SetViewport(commandBuffer);
+                RecordMainPass(commandBuffer);
+            }
+        );
+
+        bool bloom = m_PostProcess->GetSettings().Bloom;
+        m_BloomResource = RenderGraphResource();
+
+        if (bloom) {
+            m_RenderGraph->AddPass("Bloom",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.Read(m_SceneColorResource, RenderGraphAccess::SampledCompute);
+
+                    m_BloomResource = builder.CreateImage("Bloom", PostProcess::GetBloomDesc(m_Swapchain.Extent));
+                    builder.Write(m_BloomResource, RenderGraphAccess::StorageWriteCompute);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    m_PostProcess->RecordBloom(commandBuffer);
+                }
+            );
+        }
+
+        // Exposure, grading and tonemapping fused into one fullscreen pass that
+        // overwrites every backbuffer pixel.
+        m_RenderGraph->AddPass("Composite",
+            [&](RenderGraphPassBuilder& builder) {
+                builder.WriteColor(m_BackbufferResource, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+                builder.Read(m_SceneColorResource, RenderGraphAccess::SampledFragment);
+
+                if (bloom)
+                    builder.Read(m_BloomResource, RenderGraphAccess::SampledFragment);
+            },
+            [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                SetViewport(commandBuffer);
+                m_PostProcess->RecordComposite(commandBuffer);
+            }
+        );
+
+        // Drawn over the final image, after post-processing so it is never multisampled or tonemapped.
+        if (m_PerfOverlayEnabled) {
+            m_RenderGraph->AddPass("Overlay",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.WriteColor(m_BackbufferResource, VK_ATTACHMENT_LOAD_OP_LOAD);
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                    SetViewport(commandBuffer);
+                    m_PerfOverlay->Record(commandBuffer);
+                }
+            );
+        }
+
+        // Always part of the graph, so starting a capture does not rebuild it
+        // and wait for the device. Costs one extra transition of the backbuffer
+        // on frames that are not captured.
+        if (m_Swapchain.Capturable) {
+            m_RenderGraph->AddPass("Capture",
+                [&](RenderGraphPassBuilder& builder) {
+                    builder.Read(m_BackbufferResource, RenderGraphAccess::TransferSrc);
+                    builder.SideEffect();
+                },
+                [this](VkCommandBuffer commandBuffer, const RenderGraph& graph) {
+                    m_FrameCapture->RecordReadback(commandBuffer, graph.GetImage(m_BackbufferResource), m_Swapchain.SurfaceFormat.format, m_Swapchain.Extent);
+                }
+            );
+        }
+
+        m_RenderGraph->Compile();
+
+        if (occlusion)
+            m_OcclusionCuller->SetTargets(*m_RenderGraph, m_DepthResource, m_PyramidResource);
+
+        if (m_DepthPrepass)
+            m_ParticleSystem->SetTargets(*m_RenderGraph, m_DepthResource);
+
+        m_PostProcess->SetTargets(*m_RenderGraph, m_SceneColorResource, m_BloomResource);
+    }
+
+    void Renderer::RecordDepthPrepass(VkCommandBuffer commandBuffer)
+    {
+        // The main pass only shades where the prepass wrote depth, it has to
+        // draw something as well or the quad leaves a hole.
+        VkPipeline pipeline = m_PipelineCache->Get(m_TriangleDepthPipeline);
+        if (pipeline != VK_NULL_HANDLE && m_PipelineCache->Get(m_TrianglePipeline, m_TriangleFallbackPipeline) != VK_NULL_HANDLE) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+            BindGeometry(commandBuffer);
+
+            vkCmdDrawIndexed(commandBuffer, m_Indices.size(), 1, 0, 0, 0);
+        }
+
+        m_MeshRenderer->RecordDepthPrepass(commandBuffer);
+    }
+
+    void Renderer::RecordMainPass(VkCommandBuffer commandBuffer)
+    {
+        VkPipeline pipeline = m_PipelineCache->Get(m_TrianglePipeline, m_TriangleFallbackPipeline);
+        if (pipeline != VK_NULL_HANDLE) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+            BindGeometry(commandBuffer);
+
+            vkCmdDrawIndexed(commandBuffer, m_Indices.size(), 1, 0, 0, 0);
+        }
 
+        m_MeshRenderer->Record(commandBuffer);
+
+        // Blended over the opaque scene.
+        m_ParticleSystem->Record(commandBuffer);
+
+        m_Renderer2D->Record(commandBuffer);
+    }
+
+    void Renderer::BindGeometry(VkCommandBuffer commandBuffer)
+    {
         VkBuffer vertexBuffers[] = { m_VertexBuffer };
         VkDeviceSize offsets[] = { 0 };
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
+        BindFrameData(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipelineLayout);
+
+        TrianglePushConstants constants;
+        constants.Model = m_TriangleTransform;
+        vkCmdPushConstants(commandBuffer, m_GraphicsPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TrianglePushConstants), &constants);
+
+        SetViewport(commandBuffer);
+    }
+
+    void Renderer::SetCamera(const glm::mat4& view, const glm::mat4& projection)
+    {
+        m_FrameData.View = view;
+        m_FrameData.Projection = projection;
+        m_FrameData.ViewProjection = projection * view;
+        m_FrameData.CameraPosition = glm::vec4(glm::vec3(glm::inverse(view)[3]), 1.0f);
+    }
+
+    void Renderer::DeclareFrameData(ShaderReflection& reflection) const
+    {
+        if (!reflection.OverrideBinding(s_FrameDataSet, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL))
+            LOG_WARN("Shaders declared to use frame data do not read it");
+    }
+
+    void Renderer::BindFrameData(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const
+    {
+        u32 offset = static_cast<u32>(m_FrameIndex * m_FrameDataStride);
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, s_FrameDataSet, 1, &m_FrameDataSet, 1, &offset);
+    }
+
+    void Renderer::CreateFrameData()
+    {
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(m_PhysicalDevice, &props);
+
+        VkDeviceSize alignment = props.limits.minUniformBufferOffsetAlignment;
+        m_FrameDataStride = (sizeof(FrameData) + alignment - 1) & ~(alignment - 1);
+
+        CreateBuffer(m_FrameDataStride * s_FrameInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_FrameDataBuffer, m_FrameDataMemory, "FrameData");
+        VK_CHECK(vkMapMemory(m_Device, m_FrameDataMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&m_FrameDataMapped)));
+
+        VkDescriptorSetLayoutBinding binding = { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_ALL, nullptr };
+        m_FrameDataLayout = m_PipelineLayoutCache->GetSetLayout({ &binding, 1 });
+
+        // A single set for the renderer's lifetime, the dynamic offset picks the slot.
+        VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 };
+
+        VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        VK_CHECK(vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_FrameDataPool));
+
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_FrameDataPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_FrameDataLayout;
+
+        VK_CHECK(vkAllocateDescriptorSets(m_Device, &allocInfo, &m_FrameDataSet));
+
+        VkDescriptorBufferInfo bufferInfo = { m_FrameDataBuffer, 0, sizeof(FrameData) };
+
+        VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet = m_FrameDataSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        write.pBufferInfo = &bufferInfo;
+
+        vkUpdateDescriptorSets(m_Device, 1, &write, 0, nullptr);
+    }
+
+    void Renderer::DestroyFrameData()
+    {
+        vkDestroyDescriptorPool(m_Device, m_FrameDataPool, nullptr);
+
+        vkUnmapMemory(m_Device, m_FrameDataMemory);
+        vkDestroyBuffer(m_Device, m_FrameDataBuffer, nullptr);
+        FreeMemory(m_FrameDataMemory);
+    }
+
+    void Renderer::UpdateFrameData()
+    {
+        f32 time = m_Clock.Elapsed();
+        m_FrameData.DeltaTime = time - m_FrameData.Time;
+        m_FrameData.Time = time;
+        m_FrameData.Extent = glm::vec2(static_cast<f32>(m_Swapchain.Extent.width), static_cast<f32>(m_Swapchain.Extent.height));
+
+        // The slot was last read by this frame index's previous submission, which BeginFrame waited on.
+        std::memcpy(m_FrameDataMapped + m_FrameIndex * m_FrameDataStride, &m_FrameData, sizeof(FrameData));
+    }
+
+    void Renderer::SetViewport(VkCommandBuffer commandBuffer)
+    {
 		VkViewport viewport;
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -834,12 +1438,6 @@ namespace Graphics {
 		scissor.extent = m_Swapchain.Extent;
 
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-		// vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-        vkCmdDrawIndexed(commandBuffer, m_Indices.size(), 1, 0, 0, 0);
-
-		vkCmdEndRenderPass(commandBuffer);
-		VK_CHECK(vkEndCommandBuffer(commandBuffer));
     }
 
     void Renderer::CreateSyncObjects()
@@ -849,33 +1447,74 @@ namespace Graphics {
 		semaphoreInfo.pNext = nullptr;
 		semaphoreInfo.flags = 0;
 
-		VkFenceCreateInfo fenceInfo;
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.pNext = nullptr;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (usize i = 0; i < s_FrameInFlight; ++i) {
+		// Frame slots are paced by the graphics timeline, acquiring still needs binary semaphores.
+		for (usize i = 0; i < s_FrameInFlight; ++i)
 			VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i]));
-			VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_RenderFinishedSemphores[i]));
-			VK_CHECK(vkCreateFence(m_Device, &fenceInfo, nullptr, &m_InFlightFences[i]));
-		}
     }
 
-    u32 Renderer::FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties)
+    void Renderer::CreateTimestampQueries()
+    {
+        u32 familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &familyCount, families.data());
+
+        u32 validBits = families[m_GraphicQueue.Index.value()].timestampValidBits;
+        if (validBits == 0) {
+            LOG_WARN("Graphics queue does not support timestamps, GPU frame times are unavailable");
+            return;
+        }
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(m_PhysicalDevice, &props);
+
+        m_TimestampPeriod = props.limits.timestampPeriod;
+        m_TimestampMask = validBits == 64 ? ~0ull : (1ull << validBits) - 1;
+
+        // A begin and end timestamp per frame slot, and one per render graph pass boundary.
+        VkQueryPoolCreateInfo createInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+        createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        createInfo.queryCount = static_cast<u32>(s_FrameInFlight) * s_TimestampsPerFrame;
+
+        VK_CHECK(vkCreateQueryPool(m_Device, &createInfo, nullptr, &m_TimestampPool));
+    }
+
+    void Renderer::ReadTimestamps()
     {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &memProperties);
+        if (m_TimestampPool == VK_NULL_HANDLE || !m_TimestampsWritten[m_FrameIndex])
+            return;
 
-        for (u32 i = 0; i < memProperties.memoryTypeCount; ++i) {
-            if ((typeFilter & (1 << i)) && ((memProperties.memoryTypes[i].propertyFlags & properties) == properties)) {
-                return i;
-            }
+        const std::vector<std::string>& timedPasses = m_TimedPasses[m_FrameIndex];
+
+        // The slot's frame has completed, the results are available without waiting.
+        // Only the queries the frame wrote are read, the rest are still reset.
+        std::array<u64, s_TimestampsPerFrame> timestamps;
+        u32 count = timedPasses.empty() ? 2 : 2 + static_cast<u32>(timedPasses.size()) + 1;
+        VkResult result = vkGetQueryPoolResults(m_Device, m_TimestampPool, static_cast<u32>(m_FrameIndex) * s_TimestampsPerFrame, count,
+            sizeof(timestamps), timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT);
+
+        if (result != VK_SUCCESS)
+            return;
+
+        auto toMillis = [this](u64 begin, u64 end) {
+            return static_cast<f32>(static_cast<f64>((end - begin) & m_TimestampMask) * m_TimestampPeriod / 1e6);
+        };
+
+        m_GPUFrameTime = toMillis(timestamps[0], timestamps[1]);
+
+        m_PassTimings.resize(timedPasses.size());
+        for (usize i = 0; i < timedPasses.size(); ++i) {
+            m_PassTimings[i].Name = timedPasses[i];
+            m_PassTimings[i].Time = toMillis(timestamps[2 + i], timestamps[3 + i]);
         }
+    }
 
-        return -1;
+    u32 Renderer::FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties)
+    {
+        return m_MemoryTracker->FindMemoryType(typeFilter, properties);
     }
 
-    void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+    void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, const char* owner)
     {
         VkBufferCreateInfo createInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
         createInfo.size = size;
@@ -891,12 +1530,40 @@ namespace Graphics {
         allocInfo.allocationSize = memRequirements.size;
         allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
 
-        VK_CHECK(vkAllocateMemory(m_Device, &allocInfo, nullptr, &bufferMemory));
+        MemoryCategory category = MemoryCategory::Buffer;
+        if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+            category = MemoryCategory::Staging;
+        else if (usage == VK_BUFFER_USAGE_TRANSFER_DST_BIT && (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+            category = MemoryCategory::Readback;
+
+        VK_CHECK(AllocateMemory(allocInfo, category, owner, bufferMemory));
 
         vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
     }
 
+    VkResult Renderer::AllocateMemory(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, const char* owner, VkDeviceMemory& memory)
+    {
+        return m_MemoryTracker->Allocate(allocInfo, category, owner, memory);
+    }
+
+    void Renderer::FreeMemory(VkDeviceMemory memory)
+    {
+        m_MemoryTracker->Free(memory);
+    }
+
     void Renderer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+    {
+        ImmediateSubmit([&](VkCommandBuffer commandBuffer) {
+            VkBufferCopy copyRegion {};
+            copyRegion.srcOffset = 0;
+            copyRegion.dstOffset = 0;
+            copyRegion.size = size;
+
+            vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        });
+    }
+
+    void Renderer::ImmediateSubmit(const std::function<void(VkCommandBuffer)>& fn)
     {
         VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
         allocInfo.commandPool = m_CommandPool;
@@ -911,21 +1578,15 @@ namespace Graphics {
 
         vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-        VkBufferCopy copyRegion {};
-        copyRegion.srcOffset = 0;
-        copyRegion.dstOffset = 0;
-        copyRegion.size = size;
-
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        fn(commandBuffer);
 
         vkEndCommandBuffer(commandBuffer);
 
-        VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        VkCommandBufferSubmitInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+        commandBufferInfo.commandBuffer = commandBuffer;
 
-        vkQueueSubmit(m_GraphicQueue.Queue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_GraphicQueue.Queue);
+        // Waits for this submission only, frames in flight keep running.
+        m_GraphicsTimeline->Wait(m_GraphicsTimeline->Submit({ &commandBufferInfo, 1 }));
 
         vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
     }
@@ -1,28 +1,190 @@
 #pragma once
 
 #include <optional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <array>
+#include <functional>
 
 #include <volk.h>
 #include <glm/glm.hpp>
 
 #include "Types.hpp"
 #include "Core/Window.hpp"
+#include "Core/Timer.hpp"
+#include "VertexLayout.hpp"
+#include "RenderGraph.hpp"
+#include "ShaderCompiler.hpp"
+#include "ShaderReflection.hpp"
+#include "PipelineCache.hpp"
+#include "MemoryTracker.hpp"
 
 namespace Graphics {
 
+    class Renderer2D;
+    class MeshRenderer;
+    class OcclusionCuller;
+    class ShaderReloader;
+    class PipelineLayoutCache;
+    class DescriptorAllocator;
+    class QueueTimeline;
+    class FrameCapture;
+    class PerfOverlay;
+    class ParticleSystem;
+    class PostProcess;
+    struct PostProcessSettings;
+
+    // Contents of the FrameData block in shaders/FrameData.glsl, std140.
+    struct FrameData
+    {
+        glm::mat4 View { 1.0f };
+        glm::mat4 Projection { 1.0f };
+        glm::mat4 ViewProjection { 1.0f };
+        glm::vec4 CameraPosition { 0.0f };
+        f32 Time { 0.0f };
+        f32 DeltaTime { 0.0f };
+        glm::vec2 Extent { 0.0f };
+    };
+
+    struct RenderPassTiming
+    {
+        std::string Name;
+        // Milliseconds, including the barriers in front of the pass.
+        f32 Time { 0.0f };
+    };
+
     class Renderer
     {
     public:
         Renderer(const std::shared_ptr<Window>& window);
+        // Headless, renders into offscreen images of the given extent instead of
+        // a swapchain and runs on any device, software rasterizers included.
+        Renderer(VkExtent2D extent);
         ~Renderer();
 
-        void Render(f32 dt);
+        // BeginFrame waits for the frame slot and acquires a swapchain image, it
+        // returns false when the swapchain had to be recreated and the frame is
+        // skipped. Per-frame resources (e.g. Renderer2D buffers) may only be
+        // written between BeginFrame and EndFrame.
+        bool BeginFrame();
+        void EndFrame();
+
         void Resize();
-    
+
+        inline bool IsHeadless() const { return m_Window == nullptr; }
+
+        // GPU time in milliseconds of the last completed frame, measured with
+        // timestamps around its command buffer. 0 if the queue has no timestamps.
+        inline f32 GetGPUFrameTime() const { return m_GPUFrameTime; }
+        // Per render graph pass of the same frame, in execution order. Empty
+        // without timestamps or when the graph has more passes than can be timed.
+        inline const std::vector<RenderPassTiming>& GetPassTimings() const { return m_PassTimings; }
+
+        // Toggling the prepass recreates the pipelines, the main pass switches
+        // between an EQUAL test against prepass depth and a regular depth write.
+        void SetDepthPrepass(bool enabled);
+        inline bool IsDepthPrepassEnabled() const { return m_DepthPrepass; }
+
+        // Clamped to the highest count supported for both color and depth attachments.
+        void SetSampleCount(VkSampleCountFlagBits samples);
+        inline VkSampleCountFlagBits GetSampleCount() const { return m_Samples; }
+
+        // GPU occlusion culling of meshes, needs the depth prepass and indirect
+        // draws with a first instance. Toggling it rebuilds the render graph.
+        void SetOcclusionCulling(bool enabled);
+        inline bool IsOcclusionCullingEnabled() const { return m_OcclusionCulling && m_DepthPrepass && m_DrawIndirectFirstInstance; }
+        inline bool SupportsMultiDrawIndirect() const { return m_MultiDrawIndirect; }
+
+        // Frame times, pass timings, draw counts and memory drawn on top of the
+        // backbuffer in a pass of its own. Toggling it rebuilds the render graph.
+        void SetPerfOverlay(bool enabled);
+        inline bool IsPerfOverlayEnabled() const { return m_PerfOverlayEnabled; }
+
+        // Bloom, exposure, grading and tonemapping between the HDR scene and
+        // the backbuffer. Toggling bloom rebuilds the render graph.
+        void SetPostProcessSettings(const PostProcessSettings& settings);
+        const PostProcessSettings& GetPostProcessSettings() const;
+
+        // Camera of the frame being built, uploaded once per frame with the
+        // time. Until it is set the view and projection are identity.
+        void SetCamera(const glm::mat4& view, const glm::mat4& projection);
+        inline void SetTriangleTransform(const glm::mat4& transform) { m_TriangleTransform = transform; }
+        // Camera and time of the frame being built, the time is updated in EndFrame.
+        inline const FrameData& GetFrameData() const { return m_FrameData; }
+
+        // Pipelines that include FrameData.glsl declare its binding as a
+        // dynamic uniform buffer before creating their layout, so they share
+        // the frame set layout, and bind the set for the current frame slot.
+        void DeclareFrameData(ShaderReflection& reflection) const;
+        void BindFrameData(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const;
+        inline VkDescriptorSetLayout GetFrameDataLayout() const { return m_FrameDataLayout; }
+
+        inline Renderer2D& Get2D() { return *m_Renderer2D; }
+        inline MeshRenderer& GetMeshRenderer() { return *m_MeshRenderer; }
+        inline OcclusionCuller& GetOcclusionCuller() { return *m_OcclusionCuller; }
+        inline const OcclusionCuller& GetOcclusionCuller() const { return *m_OcclusionCuller; }
+        inline ShaderCompiler& GetShaderCompiler() { return *m_ShaderCompiler; }
+        inline ShaderReloader& GetShaderReloader() { return *m_ShaderReloader; }
+        inline PipelineLayoutCache& GetPipelineLayoutCache() { return *m_PipelineLayoutCache; }
+        inline PipelineCache& GetPipelineCache() { return *m_PipelineCache; }
+        // Sets from it are valid until the current frame slot is reused.
+        inline DescriptorAllocator& GetDescriptorAllocator() { return *m_DescriptorAllocator; }
+        // Captures the swapchain image once the frame has been rendered, only if
+        // the surface supports copies from it. Offscreen targets are read back
+        // from a render graph pass of their own.
+        inline FrameCapture& GetFrameCapture() { return *m_FrameCapture; }
+        inline PerfOverlay& GetPerfOverlay() { return *m_PerfOverlay; }
+        inline ParticleSystem& GetParticleSystem() { return *m_ParticleSystem; }
+        inline PostProcess& GetPostProcess() { return *m_PostProcess; }
+        inline bool CanCaptureSwapchain() const { return m_Swapchain.Capturable; }
+
+        // Every device allocation goes through it, with per-heap budgets and
+        // accounting by category and owner.
+        inline MemoryTracker& GetMemoryTracker() { return *m_MemoryTracker; }
+
+        // Every graphics submission signals it, resources remember the value of
+        // the last submission using them instead of waiting for a fence.
+        inline QueueTimeline& GetGraphicsTimeline() { return *m_GraphicsTimeline; }
+
+        inline VkDevice GetDevice() const { return m_Device; }
+        inline VkPhysicalDevice GetPhysicalDevice() const { return m_PhysicalDevice; }
+        inline u32 GetGraphicsQueueFamily() const { return m_GraphicQueue.Index.value(); }
+        // Backbuffer format, for passes drawn after post-processing.
+        inline VkFormat GetColorFormat() const { return m_Swapchain.SurfaceFormat.format; }
+        // Format of the HDR target the scene is drawn into.
+        inline static constexpr VkFormat GetSceneColorFormat() { return s_SceneColorFormat; }
+        inline VkFormat GetDepthFormat() const { return m_DepthFormat; }
+        inline VkFormat GetStencilFormat() const { return m_DepthFormat == VK_FORMAT_D32_SFLOAT ? VK_FORMAT_UNDEFINED : m_DepthFormat; }
+        inline VkExtent2D GetExtent() const { return m_Swapchain.Extent; }
+        inline usize GetFrameIndex() const { return m_FrameIndex; }
+        inline static constexpr usize GetFramesInFlight() { return s_FrameInFlight; }
+
+        // Loads a precompiled shaders/<source>.spv, compiling the source at runtime if it is missing.
+        VkShaderModule LoadShader(const std::string& filepath);
+        // Compiles a permutation of a source in the shader directory, results are cached on disk.
+        VkShaderModule CompileShader(const std::string& source, const std::vector<ShaderDefine>& defines = {});
+        // Merged reflection of the shaders/<source>.spv binaries, e.g. { "Mesh.vert", "Mesh.frag" }.
+        // Invalid if any of them cannot be loaded.
+        ShaderReflection ReflectShaders(const std::vector<std::string>& sources);
+
+        // Prefers a type whose heap is still under budget.
+        u32 FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties);
+        // owner tags the allocation in the memory stats. Buffers that are only
+        // a transfer source are counted as staging, host visible transfer
+        // destinations as readback.
+        void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, const char* owner = nullptr);
+
+        VkResult AllocateMemory(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, const char* owner, VkDeviceMemory& memory);
+        void FreeMemory(VkDeviceMemory memory);
+        void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+
+        // Records and submits a one-off command buffer and waits for it to finish.
+        void ImmediateSubmit(const std::function<void(VkCommandBuffer)>& fn);
+
     private:
+        void Init();
+
         void CreateInstance();
 
         void PickPhysicalDevice();
@@ -31,27 +193,40 @@ namespace Graphics {
         void QuerySwapchainCapabilities();
         VkExtent2D GetSwapchainExtent();
         void CreateSwapchain();
+        void CreateHeadlessImages();
+        void DestroySwapchain();
 
-        void CreateRenderPass();
+        VkFormat FindDepthFormat();
+        VkSampleCountFlagBits GetMaxSampleCount();
 
-        void CreateFramebuffers();
+        std::vector<u32> LoadShaderCode(const std::string& filepath);
+        VkShaderModule CreateShaderModule(const std::vector<u32>& code);
 
-        VkShaderModule LoadShader(const std::string& filepath);
         void CreateGraphicsPipeline();
+        PipelineDesc GetTrianglePipelineDesc(bool depthOnly) const;
 
         void CreateCommandPool();
 
         void CreateVertexBuffer();
         void CreateIndexBuffer();
 
+        void CreateFrameData();
+        void DestroyFrameData();
+        void UpdateFrameData();
+
         void AllocateCommandBuffers();
         void RecordCommandBuffer(VkCommandBuffer commandBuffer, u32 imageIndex);
 
+        void BuildRenderGraph();
+        void RecordDepthPrepass(VkCommandBuffer commandBuffer);
+        void RecordMainPass(VkCommandBuffer commandBuffer);
+        void BindGeometry(VkCommandBuffer commandBuffer);
+        void SetViewport(VkCommandBuffer commandBuffer);
+
         void CreateSyncObjects();
 
-        u32 FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties);
-        void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-        void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void CreateTimestampQueries();
+        void ReadTimestamps();
 
     private:
 
@@ -74,7 +249,15 @@ namespace Graphics {
             u32 ImageCount;
             std::vector<VkImage> Images;
             std::vector<VkImageView> ImageViews;
-            std::vector<VkFramebuffer> Framebuffers;
+            // Only headless images are allocated by the renderer.
+            std::vector<VkDeviceMemory> ImageMemory;
+
+            bool Capturable { false };
+        };
+
+        struct TrianglePushConstants
+        {
+            glm::mat4 Model;
         };
 
         struct Vertex
@@ -82,31 +265,12 @@ namespace Graphics {
             glm::vec2 Pos;
             glm::vec3 Color;
 
-            inline static VkVertexInputBindingDescription BindingDescription()
-            {
-                VkVertexInputBindingDescription description;
-                description.binding = 0;
-                description.stride = sizeof(Vertex);
-                description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-                return description;
-            };
-
-            inline static std::array<VkVertexInputAttributeDescription, 2> AttributeDescription()
+            static constexpr auto Layout()
             {
-                std::array<VkVertexInputAttributeDescription, 2> descriptions;
-
-                descriptions[0].location = 0;
-                descriptions[0].binding = 0;
-                descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-                descriptions[0].offset = offsetof(Vertex, Pos);
-
-                descriptions[1].location = 1;
-                descriptions[1].binding = 0;
-                descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-                descriptions[1].offset = offsetof(Vertex, Color);
-
-                return descriptions;
+                return MakeVertexLayout<Vertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                    VERTEX_ATTRIBUTE(Vertex, Pos),
+                    VERTEX_ATTRIBUTE(Vertex, Color)
+                );
             }
         };
 
@@ -115,10 +279,14 @@ namespace Graphics {
 
         inline static VkInstance s_Instance { VK_NULL_HANDLE };
         inline static constexpr usize s_FrameInFlight { 2 };
+        inline static constexpr u32 s_FrameDataSet { 0 };
+        inline static constexpr VkFormat s_SceneColorFormat { VK_FORMAT_R16G16B16A16_SFLOAT };
 
         usize m_FrameIndex { 0 };
 
-        VkSurfaceKHR m_Surface;
+        VkExtent2D m_HeadlessExtent { 0, 0 };
+
+        VkSurfaceKHR m_Surface { VK_NULL_HANDLE };
 
         VkPhysicalDevice m_PhysicalDevice { VK_NULL_HANDLE };
         VkDevice m_Device;
@@ -128,10 +296,50 @@ namespace Graphics {
 
         Swapchain m_Swapchain;
 
-        VkRenderPass m_RenderPass;
+        VkFormat m_DepthFormat { VK_FORMAT_UNDEFINED };
+        bool m_DepthPrepass { true };
+
+        VkSampleCountFlagBits m_Samples { VK_SAMPLE_COUNT_4_BIT };
+        VkSampleCountFlagBits m_MaxSamples { VK_SAMPLE_COUNT_1_BIT };
+
+        bool m_MemoryBudget { false };
+
+        bool m_OcclusionCulling { true };
+        bool m_MultiDrawIndirect { false };
+        bool m_DrawIndirectFirstInstance { false };
+
+        bool m_PerfOverlayEnabled { false };
+
+        std::unique_ptr<MemoryTracker> m_MemoryTracker;
+
+        std::unique_ptr<RenderGraph> m_RenderGraph;
+        RenderGraphResource m_BackbufferResource;
+        RenderGraphResource m_DepthResource;
+        RenderGraphResource m_SceneColorResource;
+        RenderGraphResource m_BloomResource;
+        RenderGraphResource m_PyramidResource;
+        RenderGraphResource m_VisibilityResource;
+        std::array<RenderGraphResource, 2> m_DrawResources;
+        u32 m_ImageIndex { 0 };
 
         VkPipelineLayout m_GraphicsPipelineLayout;
-        VkPipeline m_GraphicsPipeline;
+        PipelineDesc m_TrianglePipeline;
+        PipelineDesc m_TriangleFallbackPipeline;
+        PipelineDesc m_TriangleDepthPipeline;
+
+        std::unique_ptr<ShaderCompiler> m_ShaderCompiler;
+        std::unique_ptr<ShaderReloader> m_ShaderReloader;
+        std::unique_ptr<PipelineLayoutCache> m_PipelineLayoutCache;
+        std::unique_ptr<PipelineCache> m_PipelineCache;
+        std::unique_ptr<DescriptorAllocator> m_DescriptorAllocator;
+        std::unique_ptr<FrameCapture> m_FrameCapture;
+
+        std::unique_ptr<Renderer2D> m_Renderer2D;
+        std::unique_ptr<MeshRenderer> m_MeshRenderer;
+        std::unique_ptr<OcclusionCuller> m_OcclusionCuller;
+        std::unique_ptr<PerfOverlay> m_PerfOverlay;
+        std::unique_ptr<ParticleSystem> m_ParticleSystem;
+        std::unique_ptr<PostProcess> m_PostProcess;
 
         std::vector<Vertex> m_Vertices;
         VkBuffer m_VertexBuffer;
@@ -141,12 +349,43 @@ namespace Graphics {
         VkBuffer m_IndexBuffer;
         VkDeviceMemory m_IndexBufferMemory;
 
+        glm::mat4 m_TriangleTransform { 1.0f };
+
+        // One persistently mapped buffer with a slot per frame in flight, each
+        // slot aligned for use as a dynamic offset.
+        FrameData m_FrameData;
+        Timer m_Clock;
+        VkDeviceSize m_FrameDataStride { 0 };
+        VkBuffer m_FrameDataBuffer { VK_NULL_HANDLE };
+        VkDeviceMemory m_FrameDataMemory { VK_NULL_HANDLE };
+        u8* m_FrameDataMapped { nullptr };
+        VkDescriptorSetLayout m_FrameDataLayout { VK_NULL_HANDLE };
+        VkDescriptorPool m_FrameDataPool { VK_NULL_HANDLE };
+        VkDescriptorSet m_FrameDataSet { VK_NULL_HANDLE };
+
         VkCommandPool m_CommandPool;
         std::array<VkCommandBuffer, s_FrameInFlight> m_CommandBuffers;
 
+        std::unique_ptr<QueueTimeline> m_GraphicsTimeline;
+        // Graphics timeline value signaled by the last frame recorded in each slot.
+        std::array<u64, s_FrameInFlight> m_FrameValues {};
+
+        // Per frame slot: the frame's begin and end, then the pass boundaries.
+        inline static constexpr u32 s_MaxTimedPasses { 32 };
+        inline static constexpr u32 s_TimestampsPerFrame { 2 + s_MaxTimedPasses + 1 };
+
+        VkQueryPool m_TimestampPool { VK_NULL_HANDLE };
+        f32 m_TimestampPeriod { 0.0f };
+        u64 m_TimestampMask { 0 };
+        std::array<bool, s_FrameInFlight> m_TimestampsWritten {};
+        // Names of the passes timed by each slot's frame, the graph may have been rebuilt since.
+        std::array<std::vector<std::string>, s_FrameInFlight> m_TimedPasses;
+        f32 m_GPUFrameTime { 0.0f };
+        std::vector<RenderPassTiming> m_PassTimings;
+
         std::array<VkSemaphore, s_FrameInFlight> m_ImageAvailableSemaphores;
-        std::array<VkSemaphore, s_FrameInFlight> m_RenderFinishedSemphores;
-        std::array<VkFence, s_FrameInFlight> m_InFlightFences;
+        // Indexed by swapchain image.
+        std::vector<VkSemaphore> m_RenderFinishedSemaphores;
 
 #ifndef NDEBUG
         VkDebugUtilsMessengerEXT m_Messenger;
@@ -0,0 +1,513 @@
+#include "Renderer2D.hpp"
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Vulkan.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "DescriptorAllocator.hpp"
+
+namespace Graphics {
+
+    static constexpr std::array<glm::vec4, 4> s_QuadPositions = {
+        glm::vec4(-0.5f, -0.5f, 0.0f, 1.0f),
+        glm::vec4( 0.5f, -0.5f, 0.0f, 1.0f),
+        glm::vec4( 0.5f,  0.5f, 0.0f, 1.0f),
+        glm::vec4(-0.5f,  0.5f, 0.0f, 1.0f)
+    };
+
+    static constexpr std::array<glm::vec2, 4> s_QuadTexCoords = {
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(1.0f, 0.0f),
+        glm::vec2(1.0f, 1.0f),
+        glm::vec2(0.0f, 1.0f)
+    };
+
+    Renderer2D::Renderer2D(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        u32 white = 0xffffffff;
+        m_WhiteTexture = std::make_unique<Texture>(m_Renderer, 1, 1, &white, VK_FILTER_NEAREST);
+        m_TextureSlots.fill(m_WhiteTexture.get());
+
+        CreateIndexBuffer();
+        CreateDescriptors();
+        CreatePipelines();
+
+        m_Frames.resize(Renderer::GetFramesInFlight());
+
+        // Chunks grow to fit the busiest frame and are kept after it, under
+        // memory pressure the idle slot gives back what it did not need.
+        m_EvictionCallback = m_Renderer.GetMemoryTracker().AddEvictionCallback([this](const MemoryPressure&) {
+            TrimChunks();
+        });
+    }
+
+    Renderer2D::~Renderer2D()
+    {
+        VkDevice device = m_Renderer.GetDevice();
+
+        m_Renderer.GetMemoryTracker().RemoveEvictionCallback(m_EvictionCallback);
+
+        for (auto& frame : m_Frames) {
+            for (auto& chunk : frame.Chunks) {
+                vkUnmapMemory(device, chunk.Memory);
+                vkDestroyBuffer(device, chunk.Buffer, nullptr);
+                m_Renderer.FreeMemory(chunk.Memory);
+            }
+        }
+
+        vkDestroyBuffer(device, m_QuadIndexBuffer, nullptr);
+        m_Renderer.FreeMemory(m_QuadIndexBufferMemory);
+
+        m_WhiteTexture.reset();
+    }
+
+    void Renderer2D::CreatePipelines()
+    {
+        static constexpr auto quadLayout = QuadVertex::Layout();
+        static constexpr auto circleLayout = CircleVertex::Layout();
+        static constexpr auto lineLayout = LineVertex::Layout();
+
+        static_assert(quadLayout.IsValid() && circleLayout.IsValid() && lineLayout.IsValid());
+
+        m_QuadPipeline = GetPipelineDesc("Quad2D", VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        m_QuadPipeline.SetVertexLayout(quadLayout);
+
+        m_CirclePipeline = GetPipelineDesc("Circle2D", VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        m_CirclePipeline.SetVertexLayout(circleLayout);
+
+        m_LinePipeline = GetPipelineDesc("Line2D", VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+        m_LinePipeline.SetVertexLayout(lineLayout);
+
+        // Primitives are drawn flat while their own pipelines compile.
+        m_QuadFallbackPipeline = m_QuadPipeline.GetFallback();
+        m_CircleFallbackPipeline = m_CirclePipeline.GetFallback();
+        m_LineFallbackPipeline = m_LinePipeline.GetFallback();
+
+        PipelineCache& cache = m_Renderer.GetPipelineCache();
+        for (const PipelineDesc* desc : { &m_QuadFallbackPipeline, &m_CircleFallbackPipeline, &m_LineFallbackPipeline, &m_QuadPipeline, &m_CirclePipeline, &m_LinePipeline })
+            cache.Prewarm(*desc);
+    }
+
+    void Renderer2D::BeginFrame()
+    {
+        m_Frame = &m_Frames[m_Renderer.GetFrameIndex()];
+
+        m_Frame->Batches.clear();
+        m_Frame->ChunkIndex = 0;
+        m_Frame->ChunkOffset = 0;
+
+        m_BatchType = Primitive::None;
+        m_BatchVertexCount = 0;
+
+        m_TextureSlots.fill(m_WhiteTexture.get());
+        m_TextureSlotCount = 1;
+        m_TextureSlotsDirty = true;
+        m_TextureSet = VK_NULL_HANDLE;
+
+        m_Stats = Renderer2DStats();
+    }
+
+    void Renderer2D::BeginScene(const glm::mat4& viewProjection)
+    {
+        m_ViewProjection = viewProjection;
+    }
+
+    void Renderer2D::EndScene()
+    {
+        Flush();
+
+        m_Stats.DrawCalls = static_cast<u32>(m_Frame->Batches.size());
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+    {
+        DrawQuad(glm::vec3(position, 0.0f), size, color);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color)
+    {
+        // Axis aligned fast path, no matrix multiply per vertex.
+        QuadVertex* vertices = reinterpret_cast<QuadVertex*>(Reserve(Primitive::Quad, 4, sizeof(QuadVertex)));
+        glm::u8vec4 packed = PackColor(color);
+
+        for (usize i = 0; i < 4; ++i) {
+            vertices[i].Position = glm::vec3(position.x + s_QuadPositions[i].x * size.x, position.y + s_QuadPositions[i].y * size.y, position.z);
+            vertices[i].Color = packed;
+            vertices[i].TexCoord = s_QuadTexCoords[i];
+            vertices[i].TexIndex = 0;
+        }
+
+        m_Stats.QuadCount++;
+    }
+
+    void Renderer2D::DrawQuad(const glm::mat4& transform, const glm::vec4& color)
+    {
+        QuadVertex* vertices = reinterpret_cast<QuadVertex*>(Reserve(Primitive::Quad, 4, sizeof(QuadVertex)));
+        glm::u8vec4 packed = PackColor(color);
+
+        for (usize i = 0; i < 4; ++i) {
+            vertices[i].Position = glm::vec3(transform * s_QuadPositions[i]);
+            vertices[i].Color = packed;
+            vertices[i].TexCoord = s_QuadTexCoords[i];
+            vertices[i].TexIndex = 0;
+        }
+
+        m_Stats.QuadCount++;
+    }
+
+    void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, f32 rotation, const glm::vec4& color)
+    {
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
+            * glm::rotate(glm::mat4(1.0f), rotation, glm::vec3(0.0f, 0.0f, 1.0f))
+            * glm::scale(glm::mat4(1.0f), glm::vec3(size, 1.0f));
+
+        DrawQuad(transform, color);
+    }
+
+    void Renderer2D::DrawSprite(const glm::vec3& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+    {
+        u32 slot = GetTextureSlot(texture);
+
+        QuadVertex* vertices = reinterpret_cast<QuadVertex*>(Reserve(Primitive::Quad, 4, sizeof(QuadVertex)));
+        glm::u8vec4 packed = PackColor(tint);
+
+        for (usize i = 0; i < 4; ++i) {
+            vertices[i].Position = glm::vec3(position.x + s_QuadPositions[i].x * size.x, position.y + s_QuadPositions[i].y * size.y, position.z);
+            vertices[i].Color = packed;
+            vertices[i].TexCoord = s_QuadTexCoords[i];
+            vertices[i].TexIndex = slot;
+        }
+
+        m_Stats.QuadCount++;
+    }
+
+    void Renderer2D::DrawSprite(const glm::mat4& transform, const Texture& texture, const glm::vec4& tint)
+    {
+        u32 slot = GetTextureSlot(texture);
+
+        QuadVertex* vertices = reinterpret_cast<QuadVertex*>(Reserve(Primitive::Quad, 4, sizeof(QuadVertex)));
+        glm::u8vec4 packed = PackColor(tint);
+
+        for (usize i = 0; i < 4; ++i) {
+            vertices[i].Position = glm::vec3(transform * s_QuadPositions[i]);
+            vertices[i].Color = packed;
+            vertices[i].TexCoord = s_QuadTexCoords[i];
+            vertices[i].TexIndex = slot;
+        }
+
+        m_Stats.QuadCount++;
+    }
+
+    void Renderer2D::DrawCircle(const glm::mat4& transform, const glm::vec4& color, f32 thickness, f32 fade)
+    {
+        CircleVertex* vertices = reinterpret_cast<CircleVertex*>(Reserve(Primitive::Circle, 4, sizeof(CircleVertex)));
+        glm::u8vec4 packed = PackColor(color);
+
+        for (usize i = 0; i < 4; ++i) {
+            vertices[i].WorldPosition = glm::vec3(transform * s_QuadPositions[i]);
+            vertices[i].LocalPosition = glm::vec2(s_QuadPositions[i]) * 2.0f;
+            vertices[i].Color = packed;
+            vertices[i].Thickness = thickness;
+            vertices[i].Fade = fade;
+        }
+
+        m_Stats.CircleCount++;
+    }
+
+    void Renderer2D::DrawLine(const glm::vec3& p0, const glm::vec3& p1, const glm::vec4& color)
+    {
+        LineVertex* vertices = reinterpret_cast<LineVertex*>(Reserve(Primitive::Line, 2, sizeof(LineVertex)));
+        glm::u8vec4 packed = PackColor(color);
+
+        vertices[0].Position = p0;
+        vertices[0].Color = packed;
+        vertices[1].Position = p1;
+        vertices[1].Color = packed;
+
+        m_Stats.LineCount++;
+    }
+
+    void Renderer2D::DrawRect(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color)
+    {
+        std::array<glm::vec3, 4> corners;
+        for (usize i = 0; i < 4; ++i)
+            corners[i] = glm::vec3(position.x + s_QuadPositions[i].x * size.x, position.y + s_QuadPositions[i].y * size.y, position.z);
+
+        for (usize i = 0; i < 4; ++i)
+            DrawLine(corners[i], corners[(i + 1) % 4], color);
+    }
+
+    void Renderer2D::Record(VkCommandBuffer commandBuffer)
+    {
+        if (m_Frame == nullptr || m_Frame->Batches.empty())
+            return;
+
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &m_ViewProjection);
+        vkCmdBindIndexBuffer(commandBuffer, m_QuadIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        PipelineCache& cache = m_Renderer.GetPipelineCache();
+
+        Primitive boundType = Primitive::None;
+        VkPipeline boundPipeline = VK_NULL_HANDLE;
+        VkDescriptorSet boundSet = VK_NULL_HANDLE;
+
+        for (const auto& batch : m_Frame->Batches) {
+            if (batch.Type != boundType) {
+                switch (batch.Type) {
+                    case Primitive::Quad:   boundPipeline = cache.Get(m_QuadPipeline, m_QuadFallbackPipeline); break;
+                    case Primitive::Circle: boundPipeline = cache.Get(m_CirclePipeline, m_CircleFallbackPipeline); break;
+                    default:                boundPipeline = cache.Get(m_LinePipeline, m_LineFallbackPipeline); break;
+                }
+                boundType = batch.Type;
+
+                if (boundPipeline != VK_NULL_HANDLE)
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline);
+            }
+
+            // Skipped only while the fallback is not ready either.
+            if (boundPipeline == VK_NULL_HANDLE)
+                continue;
+
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &batch.Buffer, &batch.Offset);
+
+            switch (batch.Type) {
+                case Primitive::Quad:
+                    if (batch.Textures != boundSet) {
+                        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &batch.Textures, 0, nullptr);
+                        boundSet = batch.Textures;
+                    }
+                    [[fallthrough]];
+                case Primitive::Circle:
+                    vkCmdDrawIndexed(commandBuffer, batch.VertexCount / 4 * 6, 1, 0, 0, 0);
+                    break;
+                case Primitive::Line:
+                    vkCmdDraw(commandBuffer, batch.VertexCount, 1, 0, 0);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void Renderer2D::CreateIndexBuffer()
+    {
+        std::vector<u32> indices(static_cast<usize>(s_MaxQuadsPerBatch) * 6);
+
+        u32 offset = 0;
+        for (usize i = 0; i < indices.size(); i += 6) {
+            indices[i + 0] = offset + 0;
+            indices[i + 1] = offset + 1;
+            indices[i + 2] = offset + 2;
+            indices[i + 3] = offset + 2;
+            indices[i + 4] = offset + 3;
+            indices[i + 5] = offset + 0;
+
+            offset += 4;
+        }
+
+        VkDevice device = m_Renderer.GetDevice();
+        VkDeviceSize bufferSize = sizeof(u32) * indices.size();
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        m_Renderer.CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Renderer2D");
+
+        void* data;
+        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, indices.data(), bufferSize);
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        m_Renderer.CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_QuadIndexBuffer, m_QuadIndexBufferMemory, "Renderer2D");
+
+        m_Renderer.CopyBuffer(stagingBuffer, m_QuadIndexBuffer, bufferSize);
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        m_Renderer.FreeMemory(stagingBufferMemory);
+    }
+
+    void Renderer2D::CreateDescriptors()
+    {
+        // All three pipelines share one layout so a batch switches pipelines
+        // without rebinding its textures.
+        ShaderReflection reflection = m_Renderer.ReflectShaders({
+            "Quad2D.vert", "Quad2D.frag", "Circle2D.vert", "Circle2D.frag", "Line2D.vert", "Line2D.frag"
+        });
+
+        PipelineLayoutCache& layouts = m_Renderer.GetPipelineLayoutCache();
+        m_PipelineLayout = layouts.GetPipelineLayout(reflection);
+        m_DescriptorSetLayout = layouts.GetSetLayouts(m_PipelineLayout).at(0);
+    }
+
+    PipelineDesc Renderer2D::GetPipelineDesc(const std::string& name, VkPrimitiveTopology topology) const
+    {
+        PipelineDesc desc;
+        desc.Shaders = { name + ".vert", name + ".frag" };
+        desc.Layout = m_PipelineLayout;
+        desc.Topology = topology;
+
+        // 2D content is composited over the 3D scene without depth testing.
+        desc.DepthTest = false;
+        desc.DepthWrite = false;
+        desc.DepthCompare = VK_COMPARE_OP_ALWAYS;
+
+        desc.Blend = { VK_TRUE,
+            VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+            VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+
+        desc.ColorFormats = { m_Renderer.GetSceneColorFormat() };
+        desc.DepthFormat = m_Renderer.GetDepthFormat();
+        desc.StencilFormat = m_Renderer.GetStencilFormat();
+        desc.Samples = m_Renderer.GetSampleCount();
+
+        return desc;
+    }
+
+    u8* Renderer2D::Reserve(Primitive type, u32 vertexCount, u32 vertexSize)
+    {
+        if (type == m_BatchType && m_BatchVertexCount + vertexCount <= m_BatchVertexCapacity) {
+            u8* vertices = m_BatchBase + static_cast<usize>(m_BatchVertexCount) * vertexSize;
+            m_BatchVertexCount += vertexCount;
+            return vertices;
+        }
+
+        Flush();
+
+        // Every chunk fits a full batch of the largest vertex type.
+        static constexpr VkDeviceSize chunkSize = static_cast<VkDeviceSize>(s_MaxQuadsPerBatch) * 4 * std::max({ sizeof(QuadVertex), sizeof(CircleVertex), sizeof(LineVertex) });
+
+        VkDeviceSize offset = (m_Frame->ChunkOffset + 15) & ~VkDeviceSize(15);
+        if (m_Frame->ChunkIndex >= m_Frame->Chunks.size() || chunkSize - std::min(offset, chunkSize) < static_cast<VkDeviceSize>(vertexCount) * vertexSize) {
+            if (m_Frame->ChunkIndex < m_Frame->Chunks.size())
+                m_Frame->ChunkIndex++;
+
+            offset = 0;
+        }
+
+        if (m_Frame->ChunkIndex == m_Frame->Chunks.size()) {
+            VertexChunk chunk;
+            m_Renderer.CreateBuffer(chunkSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, chunk.Buffer, chunk.Memory, "Renderer2D");
+            VK_CHECK(vkMapMemory(m_Renderer.GetDevice(), chunk.Memory, 0, chunkSize, 0, reinterpret_cast<void**>(&chunk.Mapped)));
+
+            m_Frame->Chunks.push_back(chunk);
+        }
+
+        m_BatchType = type;
+        m_BatchOffset = offset;
+        m_BatchBase = m_Frame->Chunks[m_Frame->ChunkIndex].Mapped + offset;
+        m_BatchVertexSize = vertexSize;
+        m_BatchVertexCapacity = static_cast<u32>(std::min<VkDeviceSize>((chunkSize - offset) / vertexSize, static_cast<VkDeviceSize>(s_MaxQuadsPerBatch) * 4));
+        m_BatchVertexCount = vertexCount;
+
+        return m_BatchBase;
+    }
+
+    void Renderer2D::TrimChunks()
+    {
+        // Called before BeginFrame(), the slot still holds its previous frame,
+        // which the GPU has finished.
+        FrameData& frame = m_Frames[m_Renderer.GetFrameIndex()];
+        usize used = frame.Batches.empty() ? 0 : frame.ChunkIndex + 1;
+
+        VkDevice device = m_Renderer.GetDevice();
+
+        while (frame.Chunks.size() > used) {
+            VertexChunk& chunk = frame.Chunks.back();
+
+            vkUnmapMemory(device, chunk.Memory);
+            vkDestroyBuffer(device, chunk.Buffer, nullptr);
+            m_Renderer.FreeMemory(chunk.Memory);
+
+            frame.Chunks.pop_back();
+        }
+    }
+
+    u32 Renderer2D::GetTextureSlot(const Texture& texture)
+    {
+        for (u32 i = 0; i < m_TextureSlotCount; ++i) {
+            if (m_TextureSlots[i] == &texture)
+                return i;
+        }
+
+        if (m_TextureSlotCount == s_MaxTextureSlots) {
+            Flush();
+
+            m_TextureSlots.fill(m_WhiteTexture.get());
+            m_TextureSlotCount = 1;
+        }
+
+        m_TextureSlots[m_TextureSlotCount] = &texture;
+        m_TextureSlotsDirty = true;
+
+        return m_TextureSlotCount++;
+    }
+
+    void Renderer2D::Flush()
+    {
+        if (m_BatchType == Primitive::None || m_BatchVertexCount == 0) {
+            m_BatchType = Primitive::None;
+            return;
+        }
+
+        Batch batch;
+        batch.Type = m_BatchType;
+        batch.Buffer = m_Frame->Chunks[m_Frame->ChunkIndex].Buffer;
+        batch.Offset = m_BatchOffset;
+        batch.VertexCount = m_BatchVertexCount;
+        batch.Textures = VK_NULL_HANDLE;
+
+        if (m_BatchType == Primitive::Quad) {
+            if (m_TextureSlotsDirty) {
+                m_TextureSet = AllocateTextureSet();
+                m_TextureSlotsDirty = false;
+            }
+
+            batch.Textures = m_TextureSet;
+        }
+
+        m_Frame->Batches.push_back(batch);
+        m_Frame->ChunkOffset = m_BatchOffset + static_cast<VkDeviceSize>(m_BatchVertexCount) * m_BatchVertexSize;
+
+        m_BatchType = Primitive::None;
+        m_BatchVertexCount = 0;
+    }
+
+    VkDescriptorSet Renderer2D::AllocateTextureSet()
+    {
+        std::array<VkDescriptorImageInfo, s_MaxTextureSlots> imageInfos;
+        for (u32 i = 0; i < s_MaxTextureSlots; ++i) {
+            imageInfos[i].sampler = m_TextureSlots[i]->GetSampler();
+            imageInfos[i].imageView = m_TextureSlots[i]->GetImageView();
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorCount = s_MaxTextureSlots;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = imageInfos.data();
+
+        // Texture sets repeat within a frame, e.g. every scene starts with the
+        // same slots, those come back from the allocator without a write.
+        VkDescriptorSet set = m_Renderer.GetDescriptorAllocator().Allocate(m_DescriptorSetLayout, { &write, 1 });
+        if (set == VK_NULL_HANDLE) {
+            LOG_ERROR("Renderer2D: failed to allocate a texture descriptor set");
+            return m_TextureSet;
+        }
+
+        return set;
+    }
+
+    glm::u8vec4 Renderer2D::PackColor(const glm::vec4& color) const
+    {
+        glm::vec4 scaled = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return glm::u8vec4(scaled);
+    }
+
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include "Types.hpp"
+#include "VertexLayout.hpp"
+#include "PipelineCache.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+    class Texture;
+
+    struct Renderer2DStats
+    {
+        u32 DrawCalls { 0 };
+        u32 QuadCount { 0 };
+        u32 CircleCount { 0 };
+        u32 LineCount { 0 };
+    };
+
+    // Immediate-mode batch renderer for quads, sprites, circles and lines.
+    // Vertices are written straight into persistently mapped per-frame buffers,
+    // a batch is only flushed when the primitive type changes, the texture slots
+    // overflow or the batch reaches s_MaxQuadsPerBatch. Draw calls are recorded
+    // at the end of the main pass, on top of the 3D content.
+    class Renderer2D
+    {
+    public:
+        Renderer2D(Renderer& renderer);
+        ~Renderer2D();
+
+        Renderer2D(const Renderer2D&) = delete;
+        Renderer2D& operator=(const Renderer2D&) = delete;
+
+        // Pipelines depend on the attachment formats and sample count of the main
+        // pass, each call queues the compiles for the current ones.
+        void CreatePipelines();
+
+        // Called by the renderer once the frame slot is free for writing.
+        void BeginFrame();
+
+        void BeginScene(const glm::mat4& viewProjection);
+        void EndScene();
+
+        void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+        void DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
+        void DrawQuad(const glm::mat4& transform, const glm::vec4& color);
+        void DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, f32 rotation, const glm::vec4& color);
+
+        void DrawSprite(const glm::vec3& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+        void DrawSprite(const glm::mat4& transform, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+
+        void DrawCircle(const glm::mat4& transform, const glm::vec4& color, f32 thickness = 1.0f, f32 fade = 0.005f);
+
+        void DrawLine(const glm::vec3& p0, const glm::vec3& p1, const glm::vec4& color);
+        void DrawRect(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
+
+        // Records every batch of the current frame, must be called inside the main pass.
+        void Record(VkCommandBuffer commandBuffer);
+
+        inline const Renderer2DStats& GetStats() const { return m_Stats; }
+
+    public:
+        inline static constexpr u32 s_MaxQuadsPerBatch { 262144 };
+        inline static constexpr u32 s_MaxTextureSlots { 32 };
+
+    private:
+        struct QuadVertex
+        {
+            glm::vec3 Position;
+            glm::u8vec4 Color;
+            glm::vec2 TexCoord;
+            u32 TexIndex;
+
+            static constexpr auto Layout()
+            {
+                return MakeVertexLayout<QuadVertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                    VERTEX_ATTRIBUTE(QuadVertex, Position),
+                    VERTEX_ATTRIBUTE(QuadVertex, Color),
+                    VERTEX_ATTRIBUTE(QuadVertex, TexCoord),
+                    VERTEX_ATTRIBUTE(QuadVertex, TexIndex)
+                );
+            }
+        };
+
+        struct CircleVertex
+        {
+            glm::vec3 WorldPosition;
+            glm::vec2 LocalPosition;
+            glm::u8vec4 Color;
+            f32 Thickness;
+            f32 Fade;
+
+            static constexpr auto Layout()
+            {
+                return MakeVertexLayout<CircleVertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                    VERTEX_ATTRIBUTE(CircleVertex, WorldPosition),
+                    VERTEX_ATTRIBUTE(CircleVertex, LocalPosition),
+                    VERTEX_ATTRIBUTE(CircleVertex, Color),
+                    VERTEX_ATTRIBUTE(CircleVertex, Thickness),
+                    VERTEX_ATTRIBUTE(CircleVertex, Fade)
+                );
+            }
+        };
+
+        struct LineVertex
+        {
+            glm::vec3 Position;
+            glm::u8vec4 Color;
+
+            static constexpr auto Layout()
+            {
+                return MakeVertexLayout<LineVertex>(VK_VERTEX_INPUT_RATE_VERTEX,
+                    VERTEX_ATTRIBUTE(LineVertex, Position),
+                    VERTEX_ATTRIBUTE(LineVertex, Color)
+                );
+            }
+        };
+
+        enum class Primitive : u8 { None, Quad, Circle, Line };
+
+        struct VertexChunk
+        {
+            VkBuffer Buffer { VK_NULL_HANDLE };
+            VkDeviceMemory Memory { VK_NULL_HANDLE };
+            u8* Mapped { nullptr };
+        };
+
+        struct Batch
+        {
+            Primitive Type;
+            VkBuffer Buffer;
+            VkDeviceSize Offset;
+            u32 VertexCount;
+            VkDescriptorSet Textures;
+        };
+
+        struct FrameData
+        {
+            std::vector<VertexChunk> Chunks;
+            u32 ChunkIndex { 0 };
+            VkDeviceSize ChunkOffset { 0 };
+
+            std::vector<Batch> Batches;
+        };
+
+    private:
+        void CreateIndexBuffer();
+        void CreateDescriptors();
+        PipelineDesc GetPipelineDesc(const std::string& name, VkPrimitiveTopology topology) const;
+
+        // Ensures room for vertexCount vertices of the given type, flushing if needed.
+        u8* Reserve(Primitive type, u32 vertexCount, u32 vertexSize);
+        u32 GetTextureSlot(const Texture& texture);
+        void Flush();
+
+        // Frees the vertex chunks of the idle frame slot that its last frame did not use.
+        void TrimChunks();
+
+        VkDescriptorSet AllocateTextureSet();
+
+        glm::u8vec4 PackColor(const glm::vec4& color) const;
+
+    private:
+        Renderer& m_Renderer;
+
+        VkDescriptorSetLayout m_DescriptorSetLayout { VK_NULL_HANDLE };
+        VkPipelineLayout m_PipelineLayout { VK_NULL_HANDLE };
+
+        PipelineDesc m_QuadPipeline;
+        PipelineDesc m_CirclePipeline;
+        PipelineDesc m_LinePipeline;
+        PipelineDesc m_QuadFallbackPipeline;
+        PipelineDesc m_CircleFallbackPipeline;
+        PipelineDesc m_LineFallbackPipeline;
+
+        VkBuffer m_QuadIndexBuffer { VK_NULL_HANDLE };
+        VkDeviceMemory m_QuadIndexBufferMemory { VK_NULL_HANDLE };
+
+        std::unique_ptr<Texture> m_WhiteTexture;
+
+        std::vector<FrameData> m_Frames;
+        FrameData* m_Frame { nullptr };
+
+        u32 m_EvictionCallback { 0 };
+
+        glm::mat4 m_ViewProjection { 1.0f };
+
+        // Current open batch.
+        Primitive m_BatchType { Primitive::None };
+        u8* m_BatchBase { nullptr };
+        VkDeviceSize m_BatchOffset { 0 };
+        u32 m_BatchVertexCount { 0 };
+        u32 m_BatchVertexCapacity { 0 };
+        u32 m_BatchVertexSize { 0 };
+
+        std::array<const Texture*, s_MaxTextureSlots> m_TextureSlots;
+        u32 m_TextureSlotCount { 1 };
+        bool m_TextureSlotsDirty { true };
+        VkDescriptorSet m_TextureSet { VK_NULL_HANDLE };
+
+        Renderer2DStats m_Stats;
+    };
+
+}
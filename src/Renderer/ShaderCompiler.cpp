@@ -0,0 +1,377 @@
+#include "ShaderCompiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#ifdef GRAPHICS_HAS_SHADERC
+    #include <shaderc/shaderc.hpp>
+#endif
+
+#include "Core/Log.hpp"
+#include "Core/Hash.hpp"
+
+// All set by CMake, the fallbacks only matter for builds outside of it.
+#ifndef GRAPHICS_SHADER_SOURCE_DIR
+    #define GRAPHICS_SHADER_SOURCE_DIR "shaders"
+#endif
+
+#ifndef GRAPHICS_GLSLC_EXECUTABLE
+    #define GRAPHICS_GLSLC_EXECUTABLE "glslc"
+#endif
+
+#ifndef GRAPHICS_SHADER_COMPILER_VERSION
+    #define GRAPHICS_SHADER_COMPILER_VERSION "unknown"
+#endif
+
+namespace Graphics {
+
+    // Part of every cache key, bump it when the way shaders are compiled changes.
+#ifdef GRAPHICS_HAS_SHADERC
+    static constexpr const char* s_CompilerVersion = "1 shaderc " GRAPHICS_SHADER_COMPILER_VERSION;
+#else
+    static constexpr const char* s_CompilerVersion = "1 glslc " GRAPHICS_SHADER_COMPILER_VERSION;
+#endif
+
+    struct StageExtension
+    {
+        const char* Extension;
+#ifdef GRAPHICS_HAS_SHADERC
+        shaderc_shader_kind Kind;
+#endif
+    };
+
+#ifdef GRAPHICS_HAS_SHADERC
+    #define STAGE_EXTENSION(extension, kind) StageExtension { extension, kind }
+#else
+    #define STAGE_EXTENSION(extension, kind) StageExtension { extension }
+#endif
+
+    // Same extensions the shader target compiles.
+    static constexpr std::array<StageExtension, 11> s_StageExtensions = {
+        STAGE_EXTENSION(".vert", shaderc_vertex_shader),
+        STAGE_EXTENSION(".frag", shaderc_fragment_shader),
+        STAGE_EXTENSION(".comp", shaderc_compute_shader),
+        STAGE_EXTENSION(".geom", shaderc_geometry_shader),
+        STAGE_EXTENSION(".tesc", shaderc_tess_control_shader),
+        STAGE_EXTENSION(".tese", shaderc_tess_evaluation_shader),
+        STAGE_EXTENSION(".mesh", shaderc_mesh_shader),
+        STAGE_EXTENSION(".task", shaderc_task_shader),
+        STAGE_EXTENSION(".rgen", shaderc_raygen_shader),
+        STAGE_EXTENSION(".rchit", shaderc_closesthit_shader),
+        STAGE_EXTENSION(".rmiss", shaderc_miss_shader)
+    };
+
+#undef STAGE_EXTENSION
+
+    static const StageExtension* FindStage(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+
+        auto it = std::find_if(s_StageExtensions.begin(), s_StageExtensions.end(), [&](const StageExtension& stage) { return extension == stage.Extension; });
+        return it != s_StageExtensions.end() ? &*it : nullptr;
+    }
+
+    static bool ReadText(const std::filesystem::path& path, std::string& text)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        text = stream.str();
+
+        return true;
+    }
+
+#ifdef GRAPHICS_HAS_SHADERC
+
+    // Resolves "file" against the including file and <file> against the source directory.
+    class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
+    {
+    public:
+        ShaderIncluder(const std::filesystem::path& sourceDirectory)
+            : m_SourceDirectory(sourceDirectory)
+        {
+        }
+
+        shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t) override
+        {
+            std::filesystem::path base = type == shaderc_include_type_relative ? std::filesystem::path(requestingSource).parent_path() : m_SourceDirectory;
+            std::filesystem::path file = (base / requestedSource).lexically_normal();
+
+            Include* include = new Include;
+
+            if (ReadText(file, include->Content)) {
+                include->Name = file.string();
+            } else {
+                // An empty name reports the content as the error message.
+                include->Content = "Cannot open include " + file.string();
+            }
+
+            include->Result = { include->Name.data(), include->Name.size(), include->Content.data(), include->Content.size(), include };
+            return &include->Result;
+        }
+
+        void ReleaseInclude(shaderc_include_result* result) override
+        {
+            delete static_cast<Include*>(result->user_data);
+        }
+
+    private:
+        struct Include
+        {
+            std::string Name;
+            std::string Content;
+            shaderc_include_result Result;
+        };
+
+    private:
+        std::filesystem::path m_SourceDirectory;
+    };
+
+    struct ShaderCompiler::Backend
+    {
+        shaderc::Compiler Compiler;
+    };
+
+#else
+
+    struct ShaderCompiler::Backend
+    {
+    };
+
+#endif
+
+    ShaderCompiler::ShaderCompiler()
+        : m_SourceDirectory(GRAPHICS_SHADER_SOURCE_DIR), m_CacheDirectory("shaders/cache"), m_Backend(std::make_unique<Backend>())
+    {
+    }
+
+    ShaderCompiler::~ShaderCompiler()
+    {
+    }
+
+    std::vector<u32> ShaderCompiler::Compile(const std::string& source, const std::vector<ShaderDefine>& defines)
+    {
+        std::error_code error;
+        if (!FindStage(source) || !std::filesystem::is_regular_file(m_SourceDirectory / source, error)) {
+            LOG_ERROR("No shader source {} in {}", source, m_SourceDirectory.string());
+            return {};
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(ComputeKey(source, defines)));
+
+        std::filesystem::path cached = m_CacheDirectory / name;
+
+        std::vector<u32> code = ReadBinary(cached);
+        if (!code.empty()) {
+            LOG_DEBUG("Loaded {} from the shader cache", source);
+            return code;
+        }
+
+        LOG_INFO("Compiling {} with {} defines", source, defines.size());
+
+        code = CompileSource(source, defines);
+        if (!code.empty())
+            WriteBinary(cached, code);
+
+        return code;
+    }
+
+    std::vector<std::string> ShaderCompiler::CollectIncludes(const std::string& source) const
+    {
+        std::vector<std::string> includes;
+        CollectIncludes(m_SourceDirectory / source, includes);
+        return includes;
+    }
+
+    bool ShaderCompiler::IsShaderStage(const std::filesystem::path& path)
+    {
+        return FindStage(path) != nullptr;
+    }
+
+    std::vector<u32> ShaderCompiler::ReadBinary(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+            return {};
+
+        usize size = static_cast<usize>(file.tellg());
+        if (size == 0 || size % sizeof(u32) != 0)
+            return {};
+
+        std::vector<u32> code(size / sizeof(u32));
+
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(code.data()), size);
+
+        return file ? code : std::vector<u32>();
+    }
+
+    bool ShaderCompiler::WriteBinary(const std::filesystem::path& path, const std::vector<u32>& code)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // Unique per thread, two threads may finish the same shader at once.
+        std::filesystem::path temporary = path.string() + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(u32));
+
+            if (!file) {
+                LOG_ERROR("Failed to write {}", temporary.string());
+                file.close();
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            LOG_ERROR("Failed to replace {}: {}", path.string(), error.message());
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    u64 ShaderCompiler::ComputeKey(const std::string& source, const std::vector<ShaderDefine>& defines) const
+    {
+        u64 key = HashString(s_CompilerVersion);
+        key = HashString(source, key);
+
+        // The order defines are passed in does not change the result.
+        std::vector<const ShaderDefine*> sorted;
+        for (const auto& define : defines)
+            sorted.push_back(&define);
+
+        std::sort(sorted.begin(), sorted.end(), [](const ShaderDefine* a, const ShaderDefine* b) { return a->Name < b->Name; });
+
+        for (const ShaderDefine* define : sorted) {
+            key = HashString(define->Name, key);
+            key = HashString(define->Value, key);
+        }
+
+        std::string text;
+        ReadText(m_SourceDirectory / source, text);
+        key = HashString(text, key);
+
+        for (const auto& include : CollectIncludes(source)) {
+            text.clear();
+            ReadText(m_SourceDirectory / include, text);
+
+            key = HashString(include, key);
+            key = HashString(text, key);
+        }
+
+        return key;
+    }
+
+#ifdef GRAPHICS_HAS_SHADERC
+
+    std::vector<u32> ShaderCompiler::CompileSource(const std::string& source, const std::vector<ShaderDefine>& defines)
+    {
+        std::filesystem::path path = m_SourceDirectory / source;
+
+        std::string text;
+        ReadText(path, text);
+
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        options.SetIncluder(std::make_unique<ShaderIncluder>(m_SourceDirectory));
+
+        for (const auto& define : defines)
+            options.AddMacroDefinition(define.Name, define.Value);
+
+        shaderc::SpvCompilationResult result = m_Backend->Compiler.CompileGlslToSpv(text, FindStage(path)->Kind, path.string().c_str(), options);
+
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+            LOG_ERROR("Failed to compile {}:\n{}", source, result.GetErrorMessage());
+            return {};
+        }
+
+        return std::vector<u32>(result.cbegin(), result.cend());
+    }
+
+#else
+
+    std::vector<u32> ShaderCompiler::CompileSource(const std::string& source, const std::vector<ShaderDefine>& defines)
+    {
+        std::filesystem::path output = m_CacheDirectory / (source + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())));
+        std::filesystem::path log = output.string() + ".log";
+
+        std::error_code error;
+        std::filesystem::create_directories(m_CacheDirectory, error);
+
+        std::string command = std::string("\"") + GRAPHICS_GLSLC_EXECUTABLE + "\"";
+
+        for (const auto& define : defines)
+            command += " \"-D" + define.Name + (define.Value.empty() ? "" : "=" + define.Value) + "\"";
+
+        command += " -o \"" + output.string() + "\" \"" + (m_SourceDirectory / source).string() + "\" 2> \"" + log.string() + "\"";
+
+#ifdef _WIN32
+        // cmd strips the outer quotes of the whole command line.
+        command = "\"" + command + "\"";
+#endif
+
+        std::vector<u32> code;
+
+        if (std::system(command.c_str()) == 0) {
+            code = ReadBinary(output);
+        } else {
+            std::string messages;
+            ReadText(log, messages);
+            LOG_ERROR("Failed to compile {}:\n{}", source, messages);
+        }
+
+        std::filesystem::remove(output, error);
+        std::filesystem::remove(log, error);
+
+        return code;
+    }
+
+#endif
+
+    void ShaderCompiler::CollectIncludes(const std::filesystem::path& file, std::vector<std::string>& includes) const
+    {
+        std::ifstream stream(file);
+
+        std::string line;
+        while (std::getline(stream, line)) {
+            usize start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+                continue;
+
+            usize open = line.find_first_of("\"<", start + 8);
+            if (open == std::string::npos)
+                continue;
+
+            usize close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+            if (close == std::string::npos)
+                continue;
+
+            std::filesystem::path base = line[open] == '"' ? file.parent_path() : m_SourceDirectory;
+            std::filesystem::path resolved = (base / line.substr(open + 1, close - open - 1)).lexically_normal();
+
+            std::string include = resolved.lexically_relative(m_SourceDirectory).generic_string();
+            if (std::find(includes.begin(), includes.end(), include) != includes.end())
+                continue;
+
+            includes.push_back(include);
+            CollectIncludes(resolved, includes);
+        }
+    }
+
+}
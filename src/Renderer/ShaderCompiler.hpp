@@ -0,0 +1,70 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    struct ShaderDefine
+    {
+        std::string Name;
+        std::string Value;
+    };
+
+    // Compiles GLSL to SPIR-V at runtime, with #include support and macro
+    // defines, and caches the results on disk.
+    //
+    // Sources are file names relative to the shader source directory, the stage
+    // follows from the extension as for the build-time shader target. Each
+    // result is stored under a hash of the compiler version, the defines, the
+    // source and everything it includes, so every permutation is compiled once
+    // and later requests for it read the cached binary. Editing any input
+    // produces a new key, stale entries are simply never read again.
+    //
+    // Compiles with shaderc when built with GRAPHICS_HAS_SHADERC and falls back
+    // to running glslc otherwise. Safe to call from several threads.
+    class ShaderCompiler
+    {
+    public:
+        ShaderCompiler();
+        ~ShaderCompiler();
+
+        ShaderCompiler(const ShaderCompiler&) = delete;
+        ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+        // Returns an empty vector if the source cannot be compiled.
+        std::vector<u32> Compile(const std::string& source, const std::vector<ShaderDefine>& defines = {});
+
+        // Files pulled in by #include, recursively, relative to the source directory.
+        std::vector<std::string> CollectIncludes(const std::string& source) const;
+
+        inline const std::filesystem::path& GetSourceDirectory() const { return m_SourceDirectory; }
+
+        static bool IsShaderStage(const std::filesystem::path& path);
+
+        static std::vector<u32> ReadBinary(const std::filesystem::path& path);
+        // Writes through a temporary file, readers never see a partial binary.
+        static bool WriteBinary(const std::filesystem::path& path, const std::vector<u32>& code);
+
+    private:
+        struct Backend;
+
+    private:
+        u64 ComputeKey(const std::string& source, const std::vector<ShaderDefine>& defines) const;
+
+        std::vector<u32> CompileSource(const std::string& source, const std::vector<ShaderDefine>& defines);
+
+        void CollectIncludes(const std::filesystem::path& file, std::vector<std::string>& includes) const;
+
+    private:
+        std::filesystem::path m_SourceDirectory;
+        std::filesystem::path m_CacheDirectory;
+
+        std::unique_ptr<Backend> m_Backend;
+    };
+
+}
@@ -0,0 +1,608 @@
+#include "ShaderReflection.hpp"
+
+#include <algorithm>
+#include <optional>
+
+#include "Core/Log.hpp"
+
+namespace Graphics {
+
+    // The subset of the SPIR-V grammar needed to walk the resource interface.
+    namespace SpirV {
+
+        static constexpr u32 Magic = 0x07230203;
+        static constexpr u32 HeaderSize = 5;
+
+        enum Op : u32
+        {
+            OpName = 5,
+            OpEntryPoint = 15,
+            OpTypeBool = 20,
+            OpTypeInt = 21,
+            OpTypeFloat = 22,
+            OpTypeVector = 23,
+            OpTypeMatrix = 24,
+            OpTypeImage = 25,
+            OpTypeSampler = 26,
+            OpTypeSampledImage = 27,
+            OpTypeArray = 28,
+            OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30,
+            OpTypePointer = 32,
+            OpConstant = 43,
+            OpVariable = 59,
+            OpDecorate = 71,
+            OpMemberDecorate = 72,
+            OpTypeAccelerationStructureKHR = 5341
+        };
+
+        enum Decoration : u32
+        {
+            Block = 2,
+            BufferBlock = 3,
+            ArrayStride = 6,
+            MatrixStride = 7,
+            BuiltIn = 11,
+            Location = 30,
+            Binding = 33,
+            DescriptorSet = 34,
+            Offset = 35
+        };
+
+        enum StorageClass : u32
+        {
+            UniformConstant = 0,
+            Input = 1,
+            Uniform = 2,
+            PushConstant = 9,
+            StorageBuffer = 12
+        };
+
+        enum Dim : u32
+        {
+            DimBuffer = 5,
+            DimSubpassData = 6
+        };
+
+    }
+
+    struct SpirVId
+    {
+        u32 Opcode { 0 };
+
+        // Pointee, element, component or column type depending on the opcode.
+        u32 Type { 0 };
+        u32 StorageClass { 0 };
+        // Vector components, matrix columns, or the id of an array's length.
+        u32 Count { 0 };
+        u32 Width { 0 };
+        bool Signed { false };
+        u32 Dim { 0 };
+        u32 Sampled { 0 };
+        u32 Value { 0 };
+        std::vector<u32> Members;
+
+        std::optional<u32> Set;
+        std::optional<u32> Binding;
+        std::optional<u32> Location;
+        bool BuiltIn { false };
+        bool Block { false };
+        bool BufferBlock { false };
+        u32 ArrayStride { 0 };
+
+        std::vector<u32> MemberOffsets;
+        std::vector<u32> MemberMatrixStrides;
+
+        std::string Name;
+    };
+
+    static VkShaderStageFlags GetStage(u32 executionModel)
+    {
+        switch (executionModel) {
+            case 0:     return VK_SHADER_STAGE_VERTEX_BIT;
+            case 1:     return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case 2:     return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case 3:     return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case 4:     return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case 5:     return VK_SHADER_STAGE_COMPUTE_BIT;
+            case 5364:  return VK_SHADER_STAGE_TASK_BIT_EXT;
+            case 5365:  return VK_SHADER_STAGE_MESH_BIT_EXT;
+            case 5313:  return VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+            case 5314:  return VK_SHADER_STAGE_INTERSECTION_BIT_KHR;
+            case 5315:  return VK_SHADER_STAGE_ANY_HIT_BIT_KHR;
+            case 5316:  return VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+            case 5317:  return VK_SHADER_STAGE_MISS_BIT_KHR;
+            case 5318:  return VK_SHADER_STAGE_CALLABLE_BIT_KHR;
+            default:    return 0;
+        }
+    }
+
+    static std::string ReadString(std::span<const u32> words)
+    {
+        std::string string;
+        for (u32 word : words) {
+            for (u32 i = 0; i < 4; ++i) {
+                char c = static_cast<char>((word >> (i * 8)) & 0xff);
+                if (c == '\0')
+                    return string;
+                string.push_back(c);
+            }
+        }
+
+        return string;
+    }
+
+    // Words a literal string occupies, including the terminator.
+    static u32 StringWordCount(std::span<const u32> words)
+    {
+        for (u32 i = 0; i < words.size(); ++i) {
+            if ((words[i] >> 24) == 0)
+                return i + 1;
+        }
+
+        return static_cast<u32>(words.size());
+    }
+
+    static VkFormat GetVertexFormat(const std::vector<SpirVId>& ids, const SpirVId& type)
+    {
+        const SpirVId& scalar = type.Opcode == SpirV::OpTypeVector ? ids[type.Type] : type;
+        u32 components = type.Opcode == SpirV::OpTypeVector ? type.Count : 1;
+
+        if (scalar.Width != 32 || components < 1 || components > 4)
+            return VK_FORMAT_UNDEFINED;
+
+        static constexpr VkFormat floats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+        static constexpr VkFormat ints[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+        static constexpr VkFormat uints[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+        if (scalar.Opcode == SpirV::OpTypeFloat)
+            return floats[components - 1];
+
+        if (scalar.Opcode == SpirV::OpTypeInt)
+            return scalar.Signed ? ints[components - 1] : uints[components - 1];
+
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    static u32 GetFormatSize(VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_R32_SFLOAT:
+            case VK_FORMAT_R32_SINT:
+            case VK_FORMAT_R32_UINT:
+                return 4;
+            case VK_FORMAT_R32G32_SFLOAT:
+            case VK_FORMAT_R32G32_SINT:
+            case VK_FORMAT_R32G32_UINT:
+                return 8;
+            case VK_FORMAT_R32G32B32_SFLOAT:
+            case VK_FORMAT_R32G32B32_SINT:
+            case VK_FORMAT_R32G32B32_UINT:
+                return 12;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+            case VK_FORMAT_R32G32B32A32_SINT:
+            case VK_FORMAT_R32G32B32A32_UINT:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    enum class NumericType : u8
+    {
+        Unknown,
+        Float,
+        SInt,
+        UInt
+    };
+
+    // Type the shader reads an attribute as, normalized formats read as float.
+    static NumericType GetNumericType(VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_R32_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+            case VK_FORMAT_R32G32B32_SFLOAT:
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return NumericType::Float;
+            case VK_FORMAT_R32_SINT:
+            case VK_FORMAT_R32G32_SINT:
+            case VK_FORMAT_R32G32B32_SINT:
+            case VK_FORMAT_R32G32B32A32_SINT:
+                return NumericType::SInt;
+            case VK_FORMAT_R32_UINT:
+            case VK_FORMAT_R32G32_UINT:
+            case VK_FORMAT_R32G32B32_UINT:
+            case VK_FORMAT_R32G32B32A32_UINT:
+                return NumericType::UInt;
+            default:
+                return NumericType::Unknown;
+        }
+    }
+
+    // Size of a block member laid out with explicit offsets and strides.
+    static u32 GetTypeSize(const std::vector<SpirVId>& ids, u32 typeId, u32 matrixStride = 0)
+    {
+        const SpirVId& type = ids[typeId];
+
+        switch (type.Opcode) {
+            case SpirV::OpTypeBool:
+            case SpirV::OpTypeInt:
+            case SpirV::OpTypeFloat:
+                return std::max(type.Width, 32u) / 8;
+            case SpirV::OpTypeVector:
+                return type.Count * GetTypeSize(ids, type.Type);
+            case SpirV::OpTypeMatrix:
+                return type.Count * (matrixStride ? matrixStride : GetTypeSize(ids, type.Type));
+            case SpirV::OpTypeArray: {
+                u32 stride = type.ArrayStride ? type.ArrayStride : GetTypeSize(ids, type.Type, matrixStride);
+                return ids[type.Count].Value * stride;
+            }
+            case SpirV::OpTypeStruct: {
+                u32 size = 0;
+                for (usize i = 0; i < type.Members.size(); ++i) {
+                    u32 offset = i < type.MemberOffsets.size() ? type.MemberOffsets[i] : 0;
+                    u32 stride = i < type.MemberMatrixStrides.size() ? type.MemberMatrixStrides[i] : 0;
+                    size = std::max(size, offset + GetTypeSize(ids, type.Members[i], stride));
+                }
+                return size;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    static std::optional<VkDescriptorType> GetDescriptorType(const std::vector<SpirVId>& ids, const SpirVId& type, u32 storageClass)
+    {
+        if (storageClass == SpirV::StorageBuffer)
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        if (storageClass == SpirV::Uniform)
+            return type.BufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+        switch (type.Opcode) {
+            case SpirV::OpTypeSampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case SpirV::OpTypeSampledImage:
+                return ids[type.Type].Dim == SpirV::DimBuffer ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case SpirV::OpTypeImage:
+                if (type.Dim == SpirV::DimSubpassData)
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                if (type.Dim == SpirV::DimBuffer)
+                    return type.Sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                return type.Sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            case SpirV::OpTypeAccelerationStructureKHR:
+                return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    ShaderReflection ShaderReflection::Reflect(std::span<const u32> code)
+    {
+        if (code.size() < SpirV::HeaderSize || code[0] != SpirV::Magic) {
+            LOG_ERROR("Not a SPIR-V binary");
+            return ShaderReflection();
+        }
+
+        u32 bound = code[3];
+        std::vector<SpirVId> ids(bound);
+
+        VkShaderStageFlags stages = 0;
+        std::vector<u32> interface;
+        std::vector<u32> variables;
+
+        auto valid = [&](u32 id) { return id < bound; };
+
+        for (usize offset = SpirV::HeaderSize; offset < code.size(); ) {
+            u32 opcode = code[offset] & 0xffff;
+            u32 count = code[offset] >> 16;
+
+            if (count == 0 || offset + count > code.size()) {
+                LOG_ERROR("Malformed SPIR-V instruction at word {}", offset);
+                return ShaderReflection();
+            }
+
+            std::span<const u32> operands = code.subspan(offset + 1, count - 1);
+            offset += count;
+
+            // Every opcode read below defines or refers to its first operand.
+            if (operands.empty())
+                continue;
+
+            switch (opcode) {
+                case SpirV::OpEntryPoint: {
+                    if (operands.size() < 3)
+                        break;
+
+                    stages |= GetStage(operands[0]);
+
+                    u32 nameWords = StringWordCount(operands.subspan(2));
+                    for (usize i = 2 + nameWords; i < operands.size(); ++i)
+                        interface.push_back(operands[i]);
+                    break;
+                }
+                case SpirV::OpName:
+                    if (valid(operands[0]))
+                        ids[operands[0]].Name = ReadString(operands.subspan(1));
+                    break;
+                case SpirV::OpDecorate: {
+                    if (operands.size() < 2 || !valid(operands[0]))
+                        break;
+
+                    SpirVId& id = ids[operands[0]];
+                    u32 literal = operands.size() > 2 ? operands[2] : 0;
+
+                    switch (operands[1]) {
+                        case SpirV::Block:          id.Block = true; break;
+                        case SpirV::BufferBlock:    id.BufferBlock = true; break;
+                        case SpirV::ArrayStride:    id.ArrayStride = literal; break;
+                        case SpirV::BuiltIn:        id.BuiltIn = true; break;
+                        case SpirV::Location:       id.Location = literal; break;
+                        case SpirV::Binding:        id.Binding = literal; break;
+                        case SpirV::DescriptorSet:  id.Set = literal; break;
+                    }
+                    break;
+                }
+                case SpirV::OpMemberDecorate: {
+                    if (operands.size() < 4 || !valid(operands[0]))
+                        break;
+
+                    SpirVId& id = ids[operands[0]];
+                    u32 member = operands[1];
+
+                    if (operands[2] == SpirV::Offset) {
+                        id.MemberOffsets.resize(std::max<usize>(id.MemberOffsets.size(), member + 1), 0);
+                        id.MemberOffsets[member] = operands[3];
+                    } else if (operands[2] == SpirV::MatrixStride) {
+                        id.MemberMatrixStrides.resize(std::max<usize>(id.MemberMatrixStrides.size(), member + 1), 0);
+                        id.MemberMatrixStrides[member] = operands[3];
+                    }
+                    break;
+                }
+                case SpirV::OpConstant:
+                    // Result type first, then the result id.
+                    if (operands.size() >= 3 && valid(operands[1])) {
+                        ids[operands[1]].Opcode = opcode;
+                        ids[operands[1]].Value = operands[2];
+                    }
+                    break;
+                case SpirV::OpVariable:
+                    if (operands.size() >= 3 && valid(operands[0]) && valid(operands[1])) {
+                        SpirVId& id = ids[operands[1]];
+                        id.Opcode = opcode;
+                        id.Type = operands[0];
+                        id.StorageClass = operands[2];
+                        variables.push_back(operands[1]);
+                    }
+                    break;
+                default: {
+                    bool type = opcode == SpirV::OpTypeBool || opcode == SpirV::OpTypeInt || opcode == SpirV::OpTypeFloat
+                        || opcode == SpirV::OpTypeVector || opcode == SpirV::OpTypeMatrix || opcode == SpirV::OpTypeImage
+                        || opcode == SpirV::OpTypeSampler || opcode == SpirV::OpTypeSampledImage || opcode == SpirV::OpTypeArray
+                        || opcode == SpirV::OpTypeRuntimeArray || opcode == SpirV::OpTypeStruct || opcode == SpirV::OpTypePointer
+                        || opcode == SpirV::OpTypeAccelerationStructureKHR;
+
+                    if (!type || !valid(operands[0]))
+                        break;
+
+                    SpirVId& id = ids[operands[0]];
+                    id.Opcode = opcode;
+
+                    auto operand = [&](usize index) { return index < operands.size() ? operands[index] : 0; };
+
+                    switch (opcode) {
+                        case SpirV::OpTypeInt:          id.Width = operand(1); id.Signed = operand(2) != 0; break;
+                        case SpirV::OpTypeFloat:        id.Width = operand(1); break;
+                        case SpirV::OpTypeVector:
+                        case SpirV::OpTypeMatrix:       id.Type = operand(1); id.Count = operand(2); break;
+                        case SpirV::OpTypeImage:        id.Type = operand(1); id.Dim = operand(2); id.Sampled = operand(6); break;
+                        case SpirV::OpTypeSampledImage:
+                        case SpirV::OpTypeRuntimeArray: id.Type = operand(1); break;
+                        case SpirV::OpTypeArray:        id.Type = operand(1); id.Count = operand(2); break;
+                        case SpirV::OpTypePointer:      id.StorageClass = operand(1); id.Type = operand(2); break;
+                        case SpirV::OpTypeStruct:       id.Members.assign(operands.begin() + 1, operands.end()); break;
+                    }
+                    break;
+                }
+            }
+        }
+
+        // Every id the type walk below follows is checked once here.
+        for (const auto& id : ids) {
+            if (!valid(id.Type) || !valid(id.Count) || std::any_of(id.Members.begin(), id.Members.end(), [&](u32 member) { return !valid(member); })) {
+                LOG_ERROR("SPIR-V binary refers to an id out of bounds");
+                return ShaderReflection();
+            }
+        }
+
+        if (stages == 0) {
+            LOG_ERROR("SPIR-V binary has no supported entry point");
+            return ShaderReflection();
+        }
+
+        ShaderReflection reflection;
+        reflection.m_Stages = stages;
+
+        for (u32 variableId : variables) {
+            const SpirVId& variable = ids[variableId];
+            const SpirVId& pointer = ids[variable.Type];
+            if (pointer.Opcode != SpirV::OpTypePointer)
+                continue;
+
+            u32 typeId = pointer.Type;
+
+            switch (variable.StorageClass) {
+                case SpirV::PushConstant:
+                    reflection.m_PushConstantSize = std::max(reflection.m_PushConstantSize, GetTypeSize(ids, typeId));
+                    reflection.m_PushConstantStages = stages;
+                    break;
+                case SpirV::Input: {
+                    // Before SPIR-V 1.4 only inputs and outputs are listed, so
+                    // the interface is checked for inputs alone.
+                    bool used = std::find(interface.begin(), interface.end(), variableId) != interface.end();
+                    if (!(stages & VK_SHADER_STAGE_VERTEX_BIT) || !used || variable.BuiltIn || !variable.Location)
+                        break;
+
+                    const SpirVId& type = ids[typeId];
+
+                    // Matrices take one location per column.
+                    u32 columns = type.Opcode == SpirV::OpTypeMatrix ? type.Count : 1;
+                    const SpirVId& column = type.Opcode == SpirV::OpTypeMatrix ? ids[type.Type] : type;
+
+                    for (u32 i = 0; i < columns; ++i)
+                        reflection.m_VertexInputs.push_back({ *variable.Location + i, GetVertexFormat(ids, column), variable.Name });
+                    break;
+                }
+                case SpirV::UniformConstant:
+                case SpirV::Uniform:
+                case SpirV::StorageBuffer: {
+                    if (!variable.Set || !variable.Binding)
+                        break;
+
+                    u32 count = 1;
+                    while (ids[typeId].Opcode == SpirV::OpTypeArray || ids[typeId].Opcode == SpirV::OpTypeRuntimeArray) {
+                        const SpirVId& array = ids[typeId];
+
+                        // Runtime arrays have no size, bindless layouts are not handled here.
+                        if (array.Opcode == SpirV::OpTypeRuntimeArray)
+                            LOG_WARN("Runtime descriptor array {} reflected with a count of 1", variable.Name);
+                        else
+                            count *= ids[array.Count].Value;
+
+                        typeId = array.Type;
+                    }
+
+                    std::optional<VkDescriptorType> descriptorType = GetDescriptorType(ids, ids[typeId], variable.StorageClass);
+                    if (!descriptorType) {
+                        LOG_WARN("Unsupported descriptor type for {}", variable.Name);
+                        break;
+                    }
+
+                    std::string name = variable.Name.empty() ? ids[typeId].Name : variable.Name;
+                    reflection.m_Bindings.push_back({ *variable.Set, *variable.Binding, *descriptorType, count, stages, name });
+                    break;
+                }
+            }
+        }
+
+        std::sort(reflection.m_Bindings.begin(), reflection.m_Bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+            return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding;
+        });
+
+        std::sort(reflection.m_VertexInputs.begin(), reflection.m_VertexInputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+            return a.Location < b.Location;
+        });
+
+        return reflection;
+    }
+
+    void ShaderReflection::Merge(const ShaderReflection& other)
+    {
+        m_Stages |= other.m_Stages;
+
+        for (const auto& binding : other.m_Bindings) {
+            auto it = std::find_if(m_Bindings.begin(), m_Bindings.end(), [&](const ReflectedBinding& existing) {
+                return existing.Set == binding.Set && existing.Binding == binding.Binding;
+            });
+
+            if (it == m_Bindings.end()) {
+                m_Bindings.push_back(binding);
+                continue;
+            }
+
+            if (it->Type != binding.Type)
+                LOG_ERROR("Set {} binding {} is declared with different descriptor types ({} and {})", binding.Set, binding.Binding, it->Name, binding.Name);
+
+            it->Count = std::max(it->Count, binding.Count);
+            it->Stages |= binding.Stages;
+        }
+
+        std::sort(m_Bindings.begin(), m_Bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+            return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding;
+        });
+
+        m_PushConstantSize = std::max(m_PushConstantSize, other.m_PushConstantSize);
+        m_PushConstantStages |= other.m_PushConstantStages;
+
+        if (m_VertexInputs.empty())
+            m_VertexInputs = other.m_VertexInputs;
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::GetSetBindings(u32 set) const
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+        for (const auto& binding : m_Bindings) {
+            if (binding.Set == set)
+                bindings.push_back({ binding.Binding, binding.Type, binding.Count, binding.Stages, nullptr });
+        }
+
+        return bindings;
+    }
+
+    bool ShaderReflection::OverrideBinding(u32 set, u32 binding, VkDescriptorType type, VkShaderStageFlags stages)
+    {
+        auto it = std::find_if(m_Bindings.begin(), m_Bindings.end(), [&](const ReflectedBinding& existing) {
+            return existing.Set == set && existing.Binding == binding;
+        });
+
+        if (it == m_Bindings.end())
+            return false;
+
+        it->Type = type;
+        it->Stages |= stages;
+
+        return true;
+    }
+
+    u32 ShaderReflection::GetSetCount() const
+    {
+        return m_Bindings.empty() ? 0 : m_Bindings.back().Set + 1;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> ShaderReflection::GetPackedAttributes(u32 binding, u32& stride) const
+    {
+        std::vector<VkVertexInputAttributeDescription> attributes;
+        stride = 0;
+
+        for (const auto& input : m_VertexInputs) {
+            attributes.push_back({ input.Location, binding, input.Format, stride });
+            stride += GetFormatSize(input.Format);
+        }
+
+        return attributes;
+    }
+
+    bool ShaderReflection::ValidateVertexInput(const VkPipelineVertexInputStateCreateInfo& vertexInput) const
+    {
+        std::span<const VkVertexInputAttributeDescription> attributes(vertexInput.pVertexAttributeDescriptions, vertexInput.vertexAttributeDescriptionCount);
+
+        bool valid = true;
+        for (const auto& input : m_VertexInputs) {
+            auto it = std::find_if(attributes.begin(), attributes.end(), [&](const VkVertexInputAttributeDescription& attribute) {
+                return attribute.location == input.Location;
+            });
+
+            if (it == attributes.end()) {
+                LOG_ERROR("Vertex input {} at location {} has no attribute", input.Name, input.Location);
+                valid = false;
+                continue;
+            }
+
+            // Component counts may differ, missing components read as 0 or 1.
+            NumericType expected = GetNumericType(input.Format);
+            NumericType provided = GetNumericType(it->format);
+
+            if (expected != NumericType::Unknown && provided != NumericType::Unknown && expected != provided) {
+                LOG_ERROR("Vertex input {} at location {} does not match the numeric type of attribute format {}", input.Name, input.Location,
+                    static_cast<u32>(it->format));
+                valid = false;
+            }
+        }
+
+        return valid;
+    }
+
+}
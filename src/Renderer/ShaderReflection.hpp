@@ -0,0 +1,83 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    struct ReflectedBinding
+    {
+        u32 Set;
+        u32 Binding;
+        VkDescriptorType Type;
+        u32 Count;
+        VkShaderStageFlags Stages;
+        std::string Name;
+    };
+
+    struct ReflectedVertexInput
+    {
+        u32 Location;
+        VkFormat Format;
+        std::string Name;
+    };
+
+    // Resource interface of one or more shader stages, read straight from the
+    // SPIR-V binary: descriptor bindings, the push constant block and the vertex
+    // inputs. Reflections of the stages of a pipeline, or of several pipelines
+    // that share a layout, are combined with Merge().
+    class ShaderReflection
+    {
+    public:
+        ShaderReflection() = default;
+
+        // Returns an invalid reflection if the binary cannot be parsed.
+        static ShaderReflection Reflect(std::span<const u32> code);
+
+        // Bindings used by several stages keep one entry with the stages combined.
+        void Merge(const ShaderReflection& other);
+
+        inline bool IsValid() const { return m_Stages != 0; }
+        inline VkShaderStageFlags GetStages() const { return m_Stages; }
+
+        // Sorted by set, then binding.
+        inline const std::vector<ReflectedBinding>& GetBindings() const { return m_Bindings; }
+        std::vector<VkDescriptorSetLayoutBinding> GetSetBindings(u32 set) const;
+        u32 GetSetCount() const;
+
+        // SPIR-V cannot tell a buffer bound with a dynamic offset from a plain
+        // one, the layout owner declares it here along with the stages of the
+        // shared set layout. Returns false if the shaders have no such binding.
+        bool OverrideBinding(u32 set, u32 binding, VkDescriptorType type, VkShaderStageFlags stages);
+
+        inline u32 GetPushConstantSize() const { return m_PushConstantSize; }
+        inline VkShaderStageFlags GetPushConstantStages() const { return m_PushConstantStages; }
+
+        // Sorted by location, only the vertex stage has any.
+        inline const std::vector<ReflectedVertexInput>& GetVertexInputs() const { return m_VertexInputs; }
+
+        // Attributes tightly packed into one binding in location order, for
+        // vertex data that has no C++ layout of its own.
+        std::vector<VkVertexInputAttributeDescription> GetPackedAttributes(u32 binding, u32& stride) const;
+
+        // Checks that every vertex input has an attribute that reads as the same
+        // numeric type (float, signed or unsigned integer).
+        bool ValidateVertexInput(const VkPipelineVertexInputStateCreateInfo& vertexInput) const;
+
+    private:
+        VkShaderStageFlags m_Stages { 0 };
+
+        std::vector<ReflectedBinding> m_Bindings;
+
+        u32 m_PushConstantSize { 0 };
+        VkShaderStageFlags m_PushConstantStages { 0 };
+
+        std::vector<ReflectedVertexInput> m_VertexInputs;
+    };
+
+}
@@ -0,0 +1,188 @@
+#include "ShaderReloader.hpp"
+
+#include <algorithm>
+
+#include "Core/Log.hpp"
+#include "Renderer.hpp"
+#include "ShaderCompiler.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "PipelineCache.hpp"
+#include "QueueTimeline.hpp"
+
+namespace Graphics {
+
+    ShaderReloader::ShaderReloader(Renderer& renderer)
+        : m_Renderer(renderer)
+    {
+        // Without a configured source directory there is nothing to watch.
+#ifdef GRAPHICS_SHADER_SOURCE_DIR
+        m_SourceDirectory = m_Renderer.GetShaderCompiler().GetSourceDirectory();
+        m_Watcher = std::make_unique<FileWatcher>(m_SourceDirectory, [this](const std::vector<std::string>& files) { OnFilesChanged(files); });
+#else
+        LOG_INFO("Shader hot-reload disabled, no shader source directory configured");
+#endif
+    }
+
+    ShaderReloader::~ShaderReloader()
+    {
+        // Stop the watcher first so no rebuild races the cleanup below.
+        m_Watcher.reset();
+
+        VkDevice device = m_Renderer.GetDevice();
+
+        for (auto& batch : m_Pending) {
+            for (auto& rebuild : batch)
+                vkDestroyPipeline(device, rebuild.Replacement, nullptr);
+        }
+
+        for (auto& retired : m_Retired)
+            vkDestroyPipeline(device, retired.Pipeline, nullptr);
+    }
+
+    void ShaderReloader::Watch(VkPipeline& pipeline, VkPipelineLayout layout, std::vector<std::string> sources, const BuildFn& build)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_BuildMutex);
+        m_Entries.push_back({ &pipeline, layout, std::move(sources), build });
+    }
+
+    void ShaderReloader::Unwatch(VkPipeline& pipeline)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_BuildMutex);
+        std::erase_if(m_Entries, [&](const Entry& entry) { return entry.Pipeline == &pipeline; });
+
+        // A replacement that was never swapped in has not been used by the GPU.
+        std::lock_guard<std::mutex> pendingLock(m_PendingMutex);
+        for (auto& batch : m_Pending) {
+            std::erase_if(batch, [&](const Rebuild& rebuild) {
+                if (rebuild.Pipeline != &pipeline)
+                    return false;
+
+                vkDestroyPipeline(m_Renderer.GetDevice(), rebuild.Replacement, nullptr);
+                return true;
+            });
+        }
+    }
+
+    void ShaderReloader::Update()
+    {
+        std::vector<std::vector<Rebuild>> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(m_PendingMutex);
+            pending.swap(m_Pending);
+        }
+
+        QueueTimeline& timeline = m_Renderer.GetGraphicsTimeline();
+
+        // Called before the frame is recorded, the last submission is the last
+        // one that can use the replaced pipelines.
+        for (auto& batch : pending) {
+            for (auto& rebuild : batch) {
+                m_Retired.push_back({ *rebuild.Pipeline, timeline.GetSubmittedValue() });
+                *rebuild.Pipeline = rebuild.Replacement;
+            }
+
+            if (!batch.empty())
+                LOG_INFO("Swapped in {} rebuilt pipelines", batch.size());
+        }
+
+        std::erase_if(m_Retired, [&](const Retired& retired) {
+            if (!timeline.IsComplete(retired.Value))
+                return false;
+
+            vkDestroyPipeline(m_Renderer.GetDevice(), retired.Pipeline, nullptr);
+            return true;
+        });
+    }
+
+    std::unique_lock<std::recursive_mutex> ShaderReloader::Suspend()
+    {
+        return std::unique_lock<std::recursive_mutex>(m_BuildMutex);
+    }
+
+    void ShaderReloader::OnFilesChanged(const std::vector<std::string>& files)
+    {
+        auto changed = [&](const std::string& name) {
+            return std::find(files.begin(), files.end(), name) != files.end();
+        };
+
+        ShaderCompiler& compiler = m_Renderer.GetShaderCompiler();
+
+        // A changed include recompiles every stage that pulls it in.
+        std::vector<std::string> stages;
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(m_SourceDirectory, error)) {
+            if (!entry.is_regular_file(error) || !ShaderCompiler::IsShaderStage(entry.path()))
+                continue;
+
+            std::string name = entry.path().filename().string();
+            std::vector<std::string> includes = compiler.CollectIncludes(name);
+
+            if (changed(name) || std::any_of(includes.begin(), includes.end(), changed))
+                stages.push_back(name);
+        }
+
+        if (stages.empty())
+            return;
+
+        std::lock_guard<std::recursive_mutex> lock(m_BuildMutex);
+
+        std::vector<std::string> failed;
+        for (const auto& stage : stages) {
+            if (!Compile(stage))
+                failed.push_back(stage);
+        }
+
+        // Pipelines owned by the pipeline cache swap themselves in once recompiled.
+        m_Renderer.GetPipelineCache().Invalidate(stages, failed);
+
+        std::vector<Rebuild> batch;
+
+        for (const auto& entry : m_Entries) {
+            auto uses = [&](const std::vector<std::string>& names) {
+                return std::any_of(entry.Sources.begin(), entry.Sources.end(), [&](const std::string& source) {
+                    return std::find(names.begin(), names.end(), source) != names.end();
+                });
+            };
+
+            // Mixing a new stage with the stale binary of a failed one could
+            // break the interface between them, keep the old pipeline instead.
+            if (!uses(stages) || uses(failed))
+                continue;
+
+            if (!m_Renderer.GetPipelineLayoutCache().IsCompatible(entry.Layout, m_Renderer.ReflectShaders(entry.Sources))) {
+                LOG_ERROR("Resources of {} no longer match its pipeline layout, keeping the previous pipeline", entry.Sources.front());
+                continue;
+            }
+
+            VkPipeline pipeline = entry.Build();
+            if (pipeline == VK_NULL_HANDLE) {
+                LOG_ERROR("Failed to rebuild pipeline, keeping the previous one");
+                continue;
+            }
+
+            batch.push_back({ entry.Pipeline, pipeline });
+        }
+
+        LOG_INFO("Recompiled {} of {} shaders, rebuilt {} pipelines", stages.size() - failed.size(), stages.size(), batch.size());
+
+        if (batch.empty())
+            return;
+
+        std::lock_guard<std::mutex> pendingLock(m_PendingMutex);
+        m_Pending.push_back(std::move(batch));
+    }
+
+    bool ShaderReloader::Compile(const std::string& source)
+    {
+        // The compiler reports its own errors.
+        std::vector<u32> code = m_Renderer.GetShaderCompiler().Compile(source);
+        if (code.empty())
+            return false;
+
+        // The loaders read shaders/<name>.spv relative to the working directory.
+        return ShaderCompiler::WriteBinary(std::filesystem::path("shaders") / (source + ".spv"), code);
+    }
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <volk.h>
+
+#include "Types.hpp"
+#include "Core/FileWatcher.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    // Recompiles shaders when their sources change and rebuilds the pipelines
+    // that use them without stalling rendering.
+    //
+    // Subsystems register every pipeline together with the shader sources it is
+    // built from and a function that builds it again. Changed sources, and the
+    // sources that #include them, are compiled by the ShaderCompiler and the
+    // affected pipelines are rebuilt on the watcher thread. Update() swaps the
+    // results in at the next frame boundary, all pipelines of one change at
+    // once, and destroys the replaced pipelines once the graphics timeline has
+    // passed the last submission that may use them. A failed compile or build keeps the
+    // old pipeline. Pipelines of the PipelineCache are not registered here,
+    // the cache is told which shaders changed and recompiles them itself.
+    class ShaderReloader
+    {
+    public:
+        // Builds the pipeline from the current .spv files, returns VK_NULL_HANDLE on failure.
+        using BuildFn = std::function<VkPipeline()>;
+
+    public:
+        ShaderReloader(Renderer& renderer);
+        ~ShaderReloader();
+
+        ShaderReloader(const ShaderReloader&) = delete;
+        ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+        // sources are file names in the shader directory, e.g. "Mesh.vert". build
+        // runs on the watcher thread, state it reads may only change under Suspend().
+        // Layouts are shared and fixed, an edit whose resources no longer fit
+        // the pipeline's layout keeps the old pipeline.
+        void Watch(VkPipeline& pipeline, VkPipelineLayout layout, std::vector<std::string> sources, const BuildFn& build);
+        // Must be called before the pipeline is destroyed, drops a pending rebuild of it.
+        void Unwatch(VkPipeline& pipeline);
+
+        // Swaps in finished rebuilds. Call once per recorded frame, before it is recorded.
+        void Update();
+
+        // Holds back rebuilds while state used by the build functions changes,
+        // such as the sample count or the prepass mode.
+        [[nodiscard]] std::unique_lock<std::recursive_mutex> Suspend();
+
+    private:
+        struct Entry
+        {
+            VkPipeline* Pipeline;
+            VkPipelineLayout Layout;
+            std::vector<std::string> Sources;
+            BuildFn Build;
+        };
+
+        struct Rebuild
+        {
+            VkPipeline* Pipeline;
+            VkPipeline Replacement;
+        };
+
+        struct Retired
+        {
+            VkPipeline Pipeline;
+            // Graphics timeline value after which no submission uses it.
+            u64 Value;
+        };
+
+    private:
+        void OnFilesChanged(const std::vector<std::string>& files);
+
+        bool Compile(const std::string& source);
+
+    private:
+        Renderer& m_Renderer;
+
+        std::filesystem::path m_SourceDirectory;
+
+        // Held by the watcher thread for a whole rebuild. Recursive so that
+        // Unwatch() can be called while the main thread holds Suspend().
+        std::recursive_mutex m_BuildMutex;
+        std::vector<Entry> m_Entries;
+
+        // One batch per change, swapped in together.
+        std::mutex m_PendingMutex;
+        std::vector<std::vector<Rebuild>> m_Pending;
+
+        std::vector<Retired> m_Retired;
+
+        std::unique_ptr<FileWatcher> m_Watcher;
+    };
+
+}
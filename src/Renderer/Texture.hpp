@@ -0,0 +1,39 @@
+#pragma once
+
+#include <volk.h>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    class Renderer;
+
+    class Texture
+    {
+    public:
+        // pixels is tightly packed RGBA8 data, uploaded once through a staging buffer.
+        Texture(Renderer& renderer, u32 width, u32 height, const void* pixels, VkFilter filter = VK_FILTER_LINEAR);
+        ~Texture();
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
+        inline u32 Width() const { return m_Width; }
+        inline u32 Height() const { return m_Height; }
+
+        inline VkImageView GetImageView() const { return m_View; }
+        inline VkSampler GetSampler() const { return m_Sampler; }
+
+    private:
+        Renderer& m_Renderer;
+
+        u32 m_Width;
+        u32 m_Height;
+
+        VkImage m_Image { VK_NULL_HANDLE };
+        VkDeviceMemory m_Memory { VK_NULL_HANDLE };
+        VkImageView m_View { VK_NULL_HANDLE };
+        VkSampler m_Sampler { VK_NULL_HANDLE };
+    };
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <volk.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    template<typename T>
+    struct VertexFormat
+    {
+        static_assert(sizeof(T) == 0, "No VkFormat mapping for this vertex attribute type");
+    };
+
+#define VERTEX_FORMAT(type, format) template<> struct VertexFormat<type> { static constexpr VkFormat Value = format; };
+
+    VERTEX_FORMAT(f32,          VK_FORMAT_R32_SFLOAT)
+    VERTEX_FORMAT(glm::vec2,    VK_FORMAT_R32G32_SFLOAT)
+    VERTEX_FORMAT(glm::vec3,    VK_FORMAT_R32G32B32_SFLOAT)
+    VERTEX_FORMAT(glm::vec4,    VK_FORMAT_R32G32B32A32_SFLOAT)
+    VERTEX_FORMAT(i32,          VK_FORMAT_R32_SINT)
+    VERTEX_FORMAT(glm::ivec2,   VK_FORMAT_R32G32_SINT)
+    VERTEX_FORMAT(glm::ivec3,   VK_FORMAT_R32G32B32_SINT)
+    VERTEX_FORMAT(glm::ivec4,   VK_FORMAT_R32G32B32A32_SINT)
+    VERTEX_FORMAT(u32,          VK_FORMAT_R32_UINT)
+    VERTEX_FORMAT(glm::uvec2,   VK_FORMAT_R32G32_UINT)
+    VERTEX_FORMAT(glm::uvec3,   VK_FORMAT_R32G32B32_UINT)
+    VERTEX_FORMAT(glm::uvec4,   VK_FORMAT_R32G32B32A32_UINT)
+    VERTEX_FORMAT(glm::u8vec4,  VK_FORMAT_R8G8B8A8_UNORM)
+
+#undef VERTEX_FORMAT
+
+    struct VertexAttribute
+    {
+        VkFormat Format;
+        u32 Offset;
+        u32 Size;
+
+        template<typename T>
+        static constexpr VertexAttribute Of(usize offset)
+        {
+            return { VertexFormat<T>::Value, static_cast<u32>(offset), static_cast<u32>(sizeof(T)) };
+        }
+    };
+
+    // Describes one vertex buffer binding. Built entirely at compile time from
+    // the attribute list so the struct, the binding and the attributes cannot drift.
+    template<usize N>
+    struct VertexLayout
+    {
+        u32 Stride;
+        VkVertexInputRate InputRate;
+        std::array<VertexAttribute, N> Attributes;
+
+        static constexpr usize AttributeCount = N;
+
+        constexpr VkVertexInputBindingDescription BindingDescription(u32 binding = 0) const
+        {
+            return { binding, Stride, InputRate };
+        }
+
+        constexpr std::array<VkVertexInputAttributeDescription, N> AttributeDescriptions(u32 binding = 0, u32 firstLocation = 0) const
+        {
+            std::array<VkVertexInputAttributeDescription, N> descriptions {};
+            for (usize i = 0; i < N; ++i) {
+                descriptions[i].location = firstLocation + static_cast<u32>(i);
+                descriptions[i].binding = binding;
+                descriptions[i].format = Attributes[i].Format;
+                descriptions[i].offset = Attributes[i].Offset;
+            }
+
+            return descriptions;
+        }
+
+        constexpr bool IsValid() const
+        {
+            for (usize i = 0; i < N; ++i) {
+                if (Attributes[i].Offset + Attributes[i].Size > Stride)
+                    return false;
+
+                for (usize j = i + 1; j < N; ++j) {
+                    bool disjoint = Attributes[i].Offset + Attributes[i].Size <= Attributes[j].Offset
+                        || Attributes[j].Offset + Attributes[j].Size <= Attributes[i].Offset;
+                    if (!disjoint)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    template<typename Vertex, typename... Attributes>
+    constexpr VertexLayout<sizeof...(Attributes)> MakeVertexLayout(VkVertexInputRate inputRate, Attributes... attributes)
+    {
+        return { static_cast<u32>(sizeof(Vertex)), inputRate, { attributes... } };
+    }
+
+    // Vertex input state for several bindings. Locations are assigned in
+    // declaration order across all layouts, binding i uses layouts[i].
+    template<usize BindingCount, usize AttributeCount>
+    struct VertexInputDescription
+    {
+        std::array<VkVertexInputBindingDescription, BindingCount> Bindings;
+        std::array<VkVertexInputAttributeDescription, AttributeCount> Attributes;
+    };
+
+    template<usize... Ns>
+    constexpr VertexInputDescription<sizeof...(Ns), (Ns + ... + 0)> MakeVertexInput(const VertexLayout<Ns>&... layouts)
+    {
+        VertexInputDescription<sizeof...(Ns), (Ns + ... + 0)> input {};
+
+        u32 binding = 0;
+        u32 location = 0;
+
+        auto append = [&](const auto& layout) {
+            input.Bindings[binding] = layout.BindingDescription(binding);
+
+            auto attributes = layout.AttributeDescriptions(binding, location);
+            for (usize i = 0; i < attributes.size(); ++i)
+                input.Attributes[location + i] = attributes[i];
+
+            location += static_cast<u32>(attributes.size());
+            binding++;
+        };
+
+        (append(layouts), ...);
+
+        return input;
+    }
+
+}
+
+#define VERTEX_ATTRIBUTE(type, member) ::Graphics::VertexAttribute::Of<decltype(type::member)>(offsetof(type, member))
@@ -0,0 +1,106 @@
+#include "Archetype.hpp"
+
+#include <new>
+#include <algorithm>
+
+namespace Graphics {
+
+    static usize AlignUp(usize value, usize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    Archetype::Archetype(const ComponentMask& mask)
+        : m_Mask(mask)
+    {
+        usize rowSize = sizeof(Entity);
+        for (ComponentID id = 0; id < ComponentRegistry::s_MaxComponents; ++id) {
+            if (!mask.test(id))
+                continue;
+
+            m_Components.push_back(id);
+            rowSize += ComponentRegistry::GetInfo(id).Size;
+        }
+
+        // Lays out the columns for a given capacity and returns the bytes needed.
+        auto layout = [&](u32 capacity) {
+            usize offset = sizeof(Entity) * capacity;
+            for (ComponentID id : m_Components) {
+                const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+                offset = AlignUp(offset, std::max(info.Alignment, s_ChunkAlignment));
+                m_ColumnOffsets[id] = offset;
+                offset += info.Size * capacity;
+            }
+            return offset;
+        };
+
+        // Start from the unpadded estimate and shrink until the padding fits.
+        m_ChunkCapacity = std::max<u32>(1, static_cast<u32>(s_ChunkSize / rowSize));
+        while (m_ChunkCapacity > 1 && layout(m_ChunkCapacity) > s_ChunkSize)
+            --m_ChunkCapacity;
+
+        m_ChunkBytes = AlignUp(std::max(s_ChunkSize, layout(m_ChunkCapacity)), s_ChunkAlignment);
+    }
+
+    Archetype::~Archetype()
+    {
+        for (ArchetypeChunk& chunk : m_Chunks) {
+            for (ComponentID id : m_Components) {
+                const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+                u8* column = static_cast<u8*>(GetColumn(chunk, id));
+                for (u32 row = 0; row < chunk.Count; ++row)
+                    info.Destroy(column + row * info.Size);
+            }
+
+            ::operator delete(chunk.Data, std::align_val_t(s_ChunkAlignment));
+        }
+    }
+
+    std::pair<u32, u32> Archetype::AllocateRow(Entity entity)
+    {
+        if (m_Chunks.empty() || m_Chunks.back().Count == m_ChunkCapacity) {
+            ArchetypeChunk chunk;
+            chunk.Data = static_cast<u8*>(::operator new(m_ChunkBytes, std::align_val_t(s_ChunkAlignment)));
+            m_Chunks.push_back(chunk);
+        }
+
+        u32 chunkIndex = static_cast<u32>(m_Chunks.size() - 1);
+        ArchetypeChunk& chunk = m_Chunks.back();
+        u32 row = chunk.Count++;
+
+        GetEntities(chunk)[row] = entity;
+
+        return { chunkIndex, row };
+    }
+
+    Entity Archetype::RemoveRow(u32 chunkIndex, u32 row)
+    {
+        ArchetypeChunk& last = m_Chunks.back();
+        u32 lastChunkIndex = static_cast<u32>(m_Chunks.size() - 1);
+        u32 lastRow = last.Count - 1;
+
+        Entity moved = Entity::Null();
+
+        if (chunkIndex != lastChunkIndex || row != lastRow) {
+            ArchetypeChunk& chunk = m_Chunks[chunkIndex];
+
+            for (ComponentID id : m_Components) {
+                const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+                void* src = GetComponent(last, id, lastRow);
+                info.MoveConstruct(GetComponent(chunk, id, row), src);
+                info.Destroy(src);
+            }
+
+            moved = GetEntities(last)[lastRow];
+            GetEntities(chunk)[row] = moved;
+        }
+
+        if (--last.Count == 0) {
+            ::operator delete(last.Data, std::align_val_t(s_ChunkAlignment));
+            m_Chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "Types.hpp"
+#include "Entity.hpp"
+#include "Component.hpp"
+
+namespace Graphics {
+
+    // Fixed-size block of an archetype's rows stored as structure-of-arrays:
+    // the entity column followed by one tightly packed column per component.
+    struct ArchetypeChunk
+    {
+        u8* Data { nullptr };
+        u32 Count { 0 };
+    };
+
+    // Storage for every entity that has exactly the component set m_Mask.
+    class Archetype
+    {
+    public:
+        Archetype(const ComponentMask& mask);
+        ~Archetype();
+
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+
+        inline const ComponentMask& GetMask() const { return m_Mask; }
+        inline bool Has(ComponentID id) const { return m_Mask.test(id); }
+
+        inline u32 GetChunkCapacity() const { return m_ChunkCapacity; }
+        inline usize GetChunkCount() const { return m_Chunks.size(); }
+        inline ArchetypeChunk& GetChunk(usize index) { return m_Chunks[index]; }
+
+        inline Entity* GetEntities(const ArchetypeChunk& chunk) const { return reinterpret_cast<Entity*>(chunk.Data); }
+        inline void* GetColumn(const ArchetypeChunk& chunk, ComponentID id) const { return chunk.Data + m_ColumnOffsets[id]; }
+        inline void* GetComponent(const ArchetypeChunk& chunk, ComponentID id, u32 row) const { return chunk.Data + m_ColumnOffsets[id] + static_cast<usize>(row) * ComponentRegistry::GetInfo(id).Size; }
+
+        template<typename T>
+        inline T* GetColumn(const ArchetypeChunk& chunk) const { return static_cast<T*>(GetColumn(chunk, ComponentRegistry::GetID<T>())); }
+
+    public:
+        inline static constexpr usize s_ChunkSize { 16 * 1024 };
+        inline static constexpr usize s_ChunkAlignment { 64 };
+
+    private:
+        friend class World;
+
+        // Appends a row for entity and returns its chunk and row, component
+        // columns are left uninitialized for the caller to construct.
+        std::pair<u32, u32> AllocateRow(Entity entity);
+
+        // Fills the hole at (chunk, row) with the last row. Components at the
+        // hole must already be destroyed or moved out. Returns the entity
+        // that now lives at (chunk, row), or Null if the hole was the last row.
+        Entity RemoveRow(u32 chunk, u32 row);
+
+    private:
+        ComponentMask m_Mask;
+        std::vector<ComponentID> m_Components;
+        std::array<usize, ComponentRegistry::s_MaxComponents> m_ColumnOffsets {};
+
+        usize m_ChunkBytes { s_ChunkSize };
+        u32 m_ChunkCapacity { 0 };
+        std::vector<ArchetypeChunk> m_Chunks;
+
+        // Cached transitions when a single component is added or removed.
+        std::array<Archetype*, ComponentRegistry::s_MaxComponents> m_AddEdges {};
+        std::array<Archetype*, ComponentRegistry::s_MaxComponents> m_RemoveEdges {};
+    };
+
+}
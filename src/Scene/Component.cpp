@@ -0,0 +1,38 @@
+#include "Component.hpp"
+
+#include <cstdlib>
+
+#include "Core/Log.hpp"
+
+namespace Graphics {
+
+    static std::array<ComponentInfo, ComponentRegistry::s_MaxComponents> s_ComponentInfos;
+    static std::atomic<u32> s_ComponentCount { 0 };
+
+    const ComponentInfo& ComponentRegistry::GetInfo(ComponentID id)
+    {
+        return s_ComponentInfos[id];
+    }
+
+    u32 ComponentRegistry::GetCount()
+    {
+        return s_ComponentCount.load(std::memory_order_acquire);
+    }
+
+    ComponentID ComponentRegistry::Register(const ComponentInfo& info)
+    {
+        // Function-local statics in ID<T>() serialize registration per type,
+        // the counter keeps IDs unique across types registered concurrently.
+        ComponentID id = s_ComponentCount.fetch_add(1, std::memory_order_acq_rel);
+
+        if (id >= s_MaxComponents) {
+            LOG_CRITICAL("Too many component types, the limit is {}", s_MaxComponents);
+            std::abort();
+        }
+
+        s_ComponentInfos[id] = info;
+
+        return id;
+    }
+
+}
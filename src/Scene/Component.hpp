@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    using ComponentID = u32;
+    using ComponentMask = std::bitset<64>;
+
+    struct ComponentInfo
+    {
+        usize Size;
+        usize Alignment;
+        void (*MoveConstruct)(void* dst, void* src);
+        void (*Destroy)(void* ptr);
+    };
+
+    // Assigns each component type a dense ID on first use. IDs are process-wide
+    // and limited to the width of ComponentMask.
+    class ComponentRegistry
+    {
+    public:
+        template<typename T>
+        static ComponentID GetID()
+        {
+            return ID<std::remove_cvref_t<T>>();
+        }
+
+        template<typename... Ts>
+        static ComponentMask MaskOf()
+        {
+            ComponentMask mask;
+            (mask.set(GetID<Ts>()), ...);
+            return mask;
+        }
+
+        static const ComponentInfo& GetInfo(ComponentID id);
+        static u32 GetCount();
+
+    public:
+        inline static constexpr u32 s_MaxComponents { 64 };
+
+    private:
+        template<typename T>
+        static ComponentID ID()
+        {
+            static_assert(std::is_nothrow_move_constructible_v<T>, "Components are relocated between chunks and must be nothrow movable");
+
+            static const ComponentID id = Register({
+                sizeof(T),
+                alignof(T),
+                [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+                [](void* ptr) { static_cast<T*>(ptr)->~T(); }
+            });
+
+            return id;
+        }
+
+        static ComponentID Register(const ComponentInfo& info);
+    };
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    struct TransformComponent
+    {
+        glm::vec3 Position { 0.0f };
+        glm::vec2 Scale { 1.0f };
+        f32 Rotation { 0.0f };
+    };
+
+    struct VelocityComponent
+    {
+        glm::vec3 Linear { 0.0f };
+        f32 Angular { 0.0f };
+    };
+
+    struct SpriteComponent
+    {
+        glm::vec4 Color { 1.0f };
+    };
+
+    // Leaf of the entity in the scene's spatial index.
+    struct SpatialProxyComponent
+    {
+        u32 Proxy { ~0u };
+    };
+
+}
@@ -0,0 +1,513 @@
+#include "DynamicBVH.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "Core/JobSystem.hpp"
+
+namespace Graphics {
+
+    DynamicBVH::DynamicBVH(f32 margin)
+        : m_Margin(margin)
+    {
+    }
+
+    u32 DynamicBVH::CreateProxy(const AABB& box, u64 userData)
+    {
+        u32 proxy = AllocateNode();
+
+        Node& node = m_Nodes[proxy];
+        node.Box = { box.Min - glm::vec3(m_Margin), box.Max + glm::vec3(m_Margin) };
+        node.UserData = userData;
+        node.Height = 0;
+
+        InsertLeaf(proxy);
+        ++m_ProxyCount;
+
+        return proxy;
+    }
+
+    void DynamicBVH::DestroyProxy(u32 proxy)
+    {
+        assert(proxy < m_Nodes.size() && m_Nodes[proxy].IsLeaf() && m_Nodes[proxy].Height == 0);
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --m_ProxyCount;
+    }
+
+    bool DynamicBVH::MoveProxy(u32 proxy, const AABB& box)
+    {
+        assert(proxy < m_Nodes.size() && m_Nodes[proxy].IsLeaf() && m_Nodes[proxy].Height == 0);
+
+        if (m_Nodes[proxy].Box.Contains(box))
+            return false;
+
+        RemoveLeaf(proxy);
+        m_Nodes[proxy].Box = { box.Min - glm::vec3(m_Margin), box.Max + glm::vec3(m_Margin) };
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    u32 DynamicBVH::AllocateNode()
+    {
+        if (m_FreeList == s_NullNode) {
+            u32 oldCapacity = static_cast<u32>(m_Nodes.size());
+            u32 newCapacity = std::max(16u, oldCapacity * 2);
+            m_Nodes.resize(newCapacity);
+
+            for (u32 i = oldCapacity; i < newCapacity - 1; ++i)
+                m_Nodes[i].Parent = i + 1;
+            m_Nodes[newCapacity - 1].Parent = s_NullNode;
+
+            m_FreeList = oldCapacity;
+        }
+
+        u32 index = m_FreeList;
+        Node& node = m_Nodes[index];
+        m_FreeList = node.Parent;
+
+        node.Parent = s_NullNode;
+        node.Child1 = s_NullNode;
+        node.Child2 = s_NullNode;
+        node.Height = 0;
+        node.UserData = 0;
+
+        return index;
+    }
+
+    void DynamicBVH::FreeNode(u32 index)
+    {
+        Node& node = m_Nodes[index];
+        node.Parent = m_FreeList;
+        node.Height = -1;
+        m_FreeList = index;
+    }
+
+    void DynamicBVH::InsertLeaf(u32 leaf)
+    {
+        if (m_Root == s_NullNode) {
+            m_Root = leaf;
+            m_Nodes[leaf].Parent = s_NullNode;
+            return;
+        }
+
+        // Descend towards the sibling that minimizes the added surface area.
+        AABB leafBox = m_Nodes[leaf].Box;
+        u32 index = m_Root;
+
+        while (!m_Nodes[index].IsLeaf()) {
+            const Node& node = m_Nodes[index];
+
+            f32 area = node.Box.SurfaceArea();
+            f32 combinedArea = AABB::Union(node.Box, leafBox).SurfaceArea();
+
+            // Cost of making a new parent for this node and the leaf.
+            f32 cost = 2.0f * combinedArea;
+
+            // Minimum cost of pushing the leaf further down the tree.
+            f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](u32 child) {
+                const Node& childNode = m_Nodes[child];
+                f32 childCost = AABB::Union(childNode.Box, leafBox).SurfaceArea();
+                if (!childNode.IsLeaf())
+                    childCost -= childNode.Box.SurfaceArea();
+                return childCost + inheritanceCost;
+            };
+
+            f32 cost1 = descendCost(node.Child1);
+            f32 cost2 = descendCost(node.Child2);
+
+            if (cost < cost1 && cost < cost2)
+                break;
+
+            index = cost1 < cost2 ? node.Child1 : node.Child2;
+        }
+
+        u32 sibling = index;
+        u32 oldParent = m_Nodes[sibling].Parent;
+
+        u32 newParent = AllocateNode();
+        m_Nodes[newParent].Parent = oldParent;
+        m_Nodes[newParent].Box = AABB::Union(leafBox, m_Nodes[sibling].Box);
+        m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+        m_Nodes[newParent].Child1 = sibling;
+        m_Nodes[newParent].Child2 = leaf;
+
+        if (oldParent != s_NullNode) {
+            if (m_Nodes[oldParent].Child1 == sibling)
+                m_Nodes[oldParent].Child1 = newParent;
+            else
+                m_Nodes[oldParent].Child2 = newParent;
+        } else {
+            m_Root = newParent;
+        }
+
+        m_Nodes[sibling].Parent = newParent;
+        m_Nodes[leaf].Parent = newParent;
+
+        Refit(m_Nodes[leaf].Parent);
+    }
+
+    void DynamicBVH::RemoveLeaf(u32 leaf)
+    {
+        if (leaf == m_Root) {
+            m_Root = s_NullNode;
+            return;
+        }
+
+        u32 parent = m_Nodes[leaf].Parent;
+        u32 grandParent = m_Nodes[parent].Parent;
+        u32 sibling = m_Nodes[parent].Child1 == leaf ? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+        if (grandParent != s_NullNode) {
+            if (m_Nodes[grandParent].Child1 == parent)
+                m_Nodes[grandParent].Child1 = sibling;
+            else
+                m_Nodes[grandParent].Child2 = sibling;
+
+            m_Nodes[sibling].Parent = grandParent;
+            FreeNode(parent);
+
+            Refit(grandParent);
+        } else {
+            m_Root = sibling;
+            m_Nodes[sibling].Parent = s_NullNode;
+            FreeNode(parent);
+        }
+    }
+
+    void DynamicBVH::Refit(u32 index)
+    {
+        while (index != s_NullNode) {
+            index = Balance(index);
+
+            Node& node = m_Nodes[index];
+            const Node& child1 = m_Nodes[node.Child1];
+            const Node& child2 = m_Nodes[node.Child2];
+
+            node.Height = 1 + std::max(child1.Height, child2.Height);
+            node.Box = AABB::Union(child1.Box, child2.Box);
+
+            index = node.Parent;
+        }
+    }
+
+    u32 DynamicBVH::Balance(u32 iA)
+    {
+        Node& A = m_Nodes[iA];
+        if (A.IsLeaf() || A.Height < 2)
+            return iA;
+
+        u32 iB = A.Child1;
+        u32 iC = A.Child2;
+        Node& B = m_Nodes[iB];
+        Node& C = m_Nodes[iC];
+
+        i32 balance = C.Height - B.Height;
+
+        auto replaceChild = [&](u32 parent, u32 oldChild, u32 newChild) {
+            if (parent == s_NullNode) {
+                m_Root = newChild;
+            } else if (m_Nodes[parent].Child1 == oldChild) {
+                m_Nodes[parent].Child1 = newChild;
+            } else {
+                m_Nodes[parent].Child2 = newChild;
+            }
+        };
+
+        // Rotate C up.
+        if (balance > 1) {
+            u32 iF = C.Child1;
+            u32 iG = C.Child2;
+            Node& F = m_Nodes[iF];
+            Node& G = m_Nodes[iG];
+
+            C.Child1 = iA;
+            C.Parent = A.Parent;
+            A.Parent = iC;
+            replaceChild(C.Parent, iA, iC);
+
+            if (F.Height > G.Height) {
+                C.Child2 = iF;
+                A.Child2 = iG;
+                G.Parent = iA;
+                A.Box = AABB::Union(B.Box, G.Box);
+                C.Box = AABB::Union(A.Box, F.Box);
+                A.Height = 1 + std::max(B.Height, G.Height);
+                C.Height = 1 + std::max(A.Height, F.Height);
+            } else {
+                C.Child2 = iG;
+                A.Child2 = iF;
+                F.Parent = iA;
+                A.Box = AABB::Union(B.Box, F.Box);
+                C.Box = AABB::Union(A.Box, G.Box);
+                A.Height = 1 + std::max(B.Height, F.Height);
+                C.Height = 1 + std::max(A.Height, G.Height);
+            }
+
+            return iC;
+        }
+
+        // Rotate B up.
+        if (balance < -1) {
+            u32 iD = B.Child1;
+            u32 iE = B.Child2;
+            Node& D = m_Nodes[iD];
+            Node& E = m_Nodes[iE];
+
+            B.Child1 = iA;
+            B.Parent = A.Parent;
+            A.Parent = iB;
+            replaceChild(B.Parent, iA, iB);
+
+            if (D.Height > E.Height) {
+                B.Child2 = iD;
+                A.Child1 = iE;
+                E.Parent = iA;
+                A.Box = AABB::Union(C.Box, E.Box);
+                B.Box = AABB::Union(A.Box, D.Box);
+                A.Height = 1 + std::max(C.Height, E.Height);
+                B.Height = 1 + std::max(A.Height, D.Height);
+            } else {
+                B.Child2 = iE;
+                A.Child1 = iD;
+                D.Parent = iA;
+                A.Box = AABB::Union(C.Box, D.Box);
+                B.Box = AABB::Union(A.Box, E.Box);
+                A.Height = 1 + std::max(C.Height, D.Height);
+                B.Height = 1 + std::max(A.Height, E.Height);
+            }
+
+            return iB;
+        }
+
+        return iA;
+    }
+
+    void DynamicBVH::Rebuild(JobSystem* jobs)
+    {
+        std::vector<BuildLeaf> leaves;
+        leaves.reserve(m_ProxyCount);
+
+        for (u32 i = 0; i < m_Nodes.size(); ++i) {
+            if (m_Nodes[i].Height == 0)
+                leaves.push_back({ m_Nodes[i].Box, m_Nodes[i].Box.Center(), i });
+            else if (m_Nodes[i].Height > 0)
+                FreeNode(i);
+        }
+
+        if (leaves.empty()) {
+            m_Root = s_NullNode;
+            return;
+        }
+
+        // A subtree over n leaves uses exactly n - 1 internal nodes, so every
+        // subtree gets a fixed slice of this array and parallel builds never
+        // allocate.
+        std::vector<u32> internal(leaves.size() - 1);
+        for (u32& node : internal)
+            node = AllocateNode();
+
+        m_Root = BuildSAH(leaves.data(), static_cast<u32>(leaves.size()), internal.data(), jobs);
+        m_Nodes[m_Root].Parent = s_NullNode;
+    }
+
+    u32 DynamicBVH::BuildSAH(BuildLeaf* leaves, u32 count, const u32* internal, JobSystem* jobs)
+    {
+        if (count == 1)
+            return leaves[0].Node;
+
+        constexpr u32 binCount = 16;
+
+        AABB centroidBounds = { leaves[0].Centroid, leaves[0].Centroid };
+        for (u32 i = 1; i < count; ++i) {
+            centroidBounds.Min = glm::min(centroidBounds.Min, leaves[i].Centroid);
+            centroidBounds.Max = glm::max(centroidBounds.Max, leaves[i].Centroid);
+        }
+
+        glm::vec3 extent = centroidBounds.Max - centroidBounds.Min;
+
+        // Binning costs more than it gains on a handful of leaves, split those at the median of the widest axis.
+        if (count <= s_MedianSplitThreshold) {
+            u32 axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            u32 mid = count / 2;
+            std::nth_element(leaves, leaves + mid, leaves + count, [axis](const BuildLeaf& a, const BuildLeaf& b) {
+                return a.Centroid[axis] < b.Centroid[axis];
+            });
+
+            return LinkChildren(internal[0], BuildSAH(leaves, mid, internal + 1, nullptr), BuildSAH(leaves + mid, count - mid, internal + mid, nullptr));
+        }
+
+        glm::vec3 scale;
+        for (u32 axis = 0; axis < 3; ++axis)
+            scale[axis] = extent[axis] > 1e-6f ? binCount / extent[axis] : 0.0f;
+
+        auto binOf = [&](const glm::vec3& centroid, u32 axis) {
+            return std::min(binCount - 1, static_cast<u32>((centroid[axis] - centroidBounds.Min[axis]) * scale[axis]));
+        };
+
+        // Bin all three axes in a single pass over the leaves.
+        std::array<std::array<AABB, binCount>, 3> binBoxes;
+        std::array<std::array<u32, binCount>, 3> binCounts {};
+
+        for (u32 i = 0; i < count; ++i) {
+            for (u32 axis = 0; axis < 3; ++axis) {
+                u32 bin = binOf(leaves[i].Centroid, axis);
+                binBoxes[axis][bin] = binCounts[axis][bin] == 0 ? leaves[i].Box : AABB::Union(binBoxes[axis][bin], leaves[i].Box);
+                ++binCounts[axis][bin];
+            }
+        }
+
+        u32 bestAxis = 0;
+        u32 bestSplit = 0;
+        f32 bestCost = std::numeric_limits<f32>::max();
+
+        for (u32 axis = 0; axis < 3; ++axis) {
+            if (scale[axis] == 0.0f)
+                continue;
+
+            const auto& boxes = binBoxes[axis];
+            const auto& counts = binCounts[axis];
+
+            // Sweep from the right to get the area of every suffix.
+            std::array<f32, binCount> rightArea {};
+            std::array<u32, binCount> rightCount {};
+            AABB accumulated;
+            u32 accumulatedCount = 0;
+            for (u32 bin = binCount - 1; bin > 0; --bin) {
+                if (counts[bin] > 0) {
+                    accumulated = accumulatedCount == 0 ? boxes[bin] : AABB::Union(accumulated, boxes[bin]);
+                    accumulatedCount += counts[bin];
+                }
+                rightArea[bin] = accumulatedCount > 0 ? accumulated.SurfaceArea() : 0.0f;
+                rightCount[bin] = accumulatedCount;
+            }
+
+            accumulatedCount = 0;
+            for (u32 split = 1; split < binCount; ++split) {
+                u32 bin = split - 1;
+                if (counts[bin] > 0) {
+                    accumulated = accumulatedCount == 0 ? boxes[bin] : AABB::Union(accumulated, boxes[bin]);
+                    accumulatedCount += counts[bin];
+                }
+
+                if (accumulatedCount == 0 || rightCount[split] == 0)
+                    continue;
+
+                f32 cost = accumulated.SurfaceArea() * accumulatedCount + rightArea[split] * rightCount[split];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        u32 mid;
+        if (bestSplit != 0) {
+            BuildLeaf* pivot = std::partition(leaves, leaves + count, [&](const BuildLeaf& leaf) {
+                return binOf(leaf.Centroid, bestAxis) < bestSplit;
+            });
+            mid = static_cast<u32>(pivot - leaves);
+        } else {
+            // All centroids coincide, any split is as good as another.
+            mid = count / 2;
+        }
+
+        u32 node = internal[0];
+        u32 child1 = s_NullNode;
+        u32 child2 = s_NullNode;
+
+        // Left subtree takes internal[1, mid), right subtree internal[mid, count - 1).
+        if (jobs != nullptr && count >= s_ParallelRebuildThreshold) {
+            JobContext context;
+            jobs->Execute(context, [&]() { child1 = BuildSAH(leaves, mid, internal + 1, jobs); });
+            child2 = BuildSAH(leaves + mid, count - mid, internal + mid, jobs);
+            jobs->Wait(context);
+        } else {
+            child1 = BuildSAH(leaves, mid, internal + 1, nullptr);
+            child2 = BuildSAH(leaves + mid, count - mid, internal + mid, nullptr);
+        }
+
+        return LinkChildren(node, child1, child2);
+    }
+
+    u32 DynamicBVH::LinkChildren(u32 node, u32 child1, u32 child2)
+    {
+        Node& parent = m_Nodes[node];
+        parent.Child1 = child1;
+        parent.Child2 = child2;
+        parent.Box = AABB::Union(m_Nodes[child1].Box, m_Nodes[child2].Box);
+        parent.Height = 1 + std::max(m_Nodes[child1].Height, m_Nodes[child2].Height);
+
+        m_Nodes[child1].Parent = node;
+        m_Nodes[child2].Parent = node;
+
+        return node;
+    }
+
+    u32 DynamicBVH::GetHeight() const
+    {
+        return m_Root == s_NullNode ? 0 : static_cast<u32>(m_Nodes[m_Root].Height);
+    }
+
+    f32 DynamicBVH::GetAreaRatio() const
+    {
+        if (m_Root == s_NullNode)
+            return 0.0f;
+
+        f32 rootArea = m_Nodes[m_Root].Box.SurfaceArea();
+
+        f32 totalArea = 0.0f;
+        for (const Node& node : m_Nodes) {
+            if (node.Height > 0)
+                totalArea += node.Box.SurfaceArea();
+        }
+
+        return rootArea > 0.0f ? totalArea / rootArea : 0.0f;
+    }
+
+    void DynamicBVH::Validate() const
+    {
+        if (m_Root == s_NullNode)
+            return;
+
+        assert(m_Nodes[m_Root].Parent == s_NullNode);
+        ValidateNode(m_Root);
+    }
+
+    u32 DynamicBVH::ComputeHeight(u32 index) const
+    {
+        const Node& node = m_Nodes[index];
+        if (node.IsLeaf())
+            return 0;
+
+        return 1 + std::max(ComputeHeight(node.Child1), ComputeHeight(node.Child2));
+    }
+
+    void DynamicBVH::ValidateNode(u32 index) const
+    {
+        const Node& node = m_Nodes[index];
+        if (node.IsLeaf()) {
+            assert(node.Height == 0);
+            return;
+        }
+
+        const Node& child1 = m_Nodes[node.Child1];
+        const Node& child2 = m_Nodes[node.Child2];
+
+        assert(child1.Parent == index && child2.Parent == index);
+        assert(node.Height == static_cast<i32>(ComputeHeight(index)));
+        assert(node.Box.Contains(child1.Box) && node.Box.Contains(child2.Box));
+        (void)child1;
+        (void)child2;
+
+        ValidateNode(node.Child1);
+        ValidateNode(node.Child2);
+    }
+
+}
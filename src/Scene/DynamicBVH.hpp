@@ -0,0 +1,290 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Frustum.hpp"
+
+namespace Graphics {
+
+    class JobSystem;
+
+    // Incrementally updated AABB tree. Leaves store a box enlarged by a margin
+    // so small movements do not touch the tree; when a proxy leaves its fat box
+    // it is reinserted at the cheapest surface-area position and the path to
+    // the root is rebalanced with height-based rotations. Rebuild() replaces
+    // the internal nodes with a binned SAH build, optionally across the job
+    // system, while keeping proxy IDs stable.
+    class DynamicBVH
+    {
+    public:
+        DynamicBVH(f32 margin = 0.1f);
+
+        u32 CreateProxy(const AABB& box, u64 userData);
+        void DestroyProxy(u32 proxy);
+
+        // Returns true if the proxy had to be reinserted.
+        bool MoveProxy(u32 proxy, const AABB& box);
+
+        inline u64 GetUserData(u32 proxy) const { return m_Nodes[proxy].UserData; }
+        inline const AABB& GetFatAABB(u32 proxy) const { return m_Nodes[proxy].Box; }
+
+        void Rebuild(JobSystem* jobs = nullptr);
+
+        // Visitors receive the proxy ID and return false to stop the query.
+        template<typename Fn>
+        void Query(const AABB& box, Fn&& fn) const;
+
+        template<typename Fn>
+        void Query(const BoundingSphere& sphere, Fn&& fn) const;
+
+        // Subtrees fully inside the frustum are reported without further tests.
+        template<typename Fn>
+        void Query(const Frustum& frustum, Fn&& fn) const;
+
+        // fn(proxy, ray, maxDistance) returns the new max distance: a hit
+        // distance clips the ray, maxDistance continues, 0 stops the cast.
+        template<typename Fn>
+        void RayCast(const Ray& ray, f32 maxDistance, Fn&& fn) const;
+
+        inline u32 GetProxyCount() const { return m_ProxyCount; }
+        u32 GetHeight() const;
+
+        // Sum of internal node areas over the root area, lower is better.
+        f32 GetAreaRatio() const;
+
+        // Checks parent links, heights and bounds. Debug only.
+        void Validate() const;
+
+    public:
+        inline static constexpr u32 s_NullNode { ~0u };
+        inline static constexpr u32 s_ParallelRebuildThreshold { 4096 };
+        inline static constexpr u32 s_MedianSplitThreshold { 16 };
+
+    private:
+        // One node per cache line.
+        struct alignas(64) Node
+        {
+            AABB Box;
+            u64 UserData { 0 };
+
+            // Next free node while on the free list.
+            u32 Parent { s_NullNode };
+            u32 Child1 { s_NullNode };
+            u32 Child2 { s_NullNode };
+
+            // 0 for leaves, -1 for free nodes.
+            i32 Height { -1 };
+
+            inline bool IsLeaf() const { return Child1 == s_NullNode; }
+        };
+
+        // Compact copy of a leaf used while rebuilding.
+        struct BuildLeaf
+        {
+            AABB Box;
+            glm::vec3 Centroid;
+            u32 Node;
+        };
+
+        // Traversal stack that only touches the heap for very deep trees.
+        class NodeStack
+        {
+        public:
+            inline void Push(u32 node)
+            {
+                if (m_Count < m_Inline.size())
+                    m_Inline[m_Count] = node;
+                else
+                    m_Overflow.push_back(node);
+                ++m_Count;
+            }
+
+            inline u32 Pop()
+            {
+                --m_Count;
+                if (m_Count < m_Inline.size())
+                    return m_Inline[m_Count];
+
+                u32 node = m_Overflow.back();
+                m_Overflow.pop_back();
+                return node;
+            }
+
+            inline bool Empty() const { return m_Count == 0; }
+
+        private:
+            std::array<u32, 64> m_Inline;
+            std::vector<u32> m_Overflow;
+            usize m_Count { 0 };
+        };
+
+    private:
+        u32 AllocateNode();
+        void FreeNode(u32 node);
+
+        void InsertLeaf(u32 leaf);
+        void RemoveLeaf(u32 leaf);
+
+        // Rotates the subtree at node if its children heights differ by more than one, returns the new subtree root.
+        u32 Balance(u32 node);
+
+        // Walks from node to the root, rebalancing and refitting.
+        void Refit(u32 node);
+
+        // Builds a subtree over leaves using the given internal nodes, returns its root.
+        u32 BuildSAH(BuildLeaf* leaves, u32 count, const u32* internal, JobSystem* jobs);
+        u32 LinkChildren(u32 node, u32 child1, u32 child2);
+
+        template<typename Fn>
+        bool ReportSubtree(u32 node, Fn& fn) const;
+
+        u32 ComputeHeight(u32 node) const;
+        void ValidateNode(u32 node) const;
+
+    private:
+        std::vector<Node> m_Nodes;
+        u32 m_Root { s_NullNode };
+        u32 m_FreeList { s_NullNode };
+        u32 m_ProxyCount { 0 };
+
+        f32 m_Margin;
+    };
+
+    template<typename Fn>
+    void DynamicBVH::Query(const AABB& box, Fn&& fn) const
+    {
+        if (m_Root == s_NullNode)
+            return;
+
+        NodeStack stack;
+        stack.Push(m_Root);
+
+        while (!stack.Empty()) {
+            const Node& node = m_Nodes[stack.Pop()];
+            if (!node.Box.Overlaps(box))
+                continue;
+
+            if (node.IsLeaf()) {
+                if (!fn(static_cast<u32>(&node - m_Nodes.data())))
+                    return;
+            } else {
+                stack.Push(node.Child1);
+                stack.Push(node.Child2);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void DynamicBVH::Query(const BoundingSphere& sphere, Fn&& fn) const
+    {
+        if (m_Root == s_NullNode)
+            return;
+
+        f32 radiusSquared = sphere.Radius * sphere.Radius;
+
+        NodeStack stack;
+        stack.Push(m_Root);
+
+        while (!stack.Empty()) {
+            const Node& node = m_Nodes[stack.Pop()];
+
+            glm::vec3 closest = glm::clamp(sphere.Center, node.Box.Min, node.Box.Max);
+            glm::vec3 delta = closest - sphere.Center;
+            if (glm::dot(delta, delta) > radiusSquared)
+                continue;
+
+            if (node.IsLeaf()) {
+                if (!fn(static_cast<u32>(&node - m_Nodes.data())))
+                    return;
+            } else {
+                stack.Push(node.Child1);
+                stack.Push(node.Child2);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void DynamicBVH::Query(const Frustum& frustum, Fn&& fn) const
+    {
+        if (m_Root == s_NullNode)
+            return;
+
+        NodeStack stack;
+        stack.Push(m_Root);
+
+        while (!stack.Empty()) {
+            u32 index = stack.Pop();
+            const Node& node = m_Nodes[index];
+
+            Containment containment = frustum.Classify(node.Box);
+            if (containment == Containment::Outside)
+                continue;
+
+            if (containment == Containment::Inside || node.IsLeaf()) {
+                if (!ReportSubtree(index, fn))
+                    return;
+            } else {
+                stack.Push(node.Child1);
+                stack.Push(node.Child2);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void DynamicBVH::RayCast(const Ray& ray, f32 maxDistance, Fn&& fn) const
+    {
+        if (m_Root == s_NullNode)
+            return;
+
+        glm::vec3 invDirection = 1.0f / ray.Direction;
+
+        NodeStack stack;
+        stack.Push(m_Root);
+
+        while (!stack.Empty()) {
+            u32 index = stack.Pop();
+            const Node& node = m_Nodes[index];
+
+            f32 distance;
+            if (!IntersectRay(ray, invDirection, node.Box, maxDistance, distance))
+                continue;
+
+            if (node.IsLeaf()) {
+                maxDistance = fn(index, ray, maxDistance);
+                if (maxDistance <= 0.0f)
+                    return;
+            } else {
+                stack.Push(node.Child1);
+                stack.Push(node.Child2);
+            }
+        }
+    }
+
+    template<typename Fn>
+    bool DynamicBVH::ReportSubtree(u32 root, Fn& fn) const
+    {
+        NodeStack stack;
+        stack.Push(root);
+
+        while (!stack.Empty()) {
+            u32 index = stack.Pop();
+            const Node& node = m_Nodes[index];
+
+            if (node.IsLeaf()) {
+                if (!fn(index))
+                    return false;
+            } else {
+                stack.Push(node.Child1);
+                stack.Push(node.Child2);
+            }
+        }
+
+        return true;
+    }
+
+}
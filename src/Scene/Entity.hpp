@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+
+#include "Types.hpp"
+
+namespace Graphics {
+
+    // Generational handle: the index addresses a slot in the world, the
+    // generation is bumped whenever the slot is freed so stale handles fail IsAlive.
+    struct Entity
+    {
+        u32 Index { ~0u };
+        u32 Generation { 0 };
+
+        inline bool IsNull() const { return Index == ~0u; }
+
+        inline bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+        inline bool operator!=(const Entity& other) const { return !(*this == other); }
+
+        // Packs the handle into 64 bits, e.g. as user data of a spatial index.
+        inline u64 ToU64() const { return (static_cast<u64>(Generation) << 32) | Index; }
+        static constexpr Entity FromU64(u64 value) { return { static_cast<u32>(value), static_cast<u32>(value >> 32) }; }
+
+        static constexpr Entity Null() { return {}; }
+    };
+
+}
+
+template<>
+struct std::hash<Graphics::Entity>
+{
+    size_t operator()(const Graphics::Entity& entity) const noexcept
+    {
+        return std::hash<Graphics::u64>()(entity.ToU64());
+    }
+};
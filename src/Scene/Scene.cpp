@@ -0,0 +1,136 @@
+#include "Scene.hpp"
+
+#include <cmath>
+
+#include "Renderer/Renderer2D.hpp"
+
+namespace Graphics {
+
+    // A rotated quad always fits in the circle through its corners.
+    static f32 GetSpriteRadius(const TransformComponent& transform)
+    {
+        return 0.5f * glm::length(transform.Scale);
+    }
+
+    static AABB GetSpriteBounds(const TransformComponent& transform)
+    {
+        glm::vec3 extents(GetSpriteRadius(transform), GetSpriteRadius(transform), 0.0f);
+        return { transform.Position - extents, transform.Position + extents };
+    }
+
+    Scene::Scene(JobSystem& jobs)
+        : m_Jobs(jobs), m_Systems(jobs), m_SpatialIndex(0.05f), m_Culler(&jobs)
+    {
+        m_Systems.AddSystem("Movement", SystemAccess().Read<VelocityComponent>().Write<TransformComponent>(), [this](World& world, f32 dt) {
+            world.ParallelEachChunk<TransformComponent, const VelocityComponent>(m_Jobs, [dt](u32 count, Entity*, TransformComponent* transforms, const VelocityComponent* velocities) {
+                for (u32 i = 0; i < count; ++i) {
+                    transforms[i].Position += velocities[i].Linear * dt;
+                    transforms[i].Rotation += velocities[i].Angular * dt;
+                }
+            });
+        });
+
+        m_Systems.AddSystem("Bounds", SystemAccess().Read<TransformComponent>().Write<VelocityComponent>(), [this](World& world, f32) {
+            glm::vec2 bounds = m_Bounds;
+
+            world.ParallelEachChunk<const TransformComponent, VelocityComponent>(m_Jobs, [bounds](u32 count, Entity*, const TransformComponent* transforms, VelocityComponent* velocities) {
+                for (u32 i = 0; i < count; ++i) {
+                    const glm::vec3& position = transforms[i].Position;
+                    glm::vec3& velocity = velocities[i].Linear;
+
+                    if ((position.x < -bounds.x && velocity.x < 0.0f) || (position.x > bounds.x && velocity.x > 0.0f))
+                        velocity.x = -velocity.x;
+                    if ((position.y < -bounds.y && velocity.y < 0.0f) || (position.y > bounds.y && velocity.y > 0.0f))
+                        velocity.y = -velocity.y;
+                }
+            });
+        });
+
+        // The tree is only touched here, so the system can share a stage with
+        // anything that does not write transforms.
+        m_Systems.AddSystem("SpatialIndex", SystemAccess().Read<TransformComponent>().Write<SpatialProxyComponent>(), [this](World& world, f32) {
+            world.EachChunk<const TransformComponent, const SpatialProxyComponent>([this](u32 count, Entity*, const TransformComponent* transforms, const SpatialProxyComponent* proxies) {
+                for (u32 i = 0; i < count; ++i)
+                    m_SpatialIndex.MoveProxy(proxies[i].Proxy, GetSpriteBounds(transforms[i]));
+            });
+        });
+    }
+
+    Entity Scene::CreateSprite(const TransformComponent& transform, const VelocityComponent& velocity, const SpriteComponent& sprite)
+    {
+        Entity entity = m_World.Create(transform, velocity, sprite, SpatialProxyComponent());
+        m_World.Get<SpatialProxyComponent>(entity).Proxy = m_SpatialIndex.CreateProxy(GetSpriteBounds(transform), entity.ToU64());
+
+        return entity;
+    }
+
+    void Scene::DestroyEntity(Entity entity)
+    {
+        if (!m_World.IsAlive(entity))
+            return;
+
+        if (m_World.Has<SpatialProxyComponent>(entity))
+            m_SpatialIndex.DestroyProxy(m_World.Get<SpatialProxyComponent>(entity).Proxy);
+
+        m_World.Destroy(entity);
+    }
+
+    Entity Scene::Pick(const glm::vec2& point)
+    {
+        Entity result = Entity::Null();
+
+        // Sprites live on the z = 0 plane, cast straight down onto it.
+        Ray ray { glm::vec3(point, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f) };
+
+        m_SpatialIndex.RayCast(ray, 2.0f, [&](u32 proxy, const Ray&, f32 maxDistance) -> f32 {
+            Entity entity = Entity::FromU64(m_SpatialIndex.GetUserData(proxy));
+            const TransformComponent& transform = m_World.Get<TransformComponent>(entity);
+
+            glm::vec2 delta = point - glm::vec2(transform.Position);
+            f32 c = std::cos(transform.Rotation);
+            f32 s = std::sin(transform.Rotation);
+            glm::vec2 local(c * delta.x + s * delta.y, c * delta.y - s * delta.x);
+
+            if (std::abs(local.x) > 0.5f * transform.Scale.x || std::abs(local.y) > 0.5f * transform.Scale.y)
+                return maxDistance;
+
+            result = entity;
+            return 0.0f;
+        });
+
+        return result;
+    }
+
+    void Scene::OnUpdate(f32 dt)
+    {
+        m_Systems.Run(m_World, dt);
+    }
+
+    void Scene::OnRender(Renderer2D& renderer, const glm::mat4& viewProjection)
+    {
+        Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+        // The tree works on fat boxes, candidates are re-tested against their
+        // tight spheres in one SIMD pass.
+        m_Sprites.clear();
+        m_SpatialIndex.Query(frustum, [&](u32 proxy) {
+            Entity entity = Entity::FromU64(m_SpatialIndex.GetUserData(proxy));
+            m_Sprites.push_back({ m_World.Get<TransformComponent>(entity), m_World.Get<SpriteComponent>(entity).Color });
+            return true;
+        });
+
+        m_SpriteBounds.Resize(static_cast<u32>(m_Sprites.size()));
+        for (u32 i = 0; i < m_Sprites.size(); ++i) {
+            const TransformComponent& transform = m_Sprites[i].Transform;
+            m_SpriteBounds.Set(i, { transform.Position, GetSpriteRadius(transform) });
+        }
+
+        m_Culler.Cull(frustum, m_SpriteBounds, m_Visible);
+
+        for (u32 index : m_Visible) {
+            const SpriteDraw& sprite = m_Sprites[index];
+            renderer.DrawRotatedQuad(sprite.Transform.Position, sprite.Transform.Scale, sprite.Transform.Rotation, sprite.Color);
+        }
+    }
+
+}
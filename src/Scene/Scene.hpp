@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Types.hpp"
+#include "World.hpp"
+#include "SystemScheduler.hpp"
+#include "Components.hpp"
+#include "DynamicBVH.hpp"
+#include "Core/JobSystem.hpp"
+#include "Renderer/FrustumCuller.hpp"
+
+namespace Graphics {
+
+    class Renderer2D;
+
+    // Owns the entity world and the systems that update it every frame.
+    class Scene
+    {
+    public:
+        Scene(JobSystem& jobs);
+        ~Scene() = default;
+
+        Scene(const Scene&) = delete;
+        Scene& operator=(const Scene&) = delete;
+
+        inline World& GetWorld() { return m_World; }
+        inline SystemScheduler& GetSystems() { return m_Systems; }
+        inline const DynamicBVH& GetSpatialIndex() const { return m_SpatialIndex; }
+
+        // Creates a moving sprite and registers it with the spatial index.
+        Entity CreateSprite(const TransformComponent& transform, const VelocityComponent& velocity, const SpriteComponent& sprite);
+        void DestroyEntity(Entity entity);
+
+        // Topmost sprite under a world-space point, or Entity::Null().
+        Entity Pick(const glm::vec2& point);
+
+        // Half extent of the visible area, moving entities bounce off its edges.
+        inline void SetBounds(const glm::vec2& bounds) { m_Bounds = bounds; }
+
+        void OnUpdate(f32 dt);
+
+        // Collects candidates from the spatial index, refines them against
+        // their tight bounds and submits the visible sprites.
+        void OnRender(Renderer2D& renderer, const glm::mat4& viewProjection);
+
+        inline u32 GetVisibleCount() const { return static_cast<u32>(m_Visible.size()); }
+        inline u32 GetCandidateCount() const { return static_cast<u32>(m_Sprites.size()); }
+
+    private:
+        JobSystem& m_Jobs;
+
+        World m_World;
+        SystemScheduler m_Systems;
+
+        glm::vec2 m_Bounds { 1.0f };
+
+        DynamicBVH m_SpatialIndex;
+
+        struct SpriteDraw
+        {
+            TransformComponent Transform;
+            glm::vec4 Color;
+        };
+
+        FrustumCuller m_Culler;
+        SphereBoundsArray m_SpriteBounds;
+        std::vector<SpriteDraw> m_Sprites;
+        std::vector<u32> m_Visible;
+    };
+
+}
@@ -0,0 +1,72 @@
+#include "SystemScheduler.hpp"
+
+#include <algorithm>
+
+#include "World.hpp"
+
+namespace Graphics {
+
+    bool SystemAccess::ConflictsWith(const SystemAccess& other) const
+    {
+        return (Writes & (other.Reads | other.Writes)).any() || (other.Writes & Reads).any();
+    }
+
+    SystemScheduler::SystemScheduler(JobSystem& jobs)
+        : m_Jobs(jobs)
+    {
+    }
+
+    void SystemScheduler::AddSystem(const std::string& name, const SystemAccess& access, const SystemFn& fn)
+    {
+        m_Systems.push_back({ name, access, fn });
+        m_StagesDirty = true;
+    }
+
+    void SystemScheduler::Run(World& world, f32 dt)
+    {
+        if (m_StagesDirty)
+            BuildStages();
+
+        for (const std::vector<u32>& stage : m_Stages) {
+            if (stage.size() == 1) {
+                m_Systems[stage[0]].Fn(world, dt);
+                continue;
+            }
+
+            JobContext context;
+            for (u32 index : stage)
+                m_Jobs.Execute(context, [&, index]() { m_Systems[index].Fn(world, dt); });
+            m_Jobs.Wait(context);
+        }
+    }
+
+    usize SystemScheduler::GetStageCount()
+    {
+        if (m_StagesDirty)
+            BuildStages();
+
+        return m_Stages.size();
+    }
+
+    void SystemScheduler::BuildStages()
+    {
+        std::vector<u32> stageOf(m_Systems.size(), 0);
+        m_Stages.clear();
+
+        for (u32 i = 0; i < m_Systems.size(); ++i) {
+            u32 stage = 0;
+            for (u32 j = 0; j < i; ++j) {
+                if (m_Systems[i].Access.ConflictsWith(m_Systems[j].Access))
+                    stage = std::max(stage, stageOf[j] + 1);
+            }
+
+            stageOf[i] = stage;
+            if (stage >= m_Stages.size())
+                m_Stages.resize(stage + 1);
+            m_Stages[stage].push_back(i);
+        }
+
+        m_StagesDirty = false;
+    }
+
+}
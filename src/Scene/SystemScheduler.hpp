@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "Types.hpp"
+#include "Component.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace Graphics {
+
+    class World;
+
+    // Declared component access of a system, used to decide which systems may run concurrently.
+    struct SystemAccess
+    {
+        ComponentMask Reads;
+        ComponentMask Writes;
+
+        template<typename... Ts>
+        SystemAccess& Read() { Reads |= ComponentRegistry::MaskOf<Ts...>(); return *this; }
+
+        template<typename... Ts>
+        SystemAccess& Write() { Writes |= ComponentRegistry::MaskOf<Ts...>(); return *this; }
+
+        // Structural changes (create, destroy, add, remove) conflict with every other system.
+        SystemAccess& Exclusive() { Writes.set(); return *this; }
+
+        bool ConflictsWith(const SystemAccess& other) const;
+    };
+
+    // Runs systems in registration order while letting systems with disjoint
+    // access share a stage. Each system is placed one stage after the latest
+    // earlier system it conflicts with, stages run one after another and the
+    // systems inside a stage run in parallel on the job system.
+    class SystemScheduler
+    {
+    public:
+        using SystemFn = std::function<void(World& world, f32 dt)>;
+
+    public:
+        SystemScheduler(JobSystem& jobs);
+
+        void AddSystem(const std::string& name, const SystemAccess& access, const SystemFn& fn);
+
+        void Run(World& world, f32 dt);
+
+        inline usize GetSystemCount() const { return m_Systems.size(); }
+        usize GetStageCount();
+
+    private:
+        struct System
+        {
+            std::string Name;
+            SystemAccess Access;
+            SystemFn Fn;
+        };
+
+        void BuildStages();
+
+    private:
+        JobSystem& m_Jobs;
+
+        std::vector<System> m_Systems;
+        std::vector<std::vector<u32>> m_Stages;
+        bool m_StagesDirty { true };
+    };
+
+}
@@ -0,0 +1,157 @@
+#include "World.hpp"
+
+namespace Graphics {
+
+    World::World()
+    {
+        m_EmptyArchetype = GetOrCreateArchetype(ComponentMask());
+    }
+
+    World::~World()
+    {
+        // Archetypes destroy the components of their remaining rows.
+        m_ArchetypeList.clear();
+        m_Archetypes.clear();
+    }
+
+    Entity World::Create()
+    {
+        return AllocateEntity(m_EmptyArchetype);
+    }
+
+    void World::Destroy(Entity entity)
+    {
+        if (!IsAlive(entity))
+            return;
+
+        EntityRecord& record = m_Records[entity.Index];
+        Archetype* archetype = record.Storage;
+        const ArchetypeChunk& chunk = archetype->GetChunk(record.Chunk);
+
+        for (ComponentID id : archetype->m_Components)
+            ComponentRegistry::GetInfo(id).Destroy(archetype->GetComponent(chunk, id, record.Row));
+
+        Entity moved = archetype->RemoveRow(record.Chunk, record.Row);
+        if (!moved.IsNull()) {
+            m_Records[moved.Index].Chunk = record.Chunk;
+            m_Records[moved.Index].Row = record.Row;
+        }
+
+        ++record.Generation;
+        record.Storage = nullptr;
+        m_FreeList.push_back(entity.Index);
+        --m_EntityCount;
+    }
+
+    bool World::IsAlive(Entity entity) const
+    {
+        return entity.Index < m_Records.size()
+            && m_Records[entity.Index].Storage != nullptr
+            && m_Records[entity.Index].Generation == entity.Generation;
+    }
+
+    Entity World::AllocateEntity(Archetype* archetype)
+    {
+        Entity entity;
+
+        if (!m_FreeList.empty()) {
+            entity.Index = m_FreeList.back();
+            m_FreeList.pop_back();
+        } else {
+            entity.Index = static_cast<u32>(m_Records.size());
+            m_Records.emplace_back();
+        }
+
+        EntityRecord& record = m_Records[entity.Index];
+        entity.Generation = record.Generation;
+
+        auto [chunk, row] = archetype->AllocateRow(entity);
+        record.Storage = archetype;
+        record.Chunk = chunk;
+        record.Row = row;
+
+        ++m_EntityCount;
+
+        return entity;
+    }
+
+    Archetype* World::GetOrCreateArchetype(const ComponentMask& mask)
+    {
+        auto it = m_Archetypes.find(mask);
+        if (it != m_Archetypes.end())
+            return it->second.get();
+
+        auto archetype = std::make_unique<Archetype>(mask);
+        Archetype* ptr = archetype.get();
+
+        m_Archetypes.emplace(mask, std::move(archetype));
+        m_ArchetypeList.push_back(ptr);
+
+        return ptr;
+    }
+
+    Archetype* World::GetAddTarget(Archetype* from, ComponentID id)
+    {
+        if (!from->m_AddEdges[id]) {
+            Archetype* to = GetOrCreateArchetype(ComponentMask(from->GetMask()).set(id));
+            from->m_AddEdges[id] = to;
+            to->m_RemoveEdges[id] = from;
+        }
+
+        return from->m_AddEdges[id];
+    }
+
+    Archetype* World::GetRemoveTarget(Archetype* from, ComponentID id)
+    {
+        if (!from->m_RemoveEdges[id]) {
+            Archetype* to = GetOrCreateArchetype(ComponentMask(from->GetMask()).reset(id));
+            from->m_RemoveEdges[id] = to;
+            to->m_AddEdges[id] = from;
+        }
+
+        return from->m_RemoveEdges[id];
+    }
+
+    void World::MoveEntity(Entity entity, Archetype* to)
+    {
+        EntityRecord& record = m_Records[entity.Index];
+        Archetype* from = record.Storage;
+
+        auto [chunkIndex, row] = to->AllocateRow(entity);
+
+        const ArchetypeChunk& src = from->GetChunk(record.Chunk);
+        const ArchetypeChunk& dst = to->GetChunk(chunkIndex);
+
+        for (ComponentID id : from->m_Components) {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            void* component = from->GetComponent(src, id, record.Row);
+
+            if (to->Has(id))
+                info.MoveConstruct(to->GetComponent(dst, id, row), component);
+
+            info.Destroy(component);
+        }
+
+        Entity moved = from->RemoveRow(record.Chunk, record.Row);
+        if (!moved.IsNull()) {
+            m_Records[moved.Index].Chunk = record.Chunk;
+            m_Records[moved.Index].Row = record.Row;
+        }
+
+        record.Storage = to;
+        record.Chunk = chunkIndex;
+        record.Row = row;
+    }
+
+    void World::GatherChunks(const ComponentMask& mask, std::vector<ChunkRef>& chunks)
+    {
+        for (Archetype* archetype : m_ArchetypeList) {
+            if ((archetype->GetMask() & mask) != mask)
+                continue;
+
+            for (usize i = 0; i < archetype->GetChunkCount(); ++i)
+                chunks.push_back({ archetype, static_cast<u32>(i) });
+        }
+    }
+
+}
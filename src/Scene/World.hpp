@@ -0,0 +1,200 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "Types.hpp"
+#include "Entity.hpp"
+#include "Component.hpp"
+#include "Archetype.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace Graphics {
+
+    // Archetype-based entity store. Entities with the same component set share
+    // an archetype whose chunks hold each component in its own contiguous
+    // column, so systems only stream the components they actually touch.
+    // Adding or removing a component moves the entity to another archetype.
+    class World
+    {
+    public:
+        World();
+        ~World();
+
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        Entity Create();
+
+        // Creates the entity directly in its final archetype.
+        template<typename... Ts>
+        Entity Create(Ts&&... components);
+
+        void Destroy(Entity entity);
+        bool IsAlive(Entity entity) const;
+
+        template<typename T>
+        T& Add(Entity entity, T component = T());
+
+        template<typename T>
+        void Remove(Entity entity);
+
+        template<typename T>
+        T& Get(Entity entity);
+
+        template<typename T>
+        bool Has(Entity entity) const;
+
+        inline u32 GetEntityCount() const { return m_EntityCount; }
+        inline usize GetArchetypeCount() const { return m_ArchetypeList.size(); }
+
+        // fn(u32 count, Entity* entities, Ts*... columns) for every chunk with all of Ts.
+        template<typename... Ts, typename Fn>
+        void EachChunk(Fn&& fn);
+
+        // fn(Ts&... components) for every entity with all of Ts.
+        template<typename... Ts, typename Fn>
+        void Each(Fn&& fn);
+
+        // Same as EachChunk, chunks are distributed over the job system.
+        // fn is called concurrently and must only touch its own chunk.
+        template<typename... Ts, typename Fn>
+        void ParallelEachChunk(JobSystem& jobs, Fn&& fn);
+
+    private:
+        struct EntityRecord
+        {
+            u32 Generation { 0 };
+            Archetype* Storage { nullptr };
+            u32 Chunk { 0 };
+            u32 Row { 0 };
+        };
+
+        struct ChunkRef
+        {
+            Archetype* Storage;
+            u32 Chunk;
+        };
+
+        Entity AllocateEntity(Archetype* archetype);
+
+        Archetype* GetOrCreateArchetype(const ComponentMask& mask);
+        Archetype* GetAddTarget(Archetype* from, ComponentID id);
+        Archetype* GetRemoveTarget(Archetype* from, ComponentID id);
+
+        // Relocates the entity's row into another archetype, moving shared
+        // components and destroying the ones the target does not have.
+        void MoveEntity(Entity entity, Archetype* to);
+
+        void GatherChunks(const ComponentMask& mask, std::vector<ChunkRef>& chunks);
+
+    private:
+        std::vector<EntityRecord> m_Records;
+        std::vector<u32> m_FreeList;
+        u32 m_EntityCount { 0 };
+
+        std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> m_Archetypes;
+        std::vector<Archetype*> m_ArchetypeList;
+        Archetype* m_EmptyArchetype { nullptr };
+    };
+
+    template<typename... Ts>
+    Entity World::Create(Ts&&... components)
+    {
+        Archetype* archetype = GetOrCreateArchetype(ComponentRegistry::MaskOf<std::remove_cvref_t<Ts>...>());
+        Entity entity = AllocateEntity(archetype);
+
+        const EntityRecord& record = m_Records[entity.Index];
+        const ArchetypeChunk& chunk = archetype->GetChunk(record.Chunk);
+        (new (archetype->GetComponent(chunk, ComponentRegistry::GetID<Ts>(), record.Row)) std::remove_cvref_t<Ts>(std::forward<Ts>(components)), ...);
+
+        return entity;
+    }
+
+    template<typename T>
+    T& World::Add(Entity entity, T component)
+    {
+        ComponentID id = ComponentRegistry::GetID<T>();
+        EntityRecord& record = m_Records[entity.Index];
+
+        if (record.Storage->Has(id)) {
+            T& existing = *static_cast<T*>(record.Storage->GetComponent(record.Storage->GetChunk(record.Chunk), id, record.Row));
+            existing = std::move(component);
+            return existing;
+        }
+
+        MoveEntity(entity, GetAddTarget(record.Storage, id));
+
+        void* ptr = record.Storage->GetComponent(record.Storage->GetChunk(record.Chunk), id, record.Row);
+        return *new (ptr) T(std::move(component));
+    }
+
+    template<typename T>
+    void World::Remove(Entity entity)
+    {
+        ComponentID id = ComponentRegistry::GetID<T>();
+        EntityRecord& record = m_Records[entity.Index];
+
+        if (!record.Storage->Has(id))
+            return;
+
+        MoveEntity(entity, GetRemoveTarget(record.Storage, id));
+    }
+
+    template<typename T>
+    T& World::Get(Entity entity)
+    {
+        const EntityRecord& record = m_Records[entity.Index];
+        return *static_cast<T*>(record.Storage->GetComponent(record.Storage->GetChunk(record.Chunk), ComponentRegistry::GetID<T>(), record.Row));
+    }
+
+    template<typename T>
+    bool World::Has(Entity entity) const
+    {
+        return IsAlive(entity) && m_Records[entity.Index].Storage->Has(ComponentRegistry::GetID<T>());
+    }
+
+    template<typename... Ts, typename Fn>
+    void World::EachChunk(Fn&& fn)
+    {
+        ComponentMask mask = ComponentRegistry::MaskOf<Ts...>();
+
+        for (Archetype* archetype : m_ArchetypeList) {
+            if ((archetype->GetMask() & mask) != mask)
+                continue;
+
+            for (usize i = 0; i < archetype->GetChunkCount(); ++i) {
+                ArchetypeChunk& chunk = archetype->GetChunk(i);
+                fn(chunk.Count, archetype->GetEntities(chunk), archetype->template GetColumn<Ts>(chunk)...);
+            }
+        }
+    }
+
+    template<typename... Ts, typename Fn>
+    void World::Each(Fn&& fn)
+    {
+        EachChunk<Ts...>([&](u32 count, Entity*, Ts*... columns) {
+            for (u32 i = 0; i < count; ++i)
+                fn(columns[i]...);
+        });
+    }
+
+    template<typename... Ts, typename Fn>
+    void World::ParallelEachChunk(JobSystem& jobs, Fn&& fn)
+    {
+        std::vector<ChunkRef> chunks;
+        GatherChunks(ComponentRegistry::MaskOf<Ts...>(), chunks);
+
+        JobContext context;
+        jobs.Dispatch(context, static_cast<u32>(chunks.size()), 1, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                ArchetypeChunk& chunk = chunks[i].Storage->GetChunk(chunks[i].Chunk);
+                fn(chunk.Count, chunks[i].Storage->GetEntities(chunk), chunks[i].Storage->template GetColumn<Ts>(chunk)...);
+            }
+        });
+        jobs.Wait(context);
+    }
+
+}
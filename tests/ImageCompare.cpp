@@ -0,0 +1,465 @@
+#include "ImageCompare.hpp"
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace Graphics::Test {
+
+    // Reads the deflate bit stream, least significant bit first.
+    class BitReader
+    {
+    public:
+        BitReader(const u8* data, usize size)
+            : m_Data(data), m_Size(size) {}
+
+        u32 Bits(u32 count)
+        {
+            u32 value = 0;
+            for (u32 i = 0; i < count; ++i, ++m_Bit) {
+                if ((m_Bit >> 3) >= m_Size) {
+                    m_Overrun = true;
+                    return 0;
+                }
+
+                value |= static_cast<u32>((m_Data[m_Bit >> 3] >> (m_Bit & 7)) & 1) << i;
+            }
+
+            return value;
+        }
+
+        // Stored blocks start at the next byte boundary.
+        bool CopyBytes(usize count, std::vector<u8>& out)
+        {
+            m_Bit = (m_Bit + 7) & ~static_cast<usize>(7);
+
+            usize offset = m_Bit >> 3;
+            if (offset + count > m_Size) {
+                m_Overrun = true;
+                return false;
+            }
+
+            out.insert(out.end(), m_Data + offset, m_Data + offset + count);
+            m_Bit += count * 8;
+
+            return true;
+        }
+
+        inline void AlignToByte() { m_Bit = (m_Bit + 7) & ~static_cast<usize>(7); }
+        inline bool HasOverrun() const { return m_Overrun; }
+
+    private:
+        const u8* m_Data;
+        usize m_Size;
+        usize m_Bit { 0 };
+        bool m_Overrun { false };
+    };
+
+    // Canonical Huffman code, decoded one bit at a time.
+    struct Huffman
+    {
+        std::array<u16, 16> Counts {};
+        std::array<u16, 288> Symbols {};
+
+        void Build(const u8* lengths, u32 count)
+        {
+            Counts.fill(0);
+            for (u32 i = 0; i < count; ++i)
+                Counts[lengths[i]]++;
+
+            std::array<u16, 16> offsets {};
+            for (u32 length = 1; length < 15; ++length)
+                offsets[length + 1] = offsets[length] + Counts[length];
+
+            for (u32 symbol = 0; symbol < count; ++symbol) {
+                if (lengths[symbol] != 0)
+                    Symbols[offsets[lengths[symbol]]++] = static_cast<u16>(symbol);
+            }
+        }
+
+        i32 Decode(BitReader& reader) const
+        {
+            i32 code = 0;
+            i32 first = 0;
+            i32 index = 0;
+
+            for (u32 length = 1; length < 16; ++length) {
+                code |= static_cast<i32>(reader.Bits(1));
+
+                i32 count = Counts[length];
+                if (code - count < first)
+                    return Symbols[index + (code - first)];
+
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+
+            return -1;
+        }
+    };
+
+    static constexpr std::array<u16, 29> s_LengthBase = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static constexpr std::array<u8, 29> s_LengthExtra = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static constexpr std::array<u16, 30> s_DistanceBase = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static constexpr std::array<u8, 30> s_DistanceExtra = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    static bool InflateBlock(BitReader& reader, const Huffman& lengths, const Huffman& distances, std::vector<u8>& out)
+    {
+        while (!reader.HasOverrun()) {
+            i32 symbol = lengths.Decode(reader);
+
+            if (symbol < 0 || symbol > 285)
+                return false;
+
+            if (symbol < 256) {
+                out.push_back(static_cast<u8>(symbol));
+                continue;
+            }
+
+            if (symbol == 256)
+                return true;
+
+            u32 index = static_cast<u32>(symbol) - 257;
+            u32 length = s_LengthBase[index] + reader.Bits(s_LengthExtra[index]);
+
+            i32 distanceSymbol = distances.Decode(reader);
+            if (distanceSymbol < 0 || distanceSymbol >= 30)
+                return false;
+
+            usize distance = s_DistanceBase[distanceSymbol] + reader.Bits(s_DistanceExtra[distanceSymbol]);
+            if (distance > out.size())
+                return false;
+
+            // The copy may overlap what it produces, byte by byte on purpose.
+            usize start = out.size() - distance;
+            for (u32 i = 0; i < length; ++i)
+                out.push_back(out[start + i]);
+        }
+
+        return false;
+    }
+
+    static bool Inflate(const u8* data, usize size, std::vector<u8>& out)
+    {
+        static constexpr std::array<u8, 19> codeLengthOrder = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        BitReader reader(data, size);
+
+        bool last = false;
+        while (!last) {
+            last = reader.Bits(1) != 0;
+            u32 type = reader.Bits(2);
+
+            if (type == 0) {
+                reader.AlignToByte();
+
+                u32 length = reader.Bits(16);
+                u32 complement = reader.Bits(16);
+
+                if ((length ^ 0xFFFF) != complement || !reader.CopyBytes(length, out))
+                    return false;
+            } else if (type == 1) {
+                std::array<u8, 288> lengthLengths;
+                std::fill(lengthLengths.begin(), lengthLengths.begin() + 144, 8);
+                std::fill(lengthLengths.begin() + 144, lengthLengths.begin() + 256, 9);
+                std::fill(lengthLengths.begin() + 256, lengthLengths.begin() + 280, 7);
+                std::fill(lengthLengths.begin() + 280, lengthLengths.end(), 8);
+
+                std::array<u8, 30> distanceLengths;
+                distanceLengths.fill(5);
+
+                Huffman lengths, distances;
+                lengths.Build(lengthLengths.data(), static_cast<u32>(lengthLengths.size()));
+                distances.Build(distanceLengths.data(), static_cast<u32>(distanceLengths.size()));
+
+                if (!InflateBlock(reader, lengths, distances, out))
+                    return false;
+            } else if (type == 2) {
+                u32 lengthCount = reader.Bits(5) + 257;
+                u32 distanceCount = reader.Bits(5) + 1;
+                u32 codeLengthCount = reader.Bits(4) + 4;
+
+                std::array<u8, 19> codeLengthLengths {};
+                for (u32 i = 0; i < codeLengthCount; ++i)
+                    codeLengthLengths[codeLengthOrder[i]] = static_cast<u8>(reader.Bits(3));
+
+                Huffman codeLengths;
+                codeLengths.Build(codeLengthLengths.data(), static_cast<u32>(codeLengthLengths.size()));
+
+                // Literal/length and distance code lengths share one run-length coded sequence.
+                std::array<u8, 320> codeLengthsOut {};
+                u32 count = 0;
+
+                while (count < lengthCount + distanceCount) {
+                    i32 symbol = codeLengths.Decode(reader);
+                    if (symbol < 0 || reader.HasOverrun())
+                        return false;
+
+                    if (symbol < 16) {
+                        codeLengthsOut[count++] = static_cast<u8>(symbol);
+                        continue;
+                    }
+
+                    u8 value = 0;
+                    u32 repeat = 0;
+
+                    if (symbol == 16) {
+                        if (count == 0)
+                            return false;
+
+                        value = codeLengthsOut[count - 1];
+                        repeat = 3 + reader.Bits(2);
+                    } else if (symbol == 17) {
+                        repeat = 3 + reader.Bits(3);
+                    } else {
+                        repeat = 11 + reader.Bits(7);
+                    }
+
+                    if (count + repeat > lengthCount + distanceCount)
+                        return false;
+
+                    for (u32 i = 0; i < repeat; ++i)
+                        codeLengthsOut[count++] = value;
+                }
+
+                Huffman lengths, distances;
+                lengths.Build(codeLengthsOut.data(), lengthCount);
+                distances.Build(codeLengthsOut.data() + lengthCount, distanceCount);
+
+                if (!InflateBlock(reader, lengths, distances, out))
+                    return false;
+            } else {
+                return false;
+            }
+
+            if (reader.HasOverrun())
+                return false;
+        }
+
+        return true;
+    }
+
+    static u32 ReadBigEndian(const u8* data)
+    {
+        return (static_cast<u32>(data[0]) << 24) | (static_cast<u32>(data[1]) << 16) | (static_cast<u32>(data[2]) << 8) | data[3];
+    }
+
+    static u8 Paeth(u8 left, u8 up, u8 upLeft)
+    {
+        i32 estimate = static_cast<i32>(left) + up - upLeft;
+        i32 distanceLeft = std::abs(estimate - left);
+        i32 distanceUp = std::abs(estimate - up);
+        i32 distanceUpLeft = std::abs(estimate - upLeft);
+
+        if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft)
+            return left;
+
+        return distanceUp <= distanceUpLeft ? up : upLeft;
+    }
+
+    bool LoadPNG(const std::filesystem::path& path, Image& image)
+    {
+        static constexpr std::array<u8, 8> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        std::vector<u8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (data.size() < signature.size() || !std::equal(signature.begin(), signature.end(), data.begin())) {
+            std::printf("%s is not a PNG\n", path.string().c_str());
+            return false;
+        }
+
+        u32 width = 0;
+        u32 height = 0;
+        u32 channels = 0;
+        std::vector<u8> compressed;
+
+        for (usize offset = signature.size(); offset + 12 <= data.size();) {
+            u32 length = ReadBigEndian(&data[offset]);
+            const u8* type = &data[offset + 4];
+            const u8* chunk = &data[offset + 8];
+
+            if (offset + 12 + length > data.size())
+                break;
+
+            if (std::memcmp(type, "IHDR", 4) == 0) {
+                width = ReadBigEndian(chunk);
+                height = ReadBigEndian(chunk + 4);
+
+                u8 depth = chunk[8];
+                u8 color = chunk[9];
+                u8 interlace = chunk[12];
+
+                switch (color) {
+                    case 0: channels = 1; break;
+                    case 2: channels = 3; break;
+                    case 4: channels = 2; break;
+                    case 6: channels = 4; break;
+                    default: channels = 0; break;
+                }
+
+                if (depth != 8 || channels == 0 || interlace != 0) {
+                    std::printf("%s: only 8-bit gray, RGB and RGBA PNGs without interlacing are supported\n", path.string().c_str());
+                    return false;
+                }
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                break;
+            }
+
+            offset += 12 + length;
+        }
+
+        // Skips the two byte zlib header, the trailing checksum is not checked.
+        std::vector<u8> raw;
+        if (channels == 0 || compressed.size() < 2 || !Inflate(compressed.data() + 2, compressed.size() - 2, raw)) {
+            std::printf("Failed to decode %s\n", path.string().c_str());
+            return false;
+        }
+
+        usize stride = static_cast<usize>(width) * channels;
+        if (raw.size() < (stride + 1) * height) {
+            std::printf("%s is truncated\n", path.string().c_str());
+            return false;
+        }
+
+        std::vector<u8> pixels(stride * height);
+        std::vector<u8> zeros(stride, 0);
+
+        for (u32 y = 0; y < height; ++y) {
+            u8 filter = raw[y * (stride + 1)];
+            const u8* source = &raw[y * (stride + 1) + 1];
+            u8* row = &pixels[y * stride];
+            const u8* up = y > 0 ? &pixels[(y - 1) * stride] : zeros.data();
+
+            for (usize x = 0; x < stride; ++x) {
+                u8 left = x >= channels ? row[x - channels] : 0;
+                u8 upLeft = x >= channels ? up[x - channels] : 0;
+
+                switch (filter) {
+                    case 0: row[x] = source[x]; break;
+                    case 1: row[x] = source[x] + left; break;
+                    case 2: row[x] = source[x] + up[x]; break;
+                    case 3: row[x] = source[x] + static_cast<u8>((static_cast<u32>(left) + up[x]) / 2); break;
+                    case 4: row[x] = source[x] + Paeth(left, up[x], upLeft); break;
+                    default:
+                        std::printf("%s has an invalid filter type\n", path.string().c_str());
+                        return false;
+                }
+            }
+        }
+
+        image.Width = width;
+        image.Height = height;
+        image.Pixels.resize(static_cast<usize>(width) * height * 4);
+
+        for (usize i = 0; i < static_cast<usize>(width) * height; ++i) {
+            const u8* pixel = &pixels[i * channels];
+            u8* target = &image.Pixels[i * 4];
+
+            if (channels <= 2) {
+                target[0] = target[1] = target[2] = pixel[0];
+                target[3] = channels == 2 ? pixel[1] : 255;
+            } else {
+                target[0] = pixel[0];
+                target[1] = pixel[1];
+                target[2] = pixel[2];
+                target[3] = channels == 4 ? pixel[3] : 255;
+            }
+        }
+
+        return true;
+    }
+
+    struct Lab
+    {
+        f32 L, A, B;
+    };
+
+    static Lab ToLab(const u8* rgb, const std::array<f32, 256>& linear)
+    {
+        f32 r = linear[rgb[0]];
+        f32 g = linear[rgb[1]];
+        f32 b = linear[rgb[2]];
+
+        // Linear sRGB to XYZ, relative to the D65 white point.
+        f32 x = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f;
+        f32 y = (0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+        f32 z = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f;
+
+        auto f = [](f32 t) {
+            return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+        };
+
+        f32 fx = f(x);
+        f32 fy = f(y);
+        f32 fz = f(z);
+
+        return { 116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz) };
+    }
+
+    ImageComparison CompareImages(const Image& expected, const Image& actual, f32 threshold)
+    {
+        ImageComparison result;
+        result.SizeMatches = expected.Width == actual.Width && expected.Height == actual.Height;
+
+        if (!result.SizeMatches)
+            return result;
+
+        std::array<f32, 256> linear;
+        for (u32 i = 0; i < linear.size(); ++i) {
+            f32 c = static_cast<f32>(i) / 255.0f;
+            linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        usize pixelCount = static_cast<usize>(expected.Width) * expected.Height;
+
+        result.Difference.Width = expected.Width;
+        result.Difference.Height = expected.Height;
+        result.Difference.Pixels.resize(pixelCount * 4);
+
+        f64 sum = 0.0;
+
+        for (usize i = 0; i < pixelCount; ++i) {
+            const u8* a = &expected.Pixels[i * 4];
+            const u8* b = &actual.Pixels[i * 4];
+            u8* difference = &result.Difference.Pixels[i * 4];
+
+            Lab labA = ToLab(a, linear);
+            Lab labB = ToLab(b, linear);
+
+            f32 deltaE = std::sqrt((labA.L - labB.L) * (labA.L - labB.L) + (labA.A - labB.A) * (labA.A - labB.A) + (labA.B - labB.B) * (labA.B - labB.B));
+
+            sum += deltaE;
+            result.MaxDeltaE = std::max(result.MaxDeltaE, deltaE);
+
+            if (deltaE > threshold) {
+                result.FailingPixels++;
+
+                difference[0] = static_cast<u8>(std::min(128.0f + deltaE * 4.0f, 255.0f));
+                difference[1] = 0;
+                difference[2] = 0;
+            } else {
+                u8 gray = static_cast<u8>(labA.L * 0.64f);
+                difference[0] = difference[1] = difference[2] = gray;
+            }
+
+            difference[3] = 255;
+        }
+
+        result.MeanDeltaE = static_cast<f32>(sum / static_cast<f64>(std::max<usize>(pixelCount, 1)));
+        result.FailingFraction = static_cast<f32>(result.FailingPixels) / static_cast<f32>(std::max<usize>(pixelCount, 1));
+
+        return result;
+    }
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace Graphics::Test {
+
+    // Tightly packed 8-bit RGBA.
+    struct Image
+    {
+        u32 Width { 0 };
+        u32 Height { 0 };
+        std::vector<u8> Pixels;
+    };
+
+    // Decodes 8-bit grayscale, RGB and RGBA PNGs without interlacing, which
+    // covers what the capture writes and what image editors save goldens as.
+    bool LoadPNG(const std::filesystem::path& path, Image& image);
+
+    struct ImageComparison
+    {
+        bool SizeMatches { false };
+        f32 MaxDeltaE { 0.0f };
+        f32 MeanDeltaE { 0.0f };
+        // Pixels further apart than the threshold.
+        u32 FailingPixels { 0 };
+        f32 FailingFraction { 0.0f };
+        // Failing pixels in red over a dimmed copy of the expected image.
+        Image Difference;
+    };
+
+    // Per-pixel CIELAB distance (delta E 1976) between the sRGB colors,
+    // ignoring alpha. A delta E around 2 is the smallest difference a viewer
+    // notices, so rasterization noise of a software renderer stays below a
+    // threshold of a few units while visible changes do not.
+    ImageComparison CompareImages(const Image& expected, const Image& actual, f32 threshold);
+
+}
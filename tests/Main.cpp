@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ImageCompare.hpp"
+#include "PerfBaseline.hpp"
+#include "RenderScenes.hpp"
+#include "Core/Log.hpp"
+#include "Core/Timer.hpp"
+#include "Core/ImageWriter.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Renderer/FrameCapture.hpp"
+#include "Renderer/QueueTimeline.hpp"
+#include "Renderer/MemoryTracker.hpp"
+
+using namespace Graphics;
+
+// Pipelines compile on worker threads, a scene that needs longer than this is stuck.
+static constexpr u32 s_MaxWarmupFrames = 2000;
+
+struct Options
+{
+    std::string Scene;
+    std::filesystem::path GoldenDirectory { "tests/golden" };
+    std::filesystem::path BaselineDirectory { "tests/baselines" };
+    std::filesystem::path OutputDirectory { "test-output" };
+    bool Update { false };
+
+    u32 Width { 640 };
+    u32 Height { 360 };
+    u32 WarmupFrames { 16 };
+    u32 MeasuredFrames { 120 };
+
+    // Pixels further apart than DeltaE count as different, more than
+    // MaxFailing of them fail the comparison.
+    f32 DeltaE { 3.0f };
+    f32 MaxFailing { 0.001f };
+    Test::PerfTolerance Tolerance;
+};
+
+struct Measurements
+{
+    f64 CPUTime { 0.0 };
+    f64 GPUTime { 0.0 };
+    f64 Memory { 0.0 };
+    // Allocated through the renderer's memory tracker, in megabytes.
+    f64 DeviceMemory { 0.0 };
+    std::string Device;
+};
+
+static f64 Median(std::vector<f64> values)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+static void PrintUsage(const char* program)
+{
+    std::printf("Usage: %s <scene> [--golden=<dir>] [--baseline=<dir>] [--output=<dir>] [--update]\n"
+        "    [--size=<width>x<height>] [--warmup=<frames>] [--frames=<frames>] [--delta-e=<threshold>] [--max-failing=<fraction>]\n"
+        "    [--cpu-tolerance=<fraction>] [--gpu-tolerance=<fraction>] [--memory-tolerance=<fraction>]\n"
+        "       %s --list\n", program, program);
+}
+
+// Renders the scene headlessly, captures the last frame and measures the frames before it.
+static bool RenderScene(const Test::RenderSceneEntry& entry, const Options& options, const std::filesystem::path& capturePath, Measurements& measurements)
+{
+    auto renderer = std::make_unique<Renderer>(VkExtent2D { options.Width, options.Height });
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(renderer->GetPhysicalDevice(), &properties);
+    measurements.Device = properties.deviceName;
+
+    if (!renderer->CanCaptureSwapchain()) {
+        std::printf("The headless renderer cannot capture its images\n");
+        return false;
+    }
+
+    auto scene = entry.Create();
+    scene->Setup(*renderer);
+
+    f32 aspect = static_cast<f32>(options.Width) / static_cast<f32>(options.Height);
+
+    auto frame = [&]() {
+        if (renderer->BeginFrame()) {
+            scene->Draw(*renderer, aspect);
+            renderer->EndFrame();
+        }
+    };
+
+    // Until every pipeline is compiled draws are skipped, and occlusion
+    // culling needs a few frames of history before its result settles.
+    u32 warmup = 0;
+    while (warmup < options.WarmupFrames || renderer->GetPipelineCache().GetStats().Compiling > 0) {
+        if (warmup == s_MaxWarmupFrames) {
+            std::printf("Pipelines were still compiling after %u frames\n", warmup);
+            return false;
+        }
+
+        frame();
+        warmup++;
+    }
+
+    std::vector<f64> cpuTimes;
+    std::vector<f64> gpuTimes;
+
+    for (u32 i = 0; i < options.MeasuredFrames; ++i) {
+        Timer timer;
+        frame();
+
+        cpuTimes.push_back(timer.ElapsedMillis());
+        gpuTimes.push_back(renderer->GetGPUFrameTime());
+    }
+
+    measurements.CPUTime = Median(cpuTimes);
+    measurements.GPUTime = Median(gpuTimes);
+    measurements.Memory = Test::GetProcessMemory();
+    measurements.DeviceMemory = static_cast<f64>(renderer->GetMemoryTracker().GetStats().Total.Bytes) / (1024.0 * 1024.0);
+
+    FrameCapture& capture = renderer->GetFrameCapture();
+    capture.CaptureFrame(capturePath);
+    frame();
+    capture.Flush();
+
+    renderer->GetGraphicsTimeline().WaitIdle();
+    scene.reset();
+
+    return capture.GetStats().Captured > 0;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+
+        if (std::strcmp(arg, "--list") == 0) {
+            for (const auto& entry : Test::GetRenderScenes())
+                std::printf("%s\n", entry.Name.c_str());
+            return 0;
+        } else if (std::strncmp(arg, "--golden=", 9) == 0) {
+            options.GoldenDirectory = arg + 9;
+        } else if (std::strncmp(arg, "--baseline=", 11) == 0) {
+            options.BaselineDirectory = arg + 11;
+        } else if (std::strncmp(arg, "--output=", 9) == 0) {
+            options.OutputDirectory = arg + 9;
+        } else if (std::strcmp(arg, "--update") == 0) {
+            options.Update = true;
+        } else if (std::strncmp(arg, "--size=", 7) == 0 && std::sscanf(arg + 7, "%ux%u", &options.Width, &options.Height) == 2) {
+            continue;
+        } else if (std::strncmp(arg, "--warmup=", 9) == 0) {
+            options.WarmupFrames = static_cast<u32>(std::stoul(arg + 9));
+        } else if (std::strncmp(arg, "--frames=", 9) == 0) {
+            options.MeasuredFrames = static_cast<u32>(std::stoul(arg + 9));
+        } else if (std::strncmp(arg, "--delta-e=", 10) == 0) {
+            options.DeltaE = std::stof(arg + 10);
+        } else if (std::strncmp(arg, "--max-failing=", 14) == 0) {
+            options.MaxFailing = std::stof(arg + 14);
+        } else if (std::strncmp(arg, "--cpu-tolerance=", 16) == 0) {
+            options.Tolerance.CPUTime = std::stod(arg + 16);
+        } else if (std::strncmp(arg, "--gpu-tolerance=", 16) == 0) {
+            options.Tolerance.GPUTime = std::stod(arg + 16);
+        } else if (std::strncmp(arg, "--memory-tolerance=", 19) == 0) {
+            options.Tolerance.Memory = std::stod(arg + 19);
+        } else if (arg[0] != '-' && options.Scene.empty()) {
+            options.Scene = arg;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const auto& scenes = Test::GetRenderScenes();
+    auto entry = std::find_if(scenes.begin(), scenes.end(), [&](const Test::RenderSceneEntry& candidate) {
+        return candidate.Name == options.Scene;
+    });
+
+    if (entry == scenes.end() || options.Width == 0 || options.Height == 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path capturePath = options.OutputDirectory / (options.Scene + ".png");
+    std::filesystem::path goldenPath = options.GoldenDirectory / (options.Scene + ".png");
+    std::filesystem::path baselinePath = options.BaselineDirectory / (options.Scene + ".txt");
+
+    Log::Init();
+
+    Measurements measurements;
+    bool rendered = RenderScene(*entry, options, capturePath, measurements);
+
+    Log::Shutdown();
+
+    if (!rendered) {
+        std::printf("FAIL %s: the scene could not be rendered and captured\n", options.Scene.c_str());
+        return 1;
+    }
+
+    Test::PerfBaseline measured;
+    measured.SetDevice(measurements.Device);
+    measured.Set("cpu_ms", measurements.CPUTime);
+    measured.Set("memory_mb", measurements.Memory);
+    measured.Set("device_memory_mb", measurements.DeviceMemory);
+
+    // Without timestamp support there is nothing to compare.
+    if (measurements.GPUTime > 0.0)
+        measured.Set("gpu_ms", measurements.GPUTime);
+
+    measured.Save(options.OutputDirectory / (options.Scene + ".txt"));
+
+    if (options.Update) {
+        std::error_code error;
+        std::filesystem::create_directories(options.GoldenDirectory, error);
+        std::filesystem::copy_file(capturePath, goldenPath, std::filesystem::copy_options::overwrite_existing, error);
+
+        if (error || !measured.Save(baselinePath)) {
+            std::printf("FAIL %s: could not write the golden image or baseline\n", options.Scene.c_str());
+            return 1;
+        }
+
+        std::printf("Updated %s and %s\n", goldenPath.string().c_str(), baselinePath.string().c_str());
+        return 0;
+    }
+
+    bool failed = false;
+
+    Test::Image actual;
+    Test::Image expected;
+
+    if (!Test::LoadPNG(capturePath, actual)) {
+        std::printf("FAIL %s: could not read the capture %s\n", options.Scene.c_str(), capturePath.string().c_str());
+        return 1;
+    }
+
+    // A missing reference is a failure, a test that cannot compare anything must not pass.
+    if (!std::filesystem::exists(goldenPath)) {
+        std::printf("FAIL image: no golden image at %s, run with --update to create it\n", goldenPath.string().c_str());
+        failed = true;
+    } else if (!Test::LoadPNG(goldenPath, expected)) {
+        std::printf("FAIL image: could not read %s\n", goldenPath.string().c_str());
+        failed = true;
+    } else {
+        Test::ImageComparison comparison = Test::CompareImages(expected, actual, options.DeltaE);
+
+        if (!comparison.SizeMatches) {
+            std::printf("FAIL image: golden is %ux%u, capture is %ux%u\n", expected.Width, expected.Height, actual.Width, actual.Height);
+            failed = true;
+        } else {
+            bool passed = comparison.FailingFraction <= options.MaxFailing;
+
+            std::printf("%s image: %u pixels (%.4f%%) above delta E %.1f, max %.2f, mean %.3f\n", passed ? "PASS" : "FAIL",
+                comparison.FailingPixels, comparison.FailingFraction * 100.0f, options.DeltaE, comparison.MaxDeltaE, comparison.MeanDeltaE);
+
+            if (!passed) {
+                std::filesystem::path differencePath = options.OutputDirectory / (options.Scene + "_diff.png");
+                WritePNG(differencePath, comparison.Difference.Width, comparison.Difference.Height, comparison.Difference.Pixels.data(), static_cast<usize>(comparison.Difference.Width) * 4);
+
+                std::printf("     difference written to %s\n", differencePath.string().c_str());
+                failed = true;
+            }
+        }
+    }
+
+    Test::PerfBaseline baseline;
+    if (!baseline.Load(baselinePath)) {
+        std::printf("FAIL perf: no baseline at %s, run with --update to create it\n", baselinePath.string().c_str());
+        failed = true;
+    } else if (baseline.GetDevice() != measured.GetDevice()) {
+        // Timings and memory use only mean something on the device the
+        // baseline was recorded on, anywhere else they are only reported.
+        std::printf("SKIP perf: baseline recorded on \"%s\", running on \"%s\"\n", baseline.GetDevice().c_str(), measured.GetDevice().c_str());
+
+        for (const auto& [name, value] : measured.GetValues())
+            std::printf("     %-16s %10.3f\n", name.c_str(), value);
+    } else {
+        struct Metric
+        {
+            const char* Name;
+            f64 Tolerance;
+        };
+
+        for (const Metric& metric : { Metric { "cpu_ms", options.Tolerance.CPUTime }, Metric { "gpu_ms", options.Tolerance.GPUTime }, Metric { "memory_mb", options.Tolerance.Memory },
+            Metric { "device_memory_mb", options.Tolerance.Memory } }) {
+            if (!measured.Has(metric.Name) || !baseline.Has(metric.Name))
+                continue;
+
+            f64 value = measured.Get(metric.Name);
+            f64 reference = baseline.Get(metric.Name);
+            f64 limit = reference * (1.0 + metric.Tolerance);
+            bool passed = value <= limit;
+
+            std::printf("%s %-10s %10.3f baseline %10.3f limit %10.3f (%+.1f%%)\n", passed ? "PASS" : "FAIL",
+                metric.Name, value, reference, limit, reference > 0.0 ? (value / reference - 1.0) * 100.0 : 0.0);
+
+            failed |= !passed;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include "PerfBaseline.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__linux__)
+    #include <unistd.h>
+#endif
+
+namespace Graphics::Test {
+
+    bool PerfBaseline::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        m_Values.clear();
+        m_Device.clear();
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream stream(line);
+
+            std::string name;
+            stream >> name;
+
+            if (name == "device") {
+                std::getline(stream >> std::ws, m_Device);
+                continue;
+            }
+
+            f64 value = 0.0;
+            if (stream >> value)
+                m_Values[name] = value;
+        }
+
+        return true;
+    }
+
+    bool PerfBaseline::Save(const std::filesystem::path& path) const
+    {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!m_Device.empty())
+            file << "device " << m_Device << '\n';
+
+        for (const auto& [name, value] : m_Values)
+            file << name << ' ' << value << '\n';
+
+        return static_cast<bool>(file);
+    }
+
+    f64 GetProcessMemory()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return static_cast<f64>(counters.WorkingSetSize) / (1024.0 * 1024.0);
+#elif defined(__linux__)
+        // The second field of statm is the resident set in pages.
+        std::ifstream statm("/proc/self/statm");
+
+        u64 size = 0;
+        u64 resident = 0;
+        if (statm >> size >> resident)
+            return static_cast<f64>(resident * static_cast<u64>(sysconf(_SC_PAGESIZE))) / (1024.0 * 1024.0);
+#endif
+        return 0.0;
+    }
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include "Types.hpp"
+
+namespace Graphics::Test {
+
+    // Named measurements of one scene, e.g. "cpu_ms" -> 1.8. Stored as one
+    // "name value" pair per line so baselines diff cleanly in review, after
+    // a "device <name>" line naming the GPU they were measured on.
+    class PerfBaseline
+    {
+    public:
+        bool Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path) const;
+
+        inline void Set(const std::string& name, f64 value) { m_Values[name] = value; }
+        inline bool Has(const std::string& name) const { return m_Values.contains(name); }
+        inline f64 Get(const std::string& name) const { return m_Values.at(name); }
+
+        inline const std::map<std::string, f64>& GetValues() const { return m_Values; }
+
+        inline void SetDevice(const std::string& device) { m_Device = device; }
+        inline const std::string& GetDevice() const { return m_Device; }
+
+    private:
+        std::map<std::string, f64> m_Values;
+        std::string m_Device;
+    };
+
+    // Fraction by which each measurement may exceed its baseline before the
+    // test fails. Being faster or smaller than the baseline never fails.
+    struct PerfTolerance
+    {
+        f64 CPUTime { 0.25 };
+        f64 GPUTime { 0.25 };
+        f64 Memory { 0.10 };
+    };
+
+    // Resident memory of the test process, in megabytes.
+    f64 GetProcessMemory();
+
+}
@@ -0,0 +1,328 @@
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Core/Log.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Renderer/RenderGraph.hpp"
+
+using namespace Graphics;
+
+// Checks what a graph compiles to: culled passes, barriers and transient
+// memory. Nothing is executed, the renderer is only there for a device and
+// memory tracker to hand the graph.
+
+struct Check
+{
+    const char* Name;
+    std::function<bool(Renderer&)> Run;
+};
+
+static bool Expect(bool condition, const char* what)
+{
+    if (!condition)
+        std::printf("     expected %s\n", what);
+
+    return condition;
+}
+
+// The barrier on resource in the batch, or nullptr.
+static const RenderGraphBarrier* FindBarrier(const std::vector<RenderGraphBarrier>& barriers, RenderGraphResource resource)
+{
+    for (const auto& barrier : barriers) {
+        if (barrier.Resource.Index == resource.Index)
+            return &barrier;
+    }
+
+    return nullptr;
+}
+
+static RenderGraphResource ImportTarget(RenderGraph& graph)
+{
+    RenderGraphImageDesc desc;
+    desc.Format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    desc.Extent = { 64, 64 };
+
+    return graph.ImportImage("Target", desc, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE);
+}
+
+static RenderGraphImageDesc ColorDesc(VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT)
+{
+    RenderGraphImageDesc desc;
+    desc.Format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    desc.Extent = { 64, 64 };
+    desc.Samples = samples;
+
+    return desc;
+}
+
+static bool HasLazyMemory(Renderer& renderer)
+{
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties(renderer.GetPhysicalDevice(), &properties);
+
+    for (u32 i = 0; i < properties.memoryTypeCount; ++i) {
+        if (properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+            return true;
+    }
+
+    return false;
+}
+
+// Passes are kept only if they lead to an imported resource or a side effect,
+// a chain that ends in an unread transient is dropped as a whole.
+static bool CullsUnreferencedPasses(Renderer& renderer)
+{
+    RenderGraph graph(renderer.GetDevice(), renderer.GetPhysicalDevice(), renderer.GetMemoryTracker());
+    RenderGraphResource target = ImportTarget(graph);
+    RenderGraphResource produced;
+    RenderGraphResource unused;
+    RenderGraphResource unread;
+
+    graph.AddPass("Producer", [&](RenderGraphPassBuilder& builder) {
+        produced = builder.CreateImage("Produced", ColorDesc());
+        builder.WriteColor(produced, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Unused", [&](RenderGraphPassBuilder& builder) {
+        unused = builder.CreateImage("Unused", ColorDesc());
+        builder.WriteColor(unused, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("UnusedReader", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(unused, RenderGraphAccess::SampledFragment);
+        unread = builder.CreateImage("Unread", ColorDesc());
+        builder.WriteColor(unread, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Consumer", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(produced, RenderGraphAccess::SampledFragment);
+        builder.WriteColor(target, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.Compile();
+
+    bool passed = true;
+
+    passed &= Expect(graph.GetPassCount() == 4, "every pass to be recorded");
+    if (!Expect(graph.GetActivePassCount() == 2, "the unused chain to be culled"))
+        return false;
+
+    passed &= Expect(graph.GetActivePassName(0) == "Producer", "the producer to run first");
+    passed &= Expect(graph.GetActivePassName(1) == "Consumer", "the consumer to run second");
+    passed &= Expect(graph.GetMemoryBlock(produced) != ~0u, "memory for the produced image");
+    passed &= Expect(graph.GetMemoryBlock(unused) == ~0u, "no memory for an image only culled passes touch");
+    passed &= Expect(graph.GetMemoryBlock(unread) == ~0u, "no memory for an image nothing reads");
+
+    return passed;
+}
+
+// A chain of three transients where each lives for two passes: the first and
+// the last never overlap and share memory, the middle one overlaps both.
+static bool AliasesDisjointTransients(Renderer& renderer)
+{
+    RenderGraph graph(renderer.GetDevice(), renderer.GetPhysicalDevice(), renderer.GetMemoryTracker());
+    RenderGraphResource target = ImportTarget(graph);
+    RenderGraphResource first;
+    RenderGraphResource second;
+    RenderGraphResource third;
+
+    graph.AddPass("First", [&](RenderGraphPassBuilder& builder) {
+        first = builder.CreateImage("First", ColorDesc());
+        builder.WriteColor(first, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Second", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(first, RenderGraphAccess::SampledFragment);
+        second = builder.CreateImage("Second", ColorDesc());
+        builder.WriteColor(second, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Third", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(second, RenderGraphAccess::SampledFragment);
+        third = builder.CreateImage("Third", ColorDesc());
+        builder.WriteColor(third, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Final", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(third, RenderGraphAccess::SampledFragment);
+        builder.WriteColor(target, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.Compile();
+
+    if (!Expect(graph.GetActivePassCount() == 4, "no pass to be culled"))
+        return false;
+
+    bool passed = true;
+
+    passed &= Expect(graph.GetMemoryBlockCount() == 2, "two memory blocks for three transients");
+    passed &= Expect(graph.GetMemoryBlock(first) == graph.GetMemoryBlock(third), "the first and third image to share memory");
+    passed &= Expect(graph.GetMemoryBlock(first) != graph.GetMemoryBlock(second), "the first and second image to use separate memory");
+    passed &= Expect(graph.GetMemoryBlock(second) != graph.GetMemoryBlock(third), "the second and third image to use separate memory");
+
+    return passed;
+}
+
+// Multisampled color and depth only ever live in attachments and get lazily
+// allocated memory of their own where the device has it. A sampled transient
+// is always backed by real memory.
+static bool LazilyAllocatesAttachmentOnlyTransients(Renderer& renderer)
+{
+    RenderGraph graph(renderer.GetDevice(), renderer.GetPhysicalDevice(), renderer.GetMemoryTracker());
+    RenderGraphResource target = ImportTarget(graph);
+    RenderGraphResource sampled;
+    RenderGraphResource multisampled;
+    RenderGraphResource depth;
+
+    graph.AddPass("Sampled", [&](RenderGraphPassBuilder& builder) {
+        sampled = builder.CreateImage("Sampled", ColorDesc());
+        builder.WriteColor(sampled, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Resolve", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(sampled, RenderGraphAccess::SampledFragment);
+
+        multisampled = builder.CreateImage("Multisampled", ColorDesc(VK_SAMPLE_COUNT_4_BIT));
+        builder.WriteColor(multisampled, VK_ATTACHMENT_LOAD_OP_CLEAR, {}, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+        builder.ResolveColor(multisampled, target);
+
+        RenderGraphImageDesc depthDesc;
+        depthDesc.Format = VK_FORMAT_D32_SFLOAT;
+        depthDesc.Extent = { 64, 64 };
+        depthDesc.Samples = VK_SAMPLE_COUNT_4_BIT;
+
+        depth = builder.CreateImage("Depth", depthDesc);
+        builder.WriteDepth(depth, VK_ATTACHMENT_LOAD_OP_CLEAR, {}, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.Compile();
+
+    if (!Expect(graph.GetActivePassCount() == 2, "no pass to be culled"))
+        return false;
+
+    bool lazy = HasLazyMemory(renderer);
+    bool passed = true;
+
+    u32 sampledBlock = graph.GetMemoryBlock(sampled);
+    u32 multisampledBlock = graph.GetMemoryBlock(multisampled);
+    u32 depthBlock = graph.GetMemoryBlock(depth);
+
+    if (!Expect(sampledBlock != ~0u && multisampledBlock != ~0u && depthBlock != ~0u, "memory for every transient"))
+        return false;
+
+    passed &= Expect(!graph.IsMemoryBlockLazy(sampledBlock), "the sampled image in real memory");
+    passed &= Expect(graph.IsMemoryBlockLazy(multisampledBlock) == lazy, lazy ? "the multisampled image in lazy memory" : "no lazy memory without a lazy memory type");
+    passed &= Expect(graph.IsMemoryBlockLazy(depthBlock) == lazy, lazy ? "the depth image in lazy memory" : "no lazy memory without a lazy memory type");
+
+    // Lazy allocations are never aliased, each attachment keeps its own.
+    if (lazy) {
+        passed &= Expect(multisampledBlock != depthBlock && multisampledBlock != sampledBlock, "a lazy block of its own for the multisampled image");
+        passed &= Expect(graph.GetMemoryBlockCount() == 3, "one real and two lazy memory blocks");
+    }
+
+    return passed;
+}
+
+// A color write sampled by compute and then by a fragment shader in the same
+// layout: both reads need the write made visible to their own stage.
+static bool WriteThenComputeThenFragmentRead(Renderer& renderer)
+{
+    RenderGraph graph(renderer.GetDevice(), renderer.GetPhysicalDevice(), renderer.GetMemoryTracker());
+    RenderGraphResource target = ImportTarget(graph);
+
+    graph.AddPass("Write", [&](RenderGraphPassBuilder& builder) {
+        builder.WriteColor(target, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("ComputeRead", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(target, RenderGraphAccess::SampledCompute);
+        builder.SideEffect();
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("FragmentRead", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(target, RenderGraphAccess::SampledFragment);
+        builder.SideEffect();
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("SecondFragmentRead", [&](RenderGraphPassBuilder& builder) {
+        builder.Read(target, RenderGraphAccess::SampledFragment);
+        builder.SideEffect();
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.AddPass("Overwrite", [&](RenderGraphPassBuilder& builder) {
+        builder.Write(target, RenderGraphAccess::StorageWriteCompute);
+    }, [](VkCommandBuffer, const RenderGraph&) {});
+
+    graph.Compile();
+
+    if (!Expect(graph.GetActivePassCount() == 5, "no pass to be culled"))
+        return false;
+
+    bool passed = true;
+
+    const auto computeBarriers = graph.GetPassBarriers(1);
+    const RenderGraphBarrier* compute = FindBarrier(computeBarriers, target);
+    passed &= Expect(compute != nullptr, "a barrier in front of the compute read");
+    if (compute) {
+        passed &= Expect(compute->SrcStage & VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, "the compute read to wait on the color write");
+        passed &= Expect(compute->SrcAccess & VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, "the color write to be made available to the compute read");
+        passed &= Expect(compute->DstStage & VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, "the compute read in the destination scope");
+        passed &= Expect(compute->NewLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, "a transition to shader read only");
+    }
+
+    const auto fragmentBarriers = graph.GetPassBarriers(2);
+    const RenderGraphBarrier* fragment = FindBarrier(fragmentBarriers, target);
+    passed &= Expect(fragment != nullptr, "a barrier in front of the fragment read");
+    if (fragment) {
+        passed &= Expect(fragment->SrcStage & VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, "the fragment read to wait on the color write");
+        passed &= Expect(fragment->SrcAccess & VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, "the color write to be made available to the fragment read");
+        passed &= Expect(fragment->DstStage & VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, "the fragment read in the destination scope");
+        passed &= Expect(fragment->DstAccess & VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, "sampled reads in the destination scope");
+        passed &= Expect(fragment->OldLayout == fragment->NewLayout, "no layout transition between the reads");
+    }
+
+    // The write is already visible to fragment shaders.
+    const auto repeatBarriers = graph.GetPassBarriers(3);
+    passed &= Expect(FindBarrier(repeatBarriers, target) == nullptr, "no barrier in front of the second fragment read");
+
+    const auto overwriteBarriers = graph.GetPassBarriers(4);
+    const RenderGraphBarrier* overwrite = FindBarrier(overwriteBarriers, target);
+    passed &= Expect(overwrite != nullptr, "a barrier in front of the overwrite");
+    if (overwrite) {
+        passed &= Expect(overwrite->SrcStage & VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, "the overwrite to wait on the compute read");
+        passed &= Expect(overwrite->SrcStage & VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, "the overwrite to wait on the fragment reads");
+        passed &= Expect(overwrite->NewLayout == VK_IMAGE_LAYOUT_GENERAL, "a transition to general");
+    }
+
+    return passed;
+}
+
+int main()
+{
+    Log::Init();
+
+    std::vector<Check> checks = {
+        { "WriteThenComputeThenFragmentRead", WriteThenComputeThenFragmentRead },
+        { "CullsUnreferencedPasses", CullsUnreferencedPasses },
+        { "AliasesDisjointTransients", AliasesDisjointTransients },
+        { "LazilyAllocatesAttachmentOnlyTransients", LazilyAllocatesAttachmentOnlyTransients }
+    };
+
+    bool failed = false;
+
+    {
+        auto renderer = std::make_unique<Renderer>(VkExtent2D { 64, 64 });
+
+        for (const auto& check : checks) {
+            bool passed = check.Run(*renderer);
+            std::printf("%s %s\n", passed ? "PASS" : "FAIL", check.Name);
+            failed |= !passed;
+        }
+    }
+
+    Log::Shutdown();
+
+    return failed ? 1 : 0;
+}
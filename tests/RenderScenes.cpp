@@ -0,0 +1,227 @@
+#include "RenderScenes.hpp"
+
+#include <cmath>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Renderer/Renderer.hpp"
+#include "Renderer/Renderer2D.hpp"
+#include "Renderer/MeshRenderer.hpp"
+#include "Renderer/Mesh.hpp"
+#include "Renderer/MeshData.hpp"
+#include "Renderer/ParticleSystem.hpp"
+
+namespace Graphics::Test {
+
+    // Reverse-Z like the application: near and far are swapped so the near plane maps to depth 1.
+    static glm::mat4 Perspective(f32 aspect)
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), aspect, 500.0f, 0.1f);
+        projection[1][1] *= -1.0f;
+
+        return projection;
+    }
+
+    static glm::mat4 Orthographic(f32 aspect)
+    {
+        glm::mat4 projection = glm::ortho(-aspect, aspect, -1.0f, 1.0f);
+        projection[1][1] *= -1.0f;
+
+        return projection;
+    }
+
+    // The renderer's built-in quad seen at an angle, through the frame data and push constants.
+    class QuadScene : public RenderScene
+    {
+    public:
+        void Draw(Renderer& renderer, f32 aspect) override
+        {
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 1.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = Perspective(aspect);
+
+            renderer.SetCamera(view, projection);
+            renderer.SetTriangleTransform(glm::scale(glm::rotate(glm::mat4(1.0f), 0.6f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.0f)));
+
+            renderer.GetMeshRenderer().BeginScene(view, projection);
+            renderer.GetMeshRenderer().EndScene();
+
+            renderer.Get2D().BeginScene(Orthographic(aspect));
+            renderer.Get2D().EndScene();
+        }
+    };
+
+    // Every Renderer2D primitive over a grid of batched quads.
+    class SpriteScene : public RenderScene
+    {
+    public:
+        void Draw(Renderer& renderer, f32 aspect) override
+        {
+            glm::mat4 projection = Orthographic(aspect);
+
+            // The quad is collapsed to a point, it would cover the sprites.
+            renderer.SetCamera(glm::mat4(1.0f), projection);
+            renderer.SetTriangleTransform(glm::mat4(0.0f));
+
+            renderer.GetMeshRenderer().BeginScene(glm::mat4(1.0f), projection);
+            renderer.GetMeshRenderer().EndScene();
+
+            Renderer2D& renderer2D = renderer.Get2D();
+            renderer2D.BeginScene(projection);
+
+            constexpr u32 gridSize = 24;
+            glm::vec2 cellSize = glm::vec2(2.0f * aspect, 2.0f) / static_cast<f32>(gridSize);
+
+            for (u32 y = 0; y < gridSize; ++y) {
+                for (u32 x = 0; x < gridSize; ++x) {
+                    glm::vec3 position(-aspect + (x + 0.5f) * cellSize.x, -1.0f + (y + 0.5f) * cellSize.y, 0.0f);
+                    glm::vec4 color(static_cast<f32>(x) / gridSize, static_cast<f32>(y) / gridSize, 0.5f, 1.0f);
+
+                    renderer2D.DrawQuad(position, cellSize * 0.8f, color);
+                }
+            }
+
+            renderer2D.DrawRect(glm::vec3(0.0f), glm::vec2(1.1f), glm::vec4(1.0f));
+            renderer2D.DrawRotatedQuad(glm::vec3(-0.5f * aspect, 0.5f, 0.0f), glm::vec2(0.4f), 0.7f, glm::vec4(0.9f, 0.4f, 0.2f, 1.0f));
+            renderer2D.DrawCircle(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f * aspect, 0.5f, 0.0f)), glm::vec3(0.5f)), glm::vec4(0.2f, 0.6f, 0.9f, 1.0f), 0.2f);
+            renderer2D.DrawLine(glm::vec3(-aspect, -1.0f, 0.0f), glm::vec3(aspect, 1.0f, 0.0f), glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
+
+            renderer2D.EndScene();
+        }
+    };
+
+    // A field of LOD meshes behind a large occluder, through the prepass, culling and LOD paths.
+    class MeshFieldScene : public RenderScene
+    {
+    public:
+        void Setup(Renderer& renderer) override
+        {
+            m_Mesh = std::make_unique<Mesh>(renderer, MeshData::CreateIcosphere(4));
+
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<f32> jitter(-0.4f, 0.4f);
+
+            constexpr i32 gridSize = 16;
+            constexpr f32 spacing = 6.0f;
+
+            for (i32 z = 0; z < gridSize; ++z) {
+                for (i32 x = 0; x < gridSize; ++x) {
+                    glm::vec3 position((x - gridSize / 2 + jitter(rng)) * spacing, 1.0f, (z - gridSize / 2 + jitter(rng)) * spacing);
+                    m_Instances.push_back({ glm::translate(glm::mat4(1.0f), position) });
+                }
+            }
+
+            m_Instances.push_back({ glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 4.0f, 0.0f)), glm::vec3(8.0f)) });
+        }
+
+        void Draw(Renderer& renderer, f32 aspect) override
+        {
+            glm::mat4 view = glm::lookAt(glm::vec3(20.0f, 3.0f, 6.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = Perspective(aspect);
+
+            renderer.SetCamera(view, projection);
+            renderer.SetTriangleTransform(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(12.0f, 4.0f, 0.0f)), glm::vec3(4.0f)));
+
+            MeshRenderer& meshRenderer = renderer.GetMeshRenderer();
+            meshRenderer.BeginScene(view, projection);
+
+            for (auto& instance : m_Instances)
+                meshRenderer.Submit(*m_Mesh, instance.Transform, instance.State);
+
+            meshRenderer.EndScene();
+
+            renderer.Get2D().BeginScene(Orthographic(aspect));
+            renderer.Get2D().EndScene();
+        }
+
+    private:
+        struct Instance
+        {
+            glm::mat4 Transform;
+            MeshInstanceState State;
+        };
+
+        std::unique_ptr<Mesh> m_Mesh;
+        std::vector<Instance> m_Instances;
+    };
+
+    // Fountains of about a million particles bouncing off a sphere, the
+    // particle benchmark. A fixed time step spawns the same particles every
+    // run, additive blending hides the order the GPU appends them in.
+    class ParticleScene : public RenderScene
+    {
+    public:
+        void Setup(Renderer& renderer) override
+        {
+            m_Mesh = std::make_unique<Mesh>(renderer, MeshData::CreateIcosphere(4));
+
+            // The renderer frees the group with the rest of the particle system.
+            ParticleSystem& particles = renderer.GetParticleSystem();
+            particles.SetFixedTimeStep(1.0f / 60.0f);
+
+            ParticleGroupDesc desc;
+            desc.Capacity = 1u << 20;
+            desc.Restitution = 0.3f;
+            m_Group = particles.CreateGroup(desc);
+
+            std::vector<ParticleEmitter> emitters;
+            for (u32 i = 0; i < 4; ++i) {
+                f32 angle = glm::radians(90.0f * i + 45.0f);
+
+                ParticleEmitter emitter;
+                emitter.Position = glm::vec3(std::cos(angle) * 6.0f, 0.5f, std::sin(angle) * 6.0f);
+                emitter.Radius = 0.2f;
+                emitter.Velocity = glm::vec3(-std::cos(angle) * 3.0f, 9.0f, -std::sin(angle) * 3.0f);
+                emitter.Spread = 1.0f;
+                emitter.StartColor = glm::vec4(0.2f + 0.2f * i, 0.5f, 1.0f - 0.2f * i, 0.6f);
+                emitter.EndColor = glm::vec4(1.0f, 0.3f, 0.1f, 0.0f);
+                emitter.StartSize = 0.03f;
+                emitter.EndSize = 0.01f;
+                emitter.Lifetime = 1.6f;
+                emitter.LifetimeVariance = 0.3f;
+                emitter.Rate = 150000.0f;
+
+                emitters.push_back(emitter);
+            }
+
+            particles.SetEmitters(m_Group, emitters);
+        }
+
+        void Draw(Renderer& renderer, f32 aspect) override
+        {
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 6.0f, 16.0f), glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 projection = Perspective(aspect);
+
+            renderer.SetCamera(view, projection);
+            renderer.SetTriangleTransform(glm::mat4(0.0f));
+
+            MeshRenderer& meshRenderer = renderer.GetMeshRenderer();
+            meshRenderer.BeginScene(view, projection);
+            meshRenderer.Submit(*m_Mesh, glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(3.0f)), m_State);
+            meshRenderer.EndScene();
+
+            renderer.Get2D().BeginScene(Orthographic(aspect));
+            renderer.Get2D().EndScene();
+        }
+
+    private:
+        u32 m_Group { ~0u };
+
+        std::unique_ptr<Mesh> m_Mesh;
+        MeshInstanceState m_State;
+    };
+
+    const std::vector<RenderSceneEntry>& GetRenderScenes()
+    {
+        static const std::vector<RenderSceneEntry> s_Scenes = {
+            { "Quad", [] { return std::make_unique<QuadScene>(); } },
+            { "Sprites", [] { return std::make_unique<SpriteScene>(); } },
+            { "MeshField", [] { return std::make_unique<MeshFieldScene>(); } },
+            { "Particles", [] { return std::make_unique<ParticleScene>(); } }
+        };
+
+        return s_Scenes;
+    }
+
+}
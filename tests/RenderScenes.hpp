@@ -0,0 +1,36 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace Graphics {
+    class Renderer;
+}
+
+namespace Graphics::Test {
+
+    // A scripted scene drawn the same way every frame, so the rendered image
+    // only changes when the renderer does. Draw() is called between BeginFrame
+    // and EndFrame and submits everything the frame shows.
+    class RenderScene
+    {
+    public:
+        virtual ~RenderScene() = default;
+
+        virtual void Setup(Renderer&) {}
+        virtual void Draw(Renderer& renderer, f32 aspect) = 0;
+    };
+
+    struct RenderSceneEntry
+    {
+        std::string Name;
+        std::function<std::unique_ptr<RenderScene>()> Create;
+    };
+
+    const std::vector<RenderSceneEntry>& GetRenderScenes();
+
+}